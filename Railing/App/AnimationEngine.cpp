@@ -0,0 +1,212 @@
+#include "AnimationEngine.h"
+#include <cmath>
+
+Easing EasingFromName(std::string_view name)
+{
+    if (name == "linear") return Easing::Linear;
+    if (name == "ease_in") return Easing::EaseIn;
+    if (name == "ease_out") return Easing::EaseOut;
+    if (name == "ease_in_out") return Easing::EaseInOut;
+    if (name == "ease_out_back") return Easing::EaseOutBack;
+    if (name == "spring") return Easing::Spring;
+    return Easing::EaseOut;
+}
+
+const char *EasingName(Easing easing)
+{
+    switch (easing) {
+    case Easing::Linear: return "linear";
+    case Easing::EaseIn: return "ease_in";
+    case Easing::EaseInOut: return "ease_in_out";
+    case Easing::EaseOutBack: return "ease_out_back";
+    case Easing::Spring: return "spring";
+    default: return "ease_out";
+    }
+}
+
+float ApplyEasing(Easing easing, float t)
+{
+    if (t <= 0.0f) return 0.0f;
+    if (t >= 1.0f) return 1.0f;
+
+    float u = 1.0f - t;
+    switch (easing) {
+    case Easing::EaseIn: return t * t * t;
+    case Easing::EaseOut: return 1.0f - u * u * u;
+    case Easing::EaseInOut: return t < 0.5f ? 4.0f * t * t * t : 1.0f - 4.0f * u * u * u;
+    case Easing::EaseOutBack: {
+        const float c1 = 1.70158f;
+        return 1.0f - u * u * u * (c1 + 1.0f) + u * u * c1;
+    }
+    default: return t;
+    }
+}
+
+AnimHandle AnimationEngine::Create(uint32_t clientBits, const float *values, int laneCount, float lanePrecision)
+{
+    if (laneCount < 1 || laneCount > MAX_LANES) return INVALID_ANIM;
+
+    AnimHandle handle;
+    std::vector<AnimHandle> &reuse = freeChannels[laneCount];
+    if (!reuse.empty()) {
+        handle = reuse.back();
+        reuse.pop_back();
+    }
+    else {
+        handle = (AnimHandle)value.size();
+        size_t size = value.size() + laneCount;
+        value.resize(size); from.resize(size); to.resize(size);
+        velocity.resize(size); stiffness.resize(size); damping.resize(size);
+        precision.resize(size); stamp.resize(size); duration.resize(size);
+        clients.resize(size); easing.resize(size); slot.resize(size, -1);
+        lanes.resize(size, 0);
+    }
+
+    for (int i = 0; i < laneCount; i++) {
+        uint32_t l = handle + i;
+        value[l] = from[l] = to[l] = values[i];
+        velocity[l] = 0.0f;
+        precision[l] = lanePrecision;
+        clients[l] = clientBits;
+        easing[l] = Easing::Linear;
+        slot[l] = -1;
+    }
+    lanes[handle] = (uint8_t)laneCount;
+    return handle;
+}
+
+void AnimationEngine::Release(AnimHandle handle)
+{
+    if (handle >= lanes.size() || !lanes[handle]) return;
+    int laneCount = lanes[handle];
+    for (int i = 0; i < laneCount; i++) Deactivate(handle + i);
+    lanes[handle] = 0;
+    freeChannels[laneCount].push_back(handle);
+}
+
+void AnimationEngine::AnimateTo(AnimHandle handle, const float *targets, const AnimationCurve &c)
+{
+    if (handle >= lanes.size() || !lanes[handle]) return;
+    bool spring = c.easing == Easing::Spring;
+    uint64_t now = clock.NowMs();
+
+    for (int i = 0; i < lanes[handle]; i++) {
+        uint32_t l = handle + i;
+        bool moving = slot[l] >= 0;
+        if (moving ? targets[i] == to[l] : targets[i] == value[l]) continue;
+
+        if (!spring && c.durationMs == 0) {
+            Deactivate(l);
+            value[l] = to[l] = targets[i];
+            continue;
+        }
+
+        // Switching between tween and spring moves the lane to the other batch
+        if (moving && (easing[l] == Easing::Spring) != spring) {
+            Deactivate(l);
+            moving = false;
+        }
+
+        from[l] = value[l];
+        to[l] = targets[i];
+        easing[l] = c.easing;
+        duration[l] = c.durationMs;
+        stiffness[l] = c.stiffness;
+        damping[l] = c.damping;
+        // A retargeted spring keeps integrating from where it was, velocity included
+        if (!spring || !moving) stamp[l] = now;
+        if (!moving) {
+            if (!spring) velocity[l] = 0.0f;
+            Activate(l, spring);
+        }
+    }
+}
+
+void AnimationEngine::Set(AnimHandle handle, const float *values)
+{
+    if (handle >= lanes.size() || !lanes[handle]) return;
+    for (int i = 0; i < lanes[handle]; i++) {
+        uint32_t l = handle + i;
+        Deactivate(l);
+        value[l] = from[l] = to[l] = values[i];
+        velocity[l] = 0.0f;
+    }
+}
+
+bool AnimationEngine::IsActive(AnimHandle handle) const
+{
+    if (handle >= lanes.size()) return false;
+    for (int i = 0; i < lanes[handle]; i++) {
+        if (slot[handle + i] >= 0) return true;
+    }
+    return false;
+}
+
+void AnimationEngine::StepTo(uint64_t now)
+{
+    if (IsIdle()) return;
+    steps++;
+    lanesStepped += tweens.size() + springs.size();
+
+    // Tweens are a pure function of elapsed time
+    for (size_t i = 0; i < tweens.size();) {
+        uint32_t l = tweens[i];
+        uint64_t elapsed = now > stamp[l] ? now - stamp[l] : 0;
+        if (elapsed >= duration[l]) {
+            value[l] = to[l];
+            Deactivate(l); // Swaps the last tween into i
+            continue;
+        }
+        float t = (float)elapsed / (float)duration[l];
+        value[l] = from[l] + (to[l] - from[l]) * ApplyEasing(easing[l], t);
+        i++;
+    }
+
+    // Springs integrate in fixed steps so the motion doesn't depend on the frame rate
+    const float dt = SPRING_STEP_MS / 1000.0f;
+    for (size_t i = 0; i < springs.size();) {
+        uint32_t l = springs[i];
+        bool settled = now > stamp[l] && now - stamp[l] > MAX_CATCH_UP_MS;
+        while (!settled && stamp[l] + SPRING_STEP_MS <= now) {
+            float accel = -stiffness[l] * (value[l] - to[l]) - damping[l] * velocity[l];
+            velocity[l] += accel * dt;
+            value[l] += velocity[l] * dt;
+            stamp[l] += SPRING_STEP_MS;
+            settled = std::fabs(value[l] - to[l]) < precision[l] && std::fabs(velocity[l]) < precision[l] * 10.0f;
+        }
+        if (settled) {
+            value[l] = to[l];
+            velocity[l] = 0.0f;
+            Deactivate(l);
+            continue;
+        }
+        i++;
+    }
+}
+
+uint32_t AnimationEngine::ActiveClients() const
+{
+    uint32_t bits = 0;
+    for (uint32_t l : tweens) bits |= clients[l];
+    for (uint32_t l : springs) bits |= clients[l];
+    return bits;
+}
+
+void AnimationEngine::Activate(uint32_t lane, bool spring)
+{
+    std::vector<uint32_t> &batch = spring ? springs : tweens;
+    slot[lane] = (int32_t)batch.size();
+    batch.push_back(lane);
+}
+
+void AnimationEngine::Deactivate(uint32_t lane)
+{
+    int32_t at = slot[lane];
+    if (at < 0) return;
+    std::vector<uint32_t> &batch = easing[lane] == Easing::Spring ? springs : tweens;
+    uint32_t last = batch.back();
+    batch[at] = last;
+    slot[last] = at;
+    batch.pop_back();
+    slot[lane] = -1;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include <string_view>
+#include <cstdint>
+#include "FrameScheduler.h"
+
+// Time-based animation for a bar. Owners (the dock highlight, the auto-hide
+// slide) allocate channels of one to four float lanes - a position, a colour -
+// and retarget them; the engine keeps the lanes that are moving in flat arrays
+// and steps them all at once per frame from the bar's clock, so an animation
+// takes the same time however many frames get dropped. Owners tag channels
+// with FrameClient bits and the bar keeps requesting frames for whatever
+// ActiveClients() reports, which is nothing once every channel has settled.
+
+enum class Easing : uint8_t {
+    Linear = 0,
+    EaseIn,
+    EaseOut,
+    EaseInOut,
+    EaseOutBack,
+    Spring, // Damped spring: ignores duration, keeps velocity across retargets
+};
+
+// "ease_in_out" -> Easing::EaseInOut; unknown names map to EaseOut
+Easing EasingFromName(std::string_view name);
+const char *EasingName(Easing easing);
+// Eased progress for t in [0, 1]
+float ApplyEasing(Easing easing, float t);
+
+struct AnimationCurve {
+    Easing easing = Easing::EaseOut;
+    uint32_t durationMs = 300;  // Tweens; 0 jumps straight to the target
+    float stiffness = 170.0f;   // Springs
+    float damping = 26.0f;
+};
+
+using AnimHandle = uint32_t;
+constexpr AnimHandle INVALID_ANIM = UINT32_MAX;
+
+class AnimationEngine
+{
+public:
+    static constexpr int MAX_LANES = 4;
+    static constexpr uint32_t SPRING_STEP_MS = 4;   // Fixed integration step
+    static constexpr uint32_t MAX_CATCH_UP_MS = 1000; // Longer gaps (sleep, a stalled thread) snap
+
+    explicit AnimationEngine(const FrameClock &clock) : clock(clock) {}
+
+    /// <summary>
+    /// Allocate a channel of `lanes` floats starting at `values`. `clients` are
+    /// the FrameClient bits that need frames while it moves; it has settled once
+    /// every lane is within `precision` of its target.
+    /// </summary>
+    AnimHandle Create(uint32_t clients, const float *values, int lanes, float precision = 0.001f);
+    AnimHandle Create(uint32_t clients, float value, float precision = 0.001f) { return Create(clients, &value, 1, precision); }
+    void Release(AnimHandle handle);
+
+    /// <summary>
+    /// Start moving towards `targets` from the current values. Retargeting to
+    /// the target already in flight is a no-op, so owners may call this every frame.
+    /// </summary>
+    void AnimateTo(AnimHandle handle, const float *targets, const AnimationCurve &curve);
+    void AnimateTo(AnimHandle handle, float target, const AnimationCurve &curve) { AnimateTo(handle, &target, curve); }
+    // Jump to `values`, stopping any animation
+    void Set(AnimHandle handle, const float *values);
+    void Set(AnimHandle handle, float value) { Set(handle, &value); }
+
+    float Get(AnimHandle handle, int lane = 0) const { return value[handle + lane]; }
+    float GetTarget(AnimHandle handle, int lane = 0) const { return to[handle + lane]; }
+    bool IsActive(AnimHandle handle) const;
+
+    // Advance every moving lane to the clock's current time
+    void Step() { StepTo(clock.NowMs()); }
+    void StepTo(uint64_t nowMs);
+
+    bool IsIdle() const { return tweens.empty() && springs.empty(); }
+    // FrameClient bits of the channels still moving
+    uint32_t ActiveClients() const;
+    size_t ActiveLanes() const { return tweens.size() + springs.size(); }
+
+    // The bar's configured curve (global.animation)
+    AnimationCurve curve;
+
+    uint64_t steps = 0;        // Batches run
+    uint64_t lanesStepped = 0; // Lanes advanced across all batches
+
+private:
+    const FrameClock &clock;
+
+    // One entry per lane; a channel's lanes are contiguous and its handle is
+    // the index of the first one
+    std::vector<float> value;
+    std::vector<float> from;
+    std::vector<float> to;
+    std::vector<float> velocity;  // Springs, units per second
+    std::vector<float> stiffness;
+    std::vector<float> damping;
+    std::vector<float> precision;
+    std::vector<uint64_t> stamp;  // Tween start, or the spring's last integrated time
+    std::vector<uint32_t> duration;
+    std::vector<uint32_t> clients;
+    std::vector<Easing> easing;
+    std::vector<int32_t> slot;    // Position in tweens/springs, -1 while at rest
+    std::vector<uint8_t> lanes;   // Channel width, on the first lane; 0 when free
+
+    // Moving lanes, stepped as one batch each
+    std::vector<uint32_t> tweens;
+    std::vector<uint32_t> springs;
+    std::vector<AnimHandle> freeChannels[MAX_LANES + 1];
+
+    void Activate(uint32_t lane, bool spring);
+    void Deactivate(uint32_t lane);
+};
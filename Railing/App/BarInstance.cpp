@@ -2,16 +2,36 @@
 #include <PinnedAppsIO.h>
 #include <WindowMonitor.h>
 #include "InputManager.h"
+#include "FrameProfiler.h"
 #include <windowsx.h>
 #include <VolumeFlyout.h>
 #include <AppBarManager.h>
 #include <wchar.h>
+#include <stdio.h>
+#include <cmath>
 #define STATS_TIMER_ID 1
 
 UINT WM_SHELLHOOKMESSAGE = RegisterWindowMessageW(L"SHELLHOOK");
 UINT WM_TASKBARCREATED = RegisterWindowMessageW(L"TaskbarCreated");
 UINT WM_APPBAR_CALL = RegisterWindowMessageW(L"AppBarMessage");
 
+// Raw mouse input goes to a single window per process; it fans out to every auto-hiding bar
+static HWND rawInputTarget = nullptr;
+
+static void RegisterMouseInput(HWND target) {
+    RAWINPUTDEVICE rid;
+    rid.usUsagePage = 0x01;  // Generic desktop
+    rid.usUsage = 0x02;      // Mouse
+    rid.dwFlags = target ? RIDEV_INPUTSINK : RIDEV_REMOVE; // Receive input even when not in foreground
+    rid.hwndTarget = target;
+
+    if (!RegisterRawInputDevices(&rid, 1, sizeof(rid))) {
+        OutputDebugStringW(L"[RAILING] Failed to register raw input!\n");
+        return;
+    }
+    rawInputTarget = target;
+}
+
 BarInstance::BarInstance(const std::string &configFile) : configFileName(configFile)
 {
 	config = ThemeLoader::Load(configFile.c_str());
@@ -20,6 +40,15 @@ BarInstance::~BarInstance() {
     if (hwnd) {
         KillTimer(hwnd, STATS_TIMER_ID); // Kill stats timer
         KillTimer(hwnd, ANIMATION_TIMER_ID); // Kill anim timer
+        if (rawInputTarget == hwnd) {
+            HWND next = nullptr;
+            if (Railing::instance) {
+                for (BarInstance *bar : Railing::instance->bars) {
+                    if (bar != this && bar->hwnd && bar->config.global.autoHide) { next = bar->hwnd; break; }
+                }
+            }
+            RegisterMouseInput(next);
+        }
         UnregisterHotKey(hwnd, 900);
         if (isPrimary) {
             for (int i = 0; i < 5; i++) UnregisterHotKey(hwnd, 100 + i);
@@ -57,17 +86,7 @@ bool BarInstance::Initialize(HINSTANCE hInstance, bool makePrimary) {
     SetPriorityClass(GetCurrentProcess(), ABOVE_NORMAL_PRIORITY_CLASS);
     hwnd = CreateBarWindow(hInstance, makePrimary);
     if (!hwnd) return false;
-    if (makePrimary && config.global.autoHide) {
-        RAWINPUTDEVICE rid;
-        rid.usUsagePage = 0x01;  // Generic desktop
-        rid.usUsage = 0x02;      // Mouse
-        rid.dwFlags = RIDEV_INPUTSINK; // Receive input even when not in foreground
-        rid.hwndTarget = hwnd;
-
-        if (!RegisterRawInputDevices(&rid, 1, sizeof(rid))) {
-            OutputDebugStringW(L"[RAILING] Failed to register raw input!\n");
-        }
-    }
+    if (config.global.autoHide && !rawInputTarget) RegisterMouseInput(hwnd);
     if (isPrimary) {
 		RegisterAppBar(hwnd);
         if (!config.global.autoHide) UpdateAppBarPosition(hwnd, config);
@@ -102,6 +121,9 @@ bool BarInstance::Initialize(HINSTANCE hInstance, bool makePrimary) {
 
     renderer = new RailingRenderer(hwnd, config);
     renderer->pWorkspaceManager = &workspaces;
+    renderer->frames = &frames;
+    renderer->animations = &animations;
+    if (Railing::instance) renderer->windowRegistry = &Railing::instance->windowRegistry;
     renderer->Resize();
 
     if (Module::HasType(config, "audio")) {
@@ -120,9 +142,9 @@ bool BarInstance::Initialize(HINSTANCE hInstance, bool makePrimary) {
     tooltips.Initialize(hwnd);
     inputManager = std::make_unique<InputManager>(this, renderer, &tooltips);
 
-    std::vector<WindowInfo> windows;
-    WindowMonitor::GetTopLevelWindows(windows, config.pinnedPaths, hwnd);
-    for (const auto &win : windows) workspaces.AddWindow(win.hwnd);
+    for (const auto &win : WindowList()) {
+        if (win.hwnd) workspaces.AddWindow(win.hwnd);
+    }
 
     if (Railing::instance) {
         Railing::instance->networkBackend.GetCurrentStatus(
@@ -152,7 +174,8 @@ bool BarInstance::Initialize(HINSTANCE hInstance, bool makePrimary) {
         //  otherwise it happens automatically on first hook)
     }
 
-    if (Module::HasType(config, "visualizer")) {
+    hasVisualizer = Module::HasType(config, "visualizer");
+    if (hasVisualizer) {
         if (!Railing::instance->visualizerBackend)
             Railing::instance->visualizerBackend = new AudioCapture();
     }
@@ -166,7 +189,11 @@ bool BarInstance::Initialize(HINSTANCE hInstance, bool makePrimary) {
     ShowWindow(hwnd, SW_SHOWNOACTIVATE);
     UpdateWindow(hwnd);
     SetTimer(hwnd, STATS_TIMER_ID, 1000, NULL);
-    SetTimer(hwnd, ANIMATION_TIMER_ID, 16, NULL);
+
+    // No fixed animation timer: frames are requested on demand
+    ApplyAnimationConfig();
+    if (config.global.autoHide) frames.RequestFrame(FRAME_CLIENT_AUTOHIDE);
+    ScheduleFrames();
 
     return true;
 }
@@ -223,6 +250,8 @@ void BarInstance::Reposition() {
 
 void BarInstance::ReloadConfig() {
 	config = ThemeLoader::Load(configFileName.c_str());
+	hasVisualizer = Module::HasType(config, "visualizer");
+	ApplyAnimationConfig();
 	if (renderer) {
 		renderer->Reload(configFileName.c_str());
 		renderer->Resize();
@@ -253,58 +282,42 @@ LRESULT CALLBACK BarInstance::BarWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LP
     }
 
     if (!self) return DefWindowProc(hwnd, uMsg, wParam, lParam);
+    PROFILE_SCOPE("WndProc", nullptr, "msg", uMsg);
 
     switch (uMsg) {
     case WM_PAINT: {
         PAINTSTRUCT ps;
         BeginPaint(hwnd, &ps);
-        if (self->renderer) {
-            std::vector<WindowInfo> windows;
-            WindowMonitor::GetTopLevelWindows(windows, self->config.pinnedPaths, hwnd);
-            self->renderer->Draw(windows, self->config.pinnedPaths, GetForegroundWindow());
-        }
+        if (self->renderer) self->renderer->Draw(self->WindowList(), self->config.pinnedPaths, GetForegroundWindow());
         EndPaint(hwnd, &ps);
+        self->ScheduleFrames(); // Modules may have asked for another frame
         return 0;
     }
 
     case WM_ERASEBKGND:
         return 1;
     case WM_INPUT: {
-        if (self->config.global.autoHide) {
-            // Force autohide check on every mouse input
-            static DWORD lastCheck = 0;
-            DWORD now = GetTickCount64();
-            if (now - lastCheck > 16) { // Throttle to ~60fps
-                self->OnTimerTick();
-                lastCheck = now;
+        // Force autohide check on mouse input; the slide itself runs on scheduled frames
+        static DWORD lastCheck = 0;
+        DWORD now = GetTickCount64();
+        if (now - lastCheck > 16 && Railing::instance) { // Throttle to ~60fps
+            for (BarInstance *bar : Railing::instance->bars) {
+                if (!bar->config.global.autoHide) continue;
+                bar->StepAutoHide();
+                bar->ScheduleFrames();
             }
+            lastCheck = now;
         }
         return 0;
     }
+    case WM_DISPLAYCHANGE:
+        self->UpdateFrameInterval();
+        break;
         // --- FIX 1: Restore Cursor Hand Logic ---
     case WM_SETCURSOR:
         if (LOWORD(lParam) == HTCLIENT && self->renderer) {
             POINT pt; GetCursorPos(&pt); ScreenToClient(hwnd, &pt);
-            float dpi = (float)GetDpiForWindow(hwnd);
-            float scale = dpi / 96.0f;
-            bool hit = false;
-
-            // Loop modules just like Old Railing.cpp did
-            auto Check = [&](const std::vector<Module *> &list) {
-                for (auto *m : list) {
-                    if (m->cachedRect.right == 0.0f) continue;
-                    // Simple hit check
-                    if (pt.x >= m->cachedRect.left * scale && pt.x <= m->cachedRect.right * scale &&
-                        pt.y >= m->cachedRect.top * scale && pt.y <= m->cachedRect.bottom * scale) return true;
-                }
-                return false;
-                };
-
-            if (Check(self->renderer->leftModules) ||
-                Check(self->renderer->centerModules) ||
-                Check(self->renderer->rightModules)) {
-                hit = true;
-            }
+            bool hit = self->renderer->GetHitIndex().Find(pt.x, pt.y).module != nullptr;
             SetCursor(LoadCursor(NULL, hit ? IDC_HAND : IDC_ARROW));
             return TRUE;
         }
@@ -322,6 +335,10 @@ LRESULT CALLBACK BarInstance::BarWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LP
             InvalidateRect(hwnd, NULL, FALSE);
         }
         return 0;
+    case WM_RAILING_WAKE:
+        self->frames.RequestFrame(FRAME_CLIENT_REPAINT);
+        self->ScheduleFrames();
+        return 0;
     case WM_USER + 999: {
         Railing::instance->networkBackend.GetCurrentStatus(
             Railing::instance->cachedWifiState,
@@ -434,6 +451,10 @@ LRESULT CALLBACK BarInstance::BarWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LP
             self->OnTimerTick(); // Handles animations
         }
         else if (wParam == STATS_TIMER_ID) {
+            self->frames.NoteWakeup();
+            PROFILE_SCOPE("StatsTick", nullptr, "idleWakeupsPerMin", self->frames.IdleWakeupsPerMinute());
+            if (self->isPrimary) TrayBackend::Get().CollectDeadIcons(); // Tray icons whose app exited without NIM_DELETE
+
             if (Railing::instance) {
                 Railing::instance->UpdateGlobalStats();
 
@@ -497,28 +518,120 @@ bool IsFullscreenWindowActive() {
     return false;
 }
 
-void BarInstance::OnTimerTick() {
-    tickCount++;
+const std::vector<WindowInfo> &BarInstance::WindowList() {
+    if (!Railing::instance) return windowList;
+    const WindowRegistry &registry = Railing::instance->windowRegistry;
+    if (registry.Version() == windowListVersion && config.pinnedPaths == windowListPinned) return windowList;
+    windowListVersion = registry.Version();
+    windowListPinned = config.pinnedPaths;
+
+    std::vector<size_t> pinnedHashes;
+    pinnedHashes.reserve(config.pinnedPaths.size());
+    for (const auto &pin : config.pinnedPaths) pinnedHashes.push_back(WindowRegistry::PathHash(pin));
+
+    std::vector<WindowListEntry> entries;
+    registry.MergePinned(pinnedHashes, entries);
+
+    windowList.clear();
+    windowList.reserve(entries.size());
+    for (const WindowListEntry &e : entries) {
+        WindowInfo info = {};
+        info.isPinned = e.pinnedIndex >= 0;
+        if (e.window) {
+            info.hwnd = (HWND)e.window->hwnd;
+            info.title = e.window->title;
+            info.exePath = e.window->exePath;
+            info.pathHash = e.window->pathHash;
+            GetWindowRect(info.hwnd, &info.rect);
+        }
+        else {
+            info.exePath = config.pinnedPaths[e.pinnedIndex];
+            info.pathHash = pinnedHashes[e.pinnedIndex];
+        }
+        windowList.push_back(std::move(info));
+    }
+    return windowList;
+}
 
-    if (tickCount % 60 == 0) {
-        if (Railing::instance) {
-            Railing::instance->UpdateGlobalStats();
-            Railing::instance->networkBackend.GetCurrentStatus(Railing::instance->cachedWifiState, Railing::instance->cachedWifiSignal);
+void BarInstance::RefreshWindowRects(const WinEventBatch &batch) {
+    // A list that is due for a rebuild reads every rect anyway
+    if (!Railing::instance || Railing::instance->windowRegistry.Version() != windowListVersion) return;
+    for (const WindowEventEntry &e : batch.windows) {
+        if (!(e.changes & WINDOW_MOVED)) continue;
+        for (WindowInfo &info : windowList) {
+            if (info.hwnd == (HWND)e.hwnd) GetWindowRect(info.hwnd, &info.rect);
         }
-        if (renderer && Railing::instance) {
-            SystemStatusData d;
-            d.cpuUsage = Railing::instance->cachedCpuUsage;
-            d.gpuTemp = Railing::instance->cachedGpuTemp;
-            d.ramUsage = Railing::instance->cachedRamUsage;
-            d.wifiSignal = Railing::instance->cachedWifiSignal;
-            d.isWifiConnected = Railing::instance->cachedWifiState;
-            d.volume = Railing::instance->cachedVolume;
-            d.isMuted = Railing::instance->cachedMute;
+    }
+}
 
-            renderer->UpdateStats(d);
+void BarInstance::ScheduleFrames() {
+    // Whatever is still tweening keeps its client ticking
+    uint32_t animating = animations.ActiveClients();
+    if (animating) frames.RequestFrame(animating);
+
+    // New samples since the last frame: keep the bars moving. Once the stream
+    // goes quiet the bar idles again; the stats tick repaints and picks it back up.
+    if (hasVisualizer && Railing::instance && Railing::instance->visualizerBackend) {
+        uint64_t written = Railing::instance->visualizerBackend->Samples().Written();
+        if (written != visualizerWritten) {
+            visualizerWritten = written;
+            frames.RequestFrame(FRAME_CLIENT_REPAINT);
         }
     }
 
+    uint64_t delay = frames.NextWakeDelay();
+    if (delay == FrameScheduler::NO_WAKE) {
+        KillTimer(hwnd, ANIMATION_TIMER_ID); // Idle: block until something happens
+        return;
+    }
+    if (delay < USER_TIMER_MINIMUM) delay = USER_TIMER_MINIMUM;
+    SetTimer(hwnd, ANIMATION_TIMER_ID, (UINT)delay, NULL); // Re-arming replaces the pending one
+}
+
+void BarInstance::UpdateFrameInterval() {
+    uint32_t interval = FrameScheduler::DEFAULT_INTERVAL;
+    MONITORINFOEXW mi = {};
+    mi.cbSize = sizeof(mi);
+    DEVMODEW dm = {};
+    dm.dmSize = sizeof(dm);
+    HMONITOR hMon = MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY);
+    if (GetMonitorInfoW(hMon, &mi) && EnumDisplaySettingsW(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1) {
+        interval = 1000 / dm.dmDisplayFrequency;
+    }
+    // animation.fps caps the rate; animations are timed, so fewer frames only look choppier
+    int fps = config.global.animation.fps;
+    if (fps > 0 && (uint32_t)(1000 / fps) > interval) interval = 1000 / fps;
+    frames.SetFrameInterval(interval);
+}
+
+AnimationCurve BarInstance::AnimationCurveFor(const ThemeConfig::Animation &a) {
+    AnimationCurve curve;
+    curve.easing = EasingFromName(a.easing);
+    curve.durationMs = a.duration > 0 ? (uint32_t)a.duration : 0;
+    curve.stiffness = a.stiffness;
+    curve.damping = a.damping;
+    if (!a.enabled) {
+        curve.easing = Easing::Linear; // Jump straight to every target
+        curve.durationMs = 0;
+    }
+    return curve;
+}
+
+void BarInstance::ApplyAnimationConfig() {
+    animations.curve = AnimationCurveFor(config.global.animation);
+    UpdateFrameInterval();
+}
+
+void BarInstance::OnTimerTick() {
+    uint32_t due = frames.BeginFrame();
+    animations.Step();
+    if (due & FRAME_CLIENT_AUTOHIDE) StepAutoHide();
+    if ((due & FRAME_CLIENT_WINEVENTS) && Railing::instance) Railing::instance->DispatchWindowEvents();
+    if (due & FRAME_CLIENT_REPAINT) InvalidateRect(hwnd, NULL, FALSE);
+    ScheduleFrames();
+}
+
+void BarInstance::StepAutoHide() {
     if (config.global.autoHide) {
         POINT pt; GetCursorPos(&pt);
 
@@ -563,19 +676,21 @@ void BarInstance::OnTimerTick() {
         }
 
         // --- APPLY ---
-        int nextY = rcWindow.top;
-
-        if (rcWindow.top != targetY) {
-            int delta = targetY - rcWindow.top;
-            if (abs(delta) < 2) nextY = targetY;
-            else nextY = rcWindow.top + (int)(delta * 0.3);
+        // The slide is a timed tween; ScheduleFrames keeps ticking us until it settles
+        if (slideAnim == INVALID_ANIM) slideAnim = animations.Create(FRAME_CLIENT_AUTOHIDE, (float)rcWindow.top, 0.5f);
+        if (!animations.IsActive(slideAnim)) animations.Set(slideAnim, (float)rcWindow.top); // Moved by Reposition
+        animations.AnimateTo(slideAnim, (float)targetY, animations.curve);
+        int nextY = (int)lroundf(animations.Get(slideAnim));
 
+        if (rcWindow.top != nextY) {
             SetWindowPos(hwnd, HWND_TOPMOST, targetX, nextY, 0, 0,
                 SWP_NOSIZE | SWP_NOACTIVATE);
         }
-        else {
+        else if (!animations.IsActive(slideAnim) && isHidden == shouldShow) {
+            // Settled: re-assert topmost once per show/hide instead of every tick
             SetWindowPos(hwnd, HWND_TOPMOST, 0, 0, 0, 0,
                 SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
         }
+        isHidden = !shouldShow;
     }
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "TooltipHandler.h"
 #include "WorkspaceManager.h"
 #include "Types.h"
+#include "FrameScheduler.h"
+#include "AnimationEngine.h"
 
 class RailingRenderer;
 class InputManager;
@@ -14,6 +16,12 @@ class VolumeFlyout;
 class TrayFlyout;
 class NetworkFlyout;
 struct IDropTarget;
+struct WinEventBatch;
+
+class TickFrameClock : public FrameClock {
+public:
+    uint64_t NowMs() const override { return GetTickCount64(); }
+};
 
 enum class InteractionMode {
     None = 0,
@@ -57,12 +65,34 @@ public:
     bool isHidden = false;
     InteractionMode interactionMode = InteractionMode::None;
     ULONGLONG lastInteractionTime = 0;
-    int tickCount = 0;
+
+    // The animation timer is only armed while the scheduler has a frame pending
+    TickFrameClock frameClock;
+    FrameScheduler frames{ frameClock };
+    AnimationEngine animations{ frameClock };
+    AnimHandle slideAnim = INVALID_ANIM; // Auto-hide window Y
+    // The visualizer redraws while the capture thread keeps writing samples
+    bool hasVisualizer = false;
+    uint64_t visualizerWritten = 0;
+    void ScheduleFrames();
+    void ApplyAnimationConfig();
+    static AnimationCurve AnimationCurveFor(const ThemeConfig::Animation &animation);
+
+    // The shared window registry merged with this bar's pinned apps; rebuilt
+    // only when either changes
+    const std::vector<WindowInfo> &WindowList();
+    // Re-read the rects of windows a batch reports as moved or resized
+    void RefreshWindowRects(const WinEventBatch &batch);
+    std::vector<WindowInfo> windowList;
+    uint64_t windowListVersion = UINT64_MAX;
+    std::vector<std::wstring> windowListPinned;
 
     IDropTarget *pDropTarget = nullptr;
 
     HWND CreateBarWindow(HINSTANCE hInstance, bool makePrimary);
     void OnTimerTick();
+    void StepAutoHide();
+    void UpdateFrameInterval();
     bool IsMouseAtEdge();
 
     static LRESULT CALLBACK BarWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
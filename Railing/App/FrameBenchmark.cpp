@@ -0,0 +1,459 @@
+#include "FrameBenchmark.h"
+#include "ThemeLoader.h"
+#include "ModuleFactory.h"
+#include "SoftwareBackend.h"
+#include "LayoutEngine.h"
+#include "DamageTracker.h"
+#include "HitIndex.h"
+#include "FrameScheduler.h"
+#include "AnimationEngine.h"
+#include "BarInstance.h"
+#include "WindowRegistry.h"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#if RAILING_BENCHMARK
+// Count heap allocations per thread. Replacing the global operator new is the
+// only portable hook; it costs one thread-local increment per allocation.
+namespace {
+    thread_local uint64_t allocationCount = 0;
+}
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    if (void *p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+    class BenchClock : public FrameClock {
+    public:
+        uint64_t now = 1000;
+        uint64_t NowMs() const override { return now; }
+    };
+
+    // One headless bar: modules, layout and damage as RailingRenderer keeps them
+    struct BenchBar {
+        const ThemeConfig &theme;
+        std::vector<Module *> sections[LayoutEngine::SECTION_COUNT];
+        LayoutEngine layout;
+        DamageTracker damage;
+        HitIndex hits;
+        std::vector<Module *> all; // Every module, group children included
+        std::vector<LayoutRect> parts;
+        SoftwareBackend canvas;
+        BenchClock clock;
+        FrameScheduler frames{ clock };
+        AnimationEngine animations{ clock };
+        std::vector<std::wstring> pinned;
+        float width = 0.0f;
+        float height = 0.0f;
+        bool vertical = false;
+
+        explicit BenchBar(const ThemeConfig &theme) : theme(theme), pinned(theme.pinnedPaths) {
+            vertical = theme.global.position == "left" || theme.global.position == "right";
+            float length = vertical ? 1080.0f : 1920.0f;
+            float thickness = (float)theme.global.height;
+            width = vertical ? thickness : length;
+            height = vertical ? length : thickness;
+            canvas.Resize((int)width, (int)height);
+            animations.curve = BarInstance::AnimationCurveFor(theme.global.animation);
+
+            const std::vector<std::string> *ids[] = { &theme.layout.left, &theme.layout.center, &theme.layout.right };
+            for (int s = 0; s < LayoutEngine::SECTION_COUNT; s++) {
+                std::vector<LayoutNode *> nodes;
+                for (const std::string &id : *ids[s]) {
+                    Module *m = ModuleFactory::Create(id, theme);
+                    if (!m) continue;
+                    sections[s].push_back(m);
+                    nodes.push_back(&m->layoutNode);
+                }
+                layout.SetSection((LayoutSection)s, nodes);
+            }
+            auto collect = [this](auto &self, Module *m) -> void {
+                all.push_back(m);
+                if (m->kind == ModuleType::Group) {
+                    for (Module *c : static_cast<GroupModule *>(m)->children) self(self, c);
+                }
+            };
+            for (auto &list : sections) for (Module *m : list) collect(collect, m);
+            damage.InvalidateAll();
+        }
+
+        ~BenchBar() {
+            for (auto &list : sections) for (Module *m : list) delete m;
+        }
+
+        size_t CountModules() const { return all.size(); }
+
+        // Same tree RailingRenderer::RebuildHitIndex publishes
+        void IndexModule(Module *m, int parent) {
+            const LayoutRect &r = m->layoutNode.rect;
+            int self = hits.Add(r, m, -1, parent);
+            if (self < 0) return;
+
+            parts.clear();
+            m->GetHitParts(r, parts);
+            for (size_t i = 0; i < parts.size(); i++) hits.Add(parts[i], m, (int)i, self);
+
+            if (m->kind == ModuleType::Group) {
+                for (Module *c : static_cast<GroupModule *>(m)->children) IndexModule(c, self);
+            }
+        }
+
+        // What InputManager does on a mouse move: hover the innermost module,
+        // its workspace slot, or the dock icon (and its preview) under the point
+        void Hover(float mouseMain) {
+            float mouseCross = (vertical ? width : height) / 2.0f;
+            int x = (int)(vertical ? mouseCross : mouseMain);
+            int y = (int)(vertical ? mouseMain : mouseCross);
+            HitResult hit = hits.Find(x, y, 24);
+            Module *hitModule = hit.module ? static_cast<Module *>(hit.module->owner) : nullptr;
+
+            for (Module *m : all) {
+                bool isOver = m == hitModule;
+                if (m->kind == ModuleType::Workspaces) {
+                    WorkspacesModule *ws = static_cast<WorkspacesModule *>(m);
+                    int index = -1;
+                    if (isOver) {
+                        const LayoutRect &r = hit.module->rect;
+                        float local = vertical ? mouseMain - r.top : mouseMain - r.left;
+                        index = (int)(local / (ws->itemWidth + ws->itemPadding));
+                        if (index < 0 || index >= ws->count) index = -1;
+                    }
+                    ws->SetHoveredIndex(index);
+                }
+                else m->SetHovered(isOver);
+
+                if (m->kind == ModuleType::Dock) {
+                    DockModule *dock = static_cast<DockModule *>(m);
+                    int index = isOver ? hit.part : -1;
+                    bool preview = index >= 0 && index < (int)dock->GetCount() && dock->GetWindowCountAtIndex(index) > 1;
+                    dock->previewState.active = preview;
+                    dock->previewState.groupIndex = preview ? index : -1;
+                }
+            }
+        }
+
+        // Returns true if anything was painted
+        bool Frame(RenderContext &ctx, float mouseMain) {
+            animations.Step();
+            for (auto &list : sections) for (Module *m : list) m->Update();
+
+            for (auto &list : sections) {
+                for (Module *m : list) {
+                    if (!m->NeedsMeasure(ctx)) continue;
+                    m->CalculateWidth(ctx);
+                    m->InvalidatePaint();
+                }
+            }
+
+            layout.SetBounds(width, height, vertical);
+            unsigned arranged = layout.Arrange();
+
+            // Sweep the mouse along the bar, down to group children and dock icons
+            if (arranged || hits.Count() == 0) {
+                hits.Begin(vertical, 1.0f);
+                for (auto &list : sections) for (Module *m : list) IndexModule(m, -1);
+                hits.Finish();
+            }
+            Hover(mouseMain);
+
+            for (int s = 0; s < LayoutEngine::SECTION_COUNT; s++) {
+                bool moved = (arranged & (1u << s)) != 0;
+                for (Module *m : sections[s]) {
+                    const LayoutNode &n = m->layoutNode;
+                    if (moved && n.previousRect != n.rect) {
+                        damage.Add(n.previousRect);
+                        damage.Add(n.rect);
+                    }
+                    else if (m->NeedsPaint(ctx)) damage.Add(n.rect);
+                }
+            }
+            damage.Resolve(width, height);
+            if (damage.IsEmpty()) return false;
+
+            float crossSize = layout.CrossExtent();
+            auto drawAll = [&](const LayoutRect *clip) {
+                ctx.draw->Clear(DrawColor(0.0f, 0.0f, 0.0f, 0.0f));
+                LayoutRect bar = { 0.0f, 0.0f, width, height };
+                if (theme.global.background.a > 0.0f) {
+                    if (theme.global.radius > 0) ctx.draw->FillRoundedRect(bar, theme.global.radius, theme.global.background);
+                    else ctx.draw->FillRect(bar, theme.global.background);
+                }
+                for (int s : { 0, 2, 1 }) { // Center draws last, as in the renderer
+                    for (Module *m : sections[s]) {
+                        const LayoutRect &r = m->layoutNode.rect;
+                        if (clip && !DamageTracker::Intersects(r, *clip)) continue;
+                        m->Draw(ctx, r.left, r.top, crossSize);
+                    }
+                }
+            };
+
+            if (damage.IsFullFrame()) drawAll(nullptr);
+            else {
+                for (const LayoutRect &clip : damage.GetRects()) {
+                    ctx.draw->PushClip(clip);
+                    drawAll(&clip);
+                    ctx.draw->PopClip();
+                }
+            }
+            damage.Reset();
+            return true;
+        }
+    };
+
+    // A fixed desktop of `count` windows spread over a few system apps, so runs
+    // compare across machines. Handles are made up and never reach a real
+    // window: the dock's icons come from the apps' files.
+    class SyntheticDesktop : public WindowSystem {
+    public:
+        std::vector<bool> open;
+
+        explicit SyntheticDesktop(int count) : open(count, true) {
+            static const wchar_t *exes[] = { L"notepad.exe", L"cmd.exe", L"calc.exe", L"taskmgr.exe",
+                L"mmc.exe", L"control.exe", L"charmap.exe", L"write.exe" };
+            wchar_t dir[MAX_PATH] = {};
+            GetSystemDirectoryW(dir, MAX_PATH);
+            for (const wchar_t *exe : exes) apps.push_back(std::wstring(dir) + L"\\" + exe);
+        }
+
+        static uintptr_t Handle(int i) { return 0x7E000000 + (uintptr_t)i * 4; }
+
+        void EnumerateAppWindows(std::vector<uintptr_t> &out) const override {
+            for (int i = 0; i < (int)open.size(); i++) {
+                if (open[i]) out.push_back(Handle(i));
+            }
+        }
+        bool IsAppWindow(uintptr_t hwnd) const override {
+            int i = Index(hwnd);
+            return i >= 0 && open[i];
+        }
+        std::wstring GetTitle(uintptr_t hwnd) const override { return L"Window " + std::to_wstring(Index(hwnd)); }
+        std::wstring GetExePath(uintptr_t hwnd) const override {
+            int i = Index(hwnd);
+            return i >= 0 ? apps[i % apps.size()] : std::wstring();
+        }
+
+    private:
+        std::vector<std::wstring> apps;
+
+        int Index(uintptr_t hwnd) const {
+            if (hwnd < Handle(0) || (hwnd - Handle(0)) % 4) return -1;
+            size_t i = (hwnd - Handle(0)) / 4;
+            return i < open.size() ? (int)i : -1;
+        }
+    };
+
+    double Percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty()) return 0.0;
+        size_t rank = (size_t)std::ceil(p * sorted.size());
+        return sorted[rank ? rank - 1 : 0];
+    }
+}
+
+BenchResult FrameBenchmark::RunConfig(const std::string &name, const ThemeConfig &theme, int windowCount)
+{
+    BenchBar bar(theme);
+    SyntheticDesktop desktop(windowCount);
+    WindowRegistry registry(desktop);
+    registry.Sync();
+    std::vector<WindowInfo> windows;
+    uint64_t windowsVersion = UINT64_MAX;
+    std::vector<const WindowRecord *> records;
+
+    RenderContext ctx{};
+    ctx.draw = &bar.canvas;
+    ctx.windows = &windows;
+    ctx.windowRegistry = &registry;
+    ctx.pinnedApps = &bar.pinned;
+    ctx.isVertical = bar.vertical;
+    ctx.logicalWidth = bar.width;
+    ctx.logicalHeight = bar.height;
+    ctx.frames = &bar.frames;
+    ctx.animations = &bar.animations;
+
+    BenchResult result;
+    result.name = name;
+    result.modules = bar.CountModules();
+    result.windows = (size_t)windowCount;
+
+    std::vector<double> times;
+    times.reserve(MEASURED_FRAMES);
+    uint64_t allocationsBefore = 0;
+    uint64_t churnAllocations = 0;
+    float barLength = bar.vertical ? bar.height : bar.width;
+
+    for (int i = 0; i < WARMUP_FRAMES + MEASURED_FRAMES; i++) {
+        if (i == WARMUP_FRAMES) allocationsBefore = allocationCount;
+        bar.clock.now += FRAME_MS;
+
+        // Telemetry changes about once a second, like the stats timer
+        int tick = i / 60;
+        ctx.cpuUsage = 50 + (int)(45.0 * std::sin(tick * 0.7));
+        ctx.ramUsage = 40 + tick % 20;
+        ctx.gpuTemp = 55 + tick % 15;
+        ctx.volume = (tick % 10) / 10.0f;
+        ctx.wifiSignal = 100 - (tick % 5) * 20;
+        ctx.isWifiConnected = true;
+
+        // A window closes or reopens every 1.5 s; the bar's own list follows the
+        // registry as BarInstance::WindowList does. Not part of the frame
+        uint64_t churnStart = allocationCount;
+        if (windowCount > 0 && i % 90 == 89) {
+            int k = (i / 90) % windowCount;
+            desktop.open[k] = !desktop.open[k];
+            if (desktop.open[k]) registry.OnShown(SyntheticDesktop::Handle(k));
+            else registry.OnRemoved(SyntheticDesktop::Handle(k));
+        }
+        if (registry.Version() != windowsVersion) {
+            windowsVersion = registry.Version();
+            registry.Snapshot(records);
+            windows.clear();
+            for (const WindowRecord *w : records) {
+                WindowInfo info = {};
+                info.hwnd = (HWND)w->hwnd;
+                info.title = w->title;
+                info.exePath = w->exePath;
+                info.pathHash = w->pathHash;
+                windows.push_back(std::move(info));
+            }
+        }
+        if (i >= WARMUP_FRAMES) churnAllocations += allocationCount - churnStart;
+
+        // Focus moves to another window every ~0.75 s
+        ctx.foregroundWindow = windows.empty() ? nullptr : windows[(i / 45) % windows.size()].hwnd;
+
+        auto start = std::chrono::steady_clock::now();
+        bool painted = bar.Frame(ctx, std::fmod(i * 7.0f, barLength));
+        auto end = std::chrono::steady_clock::now();
+
+        if (i < WARMUP_FRAMES) continue;
+        times.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        if (painted) result.paintedFrames++;
+    }
+
+    result.allocations = allocationCount - allocationsBefore - churnAllocations;
+    result.frames = times.size();
+    result.allocationsPerFrame = result.frames ? (double)result.allocations / result.frames : 0.0;
+
+    double total = 0.0;
+    for (double t : times) total += t;
+    std::sort(times.begin(), times.end());
+    result.meanUs = times.empty() ? 0.0 : total / times.size();
+    result.p50Us = Percentile(times, 0.50);
+    result.p90Us = Percentile(times, 0.90);
+    result.p99Us = Percentile(times, 0.99);
+    result.maxUs = times.empty() ? 0.0 : times.back();
+    return result;
+}
+
+ThemeConfig FrameBenchmark::SyntheticConfig(int moduleCount, int groupDepth)
+{
+    static const char *types[] = { "clock", "cpu", "ram", "gpu", "custom", "workspaces" };
+
+    ThemeConfig theme;
+    theme.global.height = 40;
+    theme.global.background = D2D1::ColorF(0.1f, 0.1f, 0.12f, 0.9f);
+
+    std::vector<std::string> level;
+    for (int i = 0; i < moduleCount; i++) {
+        ModuleConfig mod;
+        mod.id = "m" + std::to_string(i);
+        mod.type = types[i % 6];
+        if (mod.type == "custom") mod.format = "App " + std::to_string(i);
+        if (mod.type == "clock") mod.format = "%H:%M:%S";
+        mod.baseStyle.padding = { 6, 0, 6, 0 };
+        mod.baseStyle.has_padding = true;
+        theme.modules[mod.id] = mod;
+        level.push_back(mod.id);
+    }
+
+    // Wrap every four modules into a group, `groupDepth` times over
+    for (int depth = 0; depth < groupDepth && level.size() > 1; depth++) {
+        std::vector<std::string> next;
+        for (size_t i = 0; i < level.size(); i += 4) {
+            ModuleConfig group;
+            group.id = "g" + std::to_string(depth) + "_" + std::to_string(i / 4);
+            group.type = "group";
+            group.baseStyle.padding = { 2, 2, 2, 2 };
+            group.baseStyle.has_padding = true;
+            group.baseStyle.bg = D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.05f);
+            group.baseStyle.has_bg = true;
+            for (size_t j = i; j < i + 4 && j < level.size(); j++) group.groupModules.push_back(level[j]);
+            theme.modules[group.id] = group;
+            next.push_back(group.id);
+        }
+        level = next;
+    }
+
+    for (size_t i = 0; i < level.size(); i++) {
+        std::vector<std::string> &section = i % 3 == 0 ? theme.layout.left : i % 3 == 1 ? theme.layout.center : theme.layout.right;
+        section.push_back(level[i]);
+    }
+    return ThemeLoader::CompileStyles(theme);
+}
+
+std::string FrameBenchmark::ToJson(const std::vector<BenchResult> &results)
+{
+    nlohmann::json out;
+    out["warmup_frames"] = WARMUP_FRAMES;
+    out["frame_ms"] = FRAME_MS;
+    out["results"] = nlohmann::json::array();
+    for (const BenchResult &r : results) {
+        out["results"].push_back({
+            { "name", r.name },
+            { "modules", r.modules },
+            { "windows", r.windows },
+            { "frames", r.frames },
+            { "painted_frames", r.paintedFrames },
+            { "mean_us", r.meanUs },
+            { "p50_us", r.p50Us },
+            { "p90_us", r.p90Us },
+            { "p99_us", r.p99Us },
+            { "max_us", r.maxUs },
+            { "allocations", r.allocations },
+            { "allocations_per_frame", r.allocationsPerFrame },
+        });
+    }
+    return out.dump(2, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+int FrameBenchmark::Run(const std::wstring &presetDir, const std::wstring &outPath)
+{
+    std::vector<std::filesystem::path> presets;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(presetDir, ec)) {
+        if (entry.path().extension() == L".json") presets.push_back(entry.path());
+    }
+    std::sort(presets.begin(), presets.end());
+
+    std::vector<BenchResult> results;
+    for (int windows : WINDOW_COUNTS) {
+        std::string suffix = "/w" + std::to_string(windows);
+        for (const auto &path : presets) {
+            ThemeConfig theme = ThemeLoader::Load(path.string());
+            results.push_back(RunConfig(path.stem().string() + suffix, theme, windows));
+        }
+        for (int count : { 10, 100, 1000 }) {
+            ThemeConfig theme = SyntheticConfig(count, 3);
+            results.push_back(RunConfig("synthetic_" + std::to_string(count) + suffix, theme, windows));
+        }
+    }
+
+    std::ofstream file(std::filesystem::path(outPath), std::ios::binary);
+    if (!file) return 1;
+    file << ToJson(results);
+    return file ? 0 : 1;
+}
+#endif
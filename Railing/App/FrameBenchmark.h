@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ThemeTypes.h"
+#include "Types.h"
+
+// Headless steady-state frame benchmark: `Railing.exe --bench [presets dir] [out.json]`.
+// Every preset, plus synthetic bars of 10/100/1000 modules with nested groups,
+// is built through ModuleFactory and drawn into a SoftwareBackend with the
+// renderer's measure/arrange/damage passes, once per synthetic desktop of
+// 10/100/500 windows. Telemetry is synthetic, windows open and close, the
+// foreground rotates through them and a mouse sweeps the bar; frame-time
+// percentiles and heap allocations per config are written as JSON so runs
+// can be compared across commits and machines.
+//
+// Only the Bench configuration defines RAILING_BENCHMARK=1: the allocation
+// counter replaces the global operator new, which the shipping bar must not carry.
+
+#ifndef RAILING_BENCHMARK
+#define RAILING_BENCHMARK 0
+#endif
+
+struct BenchResult {
+    std::string name;
+    size_t modules = 0;       // Including group children
+    size_t windows = 0;       // Synthetic desktop size
+    size_t frames = 0;
+    size_t paintedFrames = 0; // Frames with any damage
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    uint64_t allocations = 0; // operator new calls across the measured frames
+    double allocationsPerFrame = 0.0;
+};
+
+class FrameBenchmark
+{
+public:
+    static constexpr int WARMUP_FRAMES = 120;
+    static constexpr int MEASURED_FRAMES = 1200;
+    static constexpr uint32_t FRAME_MS = 16; // Simulated time per frame
+    static constexpr int WINDOW_COUNTS[] = { 10, 100, 500 };
+
+    /// <summary>
+    /// Run every preset in `presetDir` and the synthetic configs, and write
+    /// the results to `outPath`. Returns the process exit code.
+    /// </summary>
+    static int Run(const std::wstring &presetDir, const std::wstring &outPath);
+
+    static BenchResult RunConfig(const std::string &name, const ThemeConfig &theme, int windowCount);
+
+    /// <summary>
+    /// A bar of `moduleCount` leaf modules (clock, cpu, ram, custom, workspaces)
+    /// spread over the three sections, wrapped in groups nested `groupDepth` deep.
+    /// </summary>
+    static ThemeConfig SyntheticConfig(int moduleCount, int groupDepth);
+
+    static std::string ToJson(const std::vector<BenchResult> &results);
+};
@@ -0,0 +1,130 @@
+#include "FrameProfiler.h"
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+std::atomic<bool> FrameProfiler::enabled{ false };
+
+namespace {
+    // Rings live until exit so a trace still shows threads that have finished
+    std::mutex ringsLock;
+    std::vector<std::unique_ptr<ProfileRing>> rings;
+    thread_local ProfileRing *threadRing = nullptr;
+    thread_local const char *threadName = nullptr;
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+}
+
+void ProfileRing::Snapshot(std::vector<ProfileEvent> &out) const
+{
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    begin = std::max(begin, discardBefore.load(std::memory_order_relaxed));
+
+    size_t base = out.size();
+    for (uint64_t i = begin; i < end; i++) out.push_back(events[i & (CAPACITY - 1)]);
+
+    // Anything the writer lapped while we copied is torn; keep the rest. The
+    // slot of event `now` (i.e. now - CAPACITY's) may be mid-write, so it goes too
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t now = head.load(std::memory_order_relaxed);
+    uint64_t firstIntact = now + 1 > CAPACITY ? now + 1 - CAPACITY : 0;
+    if (firstIntact > begin) {
+        size_t torn = (size_t)std::min(firstIntact - begin, end - begin);
+        out.erase(out.begin() + base, out.begin() + base + torn);
+    }
+}
+
+uint64_t FrameProfiler::NowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+ProfileRing &FrameProfiler::ThreadRing()
+{
+    if (!threadRing) {
+        std::lock_guard<std::mutex> lock(ringsLock);
+        rings.push_back(std::make_unique<ProfileRing>((uint32_t)rings.size() + 1));
+        threadRing = rings.back().get();
+        if (threadName) threadRing->threadName = threadName;
+    }
+    return *threadRing;
+}
+
+void FrameProfiler::Record(const char *name, const char *detail, const char *argName, int64_t arg, uint64_t startNs, uint64_t endNs)
+{
+    ProfileEvent e;
+    e.name = name;
+    e.argName = argName;
+    e.arg = arg;
+    e.startNs = startNs;
+    e.durationNs = endNs - startNs;
+    if (detail) {
+        size_t len = strnlen(detail, sizeof(e.detail) - 1);
+        memcpy(e.detail, detail, len);
+    }
+    ThreadRing().Push(e);
+}
+
+void FrameProfiler::SetThreadName(const char *name)
+{
+    // The ring (and its memory) only appears once the thread records something
+    threadName = name;
+    if (!threadRing) return;
+    std::lock_guard<std::mutex> lock(ringsLock);
+    threadRing->threadName = name;
+}
+
+void FrameProfiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(ringsLock);
+    for (auto &ring : rings) ring->Discard();
+}
+
+std::string FrameProfiler::ExportChromeTrace()
+{
+    nlohmann::json events = nlohmann::json::array();
+    std::vector<ProfileEvent> copy;
+
+    std::lock_guard<std::mutex> lock(ringsLock);
+    for (auto &ring : rings) {
+        std::string label = ring->threadName.empty() ? "Thread " + std::to_string(ring->tid) : ring->threadName;
+        events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", ring->tid },
+            { "args", { { "name", label } } } });
+
+        copy.clear();
+        ring->Snapshot(copy);
+        for (const ProfileEvent &e : copy) {
+            nlohmann::json ev;
+            ev["name"] = e.detail[0] ? std::string(e.name) + " " + e.detail : std::string(e.name);
+            ev["cat"] = e.name;
+            ev["ph"] = "X";
+            ev["pid"] = 1;
+            ev["tid"] = ring->tid;
+            ev["ts"] = e.startNs / 1000.0; // Microseconds
+            ev["dur"] = e.durationNs / 1000.0;
+            if (e.detail[0]) ev["args"]["module"] = e.detail;
+            if (e.argName) ev["args"][e.argName] = e.arg;
+            events.push_back(std::move(ev));
+        }
+    }
+
+    nlohmann::json trace;
+    trace["traceEvents"] = std::move(events);
+    trace["displayTimeUnit"] = "ms";
+    // Ids cut at the detail buffer may end mid UTF-8 sequence
+    return trace.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+bool FrameProfiler::WriteChromeTrace(const std::wstring &path)
+{
+    std::ofstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file) return false;
+    file << ExportChromeTrace();
+    return (bool)file;
+}
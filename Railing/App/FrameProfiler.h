@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Built-in frame instrumentation. PROFILE_SCOPE marks a span (a module's
+// Update/measure/render, a renderer phase, a window message); while the
+// profiler is switched on, each finished span is pushed into a ring owned by
+// the calling thread. Rings are single-writer and never locked on the hot
+// path: the exporter copies them on demand and writes a Chrome trace
+// (chrome://tracing, ui.perfetto.dev).
+//
+// Build with RAILING_PROFILER=0 to compile every scope out; otherwise a
+// disabled profiler costs one relaxed load per scope.
+
+#ifndef RAILING_PROFILER
+#define RAILING_PROFILER 1
+#endif
+
+struct ProfileEvent {
+    const char *name = nullptr;   // Static string: phase or method
+    const char *argName = nullptr; // Static key for `arg`, null when unused
+    uint64_t startNs = 0;         // Since the profiler's epoch
+    uint64_t durationNs = 0;
+    int64_t arg = 0;
+    char detail[24] = {};         // Copied (module ids don't outlive a reload)
+};
+
+class ProfileRing
+{
+public:
+    static constexpr size_t CAPACITY = 1 << 14; // Per thread, 1 MB; allocated on the thread's first event
+
+    explicit ProfileRing(uint32_t tid) : tid(tid) {}
+
+    // Owning thread only
+    void Push(const ProfileEvent &e) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        events[h & (CAPACITY - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    /// <summary>
+    /// Copy out the events still in the ring, oldest first. Safe while the
+    /// owner keeps pushing: slots it overwrote during the copy are dropped.
+    /// </summary>
+    void Snapshot(std::vector<ProfileEvent> &out) const;
+    // Forget everything recorded so far (the writer is not touched)
+    void Discard() { discardBefore.store(head.load(std::memory_order_acquire), std::memory_order_relaxed); }
+
+    uint64_t Written() const { return head.load(std::memory_order_relaxed); }
+
+    const uint32_t tid;
+    std::string threadName; // Written under the profiler's registry lock
+
+private:
+    std::atomic<uint64_t> head{ 0 };
+    std::atomic<uint64_t> discardBefore{ 0 };
+    ProfileEvent events[CAPACITY];
+};
+
+class FrameProfiler
+{
+public:
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    static uint64_t NowNs();
+
+    static void Record(const char *name, const char *detail, const char *argName, int64_t arg, uint64_t startNs, uint64_t endNs);
+    // Label the calling thread in exported traces (static string)
+    static void SetThreadName(const char *name);
+
+    // Drop what has been recorded on every thread
+    static void Clear();
+
+    /// <summary>
+    /// Chrome trace event JSON ("X" complete events, one track per thread)
+    /// for everything currently held in the rings.
+    /// </summary>
+    static std::string ExportChromeTrace();
+    static bool WriteChromeTrace(const std::wstring &path);
+
+private:
+    static std::atomic<bool> enabled;
+    static ProfileRing &ThreadRing();
+};
+
+class ProfileScope
+{
+public:
+    ProfileScope(const char *name, const char *detail = nullptr, const char *argName = nullptr, int64_t arg = 0)
+        : name(name), detail(detail), argName(argName), arg(arg), active(FrameProfiler::IsEnabled()) {
+        if (active) start = FrameProfiler::NowNs();
+    }
+    ~ProfileScope() {
+        if (active) FrameProfiler::Record(name, detail, argName, arg, start, FrameProfiler::NowNs());
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+    const char *detail;
+    const char *argName;
+    int64_t arg;
+    bool active;
+    uint64_t start = 0;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if RAILING_PROFILER
+// PROFILE_SCOPE("Render") / PROFILE_SCOPE("Render", module id) / PROFILE_SCOPE("WndProc", nullptr, "msg", uMsg)
+#define PROFILE_SCOPE(...) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(__VA_ARGS__)
+#else
+#define PROFILE_SCOPE(...) ((void)0)
+#endif
@@ -0,0 +1,128 @@
+#include "FrameScheduler.h"
+
+uint64_t FrameScheduler::NextTick(uint64_t now) const
+{
+    // Frames are paced to the refresh interval, however often they're requested
+    if (!hasFramed) return now;
+    uint64_t next = lastFrame + interval;
+    return next > now ? next : now;
+}
+
+void FrameScheduler::RequestFrame(uint32_t clients)
+{
+    uint64_t at = NextTick(clock.NowMs());
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if ((clients & (1u << i)) && at < slots[i].due) slots[i].due = at;
+    }
+}
+
+void FrameScheduler::RequestFrameIn(uint32_t clients, uint32_t delayMs)
+{
+    uint64_t at = clock.NowMs() + delayMs;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if ((clients & (1u << i)) && at < slots[i].due) slots[i].due = at;
+    }
+}
+
+void FrameScheduler::AnimateUntil(uint32_t clients, uint64_t untilMs)
+{
+    uint64_t now = clock.NowMs();
+    if (untilMs <= now) return;
+    uint64_t at = NextTick(now);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!(clients & (1u << i))) continue;
+        if (untilMs > slots[i].animateUntil) slots[i].animateUntil = untilMs;
+        if (at < slots[i].due) slots[i].due = at;
+    }
+}
+
+void FrameScheduler::Cancel(uint32_t clients)
+{
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients & (1u << i)) slots[i] = Slot();
+    }
+}
+
+uint64_t FrameScheduler::NextWakeDelay() const
+{
+    uint64_t due = NO_WAKE;
+    for (const Slot &slot : slots) {
+        if (slot.due < due) due = slot.due;
+    }
+    if (due == NO_WAKE) return NO_WAKE;
+
+    uint64_t now = clock.NowMs();
+    return due > now ? due - now : 0;
+}
+
+uint32_t FrameScheduler::BeginFrame()
+{
+    uint64_t now = clock.NowMs();
+
+    uint32_t clients = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        Slot &slot = slots[i];
+        if (slot.due > now) continue;
+        clients |= 1u << i;
+        slot.due = NO_WAKE;
+    }
+    // Idle unless some client asked for this frame
+    CountWakeup(now, clients == 0);
+    if (!clients) return 0;
+
+    frames++;
+    lastFrame = now;
+    hasFramed = true;
+
+    // Keep animating clients ticking
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        Slot &slot = slots[i];
+        if (slot.animateUntil > now) {
+            uint64_t at = now + interval;
+            if (at < slot.due) slot.due = at;
+        }
+        else slot.animateUntil = 0;
+    }
+    return clients;
+}
+
+void FrameScheduler::NoteWakeup()
+{
+    // Idle unless a frame is already pending, i.e. the bar is awake for it anyway
+    bool pending = false;
+    for (const Slot &slot : slots) {
+        if (slot.due != NO_WAKE) pending = true;
+    }
+    CountWakeup(clock.NowMs(), !pending);
+}
+
+bool FrameScheduler::IsAnimating() const
+{
+    return IsAnimatingAt(clock.NowMs());
+}
+
+bool FrameScheduler::IsAnimatingAt(uint64_t now) const
+{
+    for (const Slot &slot : slots) {
+        if (slot.animateUntil > now) return true;
+    }
+    return false;
+}
+
+void FrameScheduler::CountWakeup(uint64_t now, bool idle)
+{
+    if (wakeups == 0) minuteStart = now;
+    if (now - minuteStart >= 60000) {
+        // A quiet stretch longer than a minute leaves an empty last minute
+        uint64_t minutes = (now - minuteStart) / 60000;
+        lastMinuteIdle = minutes == 1 ? minuteIdle : 0;
+        minuteIdle = 0;
+        minuteStart += minutes * 60000;
+    }
+
+    wakeups++;
+    if (idle) {
+        idleWakeups++;
+        minuteIdle++;
+    }
+}
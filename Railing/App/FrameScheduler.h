@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+
+// Decides when a bar needs to wake up. Clients (the renderer, auto-hide)
+// ask for frames instead of being polled by a fixed timer: while something
+// animates the bar ticks at the display's refresh interval, otherwise the
+// scheduler reports nothing due and the message loop can block.
+// Time comes from a FrameClock so the logic runs off Windows with a fake clock.
+
+class FrameClock
+{
+public:
+    virtual ~FrameClock() = default;
+    virtual uint64_t NowMs() const = 0; // Monotonic milliseconds
+};
+
+enum FrameClient : uint32_t {
+    FRAME_CLIENT_NONE = 0,
+    FRAME_CLIENT_REPAINT = 1 << 0,  // Redraw the bar's modules
+    FRAME_CLIENT_AUTOHIDE = 1 << 1, // Step the auto-hide slide
+    FRAME_CLIENT_WINEVENTS = 1 << 2, // Hand the coalesced window events to the modules
+};
+
+class FrameScheduler
+{
+public:
+    static constexpr uint64_t NO_WAKE = UINT64_MAX;
+    static constexpr uint32_t DEFAULT_INTERVAL = 16;
+    static constexpr int MAX_CLIENTS = 8;
+
+    explicit FrameScheduler(const FrameClock &clock, uint32_t frameIntervalMs = DEFAULT_INTERVAL)
+        : clock(clock), interval(frameIntervalMs ? frameIntervalMs : DEFAULT_INTERVAL) {}
+
+    // Refresh interval of the display the bar sits on
+    void SetFrameInterval(uint32_t ms) { interval = ms ? ms : DEFAULT_INTERVAL; }
+    uint32_t GetFrameInterval() const { return interval; }
+
+    // One frame on the next refresh tick
+    void RequestFrame(uint32_t clients);
+    // One frame once `delayMs` have passed (e.g. the clock's next second)
+    void RequestFrameIn(uint32_t clients, uint32_t delayMs);
+    // A frame on every refresh tick until `untilMs` (clock time)
+    void AnimateUntil(uint32_t clients, uint64_t untilMs);
+    void AnimateFor(uint32_t clients, uint32_t durationMs) { AnimateUntil(clients, clock.NowMs() + durationMs); }
+    void Cancel(uint32_t clients);
+
+    /// <summary>
+    /// Milliseconds until the next frame is due, 0 if overdue, or NO_WAKE when
+    /// nothing is pending (no timer should be armed).
+    /// </summary>
+    uint64_t NextWakeDelay() const;
+
+    /// <summary>
+    /// Called when the frame timer fires. Returns the clients that are due now
+    /// and re-arms those still animating for the following tick.
+    /// </summary>
+    uint32_t BeginFrame();
+
+    // Any other wakeup of the bar (e.g. the stats timer); idle unless a frame is pending
+    void NoteWakeup();
+
+    bool IsAnimating() const;
+
+    // Milliseconds until the next multiple of `periodMs` on a wall clock reading
+    static uint32_t DelayToBoundary(uint64_t wallMs, uint32_t periodMs) {
+        return periodMs ? (uint32_t)(periodMs - wallMs % periodMs) : 0;
+    }
+
+    // Wakeups no client had asked a frame for; the per-minute figure is the last full minute
+    uint64_t wakeups = 0;
+    uint64_t idleWakeups = 0;
+    uint64_t frames = 0;
+    uint32_t IdleWakeupsPerMinute() const { return lastMinuteIdle; }
+
+private:
+    struct Slot {
+        uint64_t due = NO_WAKE;
+        uint64_t animateUntil = 0;
+    };
+
+    const FrameClock &clock;
+    uint32_t interval;
+    Slot slots[MAX_CLIENTS];
+    uint64_t lastFrame = 0;
+    bool hasFramed = false;
+
+    uint64_t minuteStart = 0;
+    uint32_t minuteIdle = 0;
+    uint32_t lastMinuteIdle = 0;
+
+    uint64_t NextTick(uint64_t now) const;
+    bool IsAnimatingAt(uint64_t now) const;
+    void CountWakeup(uint64_t now, bool idle);
+};
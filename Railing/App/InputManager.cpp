@@ -22,14 +22,15 @@ void InputManager::HandleMouseMove(HWND hwnd, int x, int y)
     float dpi = (float)GetDpiForWindow(barInstance->GetHwnd());
     float scale = dpi / 96.0f;
     D2D1_RECT_F rectF;
-    Module *hitModule = HitTest(x, y, rectF);
+    int dockItem = -1;
+    Module *hitModule = HitTest(x, y, rectF, &dockItem);
     std::wstring newText = L"";
     bool needsRepaint = false;
 
     // 1. Global Dock Check & Cleanup
     // If we aren't hitting the dock module explicitly, we might be in the "Gap" or "Preview Window".
-    if (!hitModule || hitModule->config.type != "dock") {
-        Module *dm = renderer->GetModule("dock");
+    if (!hitModule || hitModule->kind != ModuleType::Dock) {
+        Module *dm = renderer->GetModule(ModuleType::Dock);
         if (dm) {
             DockModule *dock = (DockModule *)dm;
 
@@ -46,12 +47,10 @@ void InputManager::HandleMouseMove(HWND hwnd, int x, int y)
     }
 
     if (renderer) {
-        for (auto const &[id, cfg] : renderer->theme.modules) {
-            Module *m = renderer->GetModule(id);
-            if (!m) continue;
+        for (Module *m : renderer->GetRegistry().All()) {
             bool isOver = (m == hitModule);
 
-            if (m->config.type == "workspaces") {
+            if (m->kind == ModuleType::Workspaces) {
                 WorkspacesModule *ws = (WorkspacesModule *)m;
                 int newHoverIdx = -1;
                 if (isOver) {
@@ -73,7 +72,7 @@ void InputManager::HandleMouseMove(HWND hwnd, int x, int y)
                 }
             }
             else if (m->isHovered != isOver) {
-                m->isHovered = isOver;
+                m->SetHovered(isOver);
                 needsRepaint = true;
             }
         }
@@ -90,29 +89,29 @@ void InputManager::HandleMouseMove(HWND hwnd, int x, int y)
             }
         }
         else {
-            std::string type = hitModule->config.type;
-            if (type == "audio") newText = L"Volume";
-            else if (type == "network") newText = L"Network";
-            else if (type == "battery") newText = L"Battery";
-            else if (type == "cpu") newText = L"CPU Usage";
-            else if (type == "gpu") newText = L"GPU Temperature";
-            else if (type == "ram") newText = L"RAM Usage";
-            else if (type == "tray") newText = L"System Tray";
-            else if (type == "notification") newText = L"Notifications";
-            else if (type == "weather") newText = L"Weather Near Me";
-            else if (type == "clock") {
+            ModuleType type = hitModule->kind;
+            if (type == ModuleType::Audio) newText = L"Volume";
+            else if (type == ModuleType::Network) newText = L"Network";
+            else if (type == ModuleType::Battery) newText = L"Battery";
+            else if (type == ModuleType::Cpu) newText = L"CPU Usage";
+            else if (type == ModuleType::Gpu) newText = L"GPU Temperature";
+            else if (type == ModuleType::Ram) newText = L"RAM Usage";
+            else if (type == ModuleType::Tray) newText = L"System Tray";
+            else if (type == ModuleType::Notification) newText = L"Notifications";
+            else if (type == ModuleType::Weather) newText = L"Weather Near Me";
+            else if (type == ModuleType::Clock) {
                 SYSTEMTIME st; GetLocalTime(&st);
                 wchar_t buf[64];
                 swprintf_s(buf, L"%02d/%02d/%d", st.wMonth, st.wDay, st.wYear);
                 newText = buf;
             }
-            else if (type == "ping") {
+            else if (type == ModuleType::Ping) {
                 PingModule *pm = static_cast<PingModule *>(hitModule);
                 std::string ip = pm->targetIP;
                 std::wstring w_ip(ip.begin(), ip.end());
                 newText = L"Ping Target: " + w_ip + L"\nLatency: " + std::to_wstring(pm->lastPing) + L"ms";
             }
-            else if (type == "dock") {
+            else if (type == ModuleType::Dock) {
                 DockModule *dock = (DockModule *)hitModule;
                 float logicalX = (float)x / scale;
                 float logicalY = (float)y / scale;
@@ -131,65 +130,33 @@ void InputManager::HandleMouseMove(HWND hwnd, int x, int y)
                     dock->previewState.hoveredRowIndex = -1;
 
                     // --- DOCK HOVER LOGIC ---
-                    std::string pos = renderer->theme.global.position;
-                    bool isVertical = (pos == "left" || pos == "right");
-
-                    float modLength = isVertical ? (rectF.bottom - rectF.top) : (rectF.right - rectF.left);
-                    float localPos = isVertical ? (logicalY - rectF.top) : (logicalX - rectF.left);
-
-                    Style s = dock->GetEffectiveStyle();
-                    Style itemStyle = dock->config.itemStyle;
-
-                    float iSize = (dock->config.dockIconSize > 0) ? dock->config.dockIconSize : 24.0f;
-
-                    // Calculate Stride based on orientation padding
-                    float paddingMain = isVertical ? (itemStyle.padding.top + itemStyle.padding.bottom) : (itemStyle.padding.left + itemStyle.padding.right);
-                    float itemBoxStride = iSize + paddingMain;
-
-                    float marginMain = isVertical ? (itemStyle.margin.top + itemStyle.margin.bottom) : (itemStyle.margin.left + itemStyle.margin.right);
-                    float iSpace = (dock->config.dockSpacing > 0) ? dock->config.dockSpacing : marginMain;
-
-                    size_t count = dock->GetCount();
-                    if (count > 0) {
-                        float totalLength = (count * itemBoxStride) + ((count - 1) * iSpace);
-
-                        float marginStart = isVertical ? s.margin.top : s.margin.left;
-                        float marginEnd = isVertical ? s.margin.bottom : s.margin.right;
-                        float bgLength = modLength - marginStart - marginEnd;
-
-                        float startPos = marginStart + ((bgLength - totalLength) / 2.0f);
-
-                        if (localPos >= startPos && localPos <= (startPos + totalLength)) {
-                            float offset = localPos - startPos;
-                            int index = (int)(offset / (itemBoxStride + iSpace));
-                            float relativePos = fmod(offset, (itemBoxStride + iSpace));
-
-                            if (index != lastHoveredDockIndex && index >= 0 && index < count) {
-                                dock->suppressPreview = false;
-                                this->lastHoveredDockIndex = index;
-                            }
+                    // The hit index already resolved which icon is under the mouse
+                    int index = dockItem;
+                    int count = (int)dock->GetCount();
+                    if (index >= 0 && index < count) {
+                        if (index != lastHoveredDockIndex) {
+                            dock->suppressPreview = false;
+                            this->lastHoveredDockIndex = index;
+                        }
 
-                            if (relativePos <= itemBoxStride && index >= 0 && index < count) {
-                                newText = dock->GetTitleAtIndex(index);
-                                int wins = dock->GetWindowCountAtIndex(index);
-                                if (wins > 1) {
-                                    if (!dock->suppressPreview) {
-                                        if (!dock->previewState.active || dock->previewState.groupIndex != index) {
-                                            dock->previewState.active = true;
-                                            dock->previewState.groupIndex = index;
-                                            needsRepaint = true;
-                                        }
-                                    }
-                                }
-                                else {
-                                    if (dock->previewState.active) {
-                                        dock->previewState.active = false;
-                                        dock->previewState.groupIndex = -1;
-                                        needsRepaint = true;
-                                    }
+                        newText = dock->GetTitleAtIndex(index);
+                        int wins = dock->GetWindowCountAtIndex(index);
+                        if (wins > 1) {
+                            if (!dock->suppressPreview) {
+                                if (!dock->previewState.active || dock->previewState.groupIndex != index) {
+                                    dock->previewState.active = true;
+                                    dock->previewState.groupIndex = index;
+                                    needsRepaint = true;
                                 }
                             }
                         }
+                        else {
+                            if (dock->previewState.active) {
+                                dock->previewState.active = false;
+                                dock->previewState.groupIndex = -1;
+                                needsRepaint = true;
+                            }
+                        }
                     }
                 }
             }
@@ -214,10 +181,11 @@ void InputManager::HandleMouseMove(HWND hwnd, int x, int y)
 
 void InputManager::HandleLeftClick(HWND hwnd, int x, int y) {
     D2D1_RECT_F rectF;
-    Module *m = HitTest(x, y, rectF);
+    int dockItem = -1;
+    Module *m = HitTest(x, y, rectF, &dockItem);
     if (!m) return;
 
-    std::string type = m->config.type;
+    ModuleType type = m->kind;
     float dpi = (float)GetDpiForWindow(hwnd);
     float scale = dpi / 96.0f;
 
@@ -230,7 +198,7 @@ void InputManager::HandleLeftClick(HWND hwnd, int x, int y) {
         return r;
         };
 
-    if (type == "dock") {
+    if (type == ModuleType::Dock) {
         DockModule *dock = (DockModule *)m;
         float logicalX = (float)x / scale;
         float logicalY = (float)y / scale;
@@ -246,78 +214,50 @@ void InputManager::HandleLeftClick(HWND hwnd, int x, int y) {
         dock->ForceHidePreview();
         this->lastHoveredDockIndex = -1; // Un-suppress preview
 
-        std::string pos = renderer->theme.global.position;
-        bool isVertical = (pos == "left" || pos == "right");
-
-        float modLength = isVertical ? (rectF.bottom - rectF.top) : (rectF.right - rectF.left);
-        float clickPos = isVertical ? (logicalY - rectF.top) : (logicalX - rectF.left);
-
-        Style s = dock->GetEffectiveStyle();
-        float iSize = (dock->config.dockIconSize > 0) ? dock->config.dockIconSize : 24.0f;
-
-        Style itemStyle = dock->config.itemStyle;
-        float paddingMain = isVertical ? (itemStyle.padding.top + itemStyle.padding.bottom) : (itemStyle.padding.left + itemStyle.padding.right);
-        float itemBoxStride = iSize + paddingMain;
-        float marginMain = isVertical ? (itemStyle.margin.top + itemStyle.margin.bottom) : (itemStyle.margin.left + itemStyle.margin.right);
-        float iSpace = (dock->config.dockSpacing > 0) ? dock->config.dockSpacing : marginMain;
-
+        int index = dockItem;
         int count = dock->GetCount();
-        if (count > 0) {
-            float totalLength = (count * itemBoxStride) + ((count - 1) * iSpace);
-            float marginStart = isVertical ? s.margin.top : s.margin.left;
-            float marginEnd = isVertical ? s.margin.bottom : s.margin.right;
-            float bgLength = modLength - marginStart - marginEnd;
-            float startPos = marginStart + ((bgLength - totalLength) / 2.0f);
-
-            if (clickPos >= startPos && clickPos <= (startPos + totalLength)) {
-                float offset = clickPos - startPos;
-                int index = (int)(offset / (itemBoxStride + iSpace));
-                float relativePos = fmod(offset, (itemBoxStride + iSpace));
-
-                if (relativePos <= itemBoxStride && index >= 0 && index < count) {
-                    WindowInfo info = dock->GetWindowInfoAtIndex(index);
-                    if (info.hwnd == NULL) {
-                        HINSTANCE hInst = ShellExecuteW(NULL, L"open", info.exePath.c_str(), NULL, NULL, SW_SHOWNORMAL);
-                        CommandExecutor::SafetyTest(hInst);
-                    }
-                    else {
-                        HWND currentFg = GetForegroundWindow();
-                        bool isGroupActive = false;
-                        if (currentFg == info.hwnd) isGroupActive = true;
-                        else {
-                            HWND next = dock->GetNextWindowInGroup(index, currentFg, 0);
-                            if (next == currentFg) isGroupActive = true;
-                        }
-                        HWND target = info.hwnd;
-                        if (isGroupActive) {
-                            target = dock->GetNextWindowInGroup(index, currentFg, 1);
-                            if (target == currentFg) {
-                                ShowWindow(target, SW_MINIMIZE);
-                                dock->SetOptimisticFocus(NULL);
-                                InvalidateRect(hwnd, NULL, FALSE);
-                                return;
-                            }
-                        }
-                        if (barInstance->workspaces.managedWindows.count(target)) {
-                            int wksp = barInstance->workspaces.managedWindows[target];
-                            if (wksp != barInstance->workspaces.currentWorkspace) {
-                                barInstance->workspaces.SwitchWorkspace(wksp);
-                                Module *wsMod = renderer->GetModule("workspaces");
-                                if (wsMod) ((WorkspacesModule *)wsMod)->SetActiveIndex(wksp);
-								InvalidateRect(hwnd, NULL, FALSE);
-                            }
-                        }
-                        if (IsIconic(target)) ShowWindow(target, SW_RESTORE);
-                        SetForegroundWindow(target);
-                        dock->SetOptimisticFocus(target);
+        if (index >= 0 && index < count) {
+            WindowInfo info = dock->GetWindowInfoAtIndex(index);
+            if (info.hwnd == NULL) {
+                HINSTANCE hInst = ShellExecuteW(NULL, L"open", info.exePath.c_str(), NULL, NULL, SW_SHOWNORMAL);
+                CommandExecutor::SafetyTest(hInst);
+            }
+            else {
+                HWND currentFg = GetForegroundWindow();
+                bool isGroupActive = false;
+                if (currentFg == info.hwnd) isGroupActive = true;
+                else {
+                    HWND next = dock->GetNextWindowInGroup(index, currentFg, 0);
+                    if (next == currentFg) isGroupActive = true;
+                }
+                HWND target = info.hwnd;
+                if (isGroupActive) {
+                    target = dock->GetNextWindowInGroup(index, currentFg, 1);
+                    if (target == currentFg) {
+                        ShowWindow(target, SW_MINIMIZE);
+                        dock->SetOptimisticFocus(NULL);
                         InvalidateRect(hwnd, NULL, FALSE);
+                        return;
+                    }
+                }
+                if (barInstance->workspaces.managedWindows.count(target)) {
+                    int wksp = barInstance->workspaces.managedWindows[target];
+                    if (wksp != barInstance->workspaces.currentWorkspace) {
+                        barInstance->workspaces.SwitchWorkspace(wksp);
+                        Module *wsMod = renderer->GetModule(ModuleType::Workspaces);
+                        if (wsMod) ((WorkspacesModule *)wsMod)->SetActiveIndex(wksp);
+						InvalidateRect(hwnd, NULL, FALSE);
                     }
                 }
+                if (IsIconic(target)) ShowWindow(target, SW_RESTORE);
+                SetForegroundWindow(target);
+                dock->SetOptimisticFocus(target);
+                InvalidateRect(hwnd, NULL, FALSE);
             }
         }
         InvalidateRect(hwnd, NULL, FALSE);
     }
-    else if (type == "workspaces") {
+    else if (type == ModuleType::Workspaces) {
         WorkspacesModule *ws = (WorkspacesModule *)m;
         float fullItemSize = ws->itemWidth + ws->itemPadding;
         int index = 0;
@@ -336,28 +276,28 @@ void InputManager::HandleLeftClick(HWND hwnd, int x, int y) {
             InvalidateRect(hwnd, NULL, FALSE);
         }
     }
-    else if (type == "audio") {
+    else if (type == ModuleType::Audio) {
         if (barInstance->flyout) { RECT r = GetScreenRect(rectF); barInstance->flyout->Toggle(r); }
     }
-    else if (type == "network") {
+    else if (type == ModuleType::Network) {
         if (barInstance->networkFlyout) {
             RECT r = GetScreenRect(rectF);
             barInstance->networkFlyout->Toggle(r);
         }
     }
-    else if (type == "tray") {
+    else if (type == ModuleType::Tray) {
         if (barInstance->trayFlyout) {
             RECT r = GetScreenRect(rectF);
             barInstance->trayFlyout->Toggle(r);
         }
     }
-    else if (type == "battery") {
+    else if (type == ModuleType::Battery) {
         CommandExecutor::SafetyTest(
             ShellExecute(NULL, L"open", L"ms-settings:batterysaver", NULL, NULL, SW_SHOWNORMAL));
 }
-    else if (type == "app_icon") { SendMessage(hwnd, WM_SYSCOMMAND, SC_TASKLIST, 0); }
-    else if (type == "notification") { CommandExecutor::Execute("notification", hwnd); }
-    else if (type == "custom" || type == "ping" || type == "weather" || type == "clock") {
+    else if (type == ModuleType::AppIcon) { SendMessage(hwnd, WM_SYSCOMMAND, SC_TASKLIST, 0); }
+    else if (type == ModuleType::Notification) { CommandExecutor::Execute("notification", hwnd); }
+    else if (type == ModuleType::Custom || type == ModuleType::Ping || type == ModuleType::Weather || type == ModuleType::Clock) {
         std::string action = m->config.onClick;
         if (!action.empty()) CommandExecutor::Execute(action, hwnd);
     }
@@ -367,86 +307,64 @@ void InputManager::HandleRightClick(HWND hwnd, int x, int y) {
     POINT screenPt = { x, y };
     ClientToScreen(hwnd, &screenPt);
     D2D1_RECT_F rectF;
-    Module *m = HitTest(x, y, rectF);
+    int dockItem = -1;
+    Module *m = HitTest(x, y, rectF, &dockItem);
 
-    if (!m || m->config.type != "dock") {
+    if (!m || m->kind != ModuleType::Dock) {
         MainMenu::Show(hwnd, screenPt);
         return;
     }
     DockModule *dock = (DockModule *)m;
-    float dpi = (float)GetDpiForWindow(hwnd);
-    float scale = dpi / 96.0f;
-
-    std::string pos = renderer->theme.global.position;
-    bool isVertical = (pos == "left" || pos == "right");
-
-    float modLength = isVertical ? (rectF.bottom - rectF.top) : (rectF.right - rectF.left);
-    float clickPos = isVertical ? (((float)y / scale) - rectF.top) : (((float)x / scale) - rectF.left);
-
-    Style s = dock->GetEffectiveStyle();
-    float iSize = (dock->config.dockIconSize > 0) ? dock->config.dockIconSize : 24.0f;
-
-    Style itemStyle = dock->config.itemStyle;
-    float paddingMain = isVertical ? (itemStyle.padding.top + itemStyle.padding.bottom) : (itemStyle.padding.left + itemStyle.padding.right);
-    float itemBoxStride = iSize + paddingMain;
-
-    float marginMain = isVertical ? (itemStyle.margin.top + itemStyle.margin.bottom) : (itemStyle.margin.left + itemStyle.margin.right);
-    float iSpace = (dock->config.dockSpacing > 0) ? dock->config.dockSpacing : marginMain;
-
+    int index = dockItem;
     int count = dock->GetCount();
-    if (count > 0) {
-        float totalLength = (count * itemBoxStride) + ((count - 1) * iSpace);
-
-        float marginStart = isVertical ? s.margin.top : s.margin.left;
-        float marginEnd = isVertical ? s.margin.bottom : s.margin.right;
-        float bgLength = modLength - marginStart - marginEnd;
-        float startPos = marginStart + ((bgLength - totalLength) / 2.0f);
-
-        if (clickPos >= startPos && clickPos <= (startPos + totalLength)) {
-            float offset = clickPos - startPos;
-            int index = (int)(offset / (itemBoxStride + iSpace));
-            if (index >= 0 && index < count) {
-                WindowInfo targetWin = dock->GetWindowInfoAtIndex(index);
-                HMENU hMenu = CreatePopupMenu();
-                std::wstring title = targetWin.title.empty() ? L"Application" : targetWin.title;
-                AppendMenuW(hMenu, MF_STRING | MF_DISABLED, 0, title.c_str());
-                AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
-                AppendMenuW(hMenu, MF_STRING, 100, targetWin.hwnd ? L"Open New Window" : L"Launch");
-                bool isPinned = dock->IsPinned(targetWin.exePath);
-                AppendMenuW(hMenu, MF_STRING, 101, isPinned ? L"Unpin" : L"Pin");
-                if (targetWin.hwnd) {
-                    AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
-                    AppendMenuW(hMenu, MF_STRING, 102, L"Close");
-                }
-                SetForegroundWindow(hwnd);
-                int cmd = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_NONOTIFY, screenPt.x, screenPt.y, 0, hwnd, NULL);
-                DestroyMenu(hMenu);
-                if (cmd == 100) {
-                    std::wstring path = targetWin.exePath;
-                    if (path.empty() && targetWin.hwnd) path = WindowMonitor::GetWindowExePath(targetWin.hwnd);
-                    if (!path.empty()) CommandExecutor::SafetyTest(
-                        ShellExecuteW(NULL, L"open", path.c_str(), NULL, NULL, SW_SHOWNORMAL));
-                }
-                else if (cmd == 101) {
-                    std::wstring path = targetWin.exePath;
-                    if (path.empty() && targetWin.hwnd) path = WindowMonitor::GetWindowExePath(targetWin.hwnd);
-                    if (!path.empty()) {
-                        if (dock->IsPinned(path)) dock->UnpinApp(path);
-                        else dock->PinApp(path);
-                    }
-                    InvalidateRect(hwnd, NULL, FALSE);
-                }
-                else if (cmd == 102) {
-                    if (targetWin.hwnd) PostMessage(targetWin.hwnd, WM_CLOSE, 0, 0);
+    if (index >= 0 && index < count) {
+        WindowInfo targetWin = dock->GetWindowInfoAtIndex(index);
+        HMENU hMenu = CreatePopupMenu();
+        std::wstring title = targetWin.title.empty() ? L"Application" : targetWin.title;
+        AppendMenuW(hMenu, MF_STRING | MF_DISABLED, 0, title.c_str());
+        AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
+        AppendMenuW(hMenu, MF_STRING, 100, targetWin.hwnd ? L"Open New Window" : L"Launch");
+        bool isPinned = dock->IsPinned(targetWin.exePath);
+        AppendMenuW(hMenu, MF_STRING, 101, isPinned ? L"Unpin" : L"Pin");
+        if (targetWin.hwnd) {
+            AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
+            AppendMenuW(hMenu, MF_STRING, 102, L"Close");
+        }
+        SetForegroundWindow(hwnd);
+        int cmd = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_NONOTIFY, screenPt.x, screenPt.y, 0, hwnd, NULL);
+        DestroyMenu(hMenu);
+        if (cmd == 100) {
+            std::wstring path = targetWin.exePath;
+            if (path.empty() && targetWin.hwnd) path = WindowMonitor::GetWindowExePath(targetWin.hwnd);
+            if (!path.empty()) CommandExecutor::SafetyTest(
+                ShellExecuteW(NULL, L"open", path.c_str(), NULL, NULL, SW_SHOWNORMAL));
+        }
+        else if (cmd == 101) {
+            std::wstring path = targetWin.exePath;
+            std::wstring name;
+            if (targetWin.hwnd) {
+                // Name the pin after the app, not whatever its window title says right now
+                const ProcessInfo *process = WindowMonitor::GetWindowProcess(targetWin.hwnd);
+                if (process) {
+                    if (path.empty()) path = process->imagePath;
+                    name = process->displayName;
                 }
             }
+            if (!path.empty()) {
+                if (dock->IsPinned(path)) dock->UnpinApp(path);
+                else dock->PinApp(path, name);
+            }
+            InvalidateRect(hwnd, NULL, FALSE);
+        }
+        else if (cmd == 102) {
+            if (targetWin.hwnd) PostMessage(targetWin.hwnd, WM_CLOSE, 0, 0);
         }
     }
 }
 
 void InputManager::HandleScroll(HWND hwnd, short delta) {
     if (GetKeyState(VK_MENU) & 0x8000) {
-        Module *m = renderer->GetModule("workspaces");
+        Module *m = renderer->GetModule(ModuleType::Workspaces);
         if (m) {
             WorkspacesModule *ws = (WorkspacesModule *)m;
             int current = barInstance->workspaces.currentWorkspace;
@@ -466,40 +384,12 @@ void InputManager::HandleScroll(HWND hwnd, short delta) {
     POINT pt; GetCursorPos(&pt);
     ScreenToClient(hwnd, &pt);
     D2D1_RECT_F rectF;
-    Module *m = HitTest(pt.x, pt.y, rectF);
-    if (m && m->config.type == "dock") {
+    int dockItem = -1;
+    Module *m = HitTest(pt.x, pt.y, rectF, &dockItem);
+    if (m && m->kind == ModuleType::Dock) {
         DockModule *dock = (DockModule *)m;
-        float dpi = (float)GetDpiForWindow(hwnd);
-        float scale = dpi / 96.0f;
-
-        // --- FIXED VERTICAL SCROLL LOGIC ---
-        std::string pos = renderer->theme.global.position;
-        bool isVertical = (pos == "left" || pos == "right");
-
-        float modLength = isVertical ? (rectF.bottom - rectF.top) : (rectF.right - rectF.left);
-        float clickPos = isVertical ? (((float)pt.y / scale) - rectF.top) : (((float)pt.x / scale) - rectF.left);
-
-        Style s = dock->GetEffectiveStyle();
-        float iSize = (dock->config.dockIconSize > 0) ? dock->config.dockIconSize : 24.0f;
-        Style itemStyle = dock->config.itemStyle;
-
-        float paddingMain = isVertical ? (itemStyle.padding.top + itemStyle.padding.bottom) : (itemStyle.padding.left + itemStyle.padding.right);
-        float itemBoxStride = iSize + paddingMain;
-
-        float marginMain = isVertical ? (itemStyle.margin.top + itemStyle.margin.bottom) : (itemStyle.margin.left + itemStyle.margin.right);
-        float iSpace = (dock->config.dockSpacing > 0) ? dock->config.dockSpacing : marginMain;
-
-        int count = dock->GetCount();
-        float totalLength = (count * itemBoxStride) + ((count - 1) * iSpace);
-
-        float marginStart = isVertical ? s.margin.top : s.margin.left;
-        float marginEnd = isVertical ? s.margin.bottom : s.margin.right;
-        float bgLength = modLength - marginStart - marginEnd;
-        float startPos = marginStart + ((bgLength - totalLength) / 2.0f);
-
-        if (clickPos >= startPos && clickPos <= (startPos + totalLength)) {
-            float offset = clickPos - startPos;
-            int index = (int)(offset / (itemBoxStride + iSpace));
+        int index = dockItem;
+        if (index >= 0 && index < (int)dock->GetCount()) {
             int direction = (delta > 0) ? -1 : 1;
             HWND currentFg = GetForegroundWindow();
             HWND nextWin = dock->GetNextWindowInGroup(index, currentFg, direction);
@@ -516,7 +406,7 @@ void InputManager::HandleScroll(HWND hwnd, short delta) {
 
 void InputManager::OnMouseLeave(HWND hwnd) {
     if (renderer) {
-        Module *dm = renderer->GetModule("dock");
+        Module *dm = renderer->GetModule(ModuleType::Dock);
         if (dm) {
             DockModule *dock = (DockModule *)dm;
 
@@ -545,68 +435,24 @@ void InputManager::OnMouseLeave(HWND hwnd) {
         lastTooltipText.clear();
         isTrackingMouse = false;
         if (renderer) {
-            for (auto const &[id, cfg] : renderer->theme.modules) {
-                Module *m = renderer->GetModule(id);
-                if (m) {
-                    m->isHovered = false;
-                    if (m->config.type == "workspaces") ((WorkspacesModule *)m)->SetHoveredIndex(-1);
-                }
+            for (Module *m : renderer->GetRegistry().All()) {
+                m->SetHovered(false);
+                if (m->kind == ModuleType::Workspaces) ((WorkspacesModule *)m)->SetHoveredIndex(-1);
             }
             InvalidateRect(hwnd, NULL, FALSE);
         }
     }
 }
 
-Module *InputManager::HitTest(int x, int y, D2D1_RECT_F &outRect) {
+Module *InputManager::HitTest(int x, int y, D2D1_RECT_F &outRect, int *outPart) {
     if (!renderer) return nullptr;
-    float dpi = (float)GetDpiForWindow(barInstance->GetHwnd());
-    float scale = dpi / 96.0f;
-    POINT pt = { x, y };
-
-    auto CheckList = [&](const std::vector<Module *> &list) -> Module *{
-        for (Module *m : list) {
-            D2D1_RECT_F f = renderer->GetModuleRect(m->config.id);
-            if (f.right == 0.0f && f.bottom == 0.0f) continue;
-
-            RECT physRect = {
-                (LONG)(f.left * scale), (LONG)(f.top * scale),
-                (LONG)(f.right * scale), (LONG)(f.bottom * scale)
-            };
-
-            // INFLATE HIT BOX (Vertical padding for easier clicking)
-            InflateRect(&physRect, 0, 24);
 
-            if (PtInRect(&physRect, pt)) {
-                if (m->config.type == "group") {
-                    GroupModule *g = (GroupModule *)m;
-                    for (auto *child : g->children) {
-                        // --- FIX START ---
-                        // Don't ask Renderer for child rects (it doesn't know them).
-                        // Use the cachedRect stored on the child module itself.
-                        D2D1_RECT_F cf = child->cachedRect;
-                        // --- FIX END ---
+    // Vertical slack makes clicks at the screen edge still land on the bar
+    HitResult hit = renderer->GetHitIndex().Find(x, y, 24);
+    if (!hit.module) return nullptr;
 
-                        RECT cphys = {
-                            (LONG)(cf.left * scale), (LONG)(cf.top * scale),
-                            (LONG)(cf.right * scale), (LONG)(cf.bottom * scale)
-                        };
-
-                        InflateRect(&cphys, 0, 24); // Inflate child items too
-
-                        if (PtInRect(&cphys, pt)) {
-                            outRect = cf;
-                            return child;
-                        }
-                    }
-                }
-                outRect = f;
-                return m;
-            }
-        }
-        return nullptr;
-        };
-
-    Module *found = CheckList(renderer->leftModules); if (found) return found;
-    found = CheckList(renderer->centerModules); if (found) return found;
-    return CheckList(renderer->rightModules);
-}
\ No newline at end of file
+    const LayoutRect &r = hit.module->rect;
+    outRect = D2D1::RectF(r.left, r.top, r.right, r.bottom);
+    if (outPart) *outPart = hit.part;
+    return static_cast<Module *>(hit.module->owner);
+}
@@ -32,6 +32,7 @@ public:
 	TooltipHandler *tooltips;
 
 private:
-	Module *HitTest(int x, int y, D2D1_RECT_F &outRect);
+	// Innermost module under a client pixel; `outPart` receives the sub-item (dock icon) or -1
+	Module *HitTest(int x, int y, D2D1_RECT_F &outRect, int *outPart = nullptr);
 };
 
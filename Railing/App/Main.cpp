@@ -1,7 +1,29 @@
 #include "Railing.h"
+#include "FrameProfiler.h"
+#include "FrameBenchmark.h"
+#include <shellapi.h>
 
 int WINAPI WinMain(__in HINSTANCE hInstance, __in_opt HINSTANCE, __in LPSTR, __in int nCmdShow)
 {
+	FrameProfiler::SetThreadName("UI");
+
+#if RAILING_BENCHMARK
+	// Railing.exe --bench [presets dir] [out.json]: headless frame benchmark, no bar
+	int argc = 0;
+	LPWSTR *argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+	if (argv && argc >= 2 && wcscmp(argv[1], L"--bench") == 0) {
+		std::wstring presets = argc >= 3 ? argv[2] : L"presets";
+		std::wstring out = argc >= 4 ? argv[3] : L"railing-bench.json";
+		LocalFree(argv);
+		CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+		SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+		int code = FrameBenchmark::Run(presets, out);
+		CoUninitialize();
+		return code;
+	}
+	if (argv) LocalFree(argv);
+#endif
+
 	Railing railing;
 	if (!railing.Initialize(hInstance)) return 0;
 
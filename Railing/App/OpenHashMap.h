@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+// Flat hash map for integer keys (window handles, path hashes, ids).
+// Linear probing over power-of-two arrays with backward-shift deletion, so
+// lookups touch one or two cache lines and erasing leaves no tombstones.
+// Keys are remixed because handles and pointers share their low bits.
+
+template <typename Key, typename Value>
+class OpenHashMap
+{
+public:
+    OpenHashMap() = default;
+    explicit OpenHashMap(size_t expected) { Reserve(expected); }
+
+    size_t Size() const { return count; }
+    bool Empty() const { return count == 0; }
+
+    Value *Find(Key key) {
+        if (!count) return nullptr;
+        for (size_t i = Home(key);; i = (i + 1) & mask) {
+            if (!used[i]) return nullptr;
+            if (keys[i] == key) return &values[i];
+        }
+    }
+    const Value *Find(Key key) const { return const_cast<OpenHashMap *>(this)->Find(key); }
+    bool Contains(Key key) const { return Find(key) != nullptr; }
+
+    // Insert or overwrite; returns the stored value
+    Value &Insert(Key key, const Value &value) {
+        if ((count + 1) * 4 > keys.size() * 3) Grow();
+        size_t i = Home(key);
+        while (used[i] && keys[i] != key) i = (i + 1) & mask;
+        if (!used[i]) {
+            used[i] = 1;
+            keys[i] = key;
+            count++;
+        }
+        values[i] = value;
+        return values[i];
+    }
+
+    bool Erase(Key key) {
+        if (!count) return false;
+        size_t i = Home(key);
+        while (true) {
+            if (!used[i]) return false;
+            if (keys[i] == key) break;
+            i = (i + 1) & mask;
+        }
+        // Pull later members of the probe run back so no gap splits it
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask; used[j]; j = (j + 1) & mask) {
+            size_t home = Home(keys[j]);
+            bool between = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+            if (between) continue;
+            keys[hole] = keys[j];
+            values[hole] = values[j];
+            hole = j;
+        }
+        used[hole] = 0;
+        values[hole] = Value();
+        count--;
+        return true;
+    }
+
+    void Clear() {
+        std::fill(used.begin(), used.end(), 0);
+        std::fill(values.begin(), values.end(), Value());
+        count = 0;
+    }
+
+    void Reserve(size_t expected) {
+        size_t capacity = 16;
+        while (capacity * 3 < expected * 4) capacity *= 2;
+        if (capacity > keys.size()) Rehash(capacity);
+    }
+
+    template <typename Fn>
+    void ForEach(Fn &&fn) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (used[i]) fn(keys[i], values[i]);
+        }
+    }
+
+private:
+    std::vector<Key> keys;
+    std::vector<Value> values;
+    std::vector<uint8_t> used;
+    size_t mask = 0;
+    size_t count = 0;
+
+    size_t Home(Key key) const {
+        uint64_t x = (uint64_t)key; // splitmix64 finalizer
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27; x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return (size_t)x & mask;
+    }
+
+    void Grow() { Rehash(keys.empty() ? 16 : keys.size() * 2); }
+
+    void Rehash(size_t capacity) {
+        std::vector<Key> oldKeys(capacity);
+        std::vector<Value> oldValues(capacity);
+        std::vector<uint8_t> oldUsed(capacity, 0);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        oldUsed.swap(used);
+        mask = capacity - 1;
+        count = 0;
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (!oldUsed[i]) continue;
+            size_t j = Home(oldKeys[i]);
+            while (used[j]) j = (j + 1) & mask;
+            used[j] = 1;
+            keys[j] = oldKeys[i];
+            values[j] = std::move(oldValues[i]);
+            count++;
+        }
+    }
+};
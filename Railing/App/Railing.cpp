@@ -41,6 +41,8 @@ Railing::~Railing() {
     if (titleHook) UnhookWinEvent(titleHook);
     if (focusHook) UnhookWinEvent(focusHook);
     if (windowLifecycleHook) UnhookWinEvent(windowLifecycleHook);
+    if (cloakHook) UnhookWinEvent(cloakHook);
+    if (locationHook) UnhookWinEvent(locationHook);
     CoUninitialize();
 }
 
@@ -101,6 +103,14 @@ bool Railing::Initialize(HINSTANCE hInstance) {
     // Start global backends
     stats.GetCpuUsage(); // Prime the pump
 
+    // The one full enumeration; windows already open won't report a show, so
+    // the queue tracks them too and still passes on their hide/destroy
+    windowRegistry.Sync();
+    lastWindowSync = GetTickCount64();
+    std::vector<const WindowRecord *> seeded;
+    windowRegistry.Snapshot(seeded);
+    for (const WindowRecord *w : seeded) windowEvents.Track(w->hwnd);
+
     // Register global hooks (apply to all bars)
     titleHook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE,
         nullptr, WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
@@ -108,7 +118,15 @@ bool Railing::Initialize(HINSTANCE hInstance) {
     focusHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND,
         nullptr, WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
 
-    windowLifecycleHook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE,
+    // Creation is skipped: a window only matters once it is shown
+    windowLifecycleHook = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_HIDE,
+        nullptr, WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
+    cloakHook = SetWinEventHook(EVENT_OBJECT_CLOAKED, EVENT_OBJECT_UNCLOAKED,
+        nullptr, WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
+    // Moves and resizes keep the window lists' rects current
+    locationHook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE,
         nullptr, WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
 
     // Create primary bar
@@ -134,11 +152,46 @@ void CALLBACK Railing::WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
     DWORD dwEventThread, DWORD dwmsEventTime) {
     if (!instance) return;
 
-    // Broadcast to all bars
+    // Out-of-context hooks run on this (the UI) thread, so the queue needs no lock.
+    // Only the first event of a frame wakes the bars; the rest merge into its batch.
+    if (!instance->windowEvents.Push(event, (uintptr_t)hwnd, idObject, idChild)) return;
     for (auto *bar : instance->bars) {
-        InvalidateRect(bar->GetHwnd(), nullptr, FALSE);
-        if (event == EVENT_SYSTEM_FOREGROUND) bar->workspaces.AddWindow(hwnd);
+        bar->frames.RequestFrame(FRAME_CLIENT_WINEVENTS);
+        bar->ScheduleFrames();
+    }
+}
+
+void Railing::DispatchWindowEvents() {
+    bool hasBatch = windowEvents.Drain(windowBatch);
+    if (hasBatch) {
+        // A rename to the same title or a show of a window that doesn't qualify leaves the dock as is
+        bool listChanged = windowRegistry.Apply(windowBatch);
+        if (!listChanged && !windowBatch.foregroundChanged) windowBatch.routes &= ~WINEVENT_ROUTE_DOCK;
+        hasBatch = windowBatch.routes != WINEVENT_ROUTE_NONE;
     }
+
+    for (auto *bar : bars) {
+        // Whichever bar ticks first delivers the batch to all of them
+        bar->frames.Cancel(FRAME_CLIENT_WINEVENTS);
+        if (!hasBatch) continue;
+
+        if (windowBatch.routes & WINEVENT_ROUTE_GEOMETRY) bar->RefreshWindowRects(windowBatch);
+        if (windowBatch.routes & WINEVENT_ROUTE_WORKSPACES) {
+            if (windowBatch.foregroundChanged) bar->workspaces.AddWindow((HWND)windowBatch.foreground);
+            for (const WindowEventEntry &e : windowBatch.windows) {
+                if (e.changes & WINDOW_DESTROYED) bar->workspaces.RemoveWindow((HWND)e.hwnd);
+            }
+        }
+        // Bars without a dock or workspaces module don't repaint at all
+        if (bar->renderer && bar->renderer->RouteWindowEvents(windowBatch)) InvalidateRect(bar->GetHwnd(), nullptr, FALSE);
+    }
+    for (auto *bar : bars) bar->ScheduleFrames();
+}
+
+bool AppWindowClassifier::IsAppWindow(uintptr_t hwnd) const {
+    HWND h = (HWND)hwnd;
+    // Child windows fail the ancestor check cheaply before the full test
+    return GetAncestor(h, GA_ROOT) == h && WindowMonitor::IsAppWindow(h, NULL);
 }
 
 void Railing::SaveSession() {
@@ -193,6 +246,23 @@ void Railing::UpdateGlobalStats() {
         updated = true;
     }
 
+    // Safety net for changes the hooks don't report (style changes, late resizes)
+    if (now - lastWindowSync >= WINDOW_SYNC_INTERVAL) {
+        lastWindowSync = now;
+        WindowMonitor::Processes().Sweep(); // Release handles of exited processes
+        if (windowRegistry.Sync()) {
+            std::vector<const WindowRecord *> listed;
+            windowRegistry.Snapshot(listed);
+            for (const WindowRecord *w : listed) windowEvents.Track(w->hwnd);
+
+            WinEventBatch resync;
+            resync.routes = WINEVENT_ROUTE_DOCK;
+            for (auto *bar : bars) {
+                if (bar->renderer && bar->renderer->RouteWindowEvents(resync)) InvalidateRect(bar->GetHwnd(), nullptr, FALSE);
+            }
+        }
+    }
+
     // Broadcast to all bars
     if (updated) {
         SystemStatusData statsData;
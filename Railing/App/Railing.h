@@ -20,6 +20,9 @@
 #include "NetworkFlyout.h"
 #include "MainMenu.h"
 #include "BarInstance.h"
+#include "WinEventQueue.h"
+#include "WindowMonitor.h"
+#include "WindowRegistry.h"
 #include <NetworkBackend.h>
 
 #define HOTKEY_KILL_THIS 9001
@@ -31,6 +34,11 @@
 
 class BarInstance;
 
+class AppWindowClassifier : public WindowClassifier {
+public:
+    bool IsAppWindow(uintptr_t hwnd) const override;
+};
+
 class Railing {
 public:
     static Railing *instance;
@@ -45,6 +53,10 @@ public:
     AudioCapture *visualizerBackend;
     NetworkBackend networkBackend;
 
+    // Desktop app windows, shared by every bar's dock
+    DesktopWindowSystem windowSystem;
+    WindowRegistry windowRegistry{ windowSystem };
+
     // Cached global stats
     int cachedCpuUsage = 0;
     int cachedRamUsage = 0;
@@ -66,15 +78,24 @@ public:
 	BarInstance *FindBar(HWND hwnd);
     void DeleteBar(BarInstance *target);
     void UpdateGlobalStats();
+    // Route the window events merged since the last frame to the bars' modules
+    void DispatchWindowEvents();
 
 private:
     HWINEVENTHOOK titleHook = nullptr;
     HWINEVENTHOOK focusHook = nullptr;
     HWINEVENTHOOK windowLifecycleHook = nullptr;
+    HWINEVENTHOOK cloakHook = nullptr;
+    HWINEVENTHOOK locationHook = nullptr;
+    AppWindowClassifier windowClassifier;
+    WinEventQueue windowEvents{ windowClassifier };
+    WinEventBatch windowBatch;
 
     ULONGLONG lastCpuUpdate = 0;
     ULONGLONG lastRamUpdate = 0;
     ULONGLONG lastGpuUpdate = 0;
+    ULONGLONG lastWindowSync = 0;
+    static constexpr ULONGLONG WINDOW_SYNC_INTERVAL = 5000; // Catches style changes and moves no hook reports
 
     static void CALLBACK WinEventProc(HWINEVENTHOOK hook, DWORD event,
         HWND hwnd, LONG idObject, LONG idChild,
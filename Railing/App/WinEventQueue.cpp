@@ -0,0 +1,132 @@
+#include "WinEventQueue.h"
+#include <algorithm>
+
+bool WinEventQueue::Push(uint32_t event, uintptr_t hwnd, int32_t idObject, int32_t idChild)
+{
+    received++;
+    // Carets, cursors, scroll bars and items inside a window all report through the same hooks
+    if (!hwnd || idObject != WinEvent::OBJID_WINDOW || idChild != WinEvent::CHILDID_SELF) {
+        filtered++;
+        return false;
+    }
+
+    bool isKnown = known.count(hwnd) != 0;
+    Slot *slot = nullptr;
+
+    switch (event) {
+    case WinEvent::SYSTEM_FOREGROUND:
+        // The active item changes even when focus goes to the desktop or a dialog
+        if (batch.foregroundChanged) coalesced++;
+        batch.foreground = hwnd;
+        batch.foregroundChanged = true;
+        if (isKnown || classifier.IsAppWindow(hwnd)) {
+            slot = Entry(hwnd, !isKnown);
+            batch.windows[slot->index].changes |= WINDOW_FOCUSED;
+        }
+        break;
+
+    case WinEvent::OBJECT_SHOW:
+    case WinEvent::OBJECT_UNCLOAKED:
+        if (!isKnown && !classifier.IsAppWindow(hwnd)) break;
+        slot = Entry(hwnd, !isKnown);
+        batch.windows[slot->index].changes = (batch.windows[slot->index].changes & ~WINDOW_HIDDEN) | WINDOW_SHOWN;
+        break;
+
+    case WinEvent::OBJECT_NAMECHANGE:
+        if (!isKnown && !classifier.IsAppWindow(hwnd)) break;
+        slot = Entry(hwnd, !isKnown);
+        batch.windows[slot->index].changes |= WINDOW_RENAMED;
+        break;
+
+    case WinEvent::OBJECT_HIDE:
+    case WinEvent::OBJECT_CLOAKED:
+        // Hidden windows no longer classify, so only windows seen before count
+        if (!isKnown) break;
+        slot = Entry(hwnd, false);
+        batch.windows[slot->index].changes = (batch.windows[slot->index].changes & ~WINDOW_SHOWN) | WINDOW_HIDDEN;
+        break;
+
+    case WinEvent::OBJECT_LOCATIONCHANGE:
+        // Fires for every step of a drag; only listed windows carry a rect
+        if (!isKnown) break;
+        slot = Entry(hwnd, false);
+        batch.windows[slot->index].changes |= WINDOW_MOVED;
+        break;
+
+    case WinEvent::OBJECT_DESTROY: {
+        if (!isKnown) break;
+        auto it = slots.find(hwnd);
+        if (it != slots.end() && it->second.fresh) {
+            // Appeared and vanished within one frame: nobody needs to hear about it
+            coalesced++;
+            Forget(hwnd);
+            return false;
+        }
+        slot = Entry(hwnd, false);
+        batch.windows[slot->index].changes = WINDOW_DESTROYED;
+        known.erase(hwnd);
+        break;
+    }
+
+    default:
+        break; // Creation is picked up when the window is first shown
+    }
+
+    if (!slot && event != WinEvent::SYSTEM_FOREGROUND) {
+        filtered++;
+        return false;
+    }
+
+    bool first = !pending;
+    pending = true;
+    return first;
+}
+
+bool WinEventQueue::Drain(WinEventBatch &out)
+{
+    out.Clear();
+    if (!pending) return false;
+    pending = false;
+    slots.clear();
+
+    // Swap rather than copy so both vectors keep their capacity between frames
+    std::swap(out.windows, batch.windows);
+    out.windows.erase(std::remove_if(out.windows.begin(), out.windows.end(),
+        [](const WindowEventEntry &e) { return e.changes == 0; }), out.windows.end());
+    out.foreground = batch.foreground;
+    out.foregroundChanged = batch.foregroundChanged;
+    batch.Clear();
+
+    if (out.foregroundChanged) out.routes |= WINEVENT_ROUTE_DOCK | WINEVENT_ROUTE_WORKSPACES;
+    for (const WindowEventEntry &e : out.windows) {
+        if (e.changes & ~WINDOW_MOVED) out.routes |= WINEVENT_ROUTE_DOCK;
+        if (e.changes & WINDOW_MOVED) out.routes |= WINEVENT_ROUTE_GEOMETRY;
+        if (e.changes & WINDOW_DESTROYED) out.routes |= WINEVENT_ROUTE_WORKSPACES;
+    }
+    if (out.routes == WINEVENT_ROUTE_NONE) return false;
+
+    batches++;
+    return true;
+}
+
+WinEventQueue::Slot *WinEventQueue::Entry(uintptr_t hwnd, bool fresh)
+{
+    auto it = slots.find(hwnd);
+    if (it != slots.end()) {
+        coalesced++;
+        return &it->second;
+    }
+    known.insert(hwnd);
+    batch.windows.push_back({ hwnd, 0 });
+    return &slots.emplace(hwnd, Slot{ (uint32_t)batch.windows.size() - 1, fresh }).first->second;
+}
+
+void WinEventQueue::Forget(uintptr_t hwnd)
+{
+    auto it = slots.find(hwnd);
+    if (it != slots.end()) {
+        batch.windows[it->second.index].changes = 0;
+        slots.erase(it);
+    }
+    known.erase(hwnd);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// Window events from the system-wide WinEvent hooks, filtered and coalesced.
+// The hooks fire for every object in every process (carets, tooltips, child
+// controls) and browsers rename their windows many times a second; instead of
+// repainting every bar per event, the hook pushes here and the bars drain one
+// batch per frame: one entry per window with its changes merged, routed only
+// to the modules that show windows.
+// Event ids mirror the Win32 values and the window test comes from a
+// WindowClassifier, so recorded streams replay off Windows.
+
+namespace WinEvent {
+    constexpr uint32_t SYSTEM_FOREGROUND = 0x0003;
+    constexpr uint32_t OBJECT_CREATE = 0x8000;
+    constexpr uint32_t OBJECT_DESTROY = 0x8001;
+    constexpr uint32_t OBJECT_SHOW = 0x8002;
+    constexpr uint32_t OBJECT_HIDE = 0x8003;
+    constexpr uint32_t OBJECT_LOCATIONCHANGE = 0x800B; // Moved or resized
+    constexpr uint32_t OBJECT_NAMECHANGE = 0x800C;
+    constexpr uint32_t OBJECT_CLOAKED = 0x8017;   // Other virtual desktop, suspended UWP app
+    constexpr uint32_t OBJECT_UNCLOAKED = 0x8018;
+
+    constexpr int32_t OBJID_WINDOW = 0;
+    constexpr int32_t CHILDID_SELF = 0;
+}
+
+class WindowClassifier
+{
+public:
+    virtual ~WindowClassifier() = default;
+    // A window the dock would list (top-level, visible, not a tool window)
+    virtual bool IsAppWindow(uintptr_t hwnd) const = 0;
+};
+
+enum WindowChange : uint8_t {
+    WINDOW_SHOWN = 1 << 0,
+    WINDOW_HIDDEN = 1 << 1,
+    WINDOW_DESTROYED = 1 << 2,
+    WINDOW_RENAMED = 1 << 3,
+    WINDOW_FOCUSED = 1 << 4,
+    WINDOW_MOVED = 1 << 5,
+};
+
+// Which modules a batch concerns
+enum WinEventRoute : uint32_t {
+    WINEVENT_ROUTE_NONE = 0,
+    WINEVENT_ROUTE_DOCK = 1 << 0,       // Window list, titles, active item
+    WINEVENT_ROUTE_WORKSPACES = 1 << 1, // Foreground and closed windows
+    WINEVENT_ROUTE_GEOMETRY = 1 << 2,   // Window rects only, nothing to repaint
+};
+
+struct WindowEventEntry {
+    uintptr_t hwnd = 0;
+    uint8_t changes = 0; // WindowChange bits, merged across the frame
+};
+
+struct WinEventBatch {
+    std::vector<WindowEventEntry> windows;
+    uintptr_t foreground = 0; // Last foreground window, 0 when it didn't change
+    bool foregroundChanged = false;
+    uint32_t routes = WINEVENT_ROUTE_NONE;
+
+    void Clear() { windows.clear(); foreground = 0; foregroundChanged = false; routes = WINEVENT_ROUTE_NONE; }
+};
+
+class WinEventQueue
+{
+public:
+    explicit WinEventQueue(const WindowClassifier &classifier) : classifier(classifier) {}
+
+    /// <summary>
+    /// Filter and merge one hook event. Returns true when it is the first
+    /// pending event since the last Drain, i.e. a frame should be requested.
+    /// </summary>
+    bool Push(uint32_t event, uintptr_t hwnd, int32_t idObject, int32_t idChild);
+
+    /// <summary>
+    /// Move everything merged since the last call into `out`. Returns false
+    /// (and leaves `out` empty) when nothing relevant happened.
+    /// </summary>
+    bool Drain(WinEventBatch &out);
+
+    bool HasPending() const { return pending; }
+
+    // Windows that existed before the hooks were installed; hides and
+    // destroys are only passed on for windows the queue knows
+    void Track(uintptr_t hwnd) { known.insert(hwnd); }
+    bool IsTracked(uintptr_t hwnd) const { return known.count(hwnd) != 0; }
+    size_t TrackedCount() const { return known.size(); }
+
+    // Hook events seen, dropped by the filter, merged into an existing entry, and batches drained
+    uint64_t received = 0;
+    uint64_t filtered = 0;
+    uint64_t coalesced = 0;
+    uint64_t batches = 0;
+
+private:
+    struct Slot {
+        uint32_t index; // Into batch.windows
+        bool fresh;     // Became known during this frame
+    };
+
+    const WindowClassifier &classifier;
+    std::unordered_set<uintptr_t> known;
+    std::unordered_map<uintptr_t, Slot> slots; // Per-window dedupe for the frame being built
+    WinEventBatch batch;
+    bool pending = false;
+
+    Slot *Entry(uintptr_t hwnd, bool fresh);
+    void Forget(uintptr_t hwnd);
+};
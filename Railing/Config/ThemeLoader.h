@@ -27,7 +27,20 @@ public:
         c.modules["default_clock"] = clock;
         c.layout.right.push_back("default_clock");
 
-        return c;
+        return CompileStyles(c);
+    }
+
+    /// <summary>
+    /// Merge every module's style variants into one interned table.
+    /// </summary>
+    static ThemeConfig &CompileStyles(ThemeConfig &config)
+    {
+        config.styles = std::make_shared<StyleTable>();
+        for (auto &[id, mod] : config.modules) {
+            CompileModuleStyles(mod, *config.styles);
+            mod.styleTable = config.styles;
+        }
+        return config;
     }
 
     static ThemeConfig Load(const std::string &filename)
@@ -67,6 +80,9 @@ public:
                     config.global.animation.duration = a.value("duration", 300);
                     config.global.animation.startScale = a.value("start_scale", 0.1f);
                     config.global.animation.fps = a.value("fps", 60);
+                    config.global.animation.easing = a.value("easing", "ease_out");
+                    config.global.animation.stiffness = a.value("stiffness", 170.0f);
+                    config.global.animation.damping = a.value("damping", 26.0f);
                 }
                 if (g.contains("style")) {
                     Style s = ParseStyle(g["style"]);
@@ -110,6 +126,7 @@ public:
                 mod.type = val.value("type", "custom");
                 mod.format = val.value("format", "");
                 mod.interval = val.value("interval", 1000);
+                mod.fixedDigits = val.value("fixed_digits", false);
                 mod.position = val.value("position", config.global.position);
                 mod.latitude = val.value("latitude", "");
                 mod.longitude = val.value("longitude", "");
@@ -118,6 +135,7 @@ public:
                 mod.target = val.value("target", "");
                 mod.onClick = val.value("on_click", "");
                 mod.icon = val.value("icon", "");
+                mod.dockIconCacheKb = val.value("icon_cache_kb", 4096);
 
                 if (val.contains("style")) {
                     auto &s = val["style"];
@@ -141,6 +159,7 @@ public:
 
                 config.modules[key] = mod;
             }
+            CompileStyles(config);
 
             // --- Parsing Pinned Apps ---
             if (j.contains("pinned") && j["pinned"].is_array()) {
@@ -179,6 +198,9 @@ public:
         j["global"]["animation"]["duration"] = config.global.animation.duration;
         j["global"]["animation"]["start_scale"] = config.global.animation.startScale;
         j["global"]["animation"]["fps"] = config.global.animation.fps;
+        j["global"]["animation"]["easing"] = config.global.animation.easing;
+        j["global"]["animation"]["stiffness"] = config.global.animation.stiffness;
+        j["global"]["animation"]["damping"] = config.global.animation.damping;
 
         nlohmann::json globalStyle;
         globalStyle["bg"] = ColorToHex(config.global.background);
@@ -208,6 +230,7 @@ public:
             m["type"] = mod.type;
             m["format"] = mod.format;
             m["interval"] = mod.interval;
+            if (mod.fixedDigits) m["fixed_digits"] = true;
             m["position"] = mod.position;
             m["latitude"] = mod.latitude;
             m["longitude"] = mod.longitude;
@@ -216,6 +239,7 @@ public:
             m["target"] = mod.target;
             m["on_click"] = mod.onClick;
             m["icon"] = mod.icon;
+            if (mod.dockIconCacheKb != 4096) m["icon_cache_kb"] = mod.dockIconCacheKb;
 
             // --- Base Style ---
             nlohmann::json styleJson = StyleToJson(mod.baseStyle);
@@ -289,6 +313,7 @@ private:
         if (s.has_radius) j["radius"] = s.radius;
         if (s.has_padding) j["padding"] = PaddingToJson(s.padding);
         if (s.has_margin) j["margin"] = PaddingToJson(s.margin);
+        if (s.has_font_weight) j["font_weight"] = (s.font_weight == FontWeight::Bold) ? "bold" : "normal";
         if (s.has_border) {
             j["border_width"] = s.borderWidth;
             j["border_color"] = ColorToHex(s.borderColor);
@@ -322,7 +347,10 @@ private:
         if (j.contains("radius")) { s.radius = j["radius"]; s.has_radius = true; }
         if (j.contains("padding")) { s.padding = Padding::FromJSON(j["padding"]); s.has_padding = true; }
         if (j.contains("margin")) { s.margin = Padding::FromJSON(j["margin"]); s.has_margin = true; }
-        if (j.contains("font_weight")) { s.font_weight = j["font_weight"]; s.has_font_weight = true; }
+        if (j.contains("font_weight")) {
+            s.font_weight = (j["font_weight"] == "bold") ? FontWeight::Bold : FontWeight::Normal;
+            s.has_font_weight = true;
+        }
         if (j.contains("border_width")) { s.borderWidth = j.value("border_width", 0.0f); s.has_border = true; }
         if (j.contains("border_color")) s.borderColor = ParseColor(j["border_color"]);
         if (j.contains("indicator")) s.indicator = ParseColor(j["indicator"]);
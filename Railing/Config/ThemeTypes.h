@@ -2,6 +2,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <cstdint>
 #include <d2d1.h>
 #include <d2d1_1.h>
 #include <nlohmann/json.hpp>
@@ -22,8 +26,12 @@ struct Padding {
         }
         return p;
     }
+
+    bool operator==(const Padding &o) const = default;
 };
 
+enum class FontWeight : uint8_t { Normal, Bold };
+
 struct Style {
     D2D1_COLOR_F bg = D2D1::ColorF(0, 0, 0, 0); // Default Transparent
     D2D1_COLOR_F fg = D2D1::ColorF(1, 1, 1, 1); // Default White
@@ -31,7 +39,7 @@ struct Style {
     float radius = 0.0f;
     Padding padding;
     Padding margin;
-    std::string font_weight = "normal";
+    FontWeight font_weight = FontWeight::Normal;
     float borderWidth = 0.0f;
     D2D1_COLOR_F borderColor = D2D1::ColorF(0, 0, 0, 0);
     bool has_bg = false;
@@ -57,6 +65,68 @@ struct Style {
         if (other.has_font_weight) { result.font_weight = other.font_weight; result.has_font_weight = true; }
         return result;
     }
+
+    bool operator==(const Style &o) const {
+        auto same = [](const D2D1_COLOR_F &a, const D2D1_COLOR_F &b) { return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a; };
+        return same(bg, o.bg) && same(fg, o.fg) && same(indicator, o.indicator) && same(borderColor, o.borderColor)
+            && radius == o.radius && padding == o.padding && margin == o.margin
+            && font_weight == o.font_weight && borderWidth == o.borderWidth
+            && has_bg == o.has_bg && has_fg == o.has_fg && has_radius == o.has_radius && has_padding == o.has_padding
+            && has_margin == o.has_margin && has_border == o.has_border && has_font_weight == o.has_font_weight;
+    }
+};
+
+using StyleId = uint16_t;
+constexpr StyleId NO_STYLE = 0xFFFF;
+
+/// <summary>
+/// Interned, fully merged styles. Every style a module can show (base, hover,
+/// item states, thresholds) is merged once at config load; modules keep ids
+/// and resolve a state by index.
+/// </summary>
+class StyleTable {
+public:
+    StyleId Intern(const Style &s) {
+        auto found = ids.find(s);
+        if (found != ids.end()) return found->second;
+        StyleId id = (StyleId)styles.size();
+        styles.push_back(s);
+        ids.emplace(s, id);
+        return id;
+    }
+    const Style &Get(StyleId id) const { return styles[id]; }
+    size_t Size() const { return styles.size(); }
+
+private:
+    // Hashes every field Style::operator== compares (std::hash<float> agrees with == on 0.0f/-0.0f)
+    struct StyleHash {
+        size_t operator()(const Style &s) const {
+            size_t h = 0;
+            auto mix = [&h](size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+            auto f = [&mix](float v) { mix(std::hash<float>{}(v)); };
+            auto color = [&f](const D2D1_COLOR_F &c) { f(c.r); f(c.g); f(c.b); f(c.a); };
+            auto pad = [&f](const Padding &p) { f(p.top); f(p.right); f(p.bottom); f(p.left); };
+            color(s.bg); color(s.fg); color(s.indicator); color(s.borderColor);
+            f(s.radius); pad(s.padding); pad(s.margin); f(s.borderWidth);
+            mix((size_t)s.font_weight);
+            mix((size_t)(s.has_bg | s.has_fg << 1 | s.has_radius << 2 | s.has_padding << 3
+                | s.has_margin << 4 | s.has_border << 5 | s.has_font_weight << 6));
+            return h;
+        }
+    };
+
+    std::vector<Style> styles;
+    std::unordered_map<Style, StyleId, StyleHash> ids;
+};
+
+// Style ids of one module, into its StyleTable
+struct ModuleStyles {
+    StyleId base = NO_STYLE;
+    StyleId hover = NO_STYLE;         // base + "hover" (== base without one)
+    StyleId active = NO_STYLE;        // Raw "active" state (dock indicator)
+    StyleId defaultState = NO_STYLE;  // Raw "default" state (visualizer bars)
+    StyleId item[4] = { NO_STYLE, NO_STYLE, NO_STYLE, NO_STYLE }; // itemStyle (+ active: 1) (+ hover: 2)
+    std::vector<StyleId> thresholds;  // base + each threshold, parallel to ModuleConfig::thresholds
 };
 
 struct Threshold {
@@ -83,6 +153,7 @@ struct ModuleConfig {
     std::string icon; // icon location or glyph
     std::string tooltip; // e.g., "CMD"
     int interval = 0;
+    bool fixedDigits = false; // cpu/ram/gpu/ping: stamp digits from a glyph atlas at a fixed advance
 
     Style baseStyle;
     VisualizerSettings viz;
@@ -100,8 +171,39 @@ struct ModuleConfig {
     float dockIconSize = 24.0f;
     float dockSpacing = 8.0f;
     float dockAnimSpeed = 0.25f;
+    int dockIconCacheKb = 4096; // Budget for icons no window is showing
+
+    ModuleStyles styleIds; // Compiled by CompileModuleStyles
+    std::shared_ptr<const StyleTable> styleTable;
 };
 
+inline void CompileModuleStyles(ModuleConfig &mod, StyleTable &table)
+{
+    auto state = [&mod](const char *name) -> const Style * {
+        auto it = mod.states.find(name);
+        return it != mod.states.end() ? &it->second : nullptr;
+    };
+    const Style *hover = state("hover");
+    const Style *active = state("active");
+    const Style *defaultState = state("default");
+
+    ModuleStyles &ids = mod.styleIds;
+    ids.base = table.Intern(mod.baseStyle);
+    ids.hover = hover ? table.Intern(mod.baseStyle.Merge(*hover)) : ids.base;
+    ids.active = active ? table.Intern(*active) : NO_STYLE;
+    ids.defaultState = defaultState ? table.Intern(*defaultState) : NO_STYLE;
+
+    for (int i = 0; i < 4; i++) {
+        Style s = mod.itemStyle;
+        if ((i & 1) && active) s = s.Merge(*active);
+        if ((i & 2) && hover) s = s.Merge(*hover);
+        ids.item[i] = table.Intern(s);
+    }
+
+    ids.thresholds.clear();
+    for (const Threshold &th : mod.thresholds) ids.thresholds.push_back(table.Intern(mod.baseStyle.Merge(th.style)));
+}
+
 // The Root Configuration
 struct ThemeConfig {
     struct Animation {
@@ -109,6 +211,9 @@ struct ThemeConfig {
         int duration = 300;
         float startScale = 0.1f;
         int fps = 60;
+        std::string easing = "ease_out"; // linear, ease_in, ease_out, ease_in_out, ease_out_back, spring
+        float stiffness = 170.0f;        // Spring easing only
+        float damping = 26.0f;
     };
     struct Global {
         int height = 40;
@@ -136,4 +241,5 @@ struct ThemeConfig {
 
     std::map<std::string, ModuleConfig> modules;
 	std::vector<std::wstring> pinnedPaths;
+    std::shared_ptr<StyleTable> styles; // Shared by all modules of this config
 };
\ No newline at end of file
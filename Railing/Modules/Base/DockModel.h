@@ -0,0 +1,224 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "OpenHashMap.h"
+
+// The dock's items (one per app, pinned first-come, windows in arrival
+// order), edited in place as windows come and go instead of being rebuilt
+// from the whole window list. Adding, removing or renaming a window costs a
+// couple of hash lookups; only an app's last window closing shifts the items
+// after it. Order is stable: items and windows keep their place and new ones
+// go to the end.
+// Templated on the window handle so it runs off Windows with plain integers.
+
+template <typename Handle>
+class DockModel
+{
+public:
+	struct Item {
+		std::wstring exePath;
+		size_t pathHash = 0;
+		bool isPinned = false;
+		std::wstring title; // The first window's, or the pin's name
+		std::vector<Handle> windows;
+	};
+
+	// A live window as a full list reports it
+	struct Window {
+		Handle hwnd{};
+		size_t pathHash = 0;
+		const std::wstring *exePath = nullptr;
+		const std::wstring *title = nullptr;
+	};
+
+	struct Pin {
+		std::wstring path;
+		std::wstring name;
+		size_t pathHash = 0;
+	};
+
+	const std::vector<Item> &Items() const { return items; }
+	size_t WindowCount() const { return windowOf.Size(); }
+	bool HasWindow(Handle hwnd) const { return windowOf.Contains(Key(hwnd)); }
+	bool IsPinned(size_t pathHash) const { return pinnedOf.Contains(pathHash); }
+
+	// Each returns true if the items changed
+	bool AddWindow(Handle hwnd, size_t pathHash, const std::wstring &exePath, const std::wstring &title) {
+		if (const uint32_t *slot = windowOf.Find(Key(hwnd))) {
+			if (windows[*slot].pathHash == pathHash) return RenameWindow(hwnd, title);
+			RemoveWindow(hwnd); // Handle reused by another app
+		}
+
+		uint32_t slot = AllocWindow();
+		windows[slot] = { hwnd, pathHash, title };
+		windowOf.Insert(Key(hwnd), slot);
+
+		if (const uint32_t *index = itemOf.Find(pathHash)) {
+			Item &item = items[*index];
+			item.windows.push_back(hwnd);
+			if (item.windows.size() == 1) item.title = title;
+			return true;
+		}
+
+		Item item;
+		item.exePath = exePath;
+		item.pathHash = pathHash;
+		item.isPinned = pinnedOf.Contains(pathHash);
+		item.title = title;
+		item.windows.push_back(hwnd);
+		items.push_back(std::move(item));
+		itemOf.Insert(pathHash, (uint32_t)items.size() - 1);
+		return true;
+	}
+
+	bool RemoveWindow(Handle hwnd) {
+		const uint32_t *found = windowOf.Find(Key(hwnd));
+		if (!found) return false;
+		uint32_t slot = *found;
+		size_t pathHash = windows[slot].pathHash;
+		windowOf.Erase(Key(hwnd));
+		windows[slot].title.clear();
+		freeWindows.push_back(slot);
+
+		const uint32_t *index = itemOf.Find(pathHash);
+		if (!index) return true;
+		uint32_t at = *index;
+		Item &item = items[at];
+		for (size_t i = 0; i < item.windows.size(); i++) {
+			if (item.windows[i] != hwnd) continue;
+			item.windows.erase(item.windows.begin() + i);
+			if (i == 0 && !item.windows.empty()) item.title = TitleOf(item.windows[0]);
+			break;
+		}
+		// A pinned app stays, showing the last title it had
+		if (item.windows.empty() && !item.isPinned) EraseItem(at);
+		return true;
+	}
+
+	bool RenameWindow(Handle hwnd, const std::wstring &title) {
+		const uint32_t *slot = windowOf.Find(Key(hwnd));
+		if (!slot || windows[*slot].title == title) return false;
+		windows[*slot].title = title;
+		const uint32_t *index = itemOf.Find(windows[*slot].pathHash);
+		if (index && !items[*index].windows.empty() && items[*index].windows[0] == hwnd) items[*index].title = title;
+		return true;
+	}
+
+	/// <summary>
+	/// Replace the pinned apps. Unpinned apps without windows leave; pinned
+	/// apps that have no item yet are added at the end, in pin order.
+	/// </summary>
+	bool SetPinned(const std::vector<Pin> &pins) {
+		pinnedOf.Clear();
+		for (size_t i = 0; i < pins.size(); i++) pinnedOf.Insert(pins[i].pathHash, (uint32_t)i);
+
+		bool changed = false;
+		size_t kept = 0;
+		for (size_t i = 0; i < items.size(); i++) {
+			Item &item = items[i];
+			bool pinned = pinnedOf.Contains(item.pathHash);
+			if (pinned != item.isPinned) changed = true;
+			item.isPinned = pinned;
+			if (!pinned && item.windows.empty()) {
+				changed = true;
+				continue;
+			}
+			if (kept != i) items[kept] = std::move(item);
+			kept++;
+		}
+		if (kept != items.size()) {
+			items.resize(kept);
+			Reindex(0);
+		}
+
+		for (const Pin &pin : pins) {
+			if (itemOf.Contains(pin.pathHash)) continue;
+			Item item;
+			item.exePath = pin.path;
+			item.pathHash = pin.pathHash;
+			item.isPinned = true;
+			item.title = pin.name;
+			items.push_back(std::move(item));
+			itemOf.Insert(pin.pathHash, (uint32_t)items.size() - 1);
+			changed = true;
+		}
+		return changed;
+	}
+
+	/// <summary>
+	/// Bring the model in line with a complete window list (first fill, or a
+	/// consumer without deltas). Same result as replaying the changes: windows
+	/// missing from `live` are removed, new ones added in list order.
+	/// </summary>
+	bool Reconcile(const std::vector<Window> &live) {
+		seen.Clear();
+		seen.Reserve(live.size());
+		for (const Window &w : live) seen.Insert(Key(w.hwnd), 1);
+
+		bool changed = false;
+		gone.clear();
+		windowOf.ForEach([&](uint64_t key, uint32_t slot) {
+			if (!seen.Contains(key)) gone.push_back(windows[slot].hwnd);
+		});
+		for (Handle hwnd : gone) changed |= RemoveWindow(hwnd);
+		for (const Window &w : live) changed |= AddWindow(w.hwnd, w.pathHash, *w.exePath, *w.title);
+		return changed;
+	}
+
+	void Clear() {
+		items.clear();
+		itemOf.Clear();
+		windows.clear();
+		freeWindows.clear();
+		windowOf.Clear();
+	}
+
+private:
+	struct WindowSlot {
+		Handle hwnd{};
+		size_t pathHash = 0;
+		std::wstring title;
+	};
+
+	std::vector<Item> items;
+	OpenHashMap<size_t, uint32_t> itemOf;     // pathHash -> index in items
+	std::vector<WindowSlot> windows;
+	std::vector<uint32_t> freeWindows;
+	OpenHashMap<uint64_t, uint32_t> windowOf; // hwnd -> slot in windows
+	OpenHashMap<size_t, uint32_t> pinnedOf;   // pathHash -> pin order
+
+	// Scratch for Reconcile
+	OpenHashMap<uint64_t, uint8_t> seen;
+	std::vector<Handle> gone;
+
+	static uint64_t Key(Handle hwnd) { return (uint64_t)(uintptr_t)hwnd; }
+
+	uint32_t AllocWindow() {
+		if (!freeWindows.empty()) {
+			uint32_t slot = freeWindows.back();
+			freeWindows.pop_back();
+			return slot;
+		}
+		windows.emplace_back();
+		return (uint32_t)windows.size() - 1;
+	}
+
+	const std::wstring &TitleOf(Handle hwnd) const {
+		static const std::wstring none;
+		const uint32_t *slot = windowOf.Find(Key(hwnd));
+		return slot ? windows[*slot].title : none;
+	}
+
+	void EraseItem(uint32_t index) {
+		itemOf.Erase(items[index].pathHash);
+		items.erase(items.begin() + index);
+		Reindex(index);
+	}
+
+	void Reindex(size_t from) {
+		if (from == 0) itemOf.Clear();
+		for (size_t i = from; i < items.size(); i++) itemOf.Insert(items[i].pathHash, (uint32_t)i);
+	}
+};
@@ -1,9 +1,10 @@
 #include "Module.h"
+#include "FrameProfiler.h"
 
 void Module::Draw(RenderContext &ctx, float x, float y, float constraintSize) {
     float paddingX = config.baseStyle.padding.left + config.baseStyle.padding.right;
     float paddingY = config.baseStyle.padding.top + config.baseStyle.padding.bottom;
-    float contentSize = GetContentWidth(ctx);
+    float contentSize = this->contentSize; // Measured by CalculateWidth
 
     float finalX, finalY, finalW  , finalH;
 
@@ -25,33 +26,47 @@ void Module::Draw(RenderContext &ctx, float x, float y, float constraintSize) {
         else finalH = finalW;
     }
 
-    // Draw Background
-    if (config.baseStyle.has_bg) {
-        D2D1_RECT_F bgRect = D2D1::RectF(finalX, finalY, finalX + finalW, finalY + finalH);
-        D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(bgRect, config.baseStyle.radius, config.baseStyle.radius);
-        ctx.bgBrush->SetColor(config.baseStyle.bg);
-        ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
+    // Cache the rect for click detection
+    D2D1_RECT_F rect = D2D1::RectF(finalX, finalY, finalX + finalW, finalY + finalH);
+    bool moved = rect.left != cachedRect.left || rect.top != cachedRect.top
+        || rect.right != cachedRect.right || rect.bottom != cachedRect.bottom;
+    this->cachedRect = rect;
+
+    // Record only when something changed, otherwise replay the last frame's commands
+    if (!displayList.IsRecorded() || moved || NeedsPaint(ctx)) {
+        DrawingBackend *target = ctx.draw;
+        displayList.Begin(target);
+        ctx.draw = &displayList;
 
-        if (config.baseStyle.borderWidth > 0) {
-            ctx.borderBrush->SetColor(config.baseStyle.borderColor);
-            ctx.rt->DrawRoundedRectangle(rounded, ctx.borderBrush, config.baseStyle.borderWidth);
+        // Draw Background
+        if (config.baseStyle.has_bg) {
+            ctx.draw->FillRoundedRect(rect, config.baseStyle.radius, config.baseStyle.bg);
+
+            if (config.baseStyle.borderWidth > 0)
+                ctx.draw->StrokeRoundedRect(rect, config.baseStyle.radius, config.baseStyle.borderColor, config.baseStyle.borderWidth);
         }
-    }
 
-    // Cache the rect for click detection
-    this->cachedRect = D2D1::RectF(finalX, finalY, finalX + finalW, finalY + finalH);
+        PROFILE_SCOPE("RenderContent", config.id.c_str());
+        RenderContent(ctx,
+            finalX + config.baseStyle.padding.left,
+            finalY + config.baseStyle.padding.top,
+            finalW - paddingX,
+            finalH - paddingY
+        );
+
+        ctx.draw = target;
+        displayList.End();
+    }
 
-    RenderContent(ctx,
-        finalX + config.baseStyle.padding.left,
-        finalY + config.baseStyle.padding.top,
-        finalW - paddingX,
-        finalH - paddingY
-    );
+    displayList.Replay(*ctx.draw);
+    paintDirty = false;
 }
 
 void Module::CalculateWidth(RenderContext &ctx)
 {
+    PROFILE_SCOPE("CalculateWidth", config.id.c_str());
     float contentSz = GetContentWidth(ctx); // This is "Main Axis Size"
+    contentSize = contentSz;
 
     if (!ctx.isVertical) {
         float paddingW = config.baseStyle.padding.left + config.baseStyle.padding.right;
@@ -63,4 +78,7 @@ void Module::CalculateWidth(RenderContext &ctx)
         float marginH = config.baseStyle.margin.top + config.baseStyle.margin.bottom;
         width = contentSz + paddingH + marginH;
     }
+
+    layoutNode.SetMeasuredSize(width);
+    layoutDirty = false;
 }
\ No newline at end of file
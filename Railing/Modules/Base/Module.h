@@ -1,30 +1,44 @@
 #pragma once
 #include "ThemeTypes.h"
 #include "RenderContext.h"
+#include "LayoutEngine.h"
+#include "DisplayList.h"
+#include "GlyphAtlas.h"
+#include "ModuleRegistry.h"
+
+// Posted to a bar by a module's worker thread when it has results: the bar
+// requests a repaint frame, and the module picks them up in that frame
+#define WM_RAILING_WAKE (WM_APP + 2)
+
 class Module
 {
 public:
 	ModuleConfig config;
+	ModuleType kind;                       // config.type, resolved once
+	ModuleHandle handle = INVALID_MODULE;  // Slot in the bar's ModuleRegistry
 	float width = 0.0f;
 	float height = 0.0f;
+	float contentSize = 0.0f; // Last measured main axis content size
 	D2D1_RECT_F cachedRect = {};
 	bool isHovered = false;
-	IDWriteTextLayout *cachedLayout = nullptr;
-	std::wstring cachedTextVal = L"";
-
-	Module(const ModuleConfig &cfg) : config(cfg) {}
-	virtual ~Module() { if (cachedLayout) cachedLayout->Release(); };
-
-	IDWriteTextLayout *GetLayout(RenderContext &ctx, const std::wstring &text, IDWriteTextFormat *format) {
-		if (!cachedLayout || text != cachedTextVal) {
-			if (cachedLayout) { cachedLayout->Release(); cachedLayout = nullptr; }
-			cachedTextVal = text;
-			ctx.writeFactory->CreateTextLayout(
-				text.c_str(), (UINT32)text.length(),
-				format, 1000.0f, 1000.0f, &cachedLayout
-			);
+	bool layoutDirty = true;
+	bool paintDirty = true;
+	LayoutNode layoutNode;
+	DisplayList displayList; // Last recorded frame, replayed while inputs are unchanged
+
+	Module(const ModuleConfig &cfg) : config(cfg), kind(ModuleTypeFromName(cfg.type)) {
+		if (!config.styleTable) {
+			// Config that didn't come through ThemeLoader: compile a private table
+			auto table = std::make_shared<StyleTable>();
+			CompileModuleStyles(config, *table);
+			config.styleTable = table;
 		}
-		return cachedLayout;
+	}
+	virtual ~Module() {};
+
+	// Font for a style's weight (bold or regular text)
+	static DrawFont FontFor(const Style &s) {
+		return (s.font_weight == FontWeight::Bold) ? DrawFont::Bold : DrawFont::Text;
 	}
 
 	static bool HasType(ThemeConfig cfg, std::string type)
@@ -40,6 +54,45 @@ public:
 	/// </summary>
 	virtual void Update() {}
 
+	/// <summary>
+	/// Whether the cached measurement is stale. Modules whose text depends on
+	/// live data override this to compare against what they last measured.
+	/// </summary>
+	/// <param name="ctx">Context</param>
+	virtual bool NeedsMeasure(RenderContext &ctx) { return layoutDirty; }
+
+	/// <summary>
+	/// Whether the module's pixels are stale. The renderer only repaints the
+	/// regions of modules that report true here (or whose rect moved).
+	/// </summary>
+	/// <param name="ctx">Context</param>
+	virtual bool NeedsPaint(RenderContext &ctx) { return paintDirty; }
+
+	/// <summary>
+	/// Hittable sub-items inside the module's rect (e.g. dock icons), in order.
+	/// Their index is reported back by hit tests as the part under the mouse.
+	/// </summary>
+	virtual void GetHitParts(const LayoutRect &rect, std::vector<LayoutRect> &out) {}
+
+	void InvalidateLayout() { layoutDirty = true; paintDirty = true; }
+	void InvalidatePaint() { paintDirty = true; }
+
+	/// <summary>
+	/// Ask for another frame while animating. The bar's scheduler paces these to
+	/// the display refresh; without one the window is simply invalidated.
+	/// </summary>
+	void RequestFrame(RenderContext &ctx) {
+		paintDirty = true;
+		if (ctx.frames) ctx.frames->RequestFrame(FRAME_CLIENT_REPAINT);
+		else if (ctx.hwnd) InvalidateRect(ctx.hwnd, NULL, FALSE);
+	}
+
+	void SetHovered(bool hovered) {
+		if (isHovered == hovered) return;
+		isHovered = hovered;
+		InvalidateLayout(); // Hover styles may change padding/margin
+	}
+
 	/// <summary>
 	/// Measure (calculate) the content width of the module.
 	/// </summary>
@@ -66,12 +119,22 @@ public:
 	/// Helper method to get effective style (base + hover)
 	/// </summary>
 	/// <returns>style of *this* module</returns>
-	Style GetEffectiveStyle() {
-		Style s = config.baseStyle;
-		if (isHovered && config.states.count("hover")) {
-			s = s.Merge(config.states.at("hover"));
+	const Style &GetEffectiveStyle() const {
+		return GetStyle(isHovered ? config.styleIds.hover : config.styleIds.base);
+	}
+
+	const Style &GetStyle(StyleId id) const { return config.styleTable->Get(id); }
+
+	/// <summary>
+	/// Base style merged with the last threshold `value` reaches, or nullptr
+	/// when it is below all of them.
+	/// </summary>
+	const Style *GetThresholdStyle(int value) const {
+		const Style *hit = nullptr;
+		for (size_t i = 0; i < config.thresholds.size(); i++) {
+			if (value >= config.thresholds[i].val) hit = &GetStyle(config.styleIds.thresholds[i]);
 		}
-		return s;
+		return hit;
 	}
 
 	void DrawModuleBackground(RenderContext &ctx, D2D1_RECT_F rect, const Style &s) {
@@ -82,21 +145,16 @@ public:
 			rect.right - s.margin.right,
 			rect.bottom - s.margin.bottom
 		);
-		D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(drawRect, s.radius, s.radius);
-		if (s.has_bg) {
-			ctx.bgBrush->SetColor(s.bg);
-			ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
-		}
+		if (s.has_bg) ctx.draw->FillRoundedRect(drawRect, s.radius, s.bg);
 		if (s.has_border) {
 			float strokeHalf = s.borderWidth / 2.0f;
-			D2D1_ROUNDED_RECT borderShape = rounded;
-			borderShape.rect.left += strokeHalf;
-			borderShape.rect.top += strokeHalf;
-			borderShape.rect.right -= strokeHalf;
-			borderShape.rect.bottom -= strokeHalf;
-
-			ctx.borderBrush->SetColor(s.borderColor);
-			ctx.rt->DrawRoundedRectangle(borderShape, ctx.borderBrush, s.borderWidth);
+			D2D1_RECT_F borderRect = drawRect;
+			borderRect.left += strokeHalf;
+			borderRect.top += strokeHalf;
+			borderRect.right -= strokeHalf;
+			borderRect.bottom -= strokeHalf;
+
+			ctx.draw->StrokeRoundedRect(borderRect, s.radius, s.borderColor, s.borderWidth);
 		}
 	}
 
@@ -143,9 +201,7 @@ public:
 		if (pct > 0.0f) {
 			if (pct > 1.0f) pct = 1.0f;
 			D2D1_RECT_F fillRect = D2D1::RectF(x, y + h - 4.0f, x + (w * pct), y + h);
-			D2D1_ROUNDED_RECT roundedBar = D2D1::RoundedRect(fillRect, 2.0f, 2.0f);
-			ctx.bgBrush->SetColor(color);
-			ctx.rt->FillRoundedRectangle(roundedBar, ctx.bgBrush);
+			ctx.draw->FillRoundedRect(fillRect, 2.0f, color);
 		}
 	}
 };
\ No newline at end of file
@@ -14,19 +14,20 @@ public:
 		}
 		ModuleConfig cfg = theme.modules.at(name);
 
-		if (cfg.type == "custom") return new CustomModule(cfg);
-		else if (cfg.type == "clock") return new ClockModule(cfg);
-		else if (cfg.type == "workspaces") return new WorkspacesModule(cfg);
-		else if (cfg.type == "cpu") return new CpuModule(cfg);
-		else if (cfg.type == "gpu") return new GpuModule(cfg);
-		else if (cfg.type == "ram") return new RamModule(cfg);
-		else if (cfg.type == "ping") return new PingModule(cfg);
-		else if (cfg.type == "weather") { return new WeatherModule(cfg); }
-		else if (cfg.type == "app_icon") return new AppIconModule(cfg);
-		else if (cfg.type == "dock") return new DockModule(cfg);
-		else if (cfg.type == "visualizer") return new VisualizerModule(cfg, Railing::instance->visualizerBackend);
+		switch (ModuleTypeFromName(cfg.type)) {
+		case ModuleType::Custom: return new CustomModule(cfg);
+		case ModuleType::Clock: return new ClockModule(cfg);
+		case ModuleType::Workspaces: return new WorkspacesModule(cfg);
+		case ModuleType::Cpu: return new CpuModule(cfg);
+		case ModuleType::Gpu: return new GpuModule(cfg);
+		case ModuleType::Ram: return new RamModule(cfg);
+		case ModuleType::Ping: return new PingModule(cfg);
+		case ModuleType::Weather: return new WeatherModule(cfg);
+		case ModuleType::AppIcon: return new AppIconModule(cfg);
+		case ModuleType::Dock: return new DockModule(cfg);
+		case ModuleType::Visualizer: return new VisualizerModule(cfg, Railing::instance ? Railing::instance->visualizerBackend : nullptr);
 
-		else if (cfg.type == "group") {
+		case ModuleType::Group: {
 			GroupModule *group = new GroupModule(cfg);
 			for (const auto &childName : cfg.groupModules) {
 				Module *child = Create(childName, theme);
@@ -34,9 +35,8 @@ public:
 			}
 			return group;
 		}
-		else if (cfg.type == "network" || cfg.type == "audio" || cfg.type == "battery"
-			|| cfg.type == "tray" || cfg.type == "notification") return new IconModule(cfg);
-		return new IconModule(cfg);
-		return nullptr; // UNK
+		default: // Network, audio, battery, tray, notification and unknown types
+			return new IconModule(cfg);
+		}
 	}
 };
\ No newline at end of file
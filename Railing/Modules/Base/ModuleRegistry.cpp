@@ -0,0 +1,52 @@
+#include "ModuleRegistry.h"
+
+ModuleType ModuleTypeFromName(std::string_view name)
+{
+	static const std::unordered_map<std::string_view, ModuleType> names = {
+		{ "custom", ModuleType::Custom },
+		{ "clock", ModuleType::Clock },
+		{ "workspaces", ModuleType::Workspaces },
+		{ "cpu", ModuleType::Cpu },
+		{ "gpu", ModuleType::Gpu },
+		{ "ram", ModuleType::Ram },
+		{ "ping", ModuleType::Ping },
+		{ "weather", ModuleType::Weather },
+		{ "app_icon", ModuleType::AppIcon },
+		{ "dock", ModuleType::Dock },
+		{ "visualizer", ModuleType::Visualizer },
+		{ "group", ModuleType::Group },
+		{ "network", ModuleType::Network },
+		{ "audio", ModuleType::Audio },
+		{ "battery", ModuleType::Battery },
+		{ "tray", ModuleType::Tray },
+		{ "notification", ModuleType::Notification },
+	};
+	auto it = names.find(name);
+	return it != names.end() ? it->second : ModuleType::Unknown;
+}
+
+void ModuleRegistry::Clear()
+{
+	modules.clear();
+	rects.clear();
+	ids.clear();
+	for (ModuleHandle &h : firstOfType) h = INVALID_MODULE;
+}
+
+ModuleHandle ModuleRegistry::Register(Module *module, const std::string &id, ModuleType type)
+{
+	if (modules.size() >= INVALID_MODULE) return INVALID_MODULE;
+
+	ModuleHandle handle = (ModuleHandle)modules.size();
+	modules.push_back(module);
+	rects.emplace_back();
+	ids.emplace(id, handle);
+	if (firstOfType[(int)type] == INVALID_MODULE) firstOfType[(int)type] = handle;
+	return handle;
+}
+
+ModuleHandle ModuleRegistry::Find(std::string_view id) const
+{
+	auto it = ids.find(id);
+	return it != ids.end() ? it->second : INVALID_MODULE;
+}
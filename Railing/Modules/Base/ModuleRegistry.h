@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include "LayoutEngine.h"
+
+// Per-bar table of live modules. Every module (group children included) gets
+// a dense integer handle and a type enum when the bar builds its modules, so
+// hot paths index flat arrays instead of comparing strings or searching the
+// left/center/right lists.
+
+class Module;
+
+enum class ModuleType : uint8_t {
+	Unknown = 0,
+	Custom,
+	Clock,
+	Workspaces,
+	Cpu,
+	Gpu,
+	Ram,
+	Ping,
+	Weather,
+	AppIcon,
+	Dock,
+	Visualizer,
+	Group,
+	Network,
+	Audio,
+	Battery,
+	Tray,
+	Notification,
+	Count
+};
+
+// "dock" -> ModuleType::Dock; unknown names map to Unknown
+ModuleType ModuleTypeFromName(std::string_view name);
+
+using ModuleHandle = uint16_t;
+constexpr ModuleHandle INVALID_MODULE = 0xFFFF;
+
+class ModuleRegistry
+{
+public:
+	ModuleRegistry() { Clear(); }
+
+	void Clear();
+
+	/// <summary>
+	/// Assign the next handle. Ids are expected to be unique; a repeated id keeps
+	/// its first registration for lookups.
+	/// </summary>
+	ModuleHandle Register(Module *module, const std::string &id, ModuleType type);
+
+	Module *Get(ModuleHandle handle) const { return handle < modules.size() ? modules[handle] : nullptr; }
+	ModuleHandle Find(std::string_view id) const;
+	// First registered module of a type (layout order)
+	ModuleHandle FindType(ModuleType type) const { return firstOfType[(int)type]; }
+
+	// Logical rects, published by the arrange pass
+	void SetRect(ModuleHandle handle, const LayoutRect &rect) { rects[handle] = rect; }
+	const LayoutRect &GetRect(ModuleHandle handle) const { return handle < rects.size() ? rects[handle] : empty; }
+
+	const std::vector<Module *> &All() const { return modules; }
+	size_t Count() const { return modules.size(); }
+
+private:
+	struct IdHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+	};
+	struct IdEqual {
+		using is_transparent = void;
+		bool operator()(std::string_view a, std::string_view b) const { return a == b; }
+	};
+
+	std::vector<Module *> modules;
+	std::vector<LayoutRect> rects;
+	std::unordered_map<std::string, ModuleHandle, IdHash, IdEqual> ids;
+	ModuleHandle firstOfType[(int)ModuleType::Count];
+	LayoutRect empty;
+};
@@ -15,14 +15,12 @@ public:
 
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 		if (s.has_bg) {
 			D2D1_RECT_F bgRect = D2D1::RectF(
 				x + s.margin.left, y + s.margin.top,
 				x + w - s.margin.right, y + h - s.margin.bottom);
-			D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(bgRect, s.radius, s.radius);
-			ctx.bgBrush->SetColor(s.bg);
-			ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
+			ctx.draw->FillRoundedRect(bgRect, s.radius, s.bg);
 		}
 		if (ctx.appIcon) {
 			float availableH = h - s.margin.top - s.margin.bottom;
@@ -33,7 +31,7 @@ public:
 			float offY = y + s.margin.top + (availableH - iconSize) / 2.0f;
 
 			D2D1_RECT_F dest = D2D1::RectF(offX, offY, offX + iconSize, offY + iconSize);
-			ctx.rt->DrawBitmap(ctx.appIcon, dest);
+			ctx.draw->DrawImage(ImageRef(ctx.appIcon), dest);
 		}
 	}
 };
\ No newline at end of file
@@ -1,49 +1,77 @@
 #pragma once
 #include "Module.h"
+#include <chrono>
 
 class ClockModule : public Module
 {
 public:
 	std::wstring cacheStr;
+	std::wstring measuredStr;
+	std::wstring paintedStr;
 	ClockModule(const ModuleConfig &cfg) : Module(cfg) {}
 
-	void Update() override { cacheStr = GetTimeStr(); }
+	void Update() override { Refresh(); }
+
+	bool NeedsMeasure(RenderContext &ctx) override { Refresh(); return layoutDirty || cacheStr != measuredStr; }
+	bool NeedsPaint(RenderContext &ctx) override { return paintDirty || cacheStr != paintedStr; }
 
 	float GetContentWidth(RenderContext &ctx) override
 	{
-		Style s = GetEffectiveStyle();
-		std::wstring text = GetTimeStr();
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		IDWriteTextLayout *layout = GetLayout(ctx, text, fmt);
-		DWRITE_TEXT_METRICS metrics;
-		layout->GetMetrics(&metrics);
+		const Style &s = GetEffectiveStyle();
+		std::wstring text = cacheStr.empty() ? GetTimeStr() : cacheStr;
+		measuredStr = text;
+		TextMetrics metrics = ctx.draw->MeasureString(text, FontFor(s));
 		return metrics.width + 4.0f + config.baseStyle.padding.left + config.baseStyle.padding.right
 			+ config.baseStyle.margin.left + config.baseStyle.margin.right;
 	}
 
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 		if (s.has_bg) {
 			D2D1_RECT_F bgRect = D2D1::RectF(
 				x + s.margin.left, y + s.margin.top,
 				x + w - s.margin.right, y + h - s.margin.bottom);
-			D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(bgRect, s.radius, s.radius);
-			ctx.bgBrush->SetColor(s.bg);
-			ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
+			ctx.draw->FillRoundedRect(bgRect, s.radius, s.bg);
 		}
 
-		std::wstring text = GetTimeStr();
+		std::wstring text = cacheStr.empty() ? GetTimeStr() : cacheStr;
+		paintedStr = text;
 		D2D1_RECT_F rect = D2D1::RectF(
 			x + s.margin.left + s.padding.left,
 			y + s.margin.top + s.padding.top,
 			x + w - s.margin.right - s.padding.right,
 			y + h - s.margin.bottom - s.padding.bottom);
-		ctx.textBrush->SetColor(s.fg);
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		ctx.rt->DrawTextW(text.c_str(), (UINT32)text.length(), fmt, rect, ctx.textBrush, D2D1_DRAW_TEXT_OPTIONS_CLIP);
+		ctx.draw->DrawString(text, rect, FontFor(s), s.fg, DRAW_TEXT_CLIP);
+
+		// Wake up exactly when the displayed text can next change
+		if (ctx.frames) {
+			auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+			ctx.frames->RequestFrameIn(FRAME_CLIENT_REPAINT, FrameScheduler::DelayToBoundary((uint64_t)wall, ShowsSeconds() ? 1000 : 60000));
+		}
 	}
 private:
+	time_t cacheTime = 0;
+
+	// Re-format at most once per second
+	void Refresh()
+	{
+		time_t now = time(0);
+		if (now == cacheTime && !cacheStr.empty()) return;
+		cacheTime = now;
+		cacheStr = GetTimeStr();
+	}
+
+	bool ShowsSeconds() const
+	{
+		const std::string &fmt = config.format;
+		for (const char *spec : { "%S", "%T", "%X", "%r", "%c" }) {
+			if (fmt.find(spec) != std::string::npos) return true;
+		}
+		return false;
+	}
+
 	std::wstring GetTimeStr()
 	{
 		time_t now = time(0);
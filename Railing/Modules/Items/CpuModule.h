@@ -5,38 +5,44 @@ class CpuModule : public Module
 {
 	int lastUsage = -1;
 	std::wstring cachedStr;
+	std::wstring valueStr;
+	NumericLabel label;
+
+	std::string GetFormat() const { return config.format.empty() ? "CPU: {usage}%" : config.format; }
 public:
-	CpuModule(const ModuleConfig &cfg) : Module(cfg) {}
+	CpuModule(const ModuleConfig &cfg) : Module(cfg) {
+		if (config.fixedDigits) {
+			label.SetFormat(Utf8ToWide(GetFormat()), L"{usage}");
+			label.SetReservedDigits(3); // "100"
+		}
+	}
+
+	bool NeedsMeasure(RenderContext &ctx) override { return layoutDirty || ctx.cpuUsage != lastUsage; }
 
     float GetContentWidth(RenderContext &ctx) override
     {
         if (ctx.cpuUsage != lastUsage) {
             lastUsage = ctx.cpuUsage;
-            std::string fmt = config.format.empty() ? "CPU: {usage}%" : config.format;
-            cachedStr = FormatOutput(fmt, "{usage}", std::to_wstring(lastUsage));
+            valueStr = std::to_wstring(lastUsage);
+            cachedStr = FormatOutput(GetFormat(), "{usage}", valueStr);
         }
-        Style s = GetEffectiveStyle();
-        IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-        IDWriteTextLayout *layout = GetLayout(ctx, cachedStr, fmt);
-
-        DWRITE_TEXT_METRICS metrics;
-        layout->GetMetrics(&metrics);
-        return metrics.width + 4.0f 
+        const Style &s = GetEffectiveStyle();
+        float textW = label.Measure(*ctx.draw, FontFor(s), ctx.scale, valueStr);
+        if (textW < 0.0f) textW = ctx.draw->MeasureString(cachedStr, FontFor(s)).width;
+        return textW + 4.0f 
             + s.padding.left + s.padding.right
             + s.margin.left + s.margin.right;
     }
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 
 		D2D1_COLOR_F color = config.baseStyle.fg;
-		for (const auto &th : config.thresholds) {
-			if (ctx.cpuUsage >= th.val) color = th.style.fg;
-		}
+		if (const Style *th = GetThresholdStyle(ctx.cpuUsage)) color = th->fg;
 		DrawProgressBar(ctx, x, y, w, h, ctx.cpuUsage / 100.0f, color);
 
-		ctx.textBrush->SetColor(s.fg);
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		ctx.rt->DrawTextW(cachedStr.c_str(), (UINT32)cachedStr.length(), fmt, D2D1::RectF(x, y, x + w, y + h), ctx.textBrush);
+		D2D1_RECT_F rect = D2D1::RectF(x, y, x + w, y + h);
+		if (!label.Draw(*ctx.draw, valueStr, rect, s.fg))
+			ctx.draw->DrawString(cachedStr, rect, FontFor(s), s.fg);
 	}
 };
\ No newline at end of file
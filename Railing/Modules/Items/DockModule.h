@@ -8,37 +8,232 @@
 #include <vector>
 #include <algorithm>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 #include <cwctype>
+#include <cmath>
 #include "DockPreviewWindow.h"
+#include "DockModel.h"
+#include "WindowRegistry.h"
+#include "IconCache.h"
+#include "IconLoader.h"
+#include "IconAtlas.h"
+#include "IconDecode.h"
 #pragma comment(lib, "version.lib")
 
-struct DockItem {
-    std::wstring exePath;
-    size_t pathHash;
-    bool isPinned = false;
-    std::wstring title;
-    std::vector<HWND> windows;
+using DockItem = DockModel<HWND>::Item;
+
+// Uploads decoded icons as bitmaps on the bar's render target
+class D2DIconUploader : public IconUploader {
+public:
+    ID2D1RenderTarget *rt = nullptr;
+
+    void *Upload(const uint32_t *pixels, int width, int height, int stride) override {
+        if (!rt) return nullptr;
+        float dpiX = 96.0f, dpiY = 96.0f;
+        rt->GetDpi(&dpiX, &dpiY);
+        D2D1_BITMAP_PROPERTIES props = D2D1::BitmapProperties(
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpiX, dpiY);
+        ID2D1Bitmap *bmp = nullptr;
+        rt->CreateBitmap(D2D1::SizeU(width, height), pixels, stride * sizeof(uint32_t), props, &bmp);
+        return bmp;
+    }
+    void Release(void *image) override { ((ID2D1Bitmap *)image)->Release(); }
+};
+
+// The icon atlas file, mapped read-only and replaced through a temp file
+class Win32AtlasStorage : public IconAtlasStorage {
+    std::wstring path;
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+    const uint8_t *view = nullptr;
+
+public:
+    explicit Win32AtlasStorage(std::wstring path) : path(std::move(path)) {}
+    ~Win32AtlasStorage() { Unmap(); }
+
+    bool Map(const uint8_t *&data, size_t &size) override {
+        Unmap();
+        file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER length = {};
+        if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+            mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping) view = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!view) {
+            Unmap();
+            return false;
+        }
+        data = view;
+        size = (size_t)length.QuadPart;
+        return true;
+    }
+
+    void Unmap() override {
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        view = nullptr;
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+    }
+
+    bool Write(const std::vector<uint8_t> &bytes) override {
+        std::wstring temp = path + L".tmp";
+        HANDLE out = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (out == INVALID_HANDLE_VALUE) return false;
+        DWORD written = 0;
+        BOOL ok = WriteFile(out, bytes.data(), (DWORD)bytes.size(), &written, NULL) && written == bytes.size();
+        CloseHandle(out);
+        if (ok) ok = MoveFileExW(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+        if (!ok) DeleteFileW(temp.c_str());
+        return ok;
+    }
+};
+
+// One atlas per process, shared by every bar's dock
+inline IconAtlas &DockIconAtlas() {
+    static Win32AtlasStorage storage(PinnedAppsIO::GetIconAtlasPath());
+    static IconAtlas atlas(storage);
+    static bool loaded = (atlas.Load(), true);
+    return atlas;
+}
+
+// Device-pixel edges the docks draw icons at, shared by every bar so an icon
+// decoded once carries a mip level for each monitor's DPI. Only grows: a bar
+// moving back to a DPI it has seen finds its level already there.
+struct DockIconSizes {
+    std::vector<int> edges;
+    uint32_t version = 0;
+
+    void Use(int edge) {
+        auto at = std::lower_bound(edges.begin(), edges.end(), edge);
+        if (at != edges.end() && *at == edge) return;
+        edges.insert(at, edge);
+        version++;
+    }
+    int Largest() const { return edges.empty() ? 0 : edges.back(); }
+};
+
+inline DockIconSizes &DockIconEdges() {
+    static DockIconSizes sizes;
+    return sizes;
+}
+
+// Extracts and decodes icons on IconLoader's workers, each with its own WIC factory
+class Win32IconSource : public IconSource {
+    inline static thread_local IWICImagingFactory *wic = nullptr;
+
+public:
+    void BeginThread() override {
+        SetThreadDescription(GetCurrentThread(), L"Railing_IconWorker");
+        CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&wic));
+    }
+
+    void EndThread() override {
+        if (wic) { wic->Release(); wic = nullptr; }
+        CoUninitialize();
+    }
+
+    bool Load(const IconRequest &request, LoadedIcon &out) override {
+        HICON hIcon = NULL;
+        bool shouldDestroy = false;
+
+        if (!request.path.empty()) {
+            UINT id = 0;
+            int extractSize = ExtractSize(request.size);
+            if (PrivateExtractIconsW(request.path.c_str(), request.index, extractSize, extractSize, &hIcon, &id, 1, 0) > 0) {
+                if (hIcon) shouldDestroy = true;
+            }
+            if (!hIcon && ExtractIconExW(request.path.c_str(), 0, &hIcon, NULL, 1) > 0 && hIcon) {
+                shouldDestroy = true;
+            }
+        }
+        out.fromFile = hIcon != NULL;
+
+        // A hung window gives up after the timeout instead of stalling the worker
+        HWND hwnd = (HWND)request.hwnd;
+        if (!hIcon && hwnd) {
+            DWORD_PTR result = 0;
+            if (SendMessageTimeoutW(hwnd, WM_GETICON, ICON_BIG, 0, SMTO_ABORTIFHUNG, 200, &result)) hIcon = (HICON)result;
+            if (!hIcon && SendMessageTimeoutW(hwnd, WM_GETICON, ICON_SMALL, 0, SMTO_ABORTIFHUNG, 200, &result)) hIcon = (HICON)result;
+            if (!hIcon) hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICON);
+        }
+        if (!hIcon) { hIcon = LoadIcon(NULL, IDI_APPLICATION); shouldDestroy = false; }
+
+        bool ok = DecodeIconPixels(wic, hIcon, request.size, out.pixels, out.width, out.height);
+        if (shouldDestroy && hIcon) DestroyIcon(hIcon);
+        return ok;
+    }
+
+private:
+    // Smallest size icon files commonly carry that is at least `size`; the
+    // decode filters it down, which beats the shell stretching a far-off image
+    static int ExtractSize(int size) {
+        static const int STANDARD[] = { 16, 20, 24, 32, 40, 48, 64, 96, 128, 256 };
+        for (int s : STANDARD) if (s >= size) return s;
+        return 256;
+    }
 };
 
 class DockModule : public Module {
-    std::map<HWND, ID2D1Bitmap *> iconCache;
-    std::map<size_t, ID2D1Bitmap *> pinnedIconCache;
+    // Icons are shared by content; these hold one reference each
+    D2DIconUploader iconUploader;
+    IconCache icons{ iconUploader };
+    std::unordered_map<HWND, IconKey> windowIcons;
+    std::unordered_map<size_t, IconKey> pinnedIcons;
+    uint32_t iconEpoch = 0;
+    uint32_t iconSizesVersion = 0;             // DockIconEdges() the cached chains were built for
+    float iconDrawEdge = 0.0f;                 // Device pixels this frame's icons are drawn at
+    bool iconsStale = false;
+
+    // Loads run on workers; the dock draws a placeholder until they land
+    Win32IconSource iconSource;
+    IconLoader iconLoader{ iconSource };
+    std::vector<LoadedIcon> loadedIcons;
+    std::vector<IconKey> arrivedIcons;         // Held for one frame so the items can claim them
+    std::atomic<HWND> wakeWindow{ NULL };      // Bar the loader wakes when results land
+    std::atomic<bool> iconsReady{ false };     // Results waiting to be drained
+    std::unordered_set<uint64_t> failedIcons;  // Not retried until the icons are dropped
+    std::unordered_map<uint64_t, IconAtlasKey> atlasKeys; // Loads whose result goes into the atlas
+    ULONGLONG lastAtlasSave = 0;
     std::vector<PinnedAppEntry> m_pinnedApps;
 
     std::set<HWND> attentionWindows;
-    std::vector<DockItem> stableList;
+    DockModel<HWND> model;
+    const std::vector<DockItem> &stableList = model.Items();
+    uint64_t modelVersion = 0;     // Registry version the model reflects
+    bool modelSeeded = false;
+    bool pinsChanged = true;
+    std::vector<WindowDelta> deltas;
+    size_t measuredCount = SIZE_MAX;
 
-    ULONGLONG lastAnimTime = 0;
     float iconSize = 24.0f;
     float spacing = 8.0f;
     float animSpeed = 0.25f;
 
     float currentHighlightPos = 0.0f;
     bool isHighlightInitialized = false;
+    AnimationEngine *animations = nullptr; // The bar's engine, once the first frame has run
+    AnimHandle highlightAnim = INVALID_ANIM;
 
     int cleanupCounter = 0;
-    int keepAliveFrames = 0;
-    size_t lastInputWindowCount = 0;
+    HWND paintedActive = NULL;     // ActiveWindow the last paint highlighted
+    bool paintedPreview = false;   // Whether the last paint kept the preview shown
+    size_t lastInputWindowCount = 0; // Without a registry: reconcile when the frame's list changes size
+
+    // The bar's curve, sped up or slowed by the dock's anim_speed (0.25 = as configured)
+    AnimationCurve HighlightCurve(const AnimationCurve &base) const {
+        float speed = animSpeed / 0.25f;
+        AnimationCurve curve = base;
+        curve.durationMs = (uint32_t)(base.durationMs / speed);
+        curve.stiffness = base.stiffness * speed * speed;
+        curve.damping = base.damping * speed;
+        return curve;
+    }
 
     size_t GetPathHash(const std::wstring &path) {
         std::wstring lower = path;
@@ -46,10 +241,16 @@ class DockModule : public Module {
         return std::hash<std::wstring>{}(lower);
     }
 
+    ID2D1Bitmap *IconBitmap(IconKey key) const { return (ID2D1Bitmap *)icons.Image(key, iconDrawEdge); }
+
     ID2D1Bitmap *GetItemIcon(RenderContext &ctx, const DockItem &item) {
-        if (pinnedIconCache.count(item.pathHash)) return pinnedIconCache[item.pathHash];
+        auto pinned = pinnedIcons.find(item.pathHash);
+        if (pinned != pinnedIcons.end()) return IconBitmap(pinned->second);
         HWND hIconSource = item.windows.empty() ? NULL : item.windows[0];
-        if (hIconSource && iconCache.count(hIconSource)) return iconCache[hIconSource];
+        if (hIconSource) {
+            auto found = windowIcons.find(hIconSource);
+            if (found != windowIcons.end()) return IconBitmap(found->second);
+        }
 
         WindowInfo tempInfo = {};
         tempInfo.hwnd = hIconSource;
@@ -76,182 +277,213 @@ class DockModule : public Module {
         return { path, index };
     }
 
+    // Where an icon comes from: the file, index and size, or the window for apps without a file.
+    // Loads are deduped on it and the cache remembers it, so an app's windows share one decode.
+    // `levels` tells chains built for different sets of edges apart.
+    uint64_t IconSourceKey(const std::wstring &path, int index, int size, uint32_t levels, HWND hwnd) {
+        uint64_t h = path.empty() ? (uint64_t)(uintptr_t)hwnd * 0xff51afd7ed558ccdull : GetPathHash(path);
+        h ^= ((uint64_t)levels << 40 | (uint64_t)(uint32_t)index << 16 | (uint32_t)size) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h ? h : 1;
+    }
+
     ID2D1Bitmap *GetOrLoadIcon(RenderContext &ctx, const WindowInfo &win) {
-        if (win.hwnd && iconCache.count(win.hwnd)) return iconCache[win.hwnd];
+        if (win.hwnd) {
+            auto found = windowIcons.find(win.hwnd);
+            if (found != windowIcons.end()) return IconBitmap(found->second);
+        }
         size_t pathHash = GetPathHash(win.exePath);
-        if (pinnedIconCache.count(pathHash)) {
-            ID2D1Bitmap *existing = pinnedIconCache[pathHash];
+        auto pinned = pinnedIcons.find(pathHash);
+        if (pinned != pinnedIcons.end()) {
             if (win.hwnd) {
-                existing->AddRef();
-                iconCache[win.hwnd] = existing;
+                icons.AddRef(pinned->second);
+                windowIcons[win.hwnd] = pinned->second;
             }
-            return existing;
+            return IconBitmap(pinned->second);
         }
+        if (!ctx.rt) return nullptr; // Headless (benchmark): nowhere to upload icons
 
         auto [loadPath, loadIndex] = GetEffectiveIconPath(win);
-        HICON hIcon = NULL;
-        bool shouldDestroy = false;
-
-        if (!loadPath.empty()) {
-            int targetSize = (int)iconSize;
-            if (targetSize < 32) targetSize = 32; else if (targetSize < 48) targetSize = 48;
-            UINT id = 0;
-            if (PrivateExtractIconsW(loadPath.c_str(), loadIndex, targetSize, targetSize, &hIcon, &id, 1, 0) > 0) {
-                if (hIcon) shouldDestroy = true;
-            }
-            if (!hIcon && ExtractIconExW(loadPath.c_str(), 0, &hIcon, NULL, 1) > 0 && hIcon) {
-                shouldDestroy = true;
-            }
-        }
-
-        if (!hIcon && win.hwnd) {
-            hIcon = (HICON)SendMessage(win.hwnd, WM_GETICON, ICON_BIG, 0);
-            if (!hIcon) hIcon = (HICON)SendMessage(win.hwnd, WM_GETICON, ICON_SMALL, 0);
-            if (!hIcon) hIcon = (HICON)GetClassLongPtr(win.hwnd, GCLP_HICON);
+        // Decoded for the largest bar, then filtered down to a level per DPI in use
+        const DockIconSizes &sizes = DockIconEdges();
+        int targetSize = std::max(1, sizes.Largest());
+        uint64_t source = IconSourceKey(loadPath, loadIndex, targetSize, sizes.version, win.hwnd);
+
+        IconKey key = icons.AcquireSource(source);
+        IconAtlasKey atlasKey;
+        if (key == NO_ICON && !loadPath.empty()) {
+            atlasKey = { GetPathHash(loadPath), loadIndex, targetSize, FileStamp(loadPath) };
+            key = AcquireFromAtlas(atlasKey, source);
         }
-        if (!hIcon) { hIcon = LoadIcon(NULL, IDI_APPLICATION); shouldDestroy = false; }
-
-        ID2D1Bitmap *bmp = nullptr;
-        IWICBitmap *wicBitmap = nullptr;
-        if (SUCCEEDED(ctx.wicFactory->CreateBitmapFromHICON(hIcon, &wicBitmap))) {
-            IWICFormatConverter *converter = nullptr;
-            ctx.wicFactory->CreateFormatConverter(&converter);
-            if (converter) {
-                converter->Initialize(wicBitmap, GUID_WICPixelFormat32bppPBGRA, WICBitmapDitherTypeNone, nullptr, 0.f, WICBitmapPaletteTypeMedianCut);
-                ctx.rt->CreateBitmapFromWicBitmap(converter, nullptr, &bmp);
-                converter->Release();
+        if (key == NO_ICON) {
+            wakeWindow.store(ctx.hwnd, std::memory_order_relaxed);
+            if (!failedIcons.count(source) && iconLoader.Request({ source, loadPath, loadIndex, targetSize, sizes.edges, (uintptr_t)win.hwnd })) {
+                if (atlasKey.stamp) atlasKeys[source] = atlasKey;
             }
-            wicBitmap->Release();
+            return nullptr;
         }
 
-        if (shouldDestroy && hIcon) DestroyIcon(hIcon);
+        if (win.hwnd) windowIcons[win.hwnd] = key;
+        else pinnedIcons[pathHash] = key;
+        return IconBitmap(key);
+    }
 
-        if (win.hwnd) iconCache[win.hwnd] = bmp;
-        else pinnedIconCache[pathHash] = bmp;
+    static uint64_t FileStamp(const std::wstring &path) {
+        WIN32_FILE_ATTRIBUTE_DATA attrs;
+        if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attrs)) return 0;
+        return ((uint64_t)attrs.ftLastWriteTime.dwHighDateTime << 32) | attrs.ftLastWriteTime.dwLowDateTime;
+    }
 
-        return bmp;
+    // Icons decoded on an earlier run upload straight from the mapped atlas
+    IconKey AcquireFromAtlas(const IconAtlasKey &atlasKey, uint64_t source) {
+        if (!atlasKey.stamp) return NO_ICON;
+        IconAtlasImage image = DockIconAtlas().Find(atlasKey);
+        if (!image) return NO_ICON;
+        IconMipChain mips;
+        mips.Build(image.pixels, image.width, image.height, image.width, DockIconEdges().edges);
+        return icons.Acquire(mips, source);
     }
 
-    bool PruneDeadWindows(HWND hwnd = NULL) {
-        bool changed = false;
-        for (auto &item : stableList) {
-            auto it = item.windows.begin();
-            while (it != item.windows.end()) {
-                HWND h = *it;
-                if (!IsWindow(h)) {
-                    if (h == optimisticHwnd) {
-                        optimisticHwnd = NULL;
-                        optimisticTime = 0;
-                    }
-                    it = item.windows.erase(it);
-                    changed = true;
-                }
-                else {
-                    ++it;
-                }
-            }
+    // Upload what the workers finished since the last frame
+    void ReceiveIcons(RenderContext &ctx) {
+        for (IconKey key : arrivedIcons) icons.Release(key);
+        arrivedIcons.clear();
+
+        iconsReady.store(false, std::memory_order_relaxed);
+        iconLoader.Drain(loadedIcons);
+        for (const LoadedIcon &icon : loadedIcons) {
+            IconKey key = icon.ok ? icons.Acquire(icon.mips, icon.key) : NO_ICON;
+            if (key == NO_ICON) failedIcons.insert(icon.key);
+            else arrivedIcons.push_back(key);
+
+            auto atlasKey = atlasKeys.find(icon.key);
+            if (atlasKey == atlasKeys.end()) continue;
+            if (icon.ok && icon.fromFile) DockIconAtlas().Add(atlasKey->second, icon.pixels.data(), icon.width, icon.height);
+            atlasKeys.erase(atlasKey);
         }
+        if (iconLoader.Busy()) return; // The loader wakes the bar as the rest land
 
-        if (changed) {
-            isDirty = true;
-            if (hwnd) {
-                InvalidateRect(hwnd, NULL, FALSE);
-            }
+        // Persist once the burst of loads is over
+        ULONGLONG now = GetTickCount64();
+        if (DockIconAtlas().IsDirty() && now - lastAtlasSave > 5000) {
+            lastAtlasSave = now;
+            DockIconAtlas().Save();
         }
-        return changed;
     }
 
-    void UpdateStableList(RenderContext &ctx) {
-        size_t currentWinCount = ctx.windows ? ctx.windows->size() : 0;
-        if (!isDirty && !optimisticHwnd && currentWinCount == lastInputWindowCount) return;
+    // Let go of icons whose window closed or whose app was unpinned
+    void PruneIcons() {
+        iconsStale = false;
+        for (auto it = windowIcons.begin(); it != windowIcons.end();) {
+            if (model.HasWindow(it->first)) { ++it; continue; }
+            icons.Release(it->second);
+            it = windowIcons.erase(it);
+        }
+        for (auto it = pinnedIcons.begin(); it != pinnedIcons.end();) {
+            if (model.IsPinned(it->first)) { ++it; continue; }
+            icons.Release(it->second);
+            it = pinnedIcons.erase(it);
+        }
+    }
 
-        lastInputWindowCount = currentWinCount; // Update for next frame
-        isDirty = false;
-        std::vector<const WindowInfo *> zOrderList;
+    void DropIcons() {
+        windowIcons.clear();
+        pinnedIcons.clear();
+        arrivedIcons.clear();
+        failedIcons.clear();
+        icons.Clear();
+    }
 
-        for (const auto &w : *ctx.windows) {
-            if (IsWindow(w.hwnd)) {
-                if (IsWindowVisible(w.hwnd) || w.hwnd == optimisticHwnd) {
-                    RECT r; GetWindowRect(w.hwnd, &r);
-                    if ((r.right - r.left) >= 20) zOrderList.push_back(&w);
-                }
-            }
-        }
+    // Items came or went: their icons may be unused and the dock needs repainting
+    void ModelChanged() {
+        iconsStale = true;
+        InvalidatePaint();
+    }
 
-        std::map<size_t, std::vector<HWND>> liveWindows;
-        std::map<size_t, std::wstring> titles;
+    // The window the highlight sits under; a click's target wins for a moment
+    HWND ActiveWindow(const RenderContext &ctx) const {
+        return (optimisticHwnd && (GetTickCount64() - optimisticTime < 500)) ? optimisticHwnd : ctx.foregroundWindow;
+    }
 
-        for (const auto *win : zOrderList) {
-            size_t h = (win->pathHash != 0) ? win->pathHash : GetPathHash(win->exePath);
-            liveWindows[h].push_back(win->hwnd);
-            if (titles[h].empty()) titles[h] = win->title;
+    bool PruneDeadWindows(HWND hwnd = NULL) {
+        std::vector<HWND> dead;
+        for (const auto &item : stableList) {
+            for (HWND h : item.windows) {
+                if (!IsWindow(h)) dead.push_back(h);
+            }
+        }
+        for (HWND h : dead) {
+            if (h == optimisticHwnd) {
+                optimisticHwnd = NULL;
+                optimisticTime = 0;
+            }
+            model.RemoveWindow(h);
         }
 
-        std::vector<DockItem> newList;
-        std::set<size_t> processedHashes;
-
-        for (const auto &oldItem : stableList) {
-            size_t h = oldItem.pathHash;
-            bool isPinned = IsPinned(oldItem.exePath);
-            bool hasWindows = liveWindows.count(h);
+        if (!dead.empty()) ModelChanged();
+        if (!dead.empty() && hwnd) InvalidateRect(hwnd, NULL, FALSE);
+        return !dead.empty();
+    }
 
-            if (isPinned || hasWindows) {
-                DockItem item = oldItem;
-                item.isPinned = isPinned;
-                if (hasWindows) item.title = titles[h];
+    void SyncPinned() {
+        std::vector<DockModel<HWND>::Pin> pins;
+        pins.reserve(m_pinnedApps.size());
+        for (const PinnedAppEntry &entry : m_pinnedApps) pins.push_back({ entry.path, entry.name, GetPathHash(entry.path) });
+        model.SetPinned(pins);
+        ModelChanged();
+    }
 
-                std::vector<HWND> mergedWindows;
-                const auto &currentLive = liveWindows[h];
+    void UpdateStableList(RenderContext &ctx) {
+        if (pinsChanged) {
+            pinsChanged = false;
+            SyncPinned();
+        }
 
-                for (HWND oldHwnd : oldItem.windows) {
-                    if (std::find(currentLive.begin(), currentLive.end(), oldHwnd) != currentLive.end()) {
-                        mergedWindows.push_back(oldHwnd);
+        // Replay the registry's changes since the last frame; a full pass only on first use or a lost log
+        if (const WindowRegistry *registry = ctx.windowRegistry) {
+            if (modelSeeded && registry->Version() == modelVersion) return;
+            if (modelSeeded && registry->DeltasSince(modelVersion, deltas)) {
+                for (const WindowDelta &d : deltas) {
+                    if (d.kind == WindowDelta::Removed) {
+                        model.RemoveWindow((HWND)d.hwnd);
+                        continue;
                     }
+                    // Gone again by now if there's no record; its Removed follows
+                    const WindowRecord *w = registry->Find(d.hwnd);
+                    if (w) model.AddWindow((HWND)d.hwnd, w->pathHash, w->exePath, w->title);
                 }
-                for (HWND liveHwnd : currentLive) {
-                    bool alreadyHas = false;
-                    for (HWND existing : mergedWindows) {
-                        if (existing == liveHwnd) { alreadyHas = true; break; }
-                    }
-                    if (!alreadyHas) mergedWindows.push_back(liveHwnd);
-                }
-
-                item.windows = mergedWindows;
-                newList.push_back(item);
-                processedHashes.insert(h);
             }
-        }
-
-        for (const auto *win : zOrderList) {
-            size_t h = (win->pathHash != 0) ? win->pathHash : GetPathHash(win->exePath);
-
-            if (processedHashes.find(h) == processedHashes.end()) {
-                DockItem newItem = {};
-                newItem.exePath = win->exePath;
-                newItem.pathHash = h;
-                newItem.isPinned = false;
-                newItem.title = win->title;
-                newItem.windows = liveWindows[h];
-
-                newList.push_back(newItem);
-                processedHashes.insert(h);
+            else {
+                std::vector<const WindowRecord *> snapshot;
+                registry->Snapshot(snapshot);
+                std::vector<DockModel<HWND>::Window> live;
+                live.reserve(snapshot.size());
+                for (const WindowRecord *w : snapshot) live.push_back({ (HWND)w->hwnd, w->pathHash, &w->exePath, &w->title });
+                model.Reconcile(live);
             }
+            modelVersion = registry->Version();
+            modelSeeded = true;
+            ModelChanged();
+            return;
         }
 
-        for (PinnedAppEntry &entry : m_pinnedApps) {
-            size_t h = GetPathHash(entry.path);
-            if (processedHashes.find(h) == processedHashes.end()) {
-                DockItem item = {};
-                item.exePath = entry.path;
-                item.pathHash = h;
-                item.isPinned = true;
-                item.title = entry.name;
-                newList.push_back(item);
-                processedHashes.insert(h);
+        // No registry (benchmark): reconcile with the frame's list when it may have changed
+        PruneDeadWindows(ctx.hwnd);
+        size_t currentWinCount = ctx.windows ? ctx.windows->size() : 0;
+        if (!isDirty && currentWinCount == lastInputWindowCount) return;
+        lastInputWindowCount = currentWinCount;
+        isDirty = false;
+
+        std::vector<DockModel<HWND>::Window> live;
+        if (ctx.windows) {
+            live.reserve(ctx.windows->size());
+            for (const auto &w : *ctx.windows) {
+                if (!w.hwnd || !IsWindow(w.hwnd)) continue; // Pinned placeholders
+                size_t h = (w.pathHash != 0) ? w.pathHash : GetPathHash(w.exePath);
+                live.push_back({ w.hwnd, h, &w.exePath, &w.title });
             }
         }
-
-        stableList = newList;
+        model.Reconcile(live);
+        ModelChanged();
     }
 
 public:
@@ -265,12 +497,22 @@ public:
         if (cfg.dockIconSize > 0) this->iconSize = cfg.dockIconSize;
         if (cfg.dockSpacing > 0) this->spacing = cfg.dockSpacing;
         if (cfg.dockAnimSpeed > 0) this->animSpeed = cfg.dockAnimSpeed;
+        if (cfg.dockIconCacheKb > 0) icons.SetBudget((size_t)cfg.dockIconCacheKb * 1024);
 
         m_pinnedApps = PinnedAppsIO::Load();
+
+        // Completion-driven: a worker posts one wake per batch instead of the dock polling every frame
+        iconLoader.SetOnFinished([this] {
+            iconsReady.store(true, std::memory_order_release);
+            if (HWND hwnd = wakeWindow.load(std::memory_order_relaxed)) PostMessage(hwnd, WM_RAILING_WAKE, 0, 0);
+        });
     }
 
     ~DockModule() {
-        for (auto &[k, v] : iconCache) if (v) v->Release();
+        iconLoader.Stop();
+        DropIcons();
+        DockIconAtlas().Save();
+        if (animations) animations->Release(highlightAnim);
     }
 
     void SetOptimisticFocus(HWND hwnd) {
@@ -287,7 +529,7 @@ public:
         }
         m_pinnedApps.push_back({ path, L"", name, iconPath, iconIndex });
         PinnedAppsIO::Save(m_pinnedApps);
-        isDirty = true;
+        pinsChanged = true;
     }
 
     void UnpinApp(std::wstring path) {
@@ -296,16 +538,16 @@ public:
         if (it != m_pinnedApps.end()) {
             m_pinnedApps.erase(it, m_pinnedApps.end());
             PinnedAppsIO::Save(m_pinnedApps);
-            isDirty = true;
+            pinsChanged = true;
         }
     }
 
     bool IsPinned(const std::wstring &path) {
-        size_t h = GetPathHash(path);
-        for (const auto &app : m_pinnedApps) {
-            if (GetPathHash(app.path) == h) return true;
+        if (pinsChanged) {
+            pinsChanged = false;
+            SyncPinned();
         }
-        return false;
+        return model.IsPinned(GetPathHash(path));
     }
 
     bool useThumbnails = false;
@@ -345,21 +587,37 @@ public:
         return false;
     }
 
-    float GetContentWidth(RenderContext &ctx) override {
+    // The width only depends on the item count, which the model settles here
+    bool NeedsMeasure(RenderContext &ctx) override {
         if (optimisticHwnd && !IsWindow(optimisticHwnd)) {
             optimisticHwnd = NULL;
             optimisticTime = 0;
-            isDirty = true;
         }
+        UpdateStableList(ctx);
+        return layoutDirty || stableList.size() != measuredCount;
+    }
+    // Animations and model changes set paintDirty through RequestFrame and ModelChanged,
+    // finished icon loads raise iconsReady; the rest is state that moves without telling the dock
+    bool NeedsPaint(RenderContext &ctx) override {
+        if (paintDirty || pinsChanged || !arrivedIcons.empty() || iconsReady.load(std::memory_order_acquire)) return true;
+        if (ActiveWindow(ctx) != paintedActive) return true;
+        // The preview window is positioned and hidden from RenderContent
+        if (previewState.active || paintedPreview) return true;
+        // Icons have to be dropped and uploaded again for a new target or DPI
+        uint32_t epoch = ctx.draw ? ctx.draw->GetResourceEpoch() : 0;
+        return iconUploader.rt != ctx.rt || iconEpoch != epoch || iconSizesVersion != DockIconEdges().version
+            || iconDrawEdge != iconSize * ctx.scale;
+    }
 
-        PruneDeadWindows(ctx.hwnd);
+    float GetContentWidth(RenderContext &ctx) override {
         UpdateStableList(ctx);
 
         size_t count = stableList.size();
+        measuredCount = count;
         if (count == 0) return 0.0f;
 
         float length = (count * iconSize) + ((count - 1) * spacing);
-        Style s = GetEffectiveStyle();
+        const Style &s = GetEffectiveStyle();
 
         if (config.position == "left" || config.position == "right")
             return length + s.padding.top + s.padding.bottom + s.margin.top + s.margin.bottom;
@@ -367,32 +625,63 @@ public:
             return length + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
     }
 
+    // Icon boxes, placed exactly as RenderContent lays them out
+    void GetHitParts(const LayoutRect &rect, std::vector<LayoutRect> &out) override {
+        size_t count = stableList.size();
+        if (count == 0) return;
+
+        bool isVertical = (config.position == "left" || config.position == "right");
+        const Style &containerStyle = GetEffectiveStyle();
+        const Style &itemStyle = config.itemStyle;
+
+        float itemBoxStride = iconSize + (isVertical ? (itemStyle.padding.top + itemStyle.padding.bottom) : (itemStyle.padding.left + itemStyle.padding.right));
+        float itemSpacing = isVertical ? (itemStyle.margin.top + itemStyle.margin.bottom) : (itemStyle.margin.left + itemStyle.margin.right);
+        if (spacing > 0) itemSpacing = spacing;
+        float totalLength = (count * itemBoxStride) + ((count - 1) * itemSpacing);
+
+        float startMain = isVertical
+            ? rect.top + containerStyle.margin.top + ((rect.Height() - containerStyle.margin.top - containerStyle.margin.bottom - totalLength) / 2.0f)
+            : rect.left + containerStyle.margin.left + ((rect.Width() - containerStyle.margin.left - containerStyle.margin.right - totalLength) / 2.0f);
+
+        for (size_t i = 0; i < count; i++) {
+            LayoutRect item = rect;
+            float start = startMain + i * (itemBoxStride + itemSpacing);
+            if (isVertical) { item.top = start; item.bottom = start + itemBoxStride; }
+            else { item.left = start; item.right = start + itemBoxStride; }
+            out.push_back(item);
+        }
+    }
+
     void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override {
         if (!m_previewWin && ctx.factory && ctx.writeFactory)
             m_previewWin = new DockPreviewWindow(ctx.factory, ctx.writeFactory, ctx.wicFactory);
 
-        if (optimisticHwnd && !IsWindow(optimisticHwnd)) {
-            optimisticHwnd = NULL;
-            optimisticTime = 0;
-            isDirty = true;
-        }
-
-        PruneDeadWindows(ctx.hwnd);
         UpdateStableList(ctx);
+
+        // Bitmaps belong to the render target; a new target or a lost device invalidates them all.
+        // A DPI no bar has used yet needs new levels; one already seen just draws another level
+        iconDrawEdge = iconSize * ctx.scale;
+        DockIconSizes &sizes = DockIconEdges();
+        if (ctx.rt) sizes.Use(std::max(1, (int)std::lround(iconDrawEdge)));
+        uint32_t epoch = ctx.draw ? ctx.draw->GetResourceEpoch() : 0;
+        if (iconUploader.rt != ctx.rt || iconEpoch != epoch || iconSizesVersion != sizes.version) {
+            DropIcons();
+            iconUploader.rt = ctx.rt;
+            iconEpoch = epoch;
+            iconSizesVersion = sizes.version;
+        }
+        if (iconsStale) PruneIcons();
+        if (ctx.rt) ReceiveIcons(ctx);
         if (stableList.empty()) return;
 
         bool isVertical = (config.position == "left" || config.position == "right");
 
-        Style containerStyle = GetEffectiveStyle();
-        Style itemStyle = config.itemStyle;
+        const Style &containerStyle = GetEffectiveStyle();
+        const Style &itemStyle = config.itemStyle;
 
         if (containerStyle.has_bg) {
-            D2D1_ROUNDED_RECT bgRect = D2D1::RoundedRect(
-                D2D1::RectF(x + containerStyle.margin.left, y + containerStyle.margin.top, x + w - containerStyle.margin.right, y + h - containerStyle.margin.bottom),
-                containerStyle.radius, containerStyle.radius
-            );
-            ctx.bgBrush->SetColor(containerStyle.bg);
-            ctx.rt->FillRoundedRectangle(bgRect, ctx.bgBrush);
+            D2D1_RECT_F bgRect = D2D1::RectF(x + containerStyle.margin.left, y + containerStyle.margin.top, x + w - containerStyle.margin.right, y + h - containerStyle.margin.bottom);
+            ctx.draw->FillRoundedRect(bgRect, containerStyle.radius, containerStyle.bg);
         }
 
         size_t count = stableList.size();
@@ -425,7 +714,9 @@ public:
         float targetPos = -1.0f;
         float searchCursor = startMain;
 
-        HWND activeWin = (optimisticHwnd && (GetTickCount64() - optimisticTime < 500)) ? optimisticHwnd : ctx.foregroundWindow;
+        HWND activeWin = ActiveWindow(ctx);
+        paintedActive = activeWin;
+        if (activeWin == optimisticHwnd && activeWin) RequestFrame(ctx); // Until the optimistic focus expires
         const DockItem *activeItem = nullptr;
 
         for (const auto &item : stableList) {
@@ -443,31 +734,27 @@ public:
             searchCursor += (itemBoxStride + itemSpacing);
         }
 
+        bool highlightMoving = false;
         if (targetPos >= 0.0f) {
-            ULONGLONG now = GetTickCount64();
-
-            if (!isHighlightInitialized) {
-                currentHighlightPos = targetPos;
-                isHighlightInitialized = true;
-            }
+            if (!ctx.animations) currentHighlightPos = targetPos;
             else {
-                float dt = (float)(now - lastAnimTime) / 1000.0f;
-                if (dt > 0.1f) dt = 0.016f;
-                float damping = 1.0f - std::pow(0.01f, dt * (animSpeed * 10.0f));
-
-                float diff = targetPos - currentHighlightPos;
-                currentHighlightPos += diff * damping;
-                if (abs(diff) < 0.5f) {
-                    currentHighlightPos = targetPos;
-                    if (activeItem) InvalidateRect(ctx.hwnd, NULL, FALSE);
+                if (highlightAnim == INVALID_ANIM) {
+                    animations = ctx.animations;
+                    highlightAnim = animations->Create(FRAME_CLIENT_REPAINT, targetPos, 0.5f);
                 }
-                else InvalidateRect(ctx.hwnd, NULL, FALSE);
+                if (!isHighlightInitialized) animations->Set(highlightAnim, targetPos);
+                else animations->AnimateTo(highlightAnim, targetPos, HighlightCurve(animations->curve));
+
+                // The engine keeps the bar ticking until it settles
+                currentHighlightPos = animations->Get(highlightAnim);
+                highlightMoving = animations->IsActive(highlightAnim);
+                if (highlightMoving) RequestFrame(ctx);
             }
-            lastAnimTime = now;
+            isHighlightInitialized = true;
 
             D2D1_COLOR_F activeColor = D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.2f);
-            if (config.states.count("active")) {
-                Style s = config.states.at("active");
+            if (config.styleIds.active != NO_STYLE) {
+                const Style &s = GetStyle(config.styleIds.active);
                 if (s.indicator.a > 0.0f) activeColor = s.indicator;
                 else if (s.has_bg) activeColor = s.bg;
             }
@@ -477,7 +764,7 @@ public:
             float barLength = 16.0f;
             if (activeItem && activeItem->windows.size() > 1) barLength = 28.0f;
 
-            D2D1_ROUNDED_RECT activeRect;
+            D2D1_RECT_F activeRect;
 
             if (isVertical) {
                 // Vertical Bar indicator: Left or Right side based on alignment
@@ -485,7 +772,7 @@ public:
                 float barX = onRight ? (fixedCross + iconSize + 6) : (fixedCross - 6 - barThickness);
 
                 float barY = currentHighlightPos + (itemBoxStride / 2) - (barLength / 2);
-                activeRect = D2D1::RoundedRect(D2D1::RectF(barX, barY, barX + barThickness, barY + barLength), 2, 2);
+                activeRect = D2D1::RectF(barX, barY, barX + barThickness, barY + barLength);
             }
             else {
                 // Horizontal Bar indicator: Top or Bottom
@@ -493,15 +780,14 @@ public:
                 float barY = onBottom ? (fixedCross + iconSize + 6) : (fixedCross - 6 - barThickness);
 
                 float barX = currentHighlightPos + (itemBoxStride / 2) - (barLength / 2);
-                activeRect = D2D1::RoundedRect(D2D1::RectF(barX, barY, barX + barLength, barY + barThickness), 2, 2);
+                activeRect = D2D1::RectF(barX, barY, barX + barLength, barY + barThickness);
             }
 
-            ctx.bgBrush->SetColor(activeColor);
-            ctx.rt->FillRoundedRectangle(activeRect, ctx.bgBrush);
+            ctx.draw->FillRoundedRect(activeRect, 2.0f, activeColor);
         }
         else {
             isHighlightInitialized = false;
-            if (optimisticHwnd) InvalidateRect(ctx.hwnd, NULL, FALSE);
+            if (optimisticHwnd) RequestFrame(ctx);
         }
 
         float drawCursor = startMain;
@@ -522,10 +808,13 @@ public:
                 iconY = fixedCross; // Centered
             }
 
+            D2D1_RECT_F dest = D2D1::RectF(iconX, iconY, iconX + iconSize, iconY + iconSize);
             if (bmp) {
-                D2D1_RECT_F dest = D2D1::RectF(iconX, iconY, iconX + iconSize, iconY + iconSize);
                 float opacity = item.windows.empty() ? 0.5f : 1.0f;
-                ctx.rt->DrawBitmap(bmp, dest, opacity);
+                ctx.draw->DrawImage(ImageRef(bmp), dest, opacity);
+            }
+            else if (ctx.rt) {
+                ctx.draw->FillRoundedRect(dest, iconSize * 0.2f, D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.12f)); // Still loading
             }
 
             int winCount = (int)item.windows.size();
@@ -542,9 +831,7 @@ public:
 
                     for (int d = 0; d < dotsToShow; d++) {
                         float dy = clusterStartY + (d * (dotGap + dotSize));
-                        D2D1_ELLIPSE dot = D2D1::Ellipse(D2D1::Point2F(dotX + (dotSize / 2), dy + (dotSize / 2)), dotSize / 2, dotSize / 2);
-                        ctx.bgBrush->SetColor(D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.4f));
-                        ctx.rt->FillEllipse(dot, ctx.bgBrush);
+                        ctx.draw->FillEllipse(dotX + (dotSize / 2), dy + (dotSize / 2), dotSize / 2, dotSize / 2, D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.4f));
                     }
                 }
                 else {
@@ -555,9 +842,7 @@ public:
 
                     for (int d = 0; d < dotsToShow; d++) {
                         float dx = clusterStartX + (d * (dotGap + dotSize));
-                        D2D1_ELLIPSE dot = D2D1::Ellipse(D2D1::Point2F(dx + (dotSize / 2), dotY + (dotSize / 2)), dotSize / 2, dotSize / 2);
-                        ctx.bgBrush->SetColor(D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.4f));
-                        ctx.rt->FillEllipse(dot, ctx.bgBrush);
+                        ctx.draw->FillEllipse(dx + (dotSize / 2), dotY + (dotSize / 2), dotSize / 2, dotSize / 2, D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.4f));
                     }
                 }
             }
@@ -567,9 +852,7 @@ public:
                 if (attentionWindows.count(hw)) { hasAttention = true; break; }
             }
             if (hasAttention) {
-                D2D1_ELLIPSE dot = D2D1::Ellipse(D2D1::Point2F(iconX + iconSize - 2, iconY + 2), 3, 3);
-                ctx.bgBrush->SetColor(D2D1::ColorF(D2D1::ColorF::Red));
-                ctx.rt->FillEllipse(dot, ctx.bgBrush);
+                ctx.draw->FillEllipse(iconX + iconSize - 2, iconY + 2, 3, 3, D2D1::ColorF(D2D1::ColorF::Red));
             }
 
             drawCursor += (itemBoxStride + itemSpacing);
@@ -638,15 +921,7 @@ public:
         }
 
         if (!shouldShow && m_previewWin) m_previewWin->Hide();
-
-        if (activeItem) {
-            keepAliveFrames = 60;
-        }
-
-        if (keepAliveFrames > 0) {
-            keepAliveFrames--;
-            InvalidateRect(ctx.hwnd, NULL, FALSE);
-        }
+        paintedPreview = shouldShow;
 
         if (++cleanupCounter > 600) cleanupCounter = 0;
     }
@@ -684,19 +959,20 @@ public:
     }
 
     void SetAttention(HWND hwnd, bool active) {
-        if (active) attentionWindows.insert(hwnd);
-        else attentionWindows.erase(hwnd);
+        bool changed = active ? attentionWindows.insert(hwnd).second : attentionWindows.erase(hwnd) != 0;
+        if (changed) InvalidatePaint();
     }
 
     void ClearAttention(HWND hwnd) {
-        if (attentionWindows.count(hwnd)) attentionWindows.erase(hwnd);
+        if (attentionWindows.erase(hwnd)) InvalidatePaint();
     }
 
     void InvalidateIcon(HWND hwnd) {
-        if (hwnd && iconCache.count(hwnd)) {
-            if (iconCache[hwnd]) iconCache[hwnd]->Release();
-            iconCache.erase(hwnd);
-        }
+        auto found = windowIcons.find(hwnd);
+        if (found == windowIcons.end()) return;
+        icons.Release(found->second);
+        windowIcons.erase(found);
+        InvalidatePaint();
     }
 
     int GetCount() const {
@@ -5,46 +5,42 @@ class GpuModule : public Module
 {
 	int lastTemp = -1;
 	std::wstring cachedStr;
+	std::wstring valueStr;
+	NumericLabel label;
+
+	std::string GetFormat() const { return config.format.empty() ? "GPU: {temp}\u00B0C" : config.format; }
 public:
-	GpuModule(const ModuleConfig &cfg) : Module(cfg) {}
+	GpuModule(const ModuleConfig &cfg) : Module(cfg) {
+		if (config.fixedDigits) {
+			label.SetFormat(Utf8ToWide(GetFormat()), L"{temp}");
+			label.SetReservedDigits(2);
+		}
+	}
+	bool NeedsMeasure(RenderContext &ctx) override { return layoutDirty || ctx.gpuTemp != lastTemp; }
 	float GetContentWidth(RenderContext &ctx) override {
 		if (ctx.gpuTemp != lastTemp) {
 			lastTemp = ctx.gpuTemp;
-			std::string fmt = config.format.empty() ? "GPU: {temp}\u00B0C" : config.format;
-			cachedStr = FormatOutput(fmt, "{temp}", std::to_wstring(lastTemp));
+			valueStr = std::to_wstring(lastTemp);
+			cachedStr = FormatOutput(GetFormat(), "{temp}", valueStr);
 		}
 
-		Style s = GetEffectiveStyle();
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		IDWriteTextLayout *layout = GetLayout(ctx, cachedStr, fmt);
-
-		DWRITE_TEXT_METRICS metrics;
-		layout->GetMetrics(&metrics);
-		return metrics.width + 4.0f + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
+		const Style &s = GetEffectiveStyle();
+		float textW = label.Measure(*ctx.draw, FontFor(s), ctx.scale, valueStr);
+		if (textW < 0.0f) textW = ctx.draw->MeasureString(cachedStr, FontFor(s)).width;
+		return textW + 4.0f + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
 	}
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 		D2D1_COLOR_F color = config.baseStyle.fg;
 		// Thresholds: Orange > 75C, Red > 85C
-		for (const auto &th : config.thresholds) {
-			if (ctx.gpuTemp >= th.val) {
-				color = th.style.fg;
-				if (th.style.has_bg) s.bg = th.style.bg;
-			}
-		}
+		if (const Style *th = GetThresholdStyle(ctx.gpuTemp)) color = th->fg;
 
 		DrawProgressBar(ctx, x, y, w, h, ctx.gpuTemp / 100.0f, color);
-		std::string fmt = config.format.empty() ? "GPU: {temp}\u00B0C" : config.format;
-		std::wstring text = FormatOutput(fmt, "{temp}", std::to_wstring(ctx.gpuTemp));
 
-		ctx.textBrush->SetColor(D2D1::ColorF(1, 1, 1, 1)); // White text overlay
-		ctx.rt->DrawTextW(
-			cachedStr.c_str(),
-			(UINT32)cachedStr.length(),
-			ctx.textFormat,
-			D2D1::RectF(x, y, x + w, y + h),
-			ctx.textBrush
-		);
+		// White text overlay
+		D2D1_RECT_F rect = D2D1::RectF(x, y, x + w, y + h);
+		if (!label.Draw(*ctx.draw, valueStr, rect, D2D1::ColorF(1, 1, 1, 1)))
+			ctx.draw->DrawString(cachedStr, rect, DrawFont::Text, D2D1::ColorF(1, 1, 1, 1));
 	}
 };
\ No newline at end of file
@@ -7,7 +7,28 @@ public:
 	std::vector<Module *> children;
 	GroupModule(const ModuleConfig &cfg) : Module(cfg) {}
 	~GroupModule() { for (auto m : children) delete m; }
-	void AddChild(Module *m) { children.push_back(m); }
+	void AddChild(Module *m) {
+		children.push_back(m);
+		layoutNode.children.push_back(&m->layoutNode);
+	}
+
+	bool NeedsMeasure(RenderContext &ctx) override
+	{
+		bool needs = layoutDirty;
+		for (auto *child : children) {
+			if (child->NeedsMeasure(ctx)) needs = true;
+		}
+		return needs;
+	}
+
+	bool NeedsPaint(RenderContext &ctx) override
+	{
+		bool needs = paintDirty;
+		for (auto *child : children) {
+			if (child->NeedsPaint(ctx)) needs = true;
+		}
+		return needs;
+	}
 
 	float GetContentWidth(RenderContext &ctx) override
 	{
@@ -27,13 +48,22 @@ public:
 		totalSize += isVertical ? s.padding.bottom : s.padding.right;
 		totalSize += isVertical ? (s.margin.top + s.margin.bottom) : (s.margin.left + s.margin.right);
 
+		// Children sit inside both the module box (base style) and the group's own
+		// background (effective style); the layout engine offsets them by this.
+		const Style &e = GetEffectiveStyle();
+		layoutNode.SetChildInsets({
+			s.margin.left + s.padding.left + e.margin.left + e.padding.left,
+			s.margin.top + s.padding.top + e.margin.top + e.padding.top,
+			s.margin.right + s.padding.right + e.margin.right + e.padding.right,
+			s.margin.bottom + s.padding.bottom + e.margin.bottom + e.padding.bottom
+		});
+
 		return totalSize;
 	}
 
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		bool isVertical = (config.position == "left" || config.position == "right");
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 
 		if (s.has_bg) {
 			D2D1_RECT_F bgRect = D2D1::RectF(
@@ -42,32 +72,15 @@ public:
 				x + w - s.margin.right,
 				y + h - s.margin.bottom
 			);
-			D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(bgRect, s.radius, s.radius);
-			ctx.bgBrush->SetColor(s.bg);
-			ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
-		}
-
-		if (isVertical) {
-			float cursor = y + s.margin.top + s.padding.top;
-			float fixedX = x + s.margin.left + s.padding.left;
-			float childW = w - s.margin.left - s.margin.right - s.padding.left - s.padding.right;
-
-			for (Module *child : children) {
-				child->cachedRect = D2D1::RectF(fixedX, cursor, fixedX + childW, cursor + child->width);
-				child->RenderContent(ctx, fixedX, cursor, childW, child->width);
-				cursor += child->width;
-			}
+			ctx.draw->FillRoundedRect(bgRect, s.radius, s.bg);
 		}
-		else {
-			float cursor = x + s.margin.left + s.padding.left;
-			float fixedY = y + s.margin.top + s.padding.top;
-			float childH = h - s.margin.top - s.margin.bottom - s.padding.top - s.padding.bottom;
 
-			for (Module *child : children) {
-				child->cachedRect = D2D1::RectF(cursor, fixedY, cursor + child->width, fixedY + childH);
-				child->RenderContent(ctx, cursor, fixedY, child->width, childH);
-				cursor += child->width;
-			}
+		// Children were placed by the layout engine during the arrange pass
+		for (Module *child : children) {
+			const LayoutRect &r = child->layoutNode.rect;
+			child->cachedRect = D2D1::RectF(r.left, r.top, r.right, r.bottom);
+			child->RenderContent(ctx, r.left, r.top, r.Width(), r.Height());
+			child->paintDirty = false;
 		}
 	}
 };
\ No newline at end of file
@@ -8,25 +8,42 @@ public:
 
 	float GetContentWidth(RenderContext &ctx) override
 	{
-		return ctx.iconFormat->GetFontSize()
+		return ctx.draw->GetFontSize(DrawFont::Icon)
 			+ config.baseStyle.padding.left + config.baseStyle.padding.right
 			+ config.baseStyle.margin.left + config.baseStyle.margin.right;
 	}
 
+	// Glyph depends on live volume/wifi state, so repaint only when it flips
+	bool NeedsPaint(RenderContext &ctx) override { return paintDirty || GetGlyph(ctx) != paintedGlyph; }
+
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 
 		if (s.has_bg) {
 			D2D1_RECT_F bgRect = D2D1::RectF(
 				x + s.margin.left, y + s.margin.top,
 				x + w - s.margin.right, y + h - s.margin.bottom);
-			D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(bgRect, s.radius, s.radius);
-			ctx.bgBrush->SetColor(s.bg);
-			ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
+			ctx.draw->FillRoundedRect(bgRect, s.radius, s.bg);
 		}
+		std::wstring text = GetGlyph(ctx);
+		paintedGlyph = text;
+
+		D2D1_RECT_F rect = D2D1::RectF(
+			x + s.margin.left + s.padding.left,
+			y + s.margin.top + s.padding.top,
+			x + w - s.margin.right - s.padding.right,
+			y + h - s.margin.bottom - s.padding.bottom);
+		ctx.draw->DrawString(text, rect, DrawFont::Icon, s.fg);
+	}
+
+private:
+	std::wstring paintedGlyph;
+
+	std::wstring GetGlyph(RenderContext &ctx)
+	{
 		std::wstring text = L"\uE774"; // Default Globe
-		if (config.type == "network") {
+		if (kind == ModuleType::Network) {
 			if (ctx.isWifiConnected) {
 				if (ctx.wifiSignal > 80) text = L"\uE701"; // Full
 				else if (ctx.wifiSignal > 60) text = L"\uE874"; // 3 Bars
@@ -36,23 +53,16 @@ public:
 			}
 		}
 
-		if (config.type == "audio") {
+		if (kind == ModuleType::Audio) {
 			if (ctx.isMuted || ctx.volume == 0.0f) text = L"\uE74F"; // Mute
 			else if (ctx.volume < 0.33f) text = L"\uE993"; // Low
 			else if (ctx.volume < 0.66f) text = L"\uE994"; // Medium
 			else text = L"\uE995"; // High
 		}
 
-		if (config.type == "battery") text = L"\uE83F";
-		if (config.type == "tray") text = L"\uE70E";
-		if (config.type == "notification") text = L"\uEA8F";
-
-		D2D1_RECT_F rect = D2D1::RectF(
-			x + s.margin.left + s.padding.left,
-			y + s.margin.top + s.padding.top,
-			x + w - s.margin.right - s.padding.right,
-			y + h - s.margin.bottom - s.padding.bottom);
-		ctx.textBrush->SetColor(s.fg);
-		ctx.rt->DrawTextW(text.c_str(), 1, ctx.iconFormat, rect, ctx.textBrush);
+		if (kind == ModuleType::Battery) text = L"\uE83F";
+		if (kind == ModuleType::Tray) text = L"\uE70E";
+		if (kind == ModuleType::Notification) text = L"\uEA8F";
+		return text;
 	}
 };
\ No newline at end of file
@@ -118,6 +118,10 @@ inline std::thread NetworkPoller::worker;
 class PingModule : public Module {
 	int lastRenderedPing = -999;
 	std::wstring cachedStr;
+	std::wstring valueStr;
+	NumericLabel label;
+
+	std::string GetFormat() const { return config.format.empty() ? "PING: {ping}ms" : config.format; }
 
 public:
 	std::string targetIP;
@@ -127,47 +131,45 @@ public:
 		targetIP = config.target.empty() ? "8.8.8.8" : config.target;
 		int interval = config.interval > 0 ? config.interval : 2000;
 		NetworkPoller::AddTask(this, targetIP, &lastPing, interval);
+
+		if (config.fixedDigits) {
+			label.SetFormat(Utf8ToWide(GetFormat()), L"{ping}");
+			label.SetReservedDigits(3);
+		}
 	}
 
 	~PingModule() { 
 		NetworkPoller::RemoveTask(this);
 	}
 
+	bool NeedsMeasure(RenderContext &ctx) override { return layoutDirty || lastPing != lastRenderedPing; }
+
 	float GetContentWidth(RenderContext &ctx) override {
 		int currentPing = lastPing;
 		if (currentPing != lastRenderedPing) {
 			lastRenderedPing = currentPing;
-			std::wstring valStr = (currentPing < 0) ? L"---" : std::to_wstring(currentPing);
-			std::string fmt = config.format.empty() ? "PING: {ping}ms" : config.format;
-			cachedStr = FormatOutput(fmt, "{ping}", valStr);
+			valueStr = (currentPing < 0) ? L"---" : std::to_wstring(currentPing);
+			cachedStr = FormatOutput(GetFormat(), "{ping}", valueStr);
 		}
 
-		Style s = GetEffectiveStyle();
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		IDWriteTextLayout *layout = GetLayout(ctx, cachedStr, fmt);
-		DWRITE_TEXT_METRICS m; layout->GetMetrics(&m);
-		return m.width + 10.0f + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
+		const Style &s = GetEffectiveStyle();
+		float textW = label.Measure(*ctx.draw, FontFor(s), ctx.scale, valueStr);
+		if (textW < 0.0f) textW = ctx.draw->MeasureString(cachedStr, FontFor(s)).width;
+		return textW + 10.0f + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
 	}
 
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override {
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 		int ms = lastPing;
 		D2D1_COLOR_F color = s.fg;
-		for (const auto &th : config.thresholds) {
-			if (ms >= th.val) {
-				color = th.style.fg;
-				if (th.style.has_bg) s.bg = th.style.bg;
-			}
-		}
+		if (const Style *th = GetThresholdStyle(ms)) color = th->fg;
 
 		float pct = (ms < 0) ? 0.0f : (float)ms / 200.0f;
 		if (pct > 1.0f) pct = 1.0f;
 		DrawProgressBar(ctx, x, y, w, h, pct, color);
 
 		D2D1_RECT_F rect = D2D1::RectF(x, y, x + w, y + h);
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-
-		ctx.textBrush->SetColor(s.fg);
-		ctx.rt->DrawTextW(cachedStr.c_str(), (UINT32)cachedStr.length(), fmt, rect, ctx.textBrush);
+		if (!label.Draw(*ctx.draw, valueStr, rect, s.fg))
+			ctx.draw->DrawString(cachedStr, rect, FontFor(s), s.fg);
 	}
 };
\ No newline at end of file
@@ -5,34 +5,39 @@ class RamModule : public Module
 {
 	int lastRam = -1;
 	std::wstring cachedStr;
+	std::wstring valueStr;
+	NumericLabel label;
+
+	std::string GetFormat() const { return config.format.empty() ? "RAM: {usage}%" : config.format; }
 public:
-	RamModule(const ModuleConfig &cfg) : Module(cfg) {}
+	RamModule(const ModuleConfig &cfg) : Module(cfg) {
+		if (config.fixedDigits) {
+			label.SetFormat(Utf8ToWide(GetFormat()), L"{usage}");
+			label.SetReservedDigits(3); // "100"
+		}
+	}
+	bool NeedsMeasure(RenderContext &ctx) override { return layoutDirty || ctx.ramUsage != lastRam; }
 	float GetContentWidth(RenderContext &ctx) override {
 		if (ctx.ramUsage != lastRam) {
 			lastRam = ctx.ramUsage;
-			std::string fmt = config.format.empty() ? "RAM: {usage}%" : config.format;
-			cachedStr = FormatOutput(fmt, "{usage}", std::to_wstring(lastRam));
+			valueStr = std::to_wstring(lastRam);
+			cachedStr = FormatOutput(GetFormat(), "{usage}", valueStr);
 		}
 
-		Style s = GetEffectiveStyle();
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		IDWriteTextLayout *layout = GetLayout(ctx, cachedStr, fmt);
-
-		DWRITE_TEXT_METRICS metrics;
-		layout->GetMetrics(&metrics);
-		return metrics.width + 4.0f + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
+		const Style &s = GetEffectiveStyle();
+		float textW = label.Measure(*ctx.draw, FontFor(s), ctx.scale, valueStr);
+		if (textW < 0.0f) textW = ctx.draw->MeasureString(cachedStr, FontFor(s)).width;
+		return textW + 4.0f + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
 	}
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 		D2D1_COLOR_F color = config.baseStyle.fg;
-		for (const auto &th : config.thresholds) {
-			if (ctx.ramUsage >= th.val) color = th.style.fg;
-		}
+		if (const Style *th = GetThresholdStyle(ctx.ramUsage)) color = th->fg;
 		DrawProgressBar(ctx, x, y, w, h, ctx.ramUsage / 100.0f, color);
 
-		ctx.textBrush->SetColor(s.fg);
-		IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-		ctx.rt->DrawTextW(cachedStr.c_str(), (UINT32)cachedStr.length(), fmt, D2D1::RectF(x, y, x + w, y + h), ctx.textBrush);
+		D2D1_RECT_F rect = D2D1::RectF(x, y, x + w, y + h);
+		if (!label.Draw(*ctx.draw, valueStr, rect, s.fg))
+			ctx.draw->DrawString(cachedStr, rect, FontFor(s), s.fg);
 	}
 };
\ No newline at end of file
@@ -23,19 +23,20 @@ public:
 		if (count == 0) return 0.0f;
 
 		float totalContent = (count * config.viz.thickness) + ((count - 1) * config.viz.spacing);
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 		return totalContent + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
 	}
 
 	void Update() override {
 		if (!capture) return;
 
-		std::vector<float> rawAudio;
-		capture->GetAudioData(rawAudio);
-		if (rawAudio.empty()) return;
+		const AudioRing &ring = capture->Samples();
+		AudioWindow window = ring.Latest(AudioCapture::FFT_SIZE);
+		if (!window) return;
 
 		std::vector<float> freqs;
-		fft.Compute(rawAudio, freqs);
+		fft.Compute(window.samples, window.count, freqs);
+		if (!ring.Intact(window)) return; // Overwritten while we read it; next frame has fresh samples
 
 		int numBars = config.viz.numBars;
 		if (numBars < 4) numBars = 4;
@@ -77,13 +78,14 @@ public:
 
 			if (smoothFrequencies[i] > 1.0f) smoothFrequencies[i] = 1.0f;
 		}
+		InvalidatePaint();
 	}
 
 	void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
 	{
 		if (smoothFrequencies.empty()) return;
 
-		Style s = GetEffectiveStyle();
+		const Style &s = GetEffectiveStyle();
 
 		// FIX: Use effective styling for background
 		if (s.has_bg) {
@@ -91,14 +93,13 @@ public:
 				x + s.margin.left, y + s.margin.top,
 				x + w - s.margin.right, y + h - s.margin.bottom);
 
-			ctx.bgBrush->SetColor(s.bg);
-			ctx.rt->FillRoundedRectangle(D2D1::RoundedRect(bgRect, s.radius, s.radius), ctx.bgBrush);
+			ctx.draw->FillRoundedRect(bgRect, s.radius, s.bg);
 		}
 
-		// Set Brush to Foreground Color (Red in your config)
-		ctx.bgBrush->SetColor(s.fg); // Use s.fg instead of hardcoded/config logic for consistency
-		if (config.states.count("default") && config.states.at("default").has_bg) {
-			ctx.bgBrush->SetColor(config.states.at("default").bg);
+		// Bar color: foreground, unless a "default" state supplies a background
+		D2D1_COLOR_F barColor = s.fg;
+		if (config.styleIds.defaultState != NO_STYLE && GetStyle(config.styleIds.defaultState).has_bg) {
+			barColor = GetStyle(config.styleIds.defaultState).bg;
 		}
 
 		// Start drawing content inside padding
@@ -125,7 +126,7 @@ public:
 				float barX = startX + (i * (config.viz.thickness + barSpacing));
 
 				D2D1_RECT_F rect = D2D1::RectF(barX, barY, barX + config.viz.thickness, drawY + drawH);
-				ctx.rt->FillRectangle(rect, ctx.bgBrush);
+				ctx.draw->FillRect(rect, barColor);
 			}
 		}
 	}
@@ -144,6 +144,8 @@ public:
         if (worker.joinable()) worker.join();
     }
 
+    bool NeedsMeasure(RenderContext &ctx) override { return layoutDirty || needsUpdate; }
+
     float GetContentWidth(RenderContext &ctx) override {
         if (needsUpdate) {
             int code = weatherCode;
@@ -168,17 +170,13 @@ public:
             needsUpdate = false;
         }
 
-        Style s = GetEffectiveStyle();
-        IDWriteTextFormat *fmt = ctx.emojiFormat ? ctx.emojiFormat : ctx.textFormat;
-        IDWriteTextLayout *layout = GetLayout(ctx, cachedDisplayStr, fmt);
-
-        DWRITE_TEXT_METRICS m;
-        layout->GetMetrics(&m);
+        const Style &s = GetEffectiveStyle();
+        TextMetrics m = ctx.draw->MeasureString(cachedDisplayStr, DrawFont::Emoji);
         return m.width + s.padding.left + s.padding.right + s.margin.left + s.margin.right;
     }
 
     void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override {
-        Style s = GetEffectiveStyle();
+        const Style &s = GetEffectiveStyle();
         if (s.has_bg) {
             D2D1_RECT_F bgRect = D2D1::RectF(
                 x + s.margin.left,
@@ -186,26 +184,15 @@ public:
                 x + w - s.margin.right,
                 y + h - s.margin.bottom
             );
-            D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(bgRect, s.radius, s.radius);
-            ctx.bgBrush->SetColor(s.bg);
-            ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
+            ctx.draw->FillRoundedRect(bgRect, s.radius, s.bg);
         }
 
-        ctx.textBrush->SetColor(s.fg);
         D2D1_RECT_F textRect = D2D1::RectF(
             x + s.margin.left + s.padding.left,
             y + s.margin.top + s.padding.top,
             x + w - s.margin.right - s.padding.right,
             y + h - s.margin.bottom - s.padding.bottom
         );
-        IDWriteTextFormat *fmt = ctx.emojiFormat ? ctx.emojiFormat : ctx.textFormat;
-        ctx.rt->DrawTextW(
-            cachedDisplayStr.c_str(),
-            (UINT32)cachedDisplayStr.length(),
-            fmt,
-            textRect,
-            ctx.textBrush,
-            D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT
-        );
+        ctx.draw->DrawString(cachedDisplayStr, textRect, DrawFont::Emoji, s.fg, DRAW_TEXT_COLOR_FONT);
     }
 };
\ No newline at end of file
@@ -15,6 +15,12 @@ public:
 
     WorkspacesModule(const ModuleConfig &cfg) : Module(cfg) {}
 
+    // Active index follows the foreground window, which is resolved while measuring
+    bool NeedsMeasure(RenderContext &ctx) override { return true; }
+    bool NeedsPaint(RenderContext &ctx) override {
+        return paintDirty || activeIndex != paintedActive || hoveredIndex != paintedHovered;
+    }
+
     float GetContentWidth(RenderContext &ctx) override
     {
         if (ctx.workspaces) {
@@ -33,7 +39,7 @@ public:
 
         float totalWidth = 0.0f;
         for (int i = 0; i < count; i++) {
-            Style s = ResolveStyle(i);
+            const Style &s = ResolveStyle(i);
             float width = s.margin.left + s.padding.left + 20.0f + s.padding.right + s.margin.right;
             totalWidth += width;
         }
@@ -50,9 +56,11 @@ public:
     void RenderContent(RenderContext &ctx, float x, float y, float w, float h) override
     {
         float cursor = (ctx.isVertical) ? y : x;
+        paintedActive = activeIndex;
+        paintedHovered = hoveredIndex;
 
         for (int i = 0; i < count; i++) {
-            Style s = ResolveStyle(i);
+            const Style &s = ResolveStyle(i);
 
             float padL = s.padding.left;
             float padR = s.padding.right;
@@ -79,26 +87,13 @@ public:
             }
 
             if (s.has_bg || s.has_border || i == activeIndex || i == hoveredIndex) {
-                D2D1_ROUNDED_RECT rounded = D2D1::RoundedRect(boxRect, s.radius, s.radius);
-
-                if (s.has_bg) {
-                    ctx.bgBrush->SetColor(s.bg);
-                    ctx.rt->FillRoundedRectangle(rounded, ctx.bgBrush);
-                }
-                if (s.has_border && s.borderWidth > 0.0f) {
-                    ctx.bgBrush->SetColor(s.borderColor);
-                    ctx.rt->DrawRoundedRectangle(rounded, ctx.bgBrush, s.borderWidth);
-                }
+                if (s.has_bg) ctx.draw->FillRoundedRect(boxRect, s.radius, s.bg);
+                if (s.has_border && s.borderWidth > 0.0f) ctx.draw->StrokeRoundedRect(boxRect, s.radius, s.borderColor, s.borderWidth);
             }
 
             wchar_t buf[4];
             swprintf_s(buf, L"%d", i + 1);
-
-            ctx.textBrush->SetColor(s.fg);
-            IDWriteTextFormat *fmt = (s.font_weight == "bold") ? ctx.boldTextFormat : ctx.textFormat;
-            fmt->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-            fmt->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
-            ctx.rt->DrawTextW(buf, (UINT32)wcslen(buf), fmt, boxRect, ctx.textBrush);
+            ctx.draw->DrawString(buf, boxRect, FontFor(s), s.fg);
             cursor += layoutStep;
         }
     }
@@ -107,14 +102,11 @@ public:
     void SetHoveredIndex(int index) { hoveredIndex = index; }
 
 private:
-    Style ResolveStyle(int i) {
-        Style s = config.itemStyle; // Base
-        if (i == activeIndex && config.states.count("active")) {
-            s = s.Merge(config.states.at("active"));
-        }
-        if (i == hoveredIndex && config.states.count("hover")) {
-            s = s.Merge(config.states.at("hover"));
-        }
-        return s;
+    int paintedActive = -1;
+    int paintedHovered = -1;
+
+    const Style &ResolveStyle(int i) const {
+        int state = (i == activeIndex ? 1 : 0) | (i == hoveredIndex ? 2 : 0);
+        return GetStyle(config.styleIds.item[state]);
     }
 };
\ No newline at end of file
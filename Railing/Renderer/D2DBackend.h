@@ -0,0 +1,275 @@
+#pragma once
+#include <d2d1_1.h>
+#include <dwrite.h>
+#include "DrawingBackend.h"
+#include "TextLayoutCache.h"
+
+/// <summary>
+/// A text format as the backend first saw it. Layouts are shared between bars
+/// by `id`, so they take the alignment recorded here rather than whatever the
+/// format object says now (flyouts realign the bar's formats while drawing).
+/// </summary>
+struct DWriteFormat {
+    IDWriteTextFormat *format = nullptr;
+    uint32_t id = 0; // TextLayoutCache::FormatId
+    DWRITE_TEXT_ALIGNMENT textAlignment = DWRITE_TEXT_ALIGNMENT_LEADING;
+    DWRITE_PARAGRAPH_ALIGNMENT paragraphAlignment = DWRITE_PARAGRAPH_ALIGNMENT_NEAR;
+    DWRITE_WORD_WRAPPING wordWrapping = DWRITE_WORD_WRAPPING_WRAP;
+
+    static DWriteFormat Describe(IDWriteTextFormat *format, TextLayoutCache &cache) {
+        DWriteFormat bound;
+        bound.format = format;
+        if (!format) return bound;
+        bound.textAlignment = format->GetTextAlignment();
+        bound.paragraphAlignment = format->GetParagraphAlignment();
+        bound.wordWrapping = format->GetWordWrapping();
+
+        TextFormatDesc desc;
+        desc.family.resize(format->GetFontFamilyNameLength() + 1);
+        format->GetFontFamilyName(desc.family.data(), (UINT32)desc.family.size());
+        desc.family.resize(desc.family.size() - 1);
+        desc.locale.resize(format->GetLocaleNameLength() + 1);
+        format->GetLocaleName(desc.locale.data(), (UINT32)desc.locale.size());
+        desc.locale.resize(desc.locale.size() - 1);
+        desc.size = format->GetFontSize();
+        desc.weight = format->GetFontWeight();
+        desc.style = format->GetFontStyle();
+        desc.stretch = format->GetFontStretch();
+        desc.textAlignment = bound.textAlignment;
+        desc.paragraphAlignment = bound.paragraphAlignment;
+        desc.wordWrapping = bound.wordWrapping;
+        bound.id = cache.FormatId(desc);
+        return bound;
+    }
+};
+
+/// <summary>
+/// Shapes text into IDWriteTextLayouts for the shared TextLayoutCache.
+/// </summary>
+class DWriteShaper : public TextShaper
+{
+public:
+    void Bind(IDWriteFactory *factory) { writeFactory = factory; }
+
+    // `format` is a DWriteFormat
+    bool Shape(std::wstring_view text, const void *format, float maxWidth, float maxHeight, ShapedText &out) override {
+        const DWriteFormat *bound = static_cast<const DWriteFormat *>(format);
+        if (!writeFactory || !bound || !bound->format) return false;
+
+        IDWriteTextLayout *layout = nullptr;
+        if (FAILED(writeFactory->CreateTextLayout(text.data(), (UINT32)text.length(), bound->format,
+            maxWidth > 0.0f ? maxWidth : 0.0f, maxHeight > 0.0f ? maxHeight : 0.0f, &layout))) return false;
+        layout->SetTextAlignment(bound->textAlignment);
+        layout->SetParagraphAlignment(bound->paragraphAlignment);
+        layout->SetWordWrapping(bound->wordWrapping);
+
+        DWRITE_TEXT_METRICS metrics;
+        if (SUCCEEDED(layout->GetMetrics(&metrics))) {
+            out.metrics.width = metrics.width;
+            out.metrics.height = metrics.height;
+            out.metrics.advance = metrics.widthIncludingTrailingWhitespace;
+        }
+        out.layout = layout;
+        // Rough footprint: layout object plus per-cluster glyph runs
+        out.bytes = 512 + text.length() * 64;
+        return true;
+    }
+
+    void Release(void *layout) override { static_cast<IDWriteTextLayout *>(layout)->Release(); }
+
+private:
+    IDWriteFactory *writeFactory = nullptr;
+};
+
+/// <summary>
+/// DrawingBackend over a Direct2D render target. Non-owning: the renderer
+/// keeps the target, brush and text formats alive and rebinds after device loss.
+/// </summary>
+class D2DBackend : public DrawingBackend
+{
+public:
+    // Cached layouts release through our shaper, drop them before it goes away
+    ~D2DBackend() override { layouts->EvictShaper(&shaper); }
+
+    void Bind(ID2D1RenderTarget *target, ID2D1SolidColorBrush *solidBrush, IDWriteFactory *factory) {
+        rt = target;
+        brush = solidBrush;
+        shaper.Bind(factory);
+        hasBrushColor = false; // Brush may have been recolored outside the backend
+    }
+    void SetFormat(DrawFont font, IDWriteTextFormat *format) {
+        DWriteFormat &bound = formats[(int)font];
+        if (bound.format != format) bound = DWriteFormat::Describe(format, *layouts);
+    }
+
+    // Device lost: images handed out so far belong to the old device
+    void DiscardResources() { epoch++; }
+
+    void SetLayoutCache(TextLayoutCache *cache) {
+        layouts->EvictShaper(&shaper);
+        layouts = cache;
+        for (DWriteFormat &bound : formats) bound = DWriteFormat::Describe(bound.format, *layouts); // Ids are per cache
+    }
+
+    size_t colorChanges = 0; // Brush SetColor calls actually issued
+
+    void Clear(const DrawColor &color) override { rt->Clear(ToColor(color)); }
+    void PushClip(const DrawRect &rect) override { rt->PushAxisAlignedClip(ToRect(rect), D2D1_ANTIALIAS_MODE_ALIASED); }
+    void PopClip() override { rt->PopAxisAlignedClip(); }
+
+    void FillRect(const DrawRect &rect, const DrawColor &color) override {
+        UseColor(color);
+        rt->FillRectangle(ToRect(rect), brush);
+    }
+
+    void StrokeRect(const DrawRect &rect, const DrawColor &color, float strokeWidth) override {
+        UseColor(color);
+        rt->DrawRectangle(ToRect(rect), brush, strokeWidth);
+    }
+
+    void FillRoundedRect(const DrawRect &rect, float radius, const DrawColor &color) override {
+        UseColor(color);
+        rt->FillRoundedRectangle(D2D1::RoundedRect(ToRect(rect), radius, radius), brush);
+    }
+
+    void StrokeRoundedRect(const DrawRect &rect, float radius, const DrawColor &color, float strokeWidth) override {
+        UseColor(color);
+        rt->DrawRoundedRectangle(D2D1::RoundedRect(ToRect(rect), radius, radius), brush, strokeWidth);
+    }
+
+    void FillEllipse(float cx, float cy, float rx, float ry, const DrawColor &color) override {
+        UseColor(color);
+        rt->FillEllipse(D2D1::Ellipse(D2D1::Point2F(cx, cy), rx, ry), brush);
+    }
+
+    void DrawImage(const ImageRef &image, const DrawRect &dest, float opacity = 1.0f) override {
+        if (!image.native) return; // Pixel-only images are a software backend concern
+        rt->DrawBitmap(static_cast<ID2D1Bitmap *>(image.native), ToRect(dest), opacity);
+    }
+
+    void DrawString(const std::wstring &text, const DrawRect &rect, DrawFont font, const DrawColor &color, unsigned flags = DRAW_TEXT_NONE) override {
+        const DWriteFormat &fmt = GetFormat(font);
+        if (!fmt.format || text.empty()) return;
+
+        D2D1_DRAW_TEXT_OPTIONS options = D2D1_DRAW_TEXT_OPTIONS_NONE;
+        if (flags & DRAW_TEXT_CLIP) options |= D2D1_DRAW_TEXT_OPTIONS_CLIP;
+        if (flags & DRAW_TEXT_COLOR_FONT) options |= D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT;
+
+        // Layout box is the text rect, so alignment matches DrawText
+        const ShapedText *shaped = layouts->Get(shaper, text, fmt.id, &fmt, rect.Width(), rect.Height());
+        if (!shaped) return;
+
+        UseColor(color);
+        rt->DrawTextLayout(D2D1::Point2F(rect.left, rect.top), static_cast<IDWriteTextLayout *>(shaped->layout), brush, options);
+    }
+
+    void DrawMask(const ImageRef &mask, const DrawRect &src, const DrawRect &dest, const DrawColor &color) override {
+        if (!mask.native) return;
+        ID2D1Bitmap *bitmap = static_cast<ID2D1Bitmap *>(mask.native);
+
+        // Source rects are in mask pixels, D2D wants the bitmap's DIPs
+        float dpiX, dpiY;
+        bitmap->GetDpi(&dpiX, &dpiY);
+        float sx = 96.0f / dpiX, sy = 96.0f / dpiY;
+        D2D1_RECT_F srcRect = D2D1::RectF(src.left * sx, src.top * sy, src.right * sx, src.bottom * sy);
+        D2D1_RECT_F destRect = ToRect(dest);
+
+        UseColor(color);
+        D2D1_ANTIALIAS_MODE previous = rt->GetAntialiasMode();
+        rt->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED); // Required by FillOpacityMask
+        rt->FillOpacityMask(bitmap, brush, D2D1_OPACITY_MASK_CONTENT_TEXT_GRAYSCALE, &destRect, &srcRect);
+        rt->SetAntialiasMode(previous);
+    }
+
+    TextMetrics MeasureString(const std::wstring &text, DrawFont font) override {
+        const DWriteFormat &fmt = GetFormat(font);
+        if (!fmt.format) return {};
+
+        const ShapedText *shaped = layouts->Get(shaper, text, fmt.id, &fmt, 1000.0f, 1000.0f);
+        return shaped ? shaped->metrics : TextMetrics{};
+    }
+
+    float GetFontSize(DrawFont font) const override {
+        const DWriteFormat &fmt = GetFormat(font);
+        return fmt.format ? fmt.format->GetFontSize() : 0.0f;
+    }
+
+    ImageRef CreateTextMask(const std::vector<MaskCell> &cells, DrawFont font, int pixelWidth, int pixelHeight, float scale) override {
+        ImageRef image;
+        ID2D1DeviceContext *dc = nullptr;
+        if (!rt || pixelWidth <= 0 || pixelHeight <= 0 || FAILED(rt->QueryInterface(&dc))) return image;
+
+        float dpi = 96.0f * scale;
+        D2D1_BITMAP_PROPERTIES1 props = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET,
+            D2D1::PixelFormat(DXGI_FORMAT_A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpi, dpi);
+        ID2D1Bitmap1 *bitmap = nullptr;
+        if (SUCCEEDED(dc->CreateBitmap(D2D1::SizeU(pixelWidth, pixelHeight), nullptr, 0, props, &bitmap))) {
+            // Render offscreen, then hand the context back as the frame left it
+            ID2D1Image *previousTarget = nullptr;
+            dc->GetTarget(&previousTarget);
+            float previousDpiX, previousDpiY;
+            dc->GetDpi(&previousDpiX, &previousDpiY);
+            D2D1_MATRIX_3X2_F previousTransform;
+            dc->GetTransform(&previousTransform);
+            D2D1_TEXT_ANTIALIAS_MODE previousTextMode = dc->GetTextAntialiasMode();
+
+            dc->SetTarget(bitmap);
+            dc->SetDpi(dpi, dpi);
+            dc->SetTransform(D2D1::Matrix3x2F::Identity());
+            dc->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE); // ClearType needs an RGB target
+            dc->BeginDraw();
+            dc->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+            for (const MaskCell &cell : cells) DrawString(cell.text, cell.rect, font, DrawColor(1.0f, 1.0f, 1.0f, 1.0f));
+            HRESULT hr = dc->EndDraw();
+
+            dc->SetTarget(previousTarget);
+            dc->SetDpi(previousDpiX, previousDpiY);
+            dc->SetTransform(previousTransform);
+            dc->SetTextAntialiasMode(previousTextMode);
+            if (previousTarget) previousTarget->Release();
+
+            if (SUCCEEDED(hr)) {
+                image.native = bitmap;
+                image.width = pixelWidth;
+                image.height = pixelHeight;
+            }
+            else bitmap->Release();
+        }
+        dc->Release();
+        return image;
+    }
+
+    void ReleaseImage(ImageRef &image) override {
+        if (image.native) static_cast<ID2D1Bitmap *>(image.native)->Release();
+        image = ImageRef();
+    }
+
+    uint32_t GetResourceEpoch() const override { return epoch; }
+
+private:
+    ID2D1RenderTarget *rt = nullptr;
+    ID2D1SolidColorBrush *brush = nullptr;
+    DWriteShaper shaper;
+    TextLayoutCache *layouts = &TextLayoutCache::Shared();
+    DWriteFormat formats[(int)DrawFont::Count];
+    DrawColor brushColor;
+    bool hasBrushColor = false;
+    uint32_t epoch = 0;
+
+    // Consecutive primitives of one color (coalesced display lists) share a SetColor
+    void UseColor(const DrawColor &color) {
+        if (hasBrushColor && color == brushColor) return;
+        brush->SetColor(ToColor(color));
+        brushColor = color;
+        hasBrushColor = true;
+        colorChanges++;
+    }
+
+    const DWriteFormat &GetFormat(DrawFont font) const {
+        const DWriteFormat &fmt = formats[(int)font];
+        return fmt.format ? fmt : formats[(int)DrawFont::Text];
+    }
+
+    static D2D1_COLOR_F ToColor(const DrawColor &c) { return D2D1::ColorF(c.r, c.g, c.b, c.a); }
+    static D2D1_RECT_F ToRect(const DrawRect &r) { return D2D1::RectF(r.left, r.top, r.right, r.bottom); }
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include "LayoutEngine.h"
+
+// Platform-neutral dirty region bookkeeping. Rects are collected in logical
+// (DIP) units during a frame, merged into a small set, and converted to device
+// pixels for the partial present.
+
+struct DamagePixelRect {
+    int left = 0, top = 0, right = 0, bottom = 0;
+};
+
+class DamageTracker
+{
+public:
+    static constexpr size_t MAX_RECTS = 8;
+
+    /// <summary>
+    /// Mark the whole surface dirty (first frame, resize, device loss, reload).
+    /// </summary>
+    void InvalidateAll() { fullFrame = true; rects.clear(); }
+
+    bool IsFullFrame() const { return fullFrame; }
+    bool IsEmpty() const { return !fullFrame && rects.empty(); }
+    const std::vector<LayoutRect> &GetRects() const { return rects; }
+
+    /// <summary>
+    /// Add a dirty rect. Overlapping or touching rects are merged; past
+    /// MAX_RECTS everything collapses into the bounding box.
+    /// </summary>
+    void Add(const LayoutRect &r) {
+        if (fullFrame || r.right <= r.left || r.bottom <= r.top) return;
+
+        LayoutRect merged = r;
+        bool absorbed = true;
+        while (absorbed) { // Merging can make the rect touch others, so repeat
+            absorbed = false;
+            for (size_t i = 0; i < rects.size(); i++) {
+                if (Touches(rects[i], merged)) {
+                    merged = Union(rects[i], merged);
+                    rects.erase(rects.begin() + i);
+                    absorbed = true;
+                    break;
+                }
+            }
+        }
+        rects.push_back(merged);
+
+        if (rects.size() > MAX_RECTS) {
+            LayoutRect bounds = rects[0];
+            for (const auto &x : rects) bounds = Union(bounds, x);
+            rects.assign(1, bounds);
+        }
+    }
+
+    /// <summary>
+    /// Finish the frame's region: clamp to the surface, and promote to a full
+    /// frame when the dirty area covers most of it anyway.
+    /// </summary>
+    /// <param name="width">Surface width (logical)</param>
+    /// <param name="height">Surface height (logical)</param>
+    void Resolve(float width, float height) {
+        if (fullFrame) return;
+
+        float area = 0.0f;
+        for (auto &r : rects) {
+            if (r.left < 0.0f) r.left = 0.0f;
+            if (r.top < 0.0f) r.top = 0.0f;
+            if (r.right > width) r.right = width;
+            if (r.bottom > height) r.bottom = height;
+            area += r.Width() * r.Height();
+        }
+        if (width > 0.0f && height > 0.0f && area >= width * height * 0.75f) InvalidateAll();
+    }
+
+    /// <summary>
+    /// Convert to device pixels, rounded outwards and padded by a pixel so
+    /// anti-aliased edges are included.
+    /// </summary>
+    std::vector<DamagePixelRect> ToPixels(float scale, int surfaceW, int surfaceH) const {
+        std::vector<DamagePixelRect> out;
+        if (fullFrame) {
+            out.push_back({ 0, 0, surfaceW, surfaceH });
+            return out;
+        }
+        for (const auto &r : rects) {
+            DamagePixelRect p;
+            p.left = (int)std::floor(r.left * scale) - 1;
+            p.top = (int)std::floor(r.top * scale) - 1;
+            p.right = (int)std::ceil(r.right * scale) + 1;
+            p.bottom = (int)std::ceil(r.bottom * scale) + 1;
+            if (p.left < 0) p.left = 0;
+            if (p.top < 0) p.top = 0;
+            if (p.right > surfaceW) p.right = surfaceW;
+            if (p.bottom > surfaceH) p.bottom = surfaceH;
+            if (p.right > p.left && p.bottom > p.top) out.push_back(p);
+        }
+        return out;
+    }
+
+    void Reset() { fullFrame = false; rects.clear(); }
+
+    static bool Intersects(const LayoutRect &a, const LayoutRect &b) {
+        return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+
+private:
+    bool fullFrame = true;
+    std::vector<LayoutRect> rects;
+
+    static bool Touches(const LayoutRect &a, const LayoutRect &b) {
+        return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+    }
+
+    static LayoutRect Union(const LayoutRect &a, const LayoutRect &b) {
+        return {
+            a.left < b.left ? a.left : b.left,
+            a.top < b.top ? a.top : b.top,
+            a.right > b.right ? a.right : b.right,
+            a.bottom > b.bottom ? a.bottom : b.bottom
+        };
+    }
+};
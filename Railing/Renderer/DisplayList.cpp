@@ -0,0 +1,306 @@
+#include "DisplayList.h"
+
+void DisplayList::Begin(DrawingBackend *measureTarget)
+{
+    Reset();
+    measure = measureTarget;
+}
+
+void DisplayList::End()
+{
+    Optimize();
+    measure = nullptr;
+    recorded = true;
+}
+
+void DisplayList::Reset()
+{
+    commands.clear(); // Keeps capacity, re-recording doesn't reallocate
+    images.clear();
+    sources.clear();
+    strings.clear();
+    recorded = false;
+}
+
+/* RECORDING */
+
+void DisplayList::Clear(const DrawColor &color)
+{
+    DrawCommand c;
+    c.op = DrawOp::Clear;
+    c.color = color;
+    commands.push_back(c);
+}
+
+void DisplayList::PushClip(const DrawRect &rect)
+{
+    DrawCommand c;
+    c.op = DrawOp::PushClip;
+    c.rect = rect;
+    commands.push_back(c);
+}
+
+void DisplayList::PopClip()
+{
+    DrawCommand c;
+    c.op = DrawOp::PopClip;
+    commands.push_back(c);
+}
+
+void DisplayList::FillRect(const DrawRect &rect, const DrawColor &color)
+{
+    DrawCommand c;
+    c.op = DrawOp::FillRect;
+    c.rect = rect;
+    c.color = color;
+    commands.push_back(c);
+}
+
+void DisplayList::StrokeRect(const DrawRect &rect, const DrawColor &color, float strokeWidth)
+{
+    DrawCommand c;
+    c.op = DrawOp::StrokeRect;
+    c.rect = rect;
+    c.color = color;
+    c.stroke = strokeWidth;
+    commands.push_back(c);
+}
+
+void DisplayList::FillRoundedRect(const DrawRect &rect, float radius, const DrawColor &color)
+{
+    DrawCommand c;
+    c.op = DrawOp::FillRoundedRect;
+    c.rect = rect;
+    c.radius = radius;
+    c.color = color;
+    commands.push_back(c);
+}
+
+void DisplayList::StrokeRoundedRect(const DrawRect &rect, float radius, const DrawColor &color, float strokeWidth)
+{
+    DrawCommand c;
+    c.op = DrawOp::StrokeRoundedRect;
+    c.rect = rect;
+    c.radius = radius;
+    c.color = color;
+    c.stroke = strokeWidth;
+    commands.push_back(c);
+}
+
+void DisplayList::FillEllipse(float cx, float cy, float rx, float ry, const DrawColor &color)
+{
+    DrawCommand c;
+    c.op = DrawOp::FillEllipse;
+    c.rect = DrawRect(cx - rx, cy - ry, cx + rx, cy + ry);
+    c.color = color;
+    commands.push_back(c);
+}
+
+void DisplayList::DrawImage(const ImageRef &image, const DrawRect &dest, float opacity)
+{
+    DrawCommand c;
+    c.op = DrawOp::DrawImage;
+    c.rect = dest;
+    c.stroke = opacity;
+    c.payload = (uint32_t)images.size();
+    images.push_back(image);
+    sources.push_back(DrawRect());
+    commands.push_back(c);
+}
+
+void DisplayList::DrawMask(const ImageRef &mask, const DrawRect &src, const DrawRect &dest, const DrawColor &color)
+{
+    DrawCommand c;
+    c.op = DrawOp::DrawMask;
+    c.rect = dest;
+    c.color = color;
+    c.payload = (uint32_t)images.size();
+    images.push_back(mask);
+    sources.push_back(src);
+    commands.push_back(c);
+}
+
+void DisplayList::DrawString(const std::wstring &text, const DrawRect &rect, DrawFont font, const DrawColor &color, unsigned flags)
+{
+    DrawCommand c;
+    c.op = DrawOp::DrawString;
+    c.rect = rect;
+    c.font = font;
+    c.flags = (uint16_t)flags;
+    c.color = color;
+    c.payload = (uint32_t)strings.size();
+    strings.push_back(text);
+    commands.push_back(c);
+}
+
+TextMetrics DisplayList::MeasureString(const std::wstring &text, DrawFont font)
+{
+    return measure ? measure->MeasureString(text, font) : TextMetrics{};
+}
+
+float DisplayList::GetFontSize(DrawFont font) const
+{
+    return measure ? measure->GetFontSize(font) : 0.0f;
+}
+
+ImageRef DisplayList::CreateTextMask(const std::vector<MaskCell> &cells, DrawFont font, int pixelWidth, int pixelHeight, float scale)
+{
+    return measure ? measure->CreateTextMask(cells, font, pixelWidth, pixelHeight, scale) : ImageRef();
+}
+
+void DisplayList::ReleaseImage(ImageRef &image)
+{
+    if (measure) measure->ReleaseImage(image);
+    else image = ImageRef();
+}
+
+uint32_t DisplayList::GetResourceEpoch() const
+{
+    return measure ? measure->GetResourceEpoch() : 0;
+}
+
+/* OPTIMIZER */
+
+bool DisplayList::IsBarrier(const DrawCommand &c)
+{
+    switch (c.op) {
+    case DrawOp::Clear:
+    case DrawOp::PushClip:
+    case DrawOp::PopClip:
+        return true;
+    case DrawOp::DrawString:
+        return !(c.flags & DRAW_TEXT_CLIP); // Unclipped glyphs can spill past the box
+    default:
+        return false;
+    }
+}
+
+bool DisplayList::HasColor(const DrawCommand &c)
+{
+    return c.op != DrawOp::DrawImage && !IsBarrier(c);
+}
+
+DrawRect DisplayList::Bounds(const DrawCommand &c)
+{
+    // Pad by the stroke overhang plus a pixel of anti-aliasing
+    float pad = 1.0f;
+    if (c.op == DrawOp::StrokeRect || c.op == DrawOp::StrokeRoundedRect) pad += c.stroke / 2.0f;
+    return DrawRect(c.rect.left - pad, c.rect.top - pad, c.rect.right + pad, c.rect.bottom + pad);
+}
+
+bool DisplayList::Overlaps(const DrawRect &a, const DrawRect &b)
+{
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+bool DisplayList::TryMerge(DrawCommand &into, const DrawCommand &next)
+{
+    if (into.op != DrawOp::FillRect || next.op != DrawOp::FillRect || into.color != next.color) return false;
+
+    const DrawRect &a = into.rect;
+    const DrawRect &b = next.rect;
+    bool sameRows = a.top == b.top && a.bottom == b.bottom;
+    bool sameCols = a.left == b.left && a.right == b.right;
+
+    // Only edge-sharing rects: the union covers exactly the same pixels once
+    if (sameRows && (a.right == b.left || b.right == a.left)) {
+        into.rect = DrawRect(a.left < b.left ? a.left : b.left, a.top, a.right > b.right ? a.right : b.right, a.bottom);
+        return true;
+    }
+    if (sameCols && (a.bottom == b.top || b.bottom == a.top)) {
+        into.rect = DrawRect(a.left, a.top < b.top ? a.top : b.top, a.right, a.bottom > b.bottom ? a.bottom : b.bottom);
+        return true;
+    }
+    return false;
+}
+
+void DisplayList::Optimize()
+{
+    reorderedCount = 0;
+    mergedCount = 0;
+    droppedCount = 0;
+
+    // 1. Drop primitives that can't produce pixels
+    size_t out = 0;
+    for (size_t i = 0; i < commands.size(); i++) {
+        const DrawCommand &c = commands[i];
+        bool emptyRect = c.rect.right < c.rect.left || c.rect.bottom < c.rect.top;
+        if (c.op == DrawOp::PushClip && emptyRect) {
+            // Nothing inside an empty clip shows: drop it with everything up to its PopClip
+            size_t depth = 1;
+            for (i++; i < commands.size(); i++) {
+                droppedCount++;
+                if (commands[i].op == DrawOp::PushClip) depth++;
+                else if (commands[i].op == DrawOp::PopClip && --depth == 0) break;
+            }
+            droppedCount++;
+            continue;
+        }
+        bool invisible = HasColor(c) && c.color.a <= 0.0f;
+        bool empty = c.op != DrawOp::PushClip && c.op != DrawOp::PopClip && c.op != DrawOp::Clear && emptyRect;
+        bool noImage = (c.op == DrawOp::DrawImage || c.op == DrawOp::DrawMask) && images[c.payload].IsEmpty();
+        if (invisible || empty || noImage) {
+            droppedCount++;
+            continue;
+        }
+        commands[out++] = c;
+    }
+    commands.resize(out);
+
+    // 2. Hoist each colored primitive back to the last one sharing its color,
+    //    provided nothing it jumps over overlaps it
+    for (size_t i = 1; i < commands.size(); i++) {
+        if (!HasColor(commands[i])) continue;
+        DrawRect bounds = Bounds(commands[i]);
+
+        size_t limit = i > REORDER_WINDOW ? i - REORDER_WINDOW : 0;
+        for (size_t j = i; j-- > limit;) {
+            const DrawCommand &prev = commands[j];
+            if (HasColor(prev) && prev.color == commands[i].color) {
+                if (j + 1 != i) {
+                    DrawCommand moving = commands[i];
+                    commands.erase(commands.begin() + i);
+                    commands.insert(commands.begin() + j + 1, moving);
+                    reorderedCount++;
+                }
+                break;
+            }
+            if (IsBarrier(prev) || Overlaps(Bounds(prev), bounds)) break;
+        }
+    }
+
+    // 3. Merge runs of fills that share an edge
+    out = 0;
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (out > 0 && TryMerge(commands[out - 1], commands[i])) {
+            mergedCount++;
+            continue;
+        }
+        commands[out++] = commands[i];
+    }
+    commands.resize(out);
+}
+
+/* REPLAY */
+
+void DisplayList::Replay(DrawingBackend &target) const
+{
+    for (const DrawCommand &c : commands) {
+        switch (c.op) {
+        case DrawOp::Clear: target.Clear(c.color); break;
+        case DrawOp::PushClip: target.PushClip(c.rect); break;
+        case DrawOp::PopClip: target.PopClip(); break;
+        case DrawOp::FillRect: target.FillRect(c.rect, c.color); break;
+        case DrawOp::StrokeRect: target.StrokeRect(c.rect, c.color, c.stroke); break;
+        case DrawOp::FillRoundedRect: target.FillRoundedRect(c.rect, c.radius, c.color); break;
+        case DrawOp::StrokeRoundedRect: target.StrokeRoundedRect(c.rect, c.radius, c.color, c.stroke); break;
+        case DrawOp::FillEllipse:
+            target.FillEllipse((c.rect.left + c.rect.right) / 2.0f, (c.rect.top + c.rect.bottom) / 2.0f,
+                c.rect.Width() / 2.0f, c.rect.Height() / 2.0f, c.color);
+            break;
+        case DrawOp::DrawImage: target.DrawImage(images[c.payload], c.rect, c.stroke); break;
+        case DrawOp::DrawMask: target.DrawMask(images[c.payload], sources[c.payload], c.rect, c.color); break;
+        case DrawOp::DrawString: target.DrawString(strings[c.payload], c.rect, c.font, c.color, c.flags); break;
+        }
+    }
+}
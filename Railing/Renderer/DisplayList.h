@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "DrawingBackend.h"
+
+// Compact recorded command buffer. A DisplayList is itself a DrawingBackend:
+// point ctx.draw at it, let the module render, then Optimize() and Replay()
+// onto the real backend - frame after frame while the module's inputs hold.
+
+enum class DrawOp : uint8_t {
+    Clear, PushClip, PopClip,
+    FillRect, StrokeRect, FillRoundedRect, StrokeRoundedRect, FillEllipse,
+    DrawImage, DrawMask, DrawString
+};
+
+struct DrawCommand {
+    DrawOp op = DrawOp::FillRect;
+    DrawFont font = DrawFont::Text;
+    uint16_t flags = 0;
+    DrawColor color;
+    DrawRect rect;          // Geometry, image destination, text box, or ellipse bounds
+    float radius = 0.0f;
+    float stroke = 0.0f;    // Stroke width, or opacity for images
+    uint32_t payload = 0;   // String or image (and mask source) index
+};
+
+class DisplayList : public DrawingBackend
+{
+public:
+    /// <summary>
+    /// Start recording. Measurement calls made while recording are forwarded
+    /// to `measureTarget` (the live backend).
+    /// </summary>
+    void Begin(DrawingBackend *measureTarget);
+    /// <summary>
+    /// Finish recording and optimize. The list is replayable until Reset().
+    /// </summary>
+    void End();
+    void Reset();
+
+    bool IsRecorded() const { return recorded; }
+    size_t Size() const { return commands.size(); }
+    const std::vector<DrawCommand> &GetCommands() const { return commands; }
+
+    /// <summary>
+    /// Reorder same-colored primitives next to each other where no
+    /// overlapping command sits between them, then merge adjacent fills.
+    /// Painter's order is preserved for anything that overlaps.
+    /// </summary>
+    void Optimize();
+
+    void Replay(DrawingBackend &target) const;
+
+    // Optimizer results of the last Optimize() call
+    size_t reorderedCount = 0;
+    size_t mergedCount = 0;
+    size_t droppedCount = 0;
+
+    // DrawingBackend (recording)
+    void Clear(const DrawColor &color) override;
+    void PushClip(const DrawRect &rect) override;
+    void PopClip() override;
+    void FillRect(const DrawRect &rect, const DrawColor &color) override;
+    void StrokeRect(const DrawRect &rect, const DrawColor &color, float strokeWidth) override;
+    void FillRoundedRect(const DrawRect &rect, float radius, const DrawColor &color) override;
+    void StrokeRoundedRect(const DrawRect &rect, float radius, const DrawColor &color, float strokeWidth) override;
+    void FillEllipse(float cx, float cy, float rx, float ry, const DrawColor &color) override;
+    void DrawImage(const ImageRef &image, const DrawRect &dest, float opacity = 1.0f) override;
+    void DrawString(const std::wstring &text, const DrawRect &rect, DrawFont font, const DrawColor &color, unsigned flags = DRAW_TEXT_NONE) override;
+    void DrawMask(const ImageRef &mask, const DrawRect &src, const DrawRect &dest, const DrawColor &color) override;
+
+    // Resource calls go straight to the live backend
+    TextMetrics MeasureString(const std::wstring &text, DrawFont font) override;
+    float GetFontSize(DrawFont font) const override;
+    ImageRef CreateTextMask(const std::vector<MaskCell> &cells, DrawFont font, int pixelWidth, int pixelHeight, float scale) override;
+    void ReleaseImage(ImageRef &image) override;
+    uint32_t GetResourceEpoch() const override;
+
+private:
+    std::vector<DrawCommand> commands;
+    std::vector<ImageRef> images;
+    std::vector<DrawRect> sources; // Mask source rects, parallel to images
+    std::vector<std::wstring> strings;
+    DrawingBackend *measure = nullptr;
+    bool recorded = false;
+
+    // Window the optimizer searches back for a same-colored partner
+    static constexpr size_t REORDER_WINDOW = 16;
+
+    static bool IsBarrier(const DrawCommand &c);
+    static bool HasColor(const DrawCommand &c);
+    static DrawRect Bounds(const DrawCommand &c);
+    static bool Overlaps(const DrawRect &a, const DrawRect &b);
+    static bool TryMerge(DrawCommand &into, const DrawCommand &next);
+};
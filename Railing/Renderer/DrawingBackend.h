@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Drawing interface modules render through. Kept free of platform headers so
+// backends (Direct2D on Windows, the software rasterizer anywhere) can be
+// swapped without touching module code.
+
+struct DrawColor {
+    float r = 0.0f, g = 0.0f, b = 0.0f, a = 1.0f;
+
+    DrawColor() = default;
+    DrawColor(float r, float g, float b, float a = 1.0f) : r(r), g(g), b(b), a(a) {}
+    // Any {r,g,b,a} struct (D2D1_COLOR_F) converts without pulling in d2d1.h
+    template <typename C> requires requires(const C &c) { c.r; c.g; c.b; c.a; }
+    DrawColor(const C &c) : r(c.r), g(c.g), b(c.b), a(c.a) {}
+
+    bool operator==(const DrawColor &o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+    bool operator!=(const DrawColor &o) const { return !(*this == o); }
+};
+
+struct DrawRect {
+    float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+
+    DrawRect() = default;
+    DrawRect(float l, float t, float r, float b) : left(l), top(t), right(r), bottom(b) {}
+    // Any {left,top,right,bottom} struct (D2D1_RECT_F, LayoutRect)
+    template <typename R> requires requires(const R &rc) { rc.left; rc.top; rc.right; rc.bottom; }
+    DrawRect(const R &rc) : left(rc.left), top(rc.top), right(rc.right), bottom(rc.bottom) {}
+
+    float Width() const { return right - left; }
+    float Height() const { return bottom - top; }
+};
+
+/// <summary>
+/// Backend-neutral image handle. The Direct2D backend draws `native`
+/// (an ID2D1Bitmap*); software backends read the premultiplied BGRA pixels.
+/// </summary>
+struct ImageRef {
+    void *native = nullptr;
+    const uint32_t *pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0; // In pixels
+
+    ImageRef() = default;
+    explicit ImageRef(void *nativeBitmap) : native(nativeBitmap) {}
+    bool IsEmpty() const { return !native && !pixels; }
+};
+
+// Text is drawn with one of the bar's shared formats, centered in its rect.
+enum class DrawFont : uint8_t { Text = 0, Bold, Icon, Emoji, Count };
+
+enum DrawTextFlags : unsigned {
+    DRAW_TEXT_NONE = 0,
+    DRAW_TEXT_CLIP = 1 << 0,        // Clip glyphs to the layout rect
+    DRAW_TEXT_COLOR_FONT = 1 << 1   // Color emoji glyphs
+};
+
+struct TextMetrics {
+    float width = 0.0f;
+    float height = 0.0f;
+    float advance = 0.0f; // Pen advance, including trailing whitespace
+};
+
+// A string rasterized into one cell of a text mask (logical units, mask-relative)
+struct MaskCell {
+    std::wstring text;
+    DrawRect rect;
+};
+
+class DrawingBackend
+{
+public:
+    virtual ~DrawingBackend() = default;
+
+    virtual void Clear(const DrawColor &color) = 0;
+    virtual void PushClip(const DrawRect &rect) = 0;
+    virtual void PopClip() = 0;
+
+    virtual void FillRect(const DrawRect &rect, const DrawColor &color) = 0;
+    virtual void StrokeRect(const DrawRect &rect, const DrawColor &color, float strokeWidth) = 0;
+    virtual void FillRoundedRect(const DrawRect &rect, float radius, const DrawColor &color) = 0;
+    virtual void StrokeRoundedRect(const DrawRect &rect, float radius, const DrawColor &color, float strokeWidth) = 0;
+    virtual void FillEllipse(float cx, float cy, float rx, float ry, const DrawColor &color) = 0;
+    virtual void DrawImage(const ImageRef &image, const DrawRect &dest, float opacity = 1.0f) = 0;
+    virtual void DrawString(const std::wstring &text, const DrawRect &rect, DrawFont font, const DrawColor &color, unsigned flags = DRAW_TEXT_NONE) = 0;
+
+    /// <summary>
+    /// Fill `color` through the alpha of `mask`, mapping `src` (mask pixels)
+    /// onto `dest`. Used to stamp pre-rasterized glyphs.
+    /// </summary>
+    virtual void DrawMask(const ImageRef &mask, const DrawRect &src, const DrawRect &dest, const DrawColor &color) = 0;
+
+    virtual TextMetrics MeasureString(const std::wstring &text, DrawFont font) = 0;
+    virtual float GetFontSize(DrawFont font) const = 0;
+
+    // Offscreen text masks (glyph atlases). Optional: a backend that can't
+    // render offscreen returns an empty image and callers draw text instead.
+    virtual ImageRef CreateTextMask(const std::vector<MaskCell> &, DrawFont, int, int, float) { return ImageRef(); }
+    virtual void ReleaseImage(ImageRef &image) { image = ImageRef(); }
+    // Bumped when device resources are lost; images created under an older epoch are gone
+    virtual uint32_t GetResourceEpoch() const { return 0; }
+};
@@ -0,0 +1,171 @@
+#include "GlyphAtlas.h"
+#include <cmath>
+
+/* ATLAS */
+
+bool GlyphAtlas::Prepare(DrawingBackend &backend, DrawFont font, float scale, const std::vector<std::wstring> &statics)
+{
+    float size = backend.GetFontSize(font);
+    if (owner == &backend && epoch == backend.GetResourceEpoch() && this->font == font
+        && fontSize == size && this->scale == scale && this->statics == statics) {
+        return IsReady(); // Also remembers a failed build, no retry every frame
+    }
+
+    Release();
+    owner = &backend;
+    epoch = backend.GetResourceEpoch();
+    this->font = font;
+    fontSize = size;
+    this->scale = scale;
+    this->statics = statics;
+    if (scale <= 0.0f) return false;
+
+    // Measure every cell. Only the ink is rasterized (backends center text, so
+    // surrounding spaces would shift it); the spaces survive as offset/advance.
+    lineHeight = 0.0f;
+    advance = 0.0f;
+    std::vector<std::wstring> inks;
+    auto measure = [&](const std::wstring &text, Cell &cell) {
+        size_t first = text.find_first_not_of(L' ');
+        size_t last = text.find_last_not_of(L' ');
+        std::wstring ink = (first == std::wstring::npos) ? std::wstring() : text.substr(first, last - first + 1);
+
+        TextMetrics full = backend.MeasureString(text, font);
+        TextMetrics inner = backend.MeasureString(ink, font);
+        cell.ink = inner.width;
+        cell.advance = full.advance > 0.0f ? full.advance : full.width;
+        cell.offset = (first > 0 && first != std::wstring::npos) ? backend.MeasureString(text.substr(0, first), font).advance : 0.0f;
+        if (inner.height > lineHeight) lineHeight = inner.height;
+        inks.push_back(std::move(ink));
+    };
+    staticCells.assign(statics.size(), Cell());
+    for (size_t i = 0; i < statics.size(); i++) measure(statics[i], staticCells[i]);
+    for (size_t i = 0; i < GLYPHS.size(); i++) {
+        measure(std::wstring(1, GLYPHS[i]), glyphCells[i]);
+        if (GLYPHS[i] >= L'0' && GLYPHS[i] <= L'9' && glyphCells[i].advance > advance) advance = glyphCells[i].advance;
+    }
+
+    // Lay the cells out in a single row of whole pixels
+    int cellH = (int)std::ceil(lineHeight * scale) + 2 * CELL_PAD;
+    int x = 0;
+    std::vector<MaskCell> cells;
+    auto add = [&](const std::wstring &ink, Cell &cell) {
+        int w = (int)std::ceil(cell.ink * scale) + 2 * CELL_PAD;
+        cell.src = DrawRect((float)x, 0.0f, (float)(x + w), (float)cellH);
+        cells.push_back({ ink, DrawRect(x / scale, 0.0f, (x + w) / scale, cellH / scale) });
+        x += w;
+    };
+    for (size_t i = 0; i < statics.size(); i++) add(inks[i], staticCells[i]);
+    for (size_t i = 0; i < GLYPHS.size(); i++) add(inks[statics.size() + i], glyphCells[i]);
+
+    mask = backend.CreateTextMask(cells, font, x, cellH, scale);
+    if (mask.IsEmpty()) return false;
+    buildCount++;
+    return true;
+}
+
+void GlyphAtlas::Release()
+{
+    if (owner && !mask.IsEmpty()) owner->ReleaseImage(mask);
+    mask = ImageRef();
+    owner = nullptr;
+}
+
+bool GlyphAtlas::CanCompose(std::wstring_view value)
+{
+    if (value.empty()) return false;
+    for (wchar_t c : value) {
+        if (GLYPHS.find(c) == std::wstring_view::npos) return false;
+    }
+    return true;
+}
+
+float GlyphAtlas::Snap(float v) const
+{
+    return std::round(v * scale) / scale;
+}
+
+GlyphQuad GlyphAtlas::Place(const Cell &cell, float x, float y) const
+{
+    // The ink sits centered in its cell; snap the cell origin so mask pixels
+    // land 1:1 on device pixels
+    float padX = (cell.src.Width() - cell.ink * scale) / 2.0f / scale;
+    float padY = (cell.src.Height() - lineHeight * scale) / 2.0f / scale;
+    float left = Snap(x - padX);
+    float top = Snap(y - padY);
+    GlyphQuad q;
+    q.src = cell.src;
+    q.dest = DrawRect(left, top, left + cell.src.Width() / scale, top + cell.src.Height() / scale);
+    return q;
+}
+
+GlyphQuad GlyphAtlas::PlaceStatic(size_t index, float x, float y) const
+{
+    const Cell &cell = staticCells[index];
+    return Place(cell, x + cell.offset, y);
+}
+
+GlyphQuad GlyphAtlas::PlaceGlyph(wchar_t c, float x, float y) const
+{
+    size_t i = GLYPHS.find(c);
+    if (i == std::wstring_view::npos) i = 0;
+    const Cell &cell = glyphCells[i];
+    return Place(cell, x + (advance - cell.ink) / 2.0f, y);
+}
+
+/* NUMERIC LABEL */
+
+bool NumericLabel::SetFormat(const std::wstring &format, const std::wstring &token)
+{
+    enabled = false;
+    size_t pos = token.empty() ? std::wstring::npos : format.find(token);
+    if (pos == std::wstring::npos || format.find(token, pos + token.length()) != std::wstring::npos) return false;
+
+    prefix = format.substr(0, pos);
+    suffix = format.substr(pos + token.length());
+    enabled = true;
+    return true;
+}
+
+float NumericLabel::Width(std::wstring_view value) const
+{
+    size_t slots = value.length() > (size_t)reservedDigits ? value.length() : (size_t)reservedDigits;
+    return atlas.GetStaticWidth(0) + slots * atlas.GetAdvance() + atlas.GetStaticWidth(1);
+}
+
+float NumericLabel::Measure(DrawingBackend &backend, DrawFont font, float scale, std::wstring_view value)
+{
+    if (!enabled || !GlyphAtlas::CanCompose(value)) return -1.0f;
+    if (!atlas.Prepare(backend, font, scale, { prefix, suffix })) return -1.0f;
+    return Width(value);
+}
+
+size_t NumericLabel::Place(std::wstring_view value, const DrawRect &rect, std::vector<GlyphQuad> &out) const
+{
+    size_t start = out.size();
+    float x = rect.left + (rect.Width() - Width(value)) / 2.0f;
+    float y = rect.top + (rect.Height() - atlas.GetLineHeight()) / 2.0f;
+
+    if (!prefix.empty()) out.push_back(atlas.PlaceStatic(0, x, y));
+    x += atlas.GetStaticWidth(0);
+
+    // Right-align the number in its reserved field
+    if (value.length() < (size_t)reservedDigits) x += (reservedDigits - value.length()) * atlas.GetAdvance();
+    for (wchar_t c : value) {
+        out.push_back(atlas.PlaceGlyph(c, x, y));
+        x += atlas.GetAdvance();
+    }
+
+    if (!suffix.empty()) out.push_back(atlas.PlaceStatic(1, x, y));
+    return out.size() - start;
+}
+
+bool NumericLabel::Draw(DrawingBackend &backend, std::wstring_view value, const DrawRect &rect, const DrawColor &color)
+{
+    if (!enabled || !atlas.IsCurrent(backend) || !GlyphAtlas::CanCompose(value)) return false;
+
+    quads.clear();
+    Place(value, rect, quads);
+    for (const GlyphQuad &q : quads) backend.DrawMask(atlas.GetMask(), q.src, q.dest, color);
+    return true;
+}
@@ -0,0 +1,104 @@
+#include "HitIndex.h"
+#include <algorithm>
+
+void HitIndex::Begin(bool vertical, float scale)
+{
+    this->vertical = vertical;
+    this->scale = scale;
+    entries.clear();
+    order.clear();
+    reach.clear();
+    firstChild.clear();
+}
+
+int HitIndex::Add(const LayoutRect &rect, void *owner, int part, int parent)
+{
+    if (rect.right <= rect.left || rect.bottom <= rect.top) return -1; // Not laid out
+
+    // Same truncation the window procedures used on logical rects
+    HitEntry e;
+    e.left = (int)(rect.left * scale);
+    e.top = (int)(rect.top * scale);
+    e.right = (int)(rect.right * scale);
+    e.bottom = (int)(rect.bottom * scale);
+    e.rect = rect;
+    e.owner = owner;
+    e.part = part;
+    e.parent = parent;
+    e.depth = parent >= 0 ? entries[parent].depth + 1 : 0;
+    entries.push_back(e);
+    return (int)entries.size() - 1;
+}
+
+void HitIndex::Finish()
+{
+    // Counting sort by parent: slot n holds the top level
+    size_t n = entries.size();
+    firstChild.assign(n + 2, 0);
+    for (const HitEntry &e : entries) firstChild[(e.parent >= 0 ? e.parent : n) + 1]++;
+    for (size_t i = 1; i < firstChild.size(); i++) firstChild[i] += firstChild[i - 1];
+
+    order.resize(n);
+    std::vector<int> fill(firstChild.begin(), firstChild.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        const HitEntry &e = entries[i];
+        order[fill[e.parent >= 0 ? e.parent : n]++] = (int)i;
+    }
+
+    reach.resize(n);
+    for (size_t g = 0; g <= n; g++) {
+        auto first = order.begin() + firstChild[g];
+        auto last = order.begin() + firstChild[g + 1];
+        std::stable_sort(first, last, [this](int a, int b) { return Start(entries[a]) < Start(entries[b]); });
+
+        int furthest = 0;
+        for (int i = firstChild[g]; i < firstChild[g + 1]; i++) {
+            furthest = i == firstChild[g] ? End(entries[order[i]]) : std::max(furthest, End(entries[order[i]]));
+            reach[i] = furthest;
+        }
+    }
+}
+
+int HitIndex::FindIn(int first, int last, int main, int cross, int crossSlack) const
+{
+    // Last sibling starting at or before the point
+    auto it = std::upper_bound(order.begin() + first, order.begin() + last, main,
+        [this](int value, int i) { return value < Start(entries[i]); });
+
+    // Siblings are laid out side by side, so this walk normally stops at the
+    // first probe; only overlapping siblings make it go further back
+    for (ptrdiff_t i = (it - order.begin()) - 1; i >= first && reach[i] > main; i--) {
+        const HitEntry &e = entries[order[i]];
+        probes++;
+        if (End(e) <= main) continue;
+        int crossStart = (vertical ? e.left : e.top) - crossSlack;
+        int crossEnd = (vertical ? e.right : e.bottom) + crossSlack;
+        if (cross < crossStart || cross >= crossEnd) continue;
+        return order[i];
+    }
+    return -1;
+}
+
+HitResult HitIndex::Find(int x, int y, int crossSlack) const
+{
+    HitResult result;
+    if (entries.empty()) return result;
+    int main = vertical ? y : x;
+    int cross = vertical ? x : y;
+
+    // Descend one level at a time: top-level module, then whichever of its
+    // children or sub-items covers the point
+    size_t group = entries.size();
+    while (true) {
+        int hit = FindIn(firstChild[group], firstChild[group + 1], main, cross, crossSlack);
+        if (hit < 0) break;
+        const HitEntry &e = entries[hit];
+        if (e.part >= 0) {
+            if (result.module && e.owner == result.module->owner) result.part = e.part;
+            break;
+        }
+        result.module = &e;
+        group = (size_t)hit;
+    }
+    return result;
+}
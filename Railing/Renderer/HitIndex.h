@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "LayoutEngine.h"
+
+// Platform-neutral spatial index for mouse hit testing. The arrange pass
+// publishes every hittable rect (modules, group children, sub-items such as
+// dock icons) once, already in device pixels. Each nesting level is sorted
+// along the bar's main axis on its own, so a mouse message is one binary search
+// per level (top-level module, then group child or sub-item) instead of a walk
+// over every section and group with a DPI multiply per rect.
+
+struct HitEntry {
+    int left = 0, top = 0, right = 0, bottom = 0; // Device pixels
+    LayoutRect rect;        // Logical rect the entry came from
+    void *owner = nullptr;  // Module (opaque to the index)
+    int part = -1;          // Sub-item of the owner, -1 for the owner itself
+    int depth = 0;          // Nesting: deeper entries win over their parents
+    int parent = -1;        // Index of the enclosing entry, -1 at the top level
+};
+
+struct HitResult {
+    const HitEntry *module = nullptr; // Innermost owner under the point
+    int part = -1;                    // Its sub-item under the point, if any
+};
+
+class HitIndex
+{
+public:
+    /// <summary>
+    /// Start a new generation. `scale` maps logical units to device pixels.
+    /// </summary>
+    void Begin(bool vertical, float scale);
+    /// <summary>
+    /// Publish a rect nested inside the entry `parent` returned (-1 for top
+    /// level). Returns the new entry's index, or -1 if the rect is empty; its
+    /// children are then skipped too.
+    /// </summary>
+    int Add(const LayoutRect &rect, void *owner, int part, int parent);
+    // Sort each level and build the search structure; call before any Find
+    void Finish();
+
+    /// <summary>
+    /// Innermost module (and sub-item) under the device pixel (x, y). `crossSlack`
+    /// grows every rect across the bar, for forgiving clicks at the screen edge.
+    /// </summary>
+    HitResult Find(int x, int y, int crossSlack = 0) const;
+
+    bool IsVertical() const { return vertical; }
+    float GetScale() const { return scale; }
+    size_t Count() const { return entries.size(); }
+    const std::vector<HitEntry> &GetEntries() const { return entries; }
+
+    mutable size_t probes = 0; // Entries inspected by Find, for profiling
+
+private:
+    std::vector<HitEntry> entries; // In Add order
+    // Entry indices grouped by parent (top level last), each group sorted by
+    // main-axis start; `reach` is the furthest end so far within the group
+    std::vector<int> order;
+    std::vector<int> reach;
+    std::vector<int> firstChild;   // Per entry plus one for the top level: its group in `order`
+    bool vertical = false;
+    float scale = 1.0f;
+
+    int Start(const HitEntry &e) const { return vertical ? e.top : e.left; }
+    int End(const HitEntry &e) const { return vertical ? e.bottom : e.right; }
+    // The member of order[first..last) covering (main, cross), or -1
+    int FindIn(int first, int last, int main, int cross, int crossSlack) const;
+};
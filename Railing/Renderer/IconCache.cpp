@@ -0,0 +1,158 @@
+#include "IconCache.h"
+#include <algorithm>
+
+IconKey IconCache::ContentKey(const IconMipChain &mips)
+{
+    // FNV-1a over the sizes and the largest level's pixels (the rest derive from it),
+    // then a final mix so nearby icons spread
+    uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&h](uint64_t v) { h = (h ^ v) * 0x100000001b3ull; };
+    for (size_t i = 0; i < mips.Count(); i++) mix((uint64_t)(uint32_t)mips.Edge(i));
+    IconMipLevel top = mips.Level(0);
+    mix((uint64_t)(uint32_t)top.width << 32 | (uint32_t)top.height);
+    for (size_t i = 0; i < (size_t)top.width * top.height; i++) mix(top.pixels[i]);
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull; h ^= h >> 33;
+    return h == NO_ICON ? 1 : h;
+}
+
+IconKey IconCache::AcquireSource(uint64_t source)
+{
+    auto found = sourceOf.find(source);
+    if (found == sourceOf.end()) return NO_ICON;
+    sourceHits++;
+    Retain(entries.at(found->second));
+    return found->second;
+}
+
+IconKey IconCache::Acquire(const IconMipChain &mips, uint64_t source)
+{
+    if (mips.Count() == 0) return NO_ICON;
+    IconKey key = ContentKey(mips);
+
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        hits++;
+    }
+    else {
+        Entry e;
+        for (size_t i = 0; i < mips.Count(); i++) {
+            IconMipLevel level = mips.Level(i);
+            void *image = uploader.Upload(level.pixels, level.width, level.height, level.width);
+            if (!image) {
+                ReleaseImages(e);
+                failures++;
+                return NO_ICON;
+            }
+            e.levels.push_back({ image, mips.Edge(i) });
+            size_t bytes = (size_t)level.width * level.height * sizeof(uint32_t);
+            e.bytes += bytes;
+            if (i > 0) e.mipBytes += bytes;
+        }
+        uploads++;
+        used += e.bytes;
+        mipBytes += e.mipBytes;
+        levelCount += e.levels.size();
+        idle.push_front(key);
+        e.idleAt = idle.begin();
+        found = entries.emplace(key, std::move(e)).first;
+    }
+
+    Entry &e = found->second;
+    if (source) {
+        auto [at, added] = sourceOf.try_emplace(source, key);
+        if (!added && at->second != key) {
+            // The source now decodes to different pixels (the file changed)
+            std::vector<uint64_t> &old = entries.at(at->second).sources;
+            old.erase(std::find(old.begin(), old.end(), source));
+            at->second = key;
+            added = true;
+        }
+        if (added) e.sources.push_back(source);
+    }
+    Retain(e);
+    Trim();
+    return key;
+}
+
+void IconCache::AddRef(IconKey key)
+{
+    auto found = entries.find(key);
+    if (found != entries.end()) Retain(found->second);
+}
+
+void IconCache::Release(IconKey key)
+{
+    auto found = entries.find(key);
+    if (found == entries.end() || found->second.refs == 0) return;
+    Entry &e = found->second;
+    if (--e.refs > 0) return;
+    idle.push_front(key);
+    e.idleAt = idle.begin();
+    Trim();
+}
+
+void *IconCache::Image(IconKey key) const
+{
+    auto found = entries.find(key);
+    return found != entries.end() ? found->second.levels[0].image : nullptr;
+}
+
+void *IconCache::Image(IconKey key, float edge) const
+{
+    auto found = entries.find(key);
+    if (found == entries.end()) return nullptr;
+    // Same choice as IconMipChain::Pick
+    const std::vector<Level> &levels = found->second.levels;
+    for (size_t i = levels.size(); i-- > 0;) {
+        if ((float)levels[i].edge + 0.5f >= edge) return levels[i].image;
+    }
+    return levels[0].image;
+}
+
+void IconCache::SetBudget(size_t bytes)
+{
+    budget = bytes;
+    Trim();
+}
+
+void IconCache::Clear()
+{
+    for (auto &[key, e] : entries) ReleaseImages(e);
+    entries.clear();
+    sourceOf.clear();
+    idle.clear();
+    used = 0;
+    mipBytes = 0;
+    levelCount = 0;
+}
+
+void IconCache::ReleaseImages(Entry &e)
+{
+    for (const Level &level : e.levels) uploader.Release(level.image);
+    e.levels.clear();
+}
+
+void IconCache::Retain(Entry &e)
+{
+    if (e.refs++ == 0) idle.erase(e.idleAt);
+}
+
+void IconCache::Erase(std::unordered_map<IconKey, Entry>::iterator it)
+{
+    Entry &e = it->second;
+    levelCount -= e.levels.size();
+    ReleaseImages(e);
+    for (uint64_t source : e.sources) sourceOf.erase(source);
+    if (e.refs == 0) idle.erase(e.idleAt);
+    used -= e.bytes;
+    mipBytes -= e.mipBytes;
+    entries.erase(it);
+}
+
+void IconCache::Trim()
+{
+    while (used > budget && !idle.empty()) {
+        Erase(entries.find(idle.back()));
+        evictions++;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "IconMips.h"
+
+// Decoded icons shared by content. Every window of an app usually shows the
+// same icon, so entries are keyed by a hash of the pixels and size instead of
+// by window: the first window uploads the bitmap, the rest take a reference.
+// Icons with no users are kept least-recently-used under a byte budget so a
+// reopened app doesn't decode again; icons in use are never evicted.
+// Each icon is a mip chain (one upload per level) and draws pick the level
+// nearest the size they are drawn at.
+// Uploads go through IconUploader, which keeps the cache free of Direct2D and
+// lets a fake uploader drive it off Windows.
+
+class IconUploader
+{
+public:
+    virtual ~IconUploader() = default;
+
+    // Premultiplied BGRA rows, `stride` in pixels. Returns the backend's image or null
+    virtual void *Upload(const uint32_t *pixels, int width, int height, int stride) = 0;
+    virtual void Release(void *image) = 0;
+};
+
+using IconKey = uint64_t;
+constexpr IconKey NO_ICON = 0;
+
+class IconCache
+{
+public:
+    static constexpr size_t DEFAULT_BUDGET = 4 * 1024 * 1024;
+
+    explicit IconCache(IconUploader &uploader, size_t budgetBytes = DEFAULT_BUDGET) : uploader(uploader), budget(budgetBytes) {}
+    ~IconCache() { Clear(); }
+    IconCache(const IconCache &) = delete;
+    IconCache &operator=(const IconCache &) = delete;
+
+    // Hash of the largest level's pixels and every level's edge
+    static IconKey ContentKey(const IconMipChain &mips);
+
+    /// <summary>
+    /// Takes a reference on the icon last decoded from `source` (the caller's
+    /// hash of where it came from, e.g. file, index and size). Returns NO_ICON
+    /// if that source hasn't been seen or its icon was evicted; decode it then.
+    /// </summary>
+    IconKey AcquireSource(uint64_t source);
+
+    /// <summary>
+    /// Takes a reference on the icon with these levels, uploading them unless
+    /// an identical chain is cached. A nonzero `source` is remembered for
+    /// AcquireSource. Returns NO_ICON if an upload failed.
+    /// </summary>
+    IconKey Acquire(const IconMipChain &mips, uint64_t source = 0);
+
+    void AddRef(IconKey key);
+    // Drops a reference; the icon stays cached until the budget needs its bytes
+    void Release(IconKey key);
+
+    // The largest level, or the one IconMipChain::Pick chooses for drawing at `edge` device pixels
+    void *Image(IconKey key) const;
+    void *Image(IconKey key, float edge) const;
+
+    void SetBudget(size_t bytes);
+    size_t GetBudget() const { return budget; }
+
+    // Releases every image, referenced or not (device loss, shutdown). Keys held by callers go stale
+    void Clear();
+
+    size_t Count() const { return entries.size(); }
+    size_t IdleCount() const { return idle.size(); }
+    size_t BytesUsed() const { return used; }   // Every level
+    size_t MipBytes() const { return mipBytes; } // Levels below the largest, included in BytesUsed
+    size_t LevelCount() const { return levelCount; }
+
+    size_t hits = 0;        // Acquire found identical pixels already uploaded
+    size_t sourceHits = 0;  // AcquireSource skipped a decode
+    size_t uploads = 0;
+    size_t evictions = 0;
+    size_t failures = 0;
+    void ResetCounters() { hits = sourceHits = uploads = evictions = failures = 0; }
+
+private:
+    struct Level {
+        void *image;
+        int edge;
+    };
+    struct Entry {
+        std::vector<Level> levels; // Largest first
+        size_t bytes = 0;
+        size_t mipBytes = 0;
+        uint32_t refs = 0;
+        std::vector<uint64_t> sources;
+        std::list<IconKey>::iterator idleAt; // Valid while refs == 0
+    };
+
+    IconUploader &uploader;
+    std::unordered_map<IconKey, Entry> entries;
+    std::unordered_map<uint64_t, IconKey> sourceOf;
+    std::list<IconKey> idle; // Unreferenced icons, front is most recently released
+    size_t budget;
+    size_t used = 0;
+    size_t mipBytes = 0;
+    size_t levelCount = 0;
+
+    void ReleaseImages(Entry &e);
+    void Retain(Entry &e);
+    void Erase(std::unordered_map<IconKey, Entry>::iterator it);
+    void Trim();
+};
@@ -0,0 +1,74 @@
+#define NOMINMAX
+#include "IconDecode.h"
+#include "PixelOps.h"
+#include <algorithm>
+
+bool ReadIconPixels(IWICImagingFactory *wic, HICON hIcon, std::vector<uint32_t> &pixels, int &width, int &height)
+{
+    if (!wic || !hIcon) return false;
+
+    UINT w = 0, h = 0;
+    bool ok = false;
+    IWICBitmap *wicBitmap = nullptr;
+    if (SUCCEEDED(wic->CreateBitmapFromHICON(hIcon, &wicBitmap))) {
+        IWICFormatConverter *converter = nullptr;
+        wic->CreateFormatConverter(&converter);
+        if (converter && SUCCEEDED(converter->Initialize(wicBitmap, GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone, nullptr, 0.f, WICBitmapPaletteTypeCustom))
+            && SUCCEEDED(converter->GetSize(&w, &h)) && w > 0 && h > 0) {
+            pixels.resize((size_t)w * h);
+            ok = SUCCEEDED(converter->CopyPixels(nullptr, w * sizeof(uint32_t), (UINT)(pixels.size() * sizeof(uint32_t)), (BYTE *)pixels.data()));
+        }
+        if (converter) converter->Release();
+        wicBitmap->Release();
+    }
+    if (!ok) return false;
+    width = (int)w;
+    height = (int)h;
+    return true;
+}
+
+void PrepareIconPixels(std::vector<uint32_t> &pixels, int &width, int &height, int edge)
+{
+    PremultiplyBGRA(pixels.data(), pixels.size());
+    if (edge <= 0) return;
+
+    // Keep the aspect of the odd non-square icon
+    int longest = std::max(width, height);
+    int dstW = std::max(1, (width * edge + longest / 2) / longest);
+    int dstH = std::max(1, (height * edge + longest / 2) / longest);
+    if (dstW == width && dstH == height) return;
+
+    std::vector<uint32_t> resized((size_t)dstW * dstH);
+    ResampleBGRA(pixels.data(), width, height, width, resized.data(), dstW, dstH, dstW);
+    pixels.swap(resized);
+    width = dstW;
+    height = dstH;
+}
+
+bool DecodeIconPixels(IWICImagingFactory *wic, HICON hIcon, int edge, std::vector<uint32_t> &pixels, int &width, int &height)
+{
+    if (!ReadIconPixels(wic, hIcon, pixels, width, height)) return false;
+    PrepareIconPixels(pixels, width, height, edge);
+    return true;
+}
+
+ID2D1Bitmap *CreateIconBitmap(ID2D1RenderTarget *rt, const uint32_t *pixels, int width, int height)
+{
+    if (!rt || !pixels) return nullptr;
+    float dpiX = 96.0f, dpiY = 96.0f;
+    rt->GetDpi(&dpiX, &dpiY);
+    D2D1_BITMAP_PROPERTIES props = D2D1::BitmapProperties(
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpiX, dpiY);
+    ID2D1Bitmap *bmp = nullptr;
+    rt->CreateBitmap(D2D1::SizeU(width, height), pixels, width * sizeof(uint32_t), props, &bmp);
+    return bmp;
+}
+
+ID2D1Bitmap *CreateIconBitmap(ID2D1RenderTarget *rt, IWICImagingFactory *wic, HICON hIcon, int edge)
+{
+    if (!rt) return nullptr;
+    std::vector<uint32_t> pixels;
+    int w = 0, h = 0;
+    if (!DecodeIconPixels(wic, hIcon, edge, pixels, w, h)) return nullptr;
+    return CreateIconBitmap(rt, pixels.data(), w, h);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <windows.h>
+#include <d2d1.h>
+#include <wincodec.h>
+#include <cstdint>
+#include <vector>
+
+// HICON to premultiplied BGRA through PixelOps: WIC hands over straight
+// alpha, which is premultiplied here and then filtered down (Lanczos3) to
+// the device-pixel edge the icon is drawn at, so D2D draws it 1:1 instead of
+// bilinear-scaling a larger image every frame.
+
+// Straight-alpha BGRA exactly as the icon holds it
+bool ReadIconPixels(IWICImagingFactory *wic, HICON hIcon, std::vector<uint32_t> &pixels, int &width, int &height);
+
+// Premultiplies what ReadIconPixels returned and resizes it so its longer side is `edge` (0 keeps the size)
+void PrepareIconPixels(std::vector<uint32_t> &pixels, int &width, int &height, int edge);
+
+// Both of the above
+bool DecodeIconPixels(IWICImagingFactory *wic, HICON hIcon, int edge, std::vector<uint32_t> &pixels, int &width, int &height);
+
+// Uploads premultiplied pixels at the render target's DPI
+ID2D1Bitmap *CreateIconBitmap(ID2D1RenderTarget *rt, const uint32_t *pixels, int width, int height);
+ID2D1Bitmap *CreateIconBitmap(ID2D1RenderTarget *rt, IWICImagingFactory *wic, HICON hIcon, int edge);
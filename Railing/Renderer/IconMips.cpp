@@ -0,0 +1,51 @@
+#include "IconMips.h"
+#include "PixelOps.h"
+#include <algorithm>
+#include <functional>
+
+void IconMipChain::Build(const uint32_t *pixels, int width, int height, int stride, const std::vector<int> &edges)
+{
+    Clear();
+    if (!pixels || width <= 0 || height <= 0) return;
+
+    int sourceEdge = std::max(width, height);
+    std::vector<int> wanted;
+    for (int e : edges) {
+        if (e > 0) wanted.push_back(std::min(e, sourceEdge));
+    }
+    if (wanted.empty()) wanted.push_back(sourceEdge);
+    int smallest = *std::min_element(wanted.begin(), wanted.end());
+    for (int e = smallest / 2; e >= MIN_EDGE; e /= 2) wanted.push_back(e);
+    std::sort(wanted.begin(), wanted.end(), std::greater<int>());
+    wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+    size_t total = 0;
+    for (int e : wanted) {
+        // Longer side is `e`; keep the aspect of the odd non-square icon
+        int w = std::max(1, (int)(((int64_t)width * e + sourceEdge / 2) / sourceEdge));
+        int h = std::max(1, (int)(((int64_t)height * e + sourceEdge / 2) / sourceEdge));
+        levels.push_back({ w, h, e, total });
+        total += (size_t)w * h;
+    }
+
+    data.resize(total);
+    for (const Slot &s : levels) {
+        ResampleBGRA(pixels, width, height, stride, data.data() + s.offset, s.width, s.height, s.width);
+    }
+}
+
+IconMipLevel IconMipChain::Level(size_t i) const
+{
+    if (i >= levels.size()) return {};
+    const Slot &s = levels[i];
+    return { data.data() + s.offset, s.width, s.height };
+}
+
+size_t IconMipChain::Pick(float edge) const
+{
+    // Levels shrink with the index; half a pixel of slack absorbs rounding in the caller's edge
+    for (size_t i = levels.size(); i-- > 0;) {
+        if ((float)levels[i].edge + 0.5f >= edge) return i;
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// One icon prefiltered at every size it is drawn at. Mixed-DPI bars share
+// an icon but need it at different device-pixel sizes, and a scaled draw
+// (animation, a bar moved to another monitor) wants a smaller copy than the
+// largest. Each level is filtered straight from the decoded source, so the
+// renderer picks the nearest level and blits it 1:1 (or shrinks it a little)
+// instead of resampling one bitmap every frame.
+// Pixels are premultiplied BGRA, levels are stored largest first.
+
+struct IconMipLevel {
+    const uint32_t *pixels = nullptr; // Tightly packed, width * height
+    int width = 0;
+    int height = 0;
+    explicit operator bool() const { return pixels != nullptr; }
+};
+
+class IconMipChain
+{
+public:
+    static constexpr int MIN_EDGE = 16;
+
+    /// <summary>
+    /// Builds one level per distinct edge in `edges` (the longer side, in
+    /// device pixels) and halvings of the smallest down to MIN_EDGE. Edges
+    /// above the source's size are clamped to it. Lanczos3 from the source.
+    /// </summary>
+    void Build(const uint32_t *pixels, int width, int height, int stride, const std::vector<int> &edges);
+    void Clear() { levels.clear(); data.clear(); }
+
+    size_t Count() const { return levels.size(); }
+    IconMipLevel Level(size_t i) const;
+    int Edge(size_t i) const { return levels[i].edge; }
+
+    // Level for drawing at `edge` device pixels: the smallest that doesn't need enlarging, else the largest
+    size_t Pick(float edge) const;
+
+    size_t Bytes() const { return data.size() * sizeof(uint32_t); }
+
+private:
+    struct Slot {
+        int width;
+        int height;
+        int edge;
+        size_t offset;
+    };
+    std::vector<Slot> levels;
+    std::vector<uint32_t> data; // All levels back to back
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Platform-neutral measure/arrange engine. Knows nothing about Direct2D or
+// modules: callers publish measured main-axis sizes into LayoutNodes and the
+// engine positions them, re-arranging only the sections whose sizes changed.
+
+struct LayoutRect {
+    float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+
+    float Width() const { return right - left; }
+    float Height() const { return bottom - top; }
+    bool operator==(const LayoutRect &o) const {
+        return left == o.left && top == o.top && right == o.right && bottom == o.bottom;
+    }
+    bool operator!=(const LayoutRect &o) const { return !(*this == o); }
+};
+
+struct LayoutInsets {
+    float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+
+    bool operator==(const LayoutInsets &o) const {
+        return left == o.left && top == o.top && right == o.right && bottom == o.bottom;
+    }
+};
+
+struct LayoutNode {
+    float measuredSize = 0.0f;      // Main axis extent (margin + padding + content)
+    bool sizeChanged = true;        // Set when measuredSize moves, cleared by Arrange
+    LayoutInsets childInsets;       // Offset from this rect to the children's box (groups)
+    std::vector<LayoutNode *> children;
+    LayoutRect rect;                // Output of the arrange pass
+    LayoutRect previousRect;        // rect before the last arrange (damage tracking)
+
+    /// <summary>
+    /// Publish a new measurement. Returns true if the size actually changed.
+    /// </summary>
+    bool SetMeasuredSize(float size) {
+        if (size == measuredSize) return false;
+        measuredSize = size;
+        sizeChanged = true;
+        return true;
+    }
+
+    bool SetChildInsets(const LayoutInsets &insets) {
+        if (insets == childInsets) return false;
+        childInsets = insets;
+        sizeChanged = true;
+        return true;
+    }
+};
+
+enum class LayoutSection { Left = 0, Center = 1, Right = 2 };
+
+class LayoutEngine
+{
+public:
+    static constexpr int SECTION_COUNT = 3;
+
+    void SetSection(LayoutSection section, std::vector<LayoutNode *> nodes) {
+        sections[(int)section] = std::move(nodes);
+        dirty[(int)section] = true;
+    }
+
+    void Clear() {
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            sections[i].clear();
+            dirty[i] = true;
+        }
+    }
+
+    /// <summary>
+    /// Set the bar extent. Changing it (or the orientation) dirties everything.
+    /// </summary>
+    void SetBounds(float width, float height, bool vertical) {
+        if (width == barWidth && height == barHeight && vertical == isVertical) return;
+        barWidth = width;
+        barHeight = height;
+        isVertical = vertical;
+        InvalidateAll();
+    }
+
+    void Invalidate(LayoutSection section) { dirty[(int)section] = true; }
+    void InvalidateAll() { for (int i = 0; i < SECTION_COUNT; i++) dirty[i] = true; }
+
+    /// <summary>
+    /// Arrange every section that is dirty or holds a node whose size changed.
+    /// </summary>
+    /// <returns>Bitmask of re-arranged sections (bit = (int)LayoutSection)</returns>
+    unsigned Arrange() {
+        unsigned arranged = 0;
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            bool needs = dirty[i];
+            for (LayoutNode *n : sections[i]) {
+                if (ConsumeSizeChanged(n)) needs = true;
+            }
+            if (!needs) continue;
+
+            ArrangeSection((LayoutSection)i);
+            dirty[i] = false;
+            arranged |= (1u << i);
+            arrangeCount++;
+        }
+        return arranged;
+    }
+
+    const std::vector<LayoutNode *> &GetSection(LayoutSection section) const { return sections[(int)section]; }
+    bool IsVertical() const { return isVertical; }
+    float CrossExtent() const { return isVertical ? barWidth : barHeight; }
+
+    // Number of section arrange passes since construction (for profiling).
+    size_t arrangeCount = 0;
+
+private:
+    std::vector<LayoutNode *> sections[SECTION_COUNT];
+    bool dirty[SECTION_COUNT] = { true, true, true };
+    float barWidth = -1.0f;
+    float barHeight = -1.0f;
+    bool isVertical = false;
+
+    static bool ConsumeSizeChanged(LayoutNode *n) {
+        bool changed = n->sizeChanged;
+        n->sizeChanged = false;
+        for (LayoutNode *c : n->children) {
+            if (ConsumeSizeChanged(c)) changed = true;
+        }
+        return changed;
+    }
+
+    void ArrangeSection(LayoutSection section) {
+        const auto &list = sections[(int)section];
+        float mainExtent = isVertical ? barHeight : barWidth;
+        float crossExtent = isVertical ? barWidth : barHeight;
+
+        float cursor = 0.0f;
+        if (section == LayoutSection::Center) {
+            float total = 0.0f;
+            for (LayoutNode *n : list) total += n->measuredSize;
+            cursor = (mainExtent - total) / 2.0f;
+        }
+        else if (section == LayoutSection::Right) {
+            float total = 0.0f;
+            for (LayoutNode *n : list) total += n->measuredSize;
+            cursor = mainExtent - total;
+        }
+
+        for (LayoutNode *n : list) {
+            Place(n, cursor, 0.0f, crossExtent);
+            cursor += n->measuredSize;
+        }
+    }
+
+    void Place(LayoutNode *n, float mainStart, float crossStart, float crossEnd) {
+        n->previousRect = n->rect;
+        if (isVertical) n->rect = { crossStart, mainStart, crossEnd, mainStart + n->measuredSize };
+        else n->rect = { mainStart, crossStart, mainStart + n->measuredSize, crossEnd };
+
+        if (n->children.empty()) return;
+
+        const LayoutInsets &in = n->childInsets;
+        float childMain = isVertical ? (n->rect.top + in.top) : (n->rect.left + in.left);
+        float childCrossStart = isVertical ? (n->rect.left + in.left) : (n->rect.top + in.top);
+        float childCrossEnd = isVertical ? (n->rect.right - in.right) : (n->rect.bottom - in.bottom);
+
+        for (LayoutNode *c : n->children) {
+            Place(c, childMain, childCrossStart, childCrossEnd);
+            childMain += c->measuredSize;
+        }
+    }
+};
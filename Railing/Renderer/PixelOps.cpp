@@ -0,0 +1,519 @@
+#include "PixelOps.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PIXEL_OPS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define PIXEL_OPS_X86 0
+#endif
+
+namespace {
+
+// Filter taps for one output pixel: `count` source pixels from `start`, weights at `offset`
+struct Contrib {
+    int start;
+    int count;
+    size_t offset;
+};
+
+struct Weights {
+    std::vector<Contrib> taps;
+    std::vector<float> w;
+};
+
+struct Kernels {
+    void (*premultiply)(uint32_t *pixels, size_t count);
+    void (*unpremultiply)(uint32_t *pixels, size_t count);
+    // src rows -> tmp (rows x dstWidth x 4 floats)
+    void (*horizontal)(const uint32_t *src, int srcStride, int rows, const Weights &wx, int dstWidth, float *tmp);
+    // tmp -> dst rows
+    void (*vertical)(const float *tmp, const Weights &wy, int dstWidth, int dstHeight, uint32_t *dst, int dstStride);
+};
+
+double Lanczos3(double x)
+{
+    x = std::fabs(x);
+    if (x < 1e-8) return 1.0;
+    if (x >= 3.0) return 0.0;
+    const double pi = 3.14159265358979323846;
+    double px = pi * x;
+    return (std::sin(px) / px) * (std::sin(px / 3.0) / (px / 3.0));
+}
+
+void BuildWeights(int srcLen, int dstLen, ResampleFilter filter, Weights &out)
+{
+    double scale = (double)srcLen / dstLen;
+    double stretch = std::max(scale, 1.0); // Widen the filter when shrinking
+    double radius = (filter == ResampleFilter::Box ? 0.5 : 3.0) * stretch;
+
+    out.taps.resize(dstLen);
+    out.w.clear();
+    std::vector<double> raw;
+    for (int i = 0; i < dstLen; i++) {
+        double center = (i + 0.5) * scale;
+        int lo = std::max(0, (int)std::floor(center - radius));
+        int hi = std::min(srcLen - 1, (int)std::ceil(center + radius) - 1);
+
+        raw.clear();
+        for (int j = lo; j <= hi; j++) {
+            double weight;
+            if (filter == ResampleFilter::Box) weight = std::max(0.0, std::min(j + 1.0, center + radius) - std::max((double)j, center - radius));
+            else weight = Lanczos3((j + 0.5 - center) / stretch);
+            raw.push_back(weight);
+        }
+        // Trim taps that contribute nothing
+        size_t first = 0, last = raw.size();
+        while (first < last && raw[first] == 0.0) first++;
+        while (last > first && raw[last - 1] == 0.0) last--;
+
+        double sum = 0.0;
+        for (size_t k = first; k < last; k++) sum += raw[k];
+
+        Contrib &c = out.taps[i];
+        c.offset = out.w.size();
+        if (sum == 0.0) {
+            c.start = std::min(srcLen - 1, std::max(0, (int)center));
+            c.count = 1;
+            out.w.push_back(1.0f);
+            continue;
+        }
+        c.start = lo + (int)first;
+        c.count = (int)(last - first);
+        for (size_t k = first; k < last; k++) out.w.push_back((float)(raw[k] / sum));
+    }
+}
+
+// --- Scalar ---
+
+inline uint32_t Div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+void PremultiplyScalar(uint32_t *pixels, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = pixels[i];
+        uint32_t a = p >> 24;
+        uint32_t b = Div255((p & 0xff) * a);
+        uint32_t g = Div255(((p >> 8) & 0xff) * a);
+        uint32_t r = Div255(((p >> 16) & 0xff) * a);
+        pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+inline uint32_t Unpremultiply1(uint32_t c, float k)
+{
+    float x = (float)c * k;
+    x = x + 0.5f;
+    return (uint32_t)std::min(x, 255.0f);
+}
+
+void UnpremultiplyScalar(uint32_t *pixels, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = pixels[i];
+        uint32_t a = p >> 24;
+        if (a == 0) {
+            pixels[i] = 0;
+            continue;
+        }
+        float k = 255.0f / (float)a;
+        pixels[i] = (a << 24) | (Unpremultiply1((p >> 16) & 0xff, k) << 16) | (Unpremultiply1((p >> 8) & 0xff, k) << 8) | Unpremultiply1(p & 0xff, k);
+    }
+}
+
+void HorizontalScalar(const uint32_t *src, int srcStride, int rows, const Weights &wx, int dstWidth, float *tmp)
+{
+    for (int y = 0; y < rows; y++) {
+        const uint32_t *row = src + (size_t)y * srcStride;
+        float *out = tmp + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; x++) {
+            const Contrib &c = wx.taps[x];
+            const float *w = &wx.w[c.offset];
+            float acc[4] = {};
+            for (int k = 0; k < c.count; k++) {
+                uint32_t p = row[c.start + k];
+                for (int ch = 0; ch < 4; ch++) acc[ch] = acc[ch] + w[k] * (float)((p >> (ch * 8)) & 0xff);
+            }
+            std::memcpy(out + x * 4, acc, sizeof(acc));
+        }
+    }
+}
+
+// Clamp to [0, 255], keep colour within alpha, round
+inline uint32_t PackPixel(const float *v)
+{
+    float c[4];
+    for (int ch = 0; ch < 4; ch++) c[ch] = std::min(std::max(v[ch], 0.0f), 255.0f);
+    float a = c[3];
+    uint32_t out = 0;
+    for (int ch = 0; ch < 4; ch++) out |= (uint32_t)(std::min(c[ch], a) + 0.5f) << (ch * 8);
+    return out;
+}
+
+void VerticalScalar(const float *tmp, const Weights &wy, int dstWidth, int dstHeight, uint32_t *dst, int dstStride)
+{
+    size_t rowFloats = (size_t)dstWidth * 4;
+    for (int y = 0; y < dstHeight; y++) {
+        const Contrib &c = wy.taps[y];
+        const float *w = &wy.w[c.offset];
+        uint32_t *out = dst + (size_t)y * dstStride;
+        for (int x = 0; x < dstWidth; x++) {
+            float acc[4] = {};
+            for (int k = 0; k < c.count; k++) {
+                const float *in = tmp + (size_t)(c.start + k) * rowFloats + x * 4;
+                for (int ch = 0; ch < 4; ch++) acc[ch] = acc[ch] + w[k] * in[ch];
+            }
+            out[x] = PackPixel(acc);
+        }
+    }
+}
+
+const Kernels SCALAR = { PremultiplyScalar, UnpremultiplyScalar, HorizontalScalar, VerticalScalar };
+
+#if PIXEL_OPS_X86
+
+// --- SSE2: 4 pixels per step for the per-pixel kernels, one pixel (4 channels) per vector when filtering ---
+
+TARGET_SSE2 inline __m128i Premultiply16(__m128i v, __m128i half, __m128i alphaLanes)
+{
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(v, a), half);
+    x = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    return _mm_or_si128(_mm_andnot_si128(alphaLanes, x), _mm_and_si128(alphaLanes, v));
+}
+
+TARGET_SSE2 void PremultiplySSE2(uint32_t *pixels, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i lo = Premultiply16(_mm_unpacklo_epi8(v, zero), half, alphaLanes);
+        __m128i hi = Premultiply16(_mm_unpackhi_epi8(v, zero), half, alphaLanes);
+        _mm_storeu_si128((__m128i *)(pixels + i), _mm_packus_epi16(lo, hi));
+    }
+    PremultiplyScalar(pixels + i, count - i);
+}
+
+// One pixel as 4 x int32
+TARGET_SSE2 inline __m128i Unpremultiply32(__m128i p, __m128 c255, __m128 half, __m128i alphaLane)
+{
+    __m128 f = _mm_cvtepi32_ps(p);
+    __m128 a = _mm_shuffle_ps(f, f, 0xFF);
+    __m128 opaque = _mm_cmpneq_ps(a, _mm_setzero_ps());
+    __m128 k = _mm_div_ps(c255, a);
+    __m128 x = _mm_add_ps(_mm_mul_ps(f, k), half);
+    x = _mm_and_ps(_mm_min_ps(x, c255), opaque);
+    __m128i r = _mm_cvttps_epi32(x);
+    return _mm_or_si128(_mm_andnot_si128(alphaLane, r), _mm_and_si128(alphaLane, p));
+}
+
+TARGET_SSE2 void UnpremultiplySSE2(uint32_t *pixels, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 c255 = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i alphaLane = _mm_set_epi32(-1, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i p0 = Unpremultiply32(_mm_unpacklo_epi16(lo, zero), c255, half, alphaLane);
+        __m128i p1 = Unpremultiply32(_mm_unpackhi_epi16(lo, zero), c255, half, alphaLane);
+        __m128i p2 = Unpremultiply32(_mm_unpacklo_epi16(hi, zero), c255, half, alphaLane);
+        __m128i p3 = Unpremultiply32(_mm_unpackhi_epi16(hi, zero), c255, half, alphaLane);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        _mm_storeu_si128((__m128i *)(pixels + i), packed);
+    }
+    UnpremultiplyScalar(pixels + i, count - i);
+}
+
+TARGET_SSE2 inline __m128 LoadPixelSSE2(uint32_t p, __m128i zero)
+{
+    __m128i v = _mm_cvtsi32_si128((int)p);
+    v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+    return _mm_cvtepi32_ps(v);
+}
+
+TARGET_SSE2 void HorizontalRowSSE2(const uint32_t *row, const Weights &wx, int dstWidth, float *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    for (int x = 0; x < dstWidth; x++) {
+        const Contrib &c = wx.taps[x];
+        const float *w = &wx.w[c.offset];
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < c.count; k++) acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), LoadPixelSSE2(row[c.start + k], zero)));
+        _mm_storeu_ps(out + x * 4, acc);
+    }
+}
+
+TARGET_SSE2 void HorizontalSSE2(const uint32_t *src, int srcStride, int rows, const Weights &wx, int dstWidth, float *tmp)
+{
+    for (int y = 0; y < rows; y++) HorizontalRowSSE2(src + (size_t)y * srcStride, wx, dstWidth, tmp + (size_t)y * dstWidth * 4);
+}
+
+TARGET_SSE2 inline uint32_t PackPixelSSE2(__m128 v, __m128 c255, __m128 half)
+{
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), c255);
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, 0xFF));
+    __m128i i = _mm_cvttps_epi32(_mm_add_ps(v, half));
+    i = _mm_packs_epi32(i, i);
+    return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+}
+
+TARGET_SSE2 void VerticalSSE2(const float *tmp, const Weights &wy, int dstWidth, int dstHeight, uint32_t *dst, int dstStride)
+{
+    const __m128 c255 = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t rowFloats = (size_t)dstWidth * 4;
+    for (int y = 0; y < dstHeight; y++) {
+        const Contrib &c = wy.taps[y];
+        const float *w = &wy.w[c.offset];
+        uint32_t *out = dst + (size_t)y * dstStride;
+        for (int x = 0; x < dstWidth; x++) {
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < c.count; k++) {
+                __m128 in = _mm_loadu_ps(tmp + (size_t)(c.start + k) * rowFloats + x * 4);
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), in));
+            }
+            out[x] = PackPixelSSE2(acc, c255, half);
+        }
+    }
+}
+
+const Kernels SSE2 = { PremultiplySSE2, UnpremultiplySSE2, HorizontalSSE2, VerticalSSE2 };
+
+// --- AVX2: 8 pixels per step for the per-pixel kernels, two pixels per vector when filtering ---
+
+TARGET_AVX2 inline __m256i Premultiply16x2(__m256i v, __m256i half, __m256i alphaLanes)
+{
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xFF), 0xFF);
+    __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(v, a), half);
+    x = _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+    return _mm256_or_si256(_mm256_andnot_si256(alphaLanes, x), _mm256_and_si256(alphaLanes, v));
+}
+
+TARGET_AVX2 void PremultiplyAVX2(uint32_t *pixels, size_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i half = _mm256_set1_epi16(128);
+    const __m256i alphaLanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Unpack and pack both work within 128-bit lanes, so pixel order survives
+        __m256i v = _mm256_loadu_si256((const __m256i *)(pixels + i));
+        __m256i lo = Premultiply16x2(_mm256_unpacklo_epi8(v, zero), half, alphaLanes);
+        __m256i hi = Premultiply16x2(_mm256_unpackhi_epi8(v, zero), half, alphaLanes);
+        _mm256_storeu_si256((__m256i *)(pixels + i), _mm256_packus_epi16(lo, hi));
+    }
+    PremultiplySSE2(pixels + i, count - i);
+}
+
+// Two pixels (one per 128-bit lane) as 8 x int32
+TARGET_AVX2 inline __m256i Unpremultiply32x2(__m256i p, __m256 c255, __m256 half, __m256i alphaLanes)
+{
+    __m256 f = _mm256_cvtepi32_ps(p);
+    __m256 a = _mm256_permute_ps(f, 0xFF);
+    __m256 opaque = _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+    __m256 k = _mm256_div_ps(c255, a);
+    __m256 x = _mm256_add_ps(_mm256_mul_ps(f, k), half);
+    x = _mm256_and_ps(_mm256_min_ps(x, c255), opaque);
+    __m256i r = _mm256_cvttps_epi32(x);
+    return _mm256_or_si256(_mm256_andnot_si256(alphaLanes, r), _mm256_and_si256(alphaLanes, p));
+}
+
+TARGET_AVX2 void UnpremultiplyAVX2(uint32_t *pixels, size_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 c255 = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i alphaLanes = _mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(pixels + i));
+        __m256i lo = _mm256_unpacklo_epi8(v, zero);
+        __m256i hi = _mm256_unpackhi_epi8(v, zero);
+        __m256i p0 = Unpremultiply32x2(_mm256_unpacklo_epi16(lo, zero), c255, half, alphaLanes);
+        __m256i p1 = Unpremultiply32x2(_mm256_unpackhi_epi16(lo, zero), c255, half, alphaLanes);
+        __m256i p2 = Unpremultiply32x2(_mm256_unpacklo_epi16(hi, zero), c255, half, alphaLanes);
+        __m256i p3 = Unpremultiply32x2(_mm256_unpackhi_epi16(hi, zero), c255, half, alphaLanes);
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(p0, p1), _mm256_packs_epi32(p2, p3));
+        _mm256_storeu_si256((__m256i *)(pixels + i), packed);
+    }
+    UnpremultiplySSE2(pixels + i, count - i);
+}
+
+// Two rows at once: the same taps applied to rows y and y + 1, one per lane
+TARGET_AVX2 void HorizontalAVX2(const uint32_t *src, int srcStride, int rows, const Weights &wx, int dstWidth, float *tmp)
+{
+    int y = 0;
+    for (; y + 2 <= rows; y += 2) {
+        const uint32_t *rowA = src + (size_t)y * srcStride;
+        const uint32_t *rowB = rowA + srcStride;
+        float *outA = tmp + (size_t)y * dstWidth * 4;
+        float *outB = outA + (size_t)dstWidth * 4;
+        for (int x = 0; x < dstWidth; x++) {
+            const Contrib &c = wx.taps[x];
+            const float *w = &wx.w[c.offset];
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < c.count; k++) {
+                __m128i pair = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)rowA[c.start + k]), _mm_cvtsi32_si128((int)rowB[c.start + k]));
+                __m256 pf = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(pair));
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(w[k]), pf));
+            }
+            _mm_storeu_ps(outA + x * 4, _mm256_castps256_ps128(acc));
+            _mm_storeu_ps(outB + x * 4, _mm256_extractf128_ps(acc, 1));
+        }
+    }
+    if (y < rows) HorizontalRowSSE2(src + (size_t)y * srcStride, wx, dstWidth, tmp + (size_t)y * dstWidth * 4);
+}
+
+TARGET_AVX2 void VerticalAVX2(const float *tmp, const Weights &wy, int dstWidth, int dstHeight, uint32_t *dst, int dstStride)
+{
+    const __m256 c255 = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m128 c255x4 = _mm_set1_ps(255.0f);
+    const __m128 halfx4 = _mm_set1_ps(0.5f);
+    size_t rowFloats = (size_t)dstWidth * 4;
+    for (int y = 0; y < dstHeight; y++) {
+        const Contrib &c = wy.taps[y];
+        const float *w = &wy.w[c.offset];
+        uint32_t *out = dst + (size_t)y * dstStride;
+        int x = 0;
+        for (; x + 2 <= dstWidth; x += 2) {
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < c.count; k++) {
+                __m256 in = _mm256_loadu_ps(tmp + (size_t)(c.start + k) * rowFloats + x * 4);
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(w[k]), in));
+            }
+            acc = _mm256_min_ps(_mm256_max_ps(acc, _mm256_setzero_ps()), c255);
+            acc = _mm256_min_ps(acc, _mm256_permute_ps(acc, 0xFF));
+            __m256i i = _mm256_cvttps_epi32(_mm256_add_ps(acc, half));
+            __m128i p = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+            _mm_storel_epi64((__m128i *)(out + x), _mm_packus_epi16(p, p));
+        }
+        for (; x < dstWidth; x++) {
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < c.count; k++) {
+                __m128 in = _mm_loadu_ps(tmp + (size_t)(c.start + k) * rowFloats + x * 4);
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), in));
+            }
+            out[x] = PackPixelSSE2(acc, c255x4, halfx4);
+        }
+    }
+}
+
+const Kernels AVX2 = { PremultiplyAVX2, UnpremultiplyAVX2, HorizontalAVX2, VerticalAVX2 };
+
+#endif
+
+PixelIsa DetectIsa()
+{
+#if PIXEL_OPS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6; // OSXSAVE, AVX, YMM state enabled
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return PixelIsa::AVX2;
+    if (sse2) return PixelIsa::SSE2;
+#endif
+    return PixelIsa::Scalar;
+}
+
+constexpr uint8_t ISA_UNSET = 0xFF;
+std::atomic<uint8_t> activeIsa{ ISA_UNSET };
+
+const Kernels &Active()
+{
+    switch (GetPixelIsa()) {
+#if PIXEL_OPS_X86
+    case PixelIsa::AVX2: return AVX2;
+    case PixelIsa::SSE2: return SSE2;
+#endif
+    default: return SCALAR;
+    }
+}
+
+}
+
+PixelIsa BestPixelIsa()
+{
+    static const PixelIsa best = DetectIsa();
+    return best;
+}
+
+PixelIsa GetPixelIsa()
+{
+    uint8_t isa = activeIsa.load(std::memory_order_relaxed);
+    if (isa == ISA_UNSET) {
+        isa = (uint8_t)BestPixelIsa();
+        activeIsa.store(isa, std::memory_order_relaxed);
+    }
+    return (PixelIsa)isa;
+}
+
+void SetPixelIsa(PixelIsa isa)
+{
+    activeIsa.store((uint8_t)std::min(isa, BestPixelIsa()), std::memory_order_relaxed);
+}
+
+void PremultiplyBGRA(uint32_t *pixels, size_t count)
+{
+    Active().premultiply(pixels, count);
+}
+
+void UnpremultiplyBGRA(uint32_t *pixels, size_t count)
+{
+    Active().unpremultiply(pixels, count);
+}
+
+void ResampleBGRA(const uint32_t *src, int srcWidth, int srcHeight, int srcStride,
+    uint32_t *dst, int dstWidth, int dstHeight, int dstStride, ResampleFilter filter)
+{
+    if (!src || !dst || srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) return;
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        for (int y = 0; y < srcHeight; y++) std::memcpy(dst + (size_t)y * dstStride, src + (size_t)y * srcStride, (size_t)srcWidth * sizeof(uint32_t));
+        return;
+    }
+
+    Weights wx, wy;
+    BuildWeights(srcWidth, dstWidth, filter, wx);
+    BuildWeights(srcHeight, dstHeight, filter, wy);
+
+    std::vector<float> tmp((size_t)srcHeight * dstWidth * 4);
+    const Kernels &k = Active();
+    k.horizontal(src, srcStride, srcHeight, wx, dstWidth, tmp.data());
+    k.vertical(tmp.data(), wy, dstWidth, dstHeight, dst, dstStride);
+}
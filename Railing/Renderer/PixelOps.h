@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// Pixel kernels for icons: BGRA premultiplication and resampling to the
+// exact device-pixel size an icon is drawn at, so each icon is filtered once
+// when it is decoded and the renderer only blits it 1:1. Each kernel has a
+// scalar version and SSE2/AVX2 versions picked at runtime; the vector
+// versions run the same arithmetic per channel in the same order, so their
+// output matches the scalar one bit for bit.
+// Pixels are 32-bit BGRA words (B in the low byte), rows `stride` pixels apart.
+
+enum class PixelIsa : uint8_t { Scalar, SSE2, AVX2 };
+
+// Best instruction set this CPU and OS support
+PixelIsa BestPixelIsa();
+PixelIsa GetPixelIsa();
+// Use `isa` (or the best supported one below it) from now on; for tests and benchmarks
+void SetPixelIsa(PixelIsa isa);
+
+// Straight alpha to premultiplied, rounding to nearest, in place
+void PremultiplyBGRA(uint32_t *pixels, size_t count);
+// Premultiplied back to straight alpha; fully transparent pixels become 0
+void UnpremultiplyBGRA(uint32_t *pixels, size_t count);
+
+enum class ResampleFilter : uint8_t {
+    Box,      // Area average: soft, no ringing
+    Lanczos3  // Sharp; colour is clamped to alpha so ringing can't overshoot
+};
+
+/// <summary>
+/// Resize premultiplied BGRA from src into dst (separable, horizontal pass
+/// first). Works for any sizes; meant for shrinking decoded icons.
+/// </summary>
+void ResampleBGRA(const uint32_t *src, int srcWidth, int srcHeight, int srcStride,
+    uint32_t *dst, int dstWidth, int dstHeight, int dstStride, ResampleFilter filter = ResampleFilter::Lanczos3);
@@ -7,6 +7,8 @@
 #include "Types.h"
 #include <wincodec.h>
 #include <GraphicsHub.h>
+#include "FrameProfiler.h"
+#include "WinEventQueue.h"
 #pragma comment(lib, "d2d1")
 #pragma comment(lib, "dwrite")
 #pragma comment(lib, "windowscodecs.lib")
@@ -73,19 +75,7 @@ RailingRenderer::RailingRenderer(HWND hwnd, const ThemeConfig &config) : hwnd(hw
     CreateDeviceResources();
     LoadAppIcon();
 
-    // Build module list
-    for (const auto &id : theme.layout.left) {
-        Module *m = ModuleFactory::Create(id, theme);
-        if (m) leftModules.push_back(m);
-    }
-    for (const auto &id : theme.layout.center) {
-        Module *m = ModuleFactory::Create(id, theme);
-        if (m) centerModules.push_back(m);
-    }
-    for (const auto &id : theme.layout.right) {
-        Module *m = ModuleFactory::Create(id, theme);
-        if (m) rightModules.push_back(m);
-    }
+    BuildModules();
     UpdateBlurRegion();
 }
 
@@ -110,39 +100,34 @@ void RailingRenderer::SetScreenPosition(std::string newPos)
     auto updateList = [&](std::vector<Module *> &list) {
         for (Module *m : list) {
             m->config.position = newPos;
-            if (m->config.position == "group") {
+            m->InvalidateLayout();
+            if (m->kind == ModuleType::Group) {
                 GroupModule *g = static_cast<GroupModule *>(m);
-                for (Module *child : g->children) child->config.position = newPos;
+                for (Module *child : g->children) {
+                    child->config.position = newPos;
+                    child->InvalidateLayout();
+                }
             }
         }
     };
 	updateList(leftModules);
 	updateList(centerModules);
 	updateList(rightModules);
+    damage.InvalidateAll();
 }
 
 void RailingRenderer::Reload(const char *name)
 {
     ThemeConfig newTheme = ThemeLoader::Load(name);
     this->theme = newTheme;
+    registry.Clear();
     for (Module *m : leftModules) delete m;
     for (Module *m : centerModules) delete m;
     for (Module *m : rightModules) delete m;
     leftModules.clear();
     centerModules.clear();
     rightModules.clear();
-    for (const auto &id : theme.layout.left) {
-        Module *m = ModuleFactory::Create(id, theme);
-        if (m) leftModules.push_back(m);
-    }
-    for (const auto &id : theme.layout.center) {
-        Module *m = ModuleFactory::Create(id, theme);
-        if (m) centerModules.push_back(m);
-    }
-    for (const auto &id : theme.layout.right) {
-        Module *m = ModuleFactory::Create(id, theme);
-        if (m) rightModules.push_back(m);
-    }
+    BuildModules();
     UpdateBlurRegion();
     if (theme.global.blur && theme.global.background.a < 1.0f) {
         EnableBlur(hwnd, D2D1ColorFToBlurColor(theme.global.background));
@@ -158,13 +143,21 @@ void RailingRenderer::Draw(const std::vector<WindowInfo> &windows, const std::ve
 {
     if (!m_d2dContext) CreateDeviceResources();
 	if (!m_d2dContext) return;
+    if (!m_canvas) CreateCanvas();
+    if (!m_canvas) return;
+    PROFILE_SCOPE("Frame");
+
+    // Every running tween/spring advances to this frame's time in one batch
+    if (animations) animations->Step();
 
-    for (Module *m : leftModules) m->Update();
-    for (Module *m : centerModules) m->Update();
-    for (Module *m : rightModules) m->Update();
+    for (auto *list : { &leftModules, &centerModules, &rightModules }) {
+        for (Module *m : *list) {
+            PROFILE_SCOPE("Update", m->config.id.c_str());
+            m->Update();
+        }
+    }
 
-    m_d2dContext->BeginDraw();
-    m_d2dContext->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+    m_d2dContext->SetTarget(m_canvas.Get());
 
     RenderContext ctx;
     ctx.dpi = GetDpiForWindow(hwnd);
@@ -199,6 +192,11 @@ void RailingRenderer::Draw(const std::vector<WindowInfo> &windows, const std::ve
         D2D1::Point2F(currentW / 2.0f, currentH / 2.0f)
     );
     m_d2dContext->SetTransform(transform);
+
+    // Stretched frames (auto-hide slide, pending resize) can't be patched in place
+    bool scaled = (scaleX != 1.0f || scaleY != 1.0f);
+    if (scaled || wasScaled) damage.InvalidateAll();
+    wasScaled = scaled;
     ctx.logicalWidth = targetW / scale;
     ctx.logicalHeight = targetH / scale;
 
@@ -207,6 +205,7 @@ void RailingRenderer::Draw(const std::vector<WindowInfo> &windows, const std::ve
     ctx.workspaces = pWorkspaceManager;
     ctx.wicFactory = GraphicsHub::Get().wicFactory.Get();;
     ctx.windows = &windows;
+    ctx.windowRegistry = windowRegistry;
     ctx.pinnedApps = (std::vector<std::wstring> *) & pinnedApps;
     ctx.foregroundWindow = activeWindow;
     ctx.textFormat = pTextFormat;
@@ -225,182 +224,257 @@ void RailingRenderer::Draw(const std::vector<WindowInfo> &windows, const std::ve
     ctx.wifiSignal = currentStats.wifiSignal;
     ctx.isWifiConnected = currentStats.isWifiConnected;
     ctx.appIcon = pAppIcon;
+    drawBackend.Bind(m_d2dContext.Get(), pBgBrush, ctx.writeFactory);
+    drawBackend.SetFormat(DrawFont::Text, pTextFormat);
+    drawBackend.SetFormat(DrawFont::Bold, pTextFormatBold);
+    drawBackend.SetFormat(DrawFont::Icon, pIconFormat);
+    drawBackend.SetFormat(DrawFont::Emoji, pEmojiFormat);
+    ctx.draw = &drawBackend;
     m_d2dContext->SetDpi((float)ctx.dpi, (float)ctx.dpi);
     ctx.scale = ctx.dpi / 96.0f;
+    if (ctx.scale != measuredScale) {
+        // Text and glyph atlases were measured (and rasterized) at the old scale
+        for (auto *list : { &leftModules, &centerModules, &rightModules }) {
+            for (Module *m : *list) {
+                m->InvalidateLayout();
+                if (m->kind != ModuleType::Group) continue;
+                for (Module *child : static_cast<GroupModule *>(m)->children) child->InvalidateLayout();
+            }
+        }
+        damage.InvalidateAll();
+        measuredScale = ctx.scale;
+    }
     ctx.hwnd = hwnd;
+    ctx.frames = frames;
+    ctx.animations = animations;
+
 
+    {
+        PROFILE_SCOPE("Layout");
+
+        // Measure: only modules that report changed content are re-measured
+        MeasureModules(ctx, leftModules);
+        MeasureModules(ctx, centerModules);
+        MeasureModules(ctx, rightModules);
+
+        // Arrange: only sections holding a resized module are re-laid out
+        layout.SetBounds(ctx.logicalWidth, ctx.logicalHeight, ctx.isVertical);
+        unsigned arranged = layout.Arrange();
+        if (arranged) PublishModuleRects();
+        if (arranged || hitIndex.GetScale() != ctx.scale || hitIndex.IsVertical() != ctx.isVertical) RebuildHitIndex(ctx);
+
+        // Damage: modules that changed, plus old and new rects of anything that moved
+        CollectDamage(ctx, leftModules, (arranged & (1u << (int)LayoutSection::Left)) != 0);
+        CollectDamage(ctx, centerModules, (arranged & (1u << (int)LayoutSection::Center)) != 0);
+        CollectDamage(ctx, rightModules, (arranged & (1u << (int)LayoutSection::Right)) != 0);
+        damage.Resolve(ctx.logicalWidth, ctx.logicalHeight);
+    }
 
+    if (damage.IsEmpty()) {
+        // Nothing changed, the last presented frame stands
+        m_d2dContext->SetTarget(m_targetBitmap.Get());
+        return;
+    }
+
+    D2D1_SIZE_U surface = m_canvas->GetPixelSize();
+    std::vector<DamagePixelRect> pixels = damage.ToPixels(ctx.scale, (int)surface.width, (int)surface.height);
+
+    float crossSize = layout.CrossExtent();
+    auto drawList = [&](const std::vector<Module *> &list, const LayoutRect *clip) {
+        for (Module *m : list) {
+            const LayoutRect &r = m->layoutNode.rect;
+            if (clip && !DamageTracker::Intersects(r, *clip)) continue;
+            m->Draw(ctx, r.left, r.top, crossSize);
+        }
+    };
+
+    {
+        PROFILE_SCOPE("BeginDraw");
+        m_d2dContext->BeginDraw();
+    }
+    {
+        PROFILE_SCOPE("Draw");
+        if (damage.IsFullFrame()) {
+            ctx.draw->Clear(DrawColor(0.0f, 0.0f, 0.0f, 0.0f));
+            DrawBarBackground(ctx);
+            drawList(leftModules, nullptr);
+            drawList(rightModules, nullptr);
+            drawList(centerModules, nullptr);
+        }
+        else {
+            for (const DamagePixelRect &p : pixels) {
+                // Clip to whole pixels so the cleared area matches the presented dirty rect
+                LayoutRect clip = { p.left / ctx.scale, p.top / ctx.scale, p.right / ctx.scale, p.bottom / ctx.scale };
+                ctx.draw->PushClip(clip);
+                ctx.draw->Clear(DrawColor(0.0f, 0.0f, 0.0f, 0.0f));
+                DrawBarBackground(ctx);
+                drawList(leftModules, &clip);
+                drawList(rightModules, &clip);
+                drawList(centerModules, &clip);
+                ctx.draw->PopClip();
+            }
+        }
+    }
+
+    HRESULT hr;
+    {
+        PROFILE_SCOPE("EndDraw");
+        hr = m_d2dContext->EndDraw();
+    }
+    m_d2dContext->SetTarget(m_targetBitmap.Get());
+    if (hr == D2DERR_RECREATE_TARGET) {
+        m_d2dContext.Reset();
+        m_swapChain.Reset();
+        m_targetBitmap.Reset();
+        m_canvas.Reset();
+        // Recorded lists and glyph atlases may point at bitmaps from the lost device
+        drawBackend.DiscardResources();
+        for (auto *list : { &leftModules, &centerModules, &rightModules }) {
+            for (Module *m : *list) {
+                m->displayList.Reset();
+                m->InvalidateLayout();
+            }
+        }
+        CreateDeviceResources();
+        return;
+    }
+
+    PROFILE_SCOPE("Present");
+    // Flip model buffers don't keep the previous frame, so hand over the whole
+    // canvas and let the dirty rects tell DWM what actually changed.
+    m_targetBitmap->CopyFromBitmap(nullptr, m_canvas.Get(), nullptr);
+
+    std::vector<RECT> dirtyRects;
+    DXGI_PRESENT_PARAMETERS params = {};
+    if (!damage.IsFullFrame()) {
+        for (const DamagePixelRect &p : pixels) dirtyRects.push_back({ p.left, p.top, p.right, p.bottom });
+        params.DirtyRectsCount = (UINT)dirtyRects.size();
+        params.pDirtyRects = dirtyRects.data();
+    }
+    m_swapChain->Present1(1, 0, &params);
+    damage.Reset();
+}
+
+void RailingRenderer::DrawBarBackground(RenderContext &ctx)
+{
     D2D1_RECT_F mainRect = D2D1::RectF(
         0.0f,
         0.0f,
         ctx.logicalWidth,
         ctx.logicalHeight);
     float r = theme.global.radius;
-    D2D1_ROUNDED_RECT globalShape = D2D1::RoundedRect(mainRect, r, r);
 
     if (theme.global.background.a > 0.0f) {
-        ctx.bgBrush->SetColor(theme.global.background);
-        if (r > 0) ctx.rt->FillRoundedRectangle(globalShape, ctx.bgBrush);
-        else ctx.rt->FillRectangle(mainRect, ctx.bgBrush);
+        if (r > 0) ctx.draw->FillRoundedRect(mainRect, r, theme.global.background);
+        else ctx.draw->FillRect(mainRect, theme.global.background);
     }
 
     if (theme.global.borderWidth > 0.0f) {
-        float r = theme.global.radius;
         float inset = theme.global.borderWidth / 2.0f;
         D2D1_RECT_F borderRect = D2D1::RectF(inset, inset, ctx.logicalWidth - inset, ctx.logicalHeight - inset);
-        D2D1_ROUNDED_RECT borderShape = D2D1::RoundedRect(borderRect, r, r);
-        ctx.borderBrush->SetColor(theme.global.borderColor);
-        if (r > 0) ctx.rt->DrawRoundedRectangle(borderShape, ctx.borderBrush, theme.global.borderWidth);
-        else ctx.rt->DrawRectangle(borderRect, ctx.borderBrush, theme.global.borderWidth);
+        if (r > 0) ctx.draw->StrokeRoundedRect(borderRect, r, theme.global.borderColor, theme.global.borderWidth);
+        else ctx.draw->StrokeRect(borderRect, theme.global.borderColor, theme.global.borderWidth);
     }
+}
 
-    for (Module *m : leftModules) m->CalculateWidth(ctx);
-    for (Module *m : centerModules) m->CalculateWidth(ctx);
-    for (Module *m : rightModules) m->CalculateWidth(ctx);
-
-    moduleRects.clear();
-
-    if (!ctx.isVertical) {
-        float barHeight = ctx.logicalHeight;
-
-        // Left
-        float cursorX = 0.0f;
-        for (Module *m : leftModules) {
-            float w = m->width;
-            D2D1_RECT_F rect = D2D1::RectF(cursorX, 0.0f, cursorX + w, barHeight);
-
-            // Register Hitbox
-            moduleRects[m->config.id] = rect;
-            moduleRects[m->config.type] = rect;
-            if (m->config.type == "group") {
-                GroupModule *g = (GroupModule *)m;
-                Style s = g->GetEffectiveStyle();
-
-                // Start inside the group's padding
-                float childX = cursorX + s.padding.left + s.margin.left;
-
-                for (auto *c : g->children) {
-                    float cW = c->width;
-                    moduleRects[c->config.id] = D2D1::RectF(childX, 0.0f, childX + cW, barHeight);
-                    childX += cW;
-                }
-            }
-
-            m->Draw(ctx, cursorX, 0.0f, barHeight);
-            cursorX += w;
-        }
-
-        // Right
-        float rightCursor = ctx.logicalWidth;
-        for (auto it = rightModules.rbegin(); it != rightModules.rend(); ++it) {
-            Module *m = *it;
-            float w = m->width;
-            rightCursor -= w;
-
-            D2D1_RECT_F rect = D2D1::RectF(rightCursor, 0.0f, rightCursor + w, barHeight);
-            moduleRects[m->config.id] = rect;
-            moduleRects[m->config.type] = rect;
-
-            if (m->config.type == "group") {
-                GroupModule *g = (GroupModule *)m;
-                Style s = g->GetEffectiveStyle();
-                float childX = rightCursor + s.padding.left + s.margin.left;
-                for (auto *c : g->children) {
-                    float cW = c->width;
-                    moduleRects[c->config.id] = D2D1::RectF(childX, 0.0f, childX + cW, barHeight);
-                    childX += cW;
-                }
-            }
+void RailingRenderer::BuildModules()
+{
+    for (const auto &id : theme.layout.left) {
+        Module *m = ModuleFactory::Create(id, theme);
+        if (m) leftModules.push_back(m);
+    }
+    for (const auto &id : theme.layout.center) {
+        Module *m = ModuleFactory::Create(id, theme);
+        if (m) centerModules.push_back(m);
+    }
+    for (const auto &id : theme.layout.right) {
+        Module *m = ModuleFactory::Create(id, theme);
+        if (m) rightModules.push_back(m);
+    }
 
-            m->Draw(ctx, rightCursor, 0.0f, barHeight);
-        }
+    for (Module *m : leftModules) RegisterModule(m);
+    for (Module *m : centerModules) RegisterModule(m);
+    for (Module *m : rightModules) RegisterModule(m);
 
-        // Center
-        float totalCenterW = 0;
-        for (Module *m : centerModules) totalCenterW += m->width;
-        float centerX = (ctx.logicalWidth - totalCenterW) / 2.0f;
-        for (Module *m : centerModules) {
-            float w = m->width;
-            D2D1_RECT_F rect = D2D1::RectF(centerX, 0.0f, centerX + w, barHeight);
-
-            moduleRects[m->config.id] = rect;
-            moduleRects[m->config.type] = rect;
-
-            if (m->config.type == "group") {
-                GroupModule *g = (GroupModule *)m;
-                Style s = g->GetEffectiveStyle();
-                float childX = centerX + s.padding.left + s.margin.left;
-                for (auto *c : g->children) {
-                    float cW = c->width;
-                    moduleRects[c->config.id] = D2D1::RectF(childX, 0.0f, childX + cW, barHeight);
-                    childX += cW;
-                }
-            }
+    auto nodesOf = [](const std::vector<Module *> &list) {
+        std::vector<LayoutNode *> nodes;
+        for (Module *m : list) nodes.push_back(&m->layoutNode);
+        return nodes;
+    };
+    layout.SetSection(LayoutSection::Left, nodesOf(leftModules));
+    layout.SetSection(LayoutSection::Center, nodesOf(centerModules));
+    layout.SetSection(LayoutSection::Right, nodesOf(rightModules));
+    damage.InvalidateAll();
+}
 
-            m->Draw(ctx, centerX, 0.0f, barHeight);
-            centerX += w;
-        }
+void RailingRenderer::RegisterModule(Module *m)
+{
+    m->handle = registry.Register(m, m->config.id, m->kind);
+    if (m->kind == ModuleType::Group) {
+        GroupModule *g = static_cast<GroupModule *>(m);
+        for (Module *c : g->children) RegisterModule(c);
     }
-    else {
-        // Vertical Logic with same fix
-        float barWidth = ctx.logicalWidth;
-
-        // Top (Left list)
-        float cursorY = 0.0f;
-        for (Module *m : leftModules) {
-            float h = m->width; // Vertical modules use width as height
-            D2D1_RECT_F rect = D2D1::RectF(0.0f, cursorY, barWidth, cursorY + h);
+}
 
-            moduleRects[m->config.id] = rect;
-            moduleRects[m->config.type] = rect;
+void RailingRenderer::MeasureModules(RenderContext &ctx, const std::vector<Module *> &list)
+{
+    for (Module *m : list) {
+        if (!m->NeedsMeasure(ctx)) continue;
+        m->CalculateWidth(ctx);
+        m->InvalidatePaint(); // New text/value means new pixels
+    }
+}
 
-            m->Draw(ctx, 0.0f, cursorY, barWidth);
-            cursorY += h;
+void RailingRenderer::CollectDamage(RenderContext &ctx, const std::vector<Module *> &list, bool moved)
+{
+    for (Module *m : list) {
+        const LayoutNode &n = m->layoutNode;
+        if (moved && n.previousRect != n.rect) {
+            damage.Add(n.previousRect); // Uncover where it used to be
+            damage.Add(n.rect);
         }
+        else if (m->NeedsPaint(ctx)) damage.Add(n.rect);
+    }
+}
 
-        // Bottom (Right list)
-        float bottomCursor = ctx.logicalHeight;
-        for (auto it = rightModules.rbegin(); it != rightModules.rend(); ++it) {
-            Module *m = *it;
-            float h = m->width;
-            bottomCursor -= h;
-
-            D2D1_RECT_F rect = D2D1::RectF(0.0f, bottomCursor, barWidth, bottomCursor + h);
-            moduleRects[m->config.id] = rect;
-            moduleRects[m->config.type] = rect;
-
-            m->Draw(ctx, 0.0f, bottomCursor, barWidth);
-        }
+void RailingRenderer::PublishModuleRects()
+{
+    // Handles are dense, so publishing is a flat copy with no allocation
+    const std::vector<Module *> &all = registry.All();
+    for (size_t h = 0; h < all.size(); h++) registry.SetRect((ModuleHandle)h, all[h]->layoutNode.rect);
+}
 
-        // Center
-        float totalCenterH = 0;
-        for (Module *m : centerModules) totalCenterH += m->width;
-        float centerY = (ctx.logicalHeight - totalCenterH) / 2.0f;
-        for (Module *m : centerModules) {
-            float h = m->width;
-            D2D1_RECT_F rect = D2D1::RectF(0.0f, centerY, barWidth, centerY + h);
+static void IndexModule(HitIndex &index, Module *m, int parent, std::vector<LayoutRect> &parts)
+{
+    const LayoutRect &r = m->layoutNode.rect;
+    int self = index.Add(r, m, -1, parent);
+    if (self < 0) return;
 
-            moduleRects[m->config.id] = rect;
-            moduleRects[m->config.type] = rect;
+    parts.clear();
+    m->GetHitParts(r, parts);
+    for (size_t i = 0; i < parts.size(); i++) index.Add(parts[i], m, (int)i, self);
 
-            m->Draw(ctx, 0.0f, centerY, barWidth);
-            centerY += h;
-        }
+    if (m->kind == ModuleType::Group) {
+        GroupModule *g = static_cast<GroupModule *>(m);
+        for (Module *c : g->children) IndexModule(index, c, self, parts);
     }
+}
 
-    HRESULT hr = m_d2dContext->EndDraw();
-    if (hr == D2DERR_RECREATE_TARGET) {
-        m_d2dContext.Reset();
-        m_swapChain.Reset();
-        CreateDeviceResources();
-    }
-    else m_swapChain->Present(1, 0);
+void RailingRenderer::RebuildHitIndex(const RenderContext &ctx)
+{
+    hitIndex.Begin(ctx.isVertical, ctx.scale);
+    std::vector<LayoutRect> parts;
+    for (Module *m : leftModules) IndexModule(hitIndex, m, -1, parts);
+    for (Module *m : centerModules) IndexModule(hitIndex, m, -1, parts);
+    for (Module *m : rightModules) IndexModule(hitIndex, m, -1, parts);
+    hitIndex.Finish();
 }
 
 void RailingRenderer::Resize()
 {
     if (!m_d2dContext || !m_swapChain) return;
     m_d2dContext->SetTarget(nullptr);
+    m_targetBitmap.Reset(); // Back buffer references must be dropped before ResizeBuffers
 
     RECT rc; GetClientRect(hwnd, &rc);
     m_swapChain->ResizeBuffers(0, rc.right - rc.left, rc.bottom - rc.top, DXGI_FORMAT_UNKNOWN, 0);
@@ -414,9 +488,9 @@ void RailingRenderer::Resize()
         D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)
     );
 
-    ComPtr<ID2D1Bitmap1> d2dTargetBitmap;
-    m_d2dContext->CreateBitmapFromDxgiSurface(dxgiBackBuffer.Get(), &bitmapProperties, &d2dTargetBitmap);
-    m_d2dContext->SetTarget(d2dTargetBitmap.Get());
+    m_d2dContext->CreateBitmapFromDxgiSurface(dxgiBackBuffer.Get(), &bitmapProperties, &m_targetBitmap);
+    m_d2dContext->SetTarget(m_targetBitmap.Get());
+    CreateCanvas();
 
     UpdateBlurRegion();
 }
@@ -494,9 +568,9 @@ void RailingRenderer::CreateDeviceResources() {
             D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
             D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
 
-		ComPtr<ID2D1Bitmap1> d2dTargetBitmap;
-		m_d2dContext->CreateBitmapFromDxgiSurface(dxgiBackBuffer.Get(), &bitmapProps, &d2dTargetBitmap);
-		m_d2dContext->SetTarget(d2dTargetBitmap.Get());
+		m_d2dContext->CreateBitmapFromDxgiSurface(dxgiBackBuffer.Get(), &bitmapProps, &m_targetBitmap);
+		m_d2dContext->SetTarget(m_targetBitmap.Get());
+		CreateCanvas();
     }
 
     if (m_d2dContext) {
@@ -510,6 +584,20 @@ void RailingRenderer::CreateDeviceResources() {
     }
 }
 
+void RailingRenderer::CreateCanvas()
+{
+    m_canvas.Reset();
+    if (!m_d2dContext || !m_targetBitmap) return;
+
+    D2D1_BITMAP_PROPERTIES1 canvasProps = D2D1::BitmapProperties1(
+        D2D1_BITMAP_OPTIONS_TARGET,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
+
+    HRESULT hr = m_d2dContext->CreateBitmap(m_targetBitmap->GetPixelSize(), nullptr, 0, &canvasProps, &m_canvas);
+    if (FAILED(hr)) OutputDebugStringA("Failed to create canvas bitmap.\n");
+    damage.InvalidateAll(); // Fresh canvas has no retained content
+}
+
 ID2D1Factory *RailingRenderer::GetFactory() const { return GraphicsHub::Get().d2dFactory.Get(); }
 IWICImagingFactory *RailingRenderer::GetWICFactory() const { return GraphicsHub::Get().wicFactory.Get(); }
 IDWriteFactory *RailingRenderer::GetWriteFactory() const { return GraphicsHub::Get().writeFactory.Get(); }
@@ -551,49 +639,46 @@ void RailingRenderer::EnableBlur(HWND hwnd, DWORD nColor) {
 
     }
 }
-bool HitTestRecursive(const std::vector<Module *> &list, POINT pt, float scale) {
-    for (Module *m : list) {
-        // Check the module itself
-        RECT r = {
-            (LONG)(m->cachedRect.left * scale),
-            (LONG)(m->cachedRect.top * scale),
-            (LONG)(m->cachedRect.right * scale),
-            (LONG)(m->cachedRect.bottom * scale)
-        };
-        if (PtInRect(&r, pt)) return true;
-        if (m->config.type == "group") { // If a group, check children
-            GroupModule *group = static_cast<GroupModule *>(m);
-            if (HitTestRecursive(group->children, pt, scale)) return true;
-        }
-    }
-    return false;
-}
 bool RailingRenderer::HitTest(POINT pt)
 {
     // Check App Icon
     if (PtInRect(&iconClickRect, pt)) return true;
 
-    // Check Modules (Recursive)
-    float scale = GetDpiForWindow(hwnd) / 96.0f;
+    // Modules and group children, published by the last arrange pass
+    return hitIndex.Find(pt.x, pt.y).module != nullptr;
+}
 
-    if (HitTestRecursive(leftModules, pt, scale)) return true;
-    if (HitTestRecursive(centerModules, pt, scale)) return true;
-    if (HitTestRecursive(rightModules, pt, scale)) return true;
+D2D1_RECT_F RailingRenderer::GetModuleRect(const std::string &moduleId)
+{
+    // Ids first, then type names ("dock") for modules looked up by kind
+    ModuleHandle h = registry.Find(moduleId);
+    if (h == INVALID_MODULE) h = registry.FindType(ModuleTypeFromName(moduleId));
+    if (h == INVALID_MODULE) return D2D1::RectF(0, 0, 0, 0);
 
-    return false;
+    const LayoutRect &r = registry.GetRect(h);
+    return D2D1::RectF(r.left, r.top, r.right, r.bottom);
 }
 
-D2D1_RECT_F RailingRenderer::GetModuleRect(std::string moduleId)
+Module *RailingRenderer::GetModule(const std::string &id)
 {
-    if (moduleRects.count(moduleId)) return moduleRects[moduleId];
-    return D2D1::RectF(0, 0, 0, 0);
+    return registry.Get(registry.Find(id));
 }
 
-Module *RailingRenderer::GetModule(std::string id)
+bool RailingRenderer::RouteWindowEvents(const WinEventBatch &batch)
 {
-    Module *m = FindModuleRecursive(leftModules, id);
-    if (!m) m = FindModuleRecursive(centerModules, id);
-    return m ? m : FindModuleRecursive(rightModules, id);
+    bool routed = false;
+    for (Module *m : registry.All()) {
+        if (m->kind == ModuleType::Dock && (batch.routes & WINEVENT_ROUTE_DOCK)) {
+            static_cast<DockModule *>(m)->MarkDirty(); // Re-sync the items on the next frame
+            m->InvalidatePaint();
+            routed = true;
+        }
+        else if (m->kind == ModuleType::Workspaces && (batch.routes & WINEVENT_ROUTE_WORKSPACES)) {
+            m->InvalidatePaint();
+            routed = true;
+        }
+    }
+    return routed;
 }
 
 void RailingRenderer::LoadAppIcon()
@@ -640,18 +725,4 @@ void RailingRenderer::LoadAppIcon()
         }
         DestroyIcon(hIcon);
 	}
-}
-
-Module *RailingRenderer::FindModuleRecursive(const std::vector<Module *> &list, const std::string &id)
-{
-    for (Module *m : list) {
-        if (m->config.id == id) return m;
-
-        if (m->config.type == "group") {
-            GroupModule *group = static_cast<GroupModule *>(m);
-            Module *found = FindModuleRecursive(group->children, id);
-            if (found) return found;
-        }
-    }
-    return nullptr;
 }
\ No newline at end of file
@@ -12,6 +12,12 @@
 #include "Module.h"
 #include "ThemeLoader.h"
 #include "Types.h"
+#include "LayoutEngine.h"
+#include "DamageTracker.h"
+#include "HitIndex.h"
+#include "D2DBackend.h"
+
+struct WinEventBatch;
 
 class RailingRenderer
 {
@@ -44,11 +50,19 @@ public:
     static void EnableBlur(HWND hwnd, DWORD nColor);
     void UpdateBlurRegion();
     bool HitTest(POINT pt);
-    D2D1_RECT_F GetModuleRect(std::string moduleId);
-    Module *GetModule(std::string id);
+    D2D1_RECT_F GetModuleRect(const std::string &moduleId);
+    Module *GetModule(const std::string &id);
+    Module *GetModule(ModuleType type) { return registry.Get(registry.FindType(type)); }
+    const ModuleRegistry &GetRegistry() const { return registry; }
+    // Hand a frame's window events to the modules that show windows; true if any did
+    bool RouteWindowEvents(const WinEventBatch &batch);
     RECT GetAppIconRect() { return iconClickRect; }
+    const HitIndex &GetHitIndex() const { return hitIndex; }
 
     WorkspaceManager *pWorkspaceManager;
+    FrameScheduler *frames = nullptr; // Owned by the bar; modules request frames through the context
+    AnimationEngine *animations = nullptr;
+    const WindowRegistry *windowRegistry = nullptr; // Shared by all bars, owned by Railing
 
     IDWriteTextFormat *GetTextFormat() const { return pTextFormat; }
     IDWriteTextFormat *GetIconFormat() const { return pIconFormat; }
@@ -58,6 +72,8 @@ private:
 
     Microsoft::WRL::ComPtr<IDXGISwapChain1> m_swapChain;
 	Microsoft::WRL::ComPtr<ID2D1DeviceContext> m_d2dContext;
+    Microsoft::WRL::ComPtr<ID2D1Bitmap1> m_targetBitmap;    // Swap chain back buffer
+    Microsoft::WRL::ComPtr<ID2D1Bitmap1> m_canvas;          // Retained frame, only damaged regions are redrawn
     Microsoft::WRL::ComPtr<IDCompositionTarget> m_dcompTarget;
     Microsoft::WRL::ComPtr<IDCompositionVisual> m_dcompVisual;
     IDWriteTextFormat *pTextFormatBold = nullptr;
@@ -71,10 +87,23 @@ private:
 
     ID2D1Bitmap *pAppIcon = nullptr;
     RECT iconClickRect = {};
-    std::map<std::string, D2D1_RECT_F> moduleRects;
+    ModuleRegistry registry;
+    LayoutEngine layout;
+    DamageTracker damage;
+    HitIndex hitIndex;
+    D2DBackend drawBackend;
+    bool wasScaled = false;
+    float measuredScale = 0.0f; // DPI scale the modules were last measured at
 
     void LoadAppIcon();
-    Module *FindModuleRecursive(const std::vector<Module *> &list, const std::string &id);
+    void BuildModules();
+    void MeasureModules(RenderContext &ctx, const std::vector<Module *> &list);
+    void PublishModuleRects();
+    void RebuildHitIndex(const RenderContext &ctx);
+    void CreateCanvas();
+    void CollectDamage(RenderContext &ctx, const std::vector<Module *> &list, bool moved);
+    void DrawBarBackground(RenderContext &ctx);
+    void RegisterModule(Module *m);
 
     static inline DWORD D2D1ColorFToBlurColor(const D2D1_COLOR_F &c)
     {
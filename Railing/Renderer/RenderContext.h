@@ -5,10 +5,17 @@
 #include <string>
 #include <vector>
 #include "ThemeTypes.h"
+#include "DrawingBackend.h"
 #include "WorkspaceManager.h"
+#include "FrameScheduler.h"
+#include "AnimationEngine.h"
 #include <Types.h>
 
+class WindowRegistry;
+
 struct RenderContext {
+    DrawingBackend *draw = nullptr; /* DRAWING (modules render through this) */
+
     ID2D1RenderTarget *rt; /* D2D RESOURCES */
     ID2D1Factory *factory;
 	ID2D1SolidColorBrush *bgBrush;
@@ -36,6 +43,7 @@ struct RenderContext {
     ID2D1Bitmap *appIcon = nullptr;
 
     const std::vector<WindowInfo> *windows; // Live app list
+    const WindowRegistry *windowRegistry = nullptr; // Same windows with change deltas; null when headless
     std::vector<std::wstring> *pinnedApps;
     HWND foregroundWindow;
     WorkspaceManager *workspaces;
@@ -44,6 +52,8 @@ struct RenderContext {
     UINT dpi = 96;
     bool isVertical = false;
     HWND hwnd;
+    FrameScheduler *frames = nullptr; // Ask for a repaint instead of invalidating the window
+    AnimationEngine *animations = nullptr; // Stepped once per frame before modules draw
     float logicalWidth = 0.0f;
     float logicalHeight = 0.0f;
 };
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "SoftwareBackend.h"
+#include "BitmapFont.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    inline float Clamp01(float v) { return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v); }
+
+    // Signed distance from a point to a rounded box (negative inside)
+    inline float RoundedBoxDistance(float px, float py, float cx, float cy, float hx, float hy, float r) {
+        float qx = std::fabs(px - cx) - (hx - r);
+        float qy = std::fabs(py - cy) - (hy - r);
+        float ox = (std::max)(qx, 0.0f);
+        float oy = (std::max)(qy, 0.0f);
+        return std::sqrt(ox * ox + oy * oy) + (std::min)((std::max)(qx, qy), 0.0f) - r;
+    }
+}
+
+SoftwareBackend::SoftwareBackend(int width, int height, float scale) : scale(scale)
+{
+    Resize(width, height);
+}
+
+void SoftwareBackend::Resize(int width, int height)
+{
+    this->width = width > 0 ? width : 0;
+    this->height = height > 0 ? height : 0;
+    pixels.assign((size_t)this->width * this->height, 0);
+    clips.clear();
+}
+
+SoftwareBackend::ClipBox SoftwareBackend::CurrentClip() const
+{
+    if (clips.empty()) return { 0, 0, width, height };
+    return clips.back();
+}
+
+SoftwareBackend::ClipBox SoftwareBackend::ToPixelBox(float left, float top, float right, float bottom) const
+{
+    ClipBox clip = CurrentClip();
+    ClipBox box = {
+        (int)std::floor(left), (int)std::floor(top),
+        (int)std::ceil(right), (int)std::ceil(bottom)
+    };
+    box.left = (std::max)(box.left, clip.left);
+    box.top = (std::max)(box.top, clip.top);
+    box.right = (std::min)(box.right, clip.right);
+    box.bottom = (std::min)(box.bottom, clip.bottom);
+    return box;
+}
+
+void SoftwareBackend::BlendPixel(int x, int y, const DrawColor &color, float coverage)
+{
+    float sa = Clamp01(color.a * coverage);
+    if (sa <= 0.0f) return;
+
+    uint32_t &dst = pixels[(size_t)y * width + x];
+    float inv = 1.0f - sa;
+    float da = (float)((dst >> 24) & 0xFF);
+    float dr = (float)((dst >> 16) & 0xFF);
+    float dg = (float)((dst >> 8) & 0xFF);
+    float db = (float)(dst & 0xFF);
+
+    // Source-over on premultiplied values
+    uint32_t a = (uint32_t)(sa * 255.0f + da * inv + 0.5f);
+    uint32_t r = (uint32_t)(Clamp01(color.r) * sa * 255.0f + dr * inv + 0.5f);
+    uint32_t g = (uint32_t)(Clamp01(color.g) * sa * 255.0f + dg * inv + 0.5f);
+    uint32_t b = (uint32_t)(Clamp01(color.b) * sa * 255.0f + db * inv + 0.5f);
+    dst = ((a > 255 ? 255 : a) << 24) | ((r > 255 ? 255 : r) << 16) | ((g > 255 ? 255 : g) << 8) | (b > 255 ? 255 : b);
+}
+
+template <typename Coverage>
+void SoftwareBackend::Rasterize(float left, float top, float right, float bottom, const DrawColor &color, Coverage coverageAt)
+{
+    primitiveCount++;
+    if (color.a <= 0.0f) return;
+
+    ClipBox box = ToPixelBox(left, top, right, bottom);
+    for (int y = box.top; y < box.bottom; y++) {
+        for (int x = box.left; x < box.right; x++) {
+            float c = coverageAt(x + 0.5f, y + 0.5f);
+            if (c > 0.0f) BlendPixel(x, y, color, c);
+        }
+    }
+}
+
+void SoftwareBackend::Clear(const DrawColor &color)
+{
+    float a = Clamp01(color.a);
+    uint32_t value =
+        ((uint32_t)(a * 255.0f + 0.5f) << 24) |
+        ((uint32_t)(Clamp01(color.r) * a * 255.0f + 0.5f) << 16) |
+        ((uint32_t)(Clamp01(color.g) * a * 255.0f + 0.5f) << 8) |
+        (uint32_t)(Clamp01(color.b) * a * 255.0f + 0.5f);
+
+    // Like ID2D1RenderTarget::Clear, respects the current clip
+    ClipBox box = CurrentClip();
+    for (int y = box.top; y < box.bottom; y++) {
+        std::fill(pixels.begin() + (size_t)y * width + box.left, pixels.begin() + (size_t)y * width + box.right, value);
+    }
+}
+
+void SoftwareBackend::PushClip(const DrawRect &rect)
+{
+    ClipBox box = ToPixelBox(rect.left * scale, rect.top * scale, rect.right * scale, rect.bottom * scale);
+    if (box.right < box.left) box.right = box.left;
+    if (box.bottom < box.top) box.bottom = box.top;
+    clips.push_back(box);
+}
+
+void SoftwareBackend::PopClip()
+{
+    if (!clips.empty()) clips.pop_back();
+}
+
+void SoftwareBackend::FillRect(const DrawRect &rect, const DrawColor &color)
+{
+    FillRoundedRect(rect, 0.0f, color);
+}
+
+void SoftwareBackend::StrokeRect(const DrawRect &rect, const DrawColor &color, float strokeWidth)
+{
+    StrokeRoundedRect(rect, 0.0f, color, strokeWidth);
+}
+
+void SoftwareBackend::FillRoundedRect(const DrawRect &rect, float radius, const DrawColor &color)
+{
+    float l = rect.left * scale, t = rect.top * scale, r = rect.right * scale, b = rect.bottom * scale;
+    if (r <= l || b <= t) return;
+
+    float cx = (l + r) / 2.0f, cy = (t + b) / 2.0f;
+    float hx = (r - l) / 2.0f, hy = (b - t) / 2.0f;
+    float rad = (std::min)(radius * scale, (std::min)(hx, hy));
+
+    Rasterize(l, t, r, b, color, [&](float px, float py) {
+        return Clamp01(0.5f - RoundedBoxDistance(px, py, cx, cy, hx, hy, rad));
+    });
+}
+
+void SoftwareBackend::StrokeRoundedRect(const DrawRect &rect, float radius, const DrawColor &color, float strokeWidth)
+{
+    float l = rect.left * scale, t = rect.top * scale, r = rect.right * scale, b = rect.bottom * scale;
+    if (r < l || b < t) return;
+
+    float cx = (l + r) / 2.0f, cy = (t + b) / 2.0f;
+    float hx = (r - l) / 2.0f, hy = (b - t) / 2.0f;
+    float rad = (std::min)(radius * scale, (std::min)(hx, hy));
+    float half = strokeWidth * scale / 2.0f;
+
+    // Stroke is centered on the outline, as in Direct2D
+    Rasterize(l - half - 1.0f, t - half - 1.0f, r + half + 1.0f, b + half + 1.0f, color, [&](float px, float py) {
+        float d = RoundedBoxDistance(px, py, cx, cy, hx, hy, rad);
+        return Clamp01(half + 0.5f - std::fabs(d));
+    });
+}
+
+void SoftwareBackend::FillEllipse(float cx, float cy, float rx, float ry, const DrawColor &color)
+{
+    cx *= scale; cy *= scale; rx *= scale; ry *= scale;
+    if (rx <= 0.0f || ry <= 0.0f) return;
+
+    float minR = (std::min)(rx, ry);
+    Rasterize(cx - rx, cy - ry, cx + rx, cy + ry, color, [&](float px, float py) {
+        float nx = (px - cx) / rx, ny = (py - cy) / ry;
+        float d = (std::sqrt(nx * nx + ny * ny) - 1.0f) * minR;
+        return Clamp01(0.5f - d);
+    });
+}
+
+void SoftwareBackend::DrawImage(const ImageRef &image, const DrawRect &dest, float opacity)
+{
+    primitiveCount++;
+    if (!image.pixels || image.width <= 0 || image.height <= 0 || opacity <= 0.0f) return;
+
+    float l = dest.left * scale, t = dest.top * scale, r = dest.right * scale, b = dest.bottom * scale;
+    if (r <= l || b <= t) return;
+
+    int stride = image.stride > 0 ? image.stride : image.width;
+    float sx = image.width / (r - l);
+    float sy = image.height / (b - t);
+
+    ClipBox box = ToPixelBox(l, t, r, b);
+    for (int y = box.top; y < box.bottom; y++) {
+        int v = std::clamp((int)((y + 0.5f - t) * sy), 0, image.height - 1);
+        const uint32_t *row = image.pixels + (size_t)v * stride;
+        for (int x = box.left; x < box.right; x++) {
+            int u = std::clamp((int)((x + 0.5f - l) * sx), 0, image.width - 1);
+            uint32_t src = row[u];
+            float a = ((src >> 24) & 0xFF) / 255.0f;
+            if (a <= 0.0f) continue;
+
+            // Un-premultiply so BlendPixel can apply alpha and opacity uniformly
+            DrawColor c(
+                ((src >> 16) & 0xFF) / 255.0f / a,
+                ((src >> 8) & 0xFF) / 255.0f / a,
+                (src & 0xFF) / 255.0f / a,
+                a);
+            BlendPixel(x, y, c, opacity);
+        }
+    }
+}
+
+void SoftwareBackend::DrawMask(const ImageRef &mask, const DrawRect &src, const DrawRect &dest, const DrawColor &color)
+{
+    primitiveCount++;
+    if (!mask.pixels || mask.width <= 0 || mask.height <= 0 || src.Width() <= 0.0f || src.Height() <= 0.0f || color.a <= 0.0f) return;
+
+    float l = dest.left * scale, t = dest.top * scale, r = dest.right * scale, b = dest.bottom * scale;
+    if (r <= l || b <= t) return;
+
+    int stride = mask.stride > 0 ? mask.stride : mask.width;
+    float sx = src.Width() / (r - l);
+    float sy = src.Height() / (b - t);
+
+    ClipBox box = ToPixelBox(l, t, r, b);
+    for (int y = box.top; y < box.bottom; y++) {
+        int v = std::clamp((int)(src.top + (y + 0.5f - t) * sy), 0, mask.height - 1);
+        const uint32_t *row = mask.pixels + (size_t)v * stride;
+        for (int x = box.left; x < box.right; x++) {
+            int u = std::clamp((int)(src.left + (x + 0.5f - l) * sx), 0, mask.width - 1);
+            BlendPixel(x, y, color, ((row[u] >> 24) & 0xFF) / 255.0f);
+        }
+    }
+}
+
+ImageRef SoftwareBackend::CreateTextMask(const std::vector<MaskCell> &cells, DrawFont font, int pixelWidth, int pixelHeight, float scale)
+{
+    ImageRef image;
+    if (pixelWidth <= 0 || pixelHeight <= 0) return image;
+
+    SoftwareBackend target(pixelWidth, pixelHeight, scale);
+    for (int i = 0; i < (int)DrawFont::Count; i++) target.fontSizes[i] = fontSizes[i];
+    for (const MaskCell &cell : cells) target.DrawString(cell.text, cell.rect, font, DrawColor(1.0f, 1.0f, 1.0f, 1.0f));
+
+    uint32_t *buffer = new uint32_t[target.pixels.size()];
+    std::copy(target.pixels.begin(), target.pixels.end(), buffer);
+    image.pixels = buffer;
+    image.width = pixelWidth;
+    image.height = pixelHeight;
+    image.stride = pixelWidth;
+    return image;
+}
+
+void SoftwareBackend::ReleaseImage(ImageRef &image)
+{
+    delete[] image.pixels;
+    image = ImageRef();
+}
+
+int SoftwareBackend::GlyphScale(DrawFont font) const
+{
+    int g = (int)std::lround(fontSizes[(int)font] * scale / BitmapFont::CELL_H);
+    return g < 1 ? 1 : g;
+}
+
+TextMetrics SoftwareBackend::MeasureString(const std::wstring &text, DrawFont font)
+{
+    TextMetrics m;
+    if (text.empty()) return m;
+
+    int g = GlyphScale(font);
+    m.width = (float)((int)text.length() * BitmapFont::CELL_W * g - g) / scale;
+    m.height = (float)(BitmapFont::CELL_H * g) / scale;
+    m.advance = (float)((int)text.length() * BitmapFont::CELL_W * g) / scale;
+    return m;
+}
+
+void SoftwareBackend::DrawString(const std::wstring &text, const DrawRect &rect, DrawFont font, const DrawColor &color, unsigned flags)
+{
+    primitiveCount++;
+    if (text.empty() || color.a <= 0.0f) return;
+
+    if (flags & DRAW_TEXT_CLIP) PushClip(rect);
+
+    // Bar formats are centered on both axes
+    int g = GlyphScale(font);
+    float textW = (float)((int)text.length() * BitmapFont::CELL_W * g - g);
+    float textH = (float)(BitmapFont::GLYPH_H * g);
+    int originX = (int)std::lround((rect.left + rect.right) * scale / 2.0f - textW / 2.0f);
+    int originY = (int)std::lround((rect.top + rect.bottom) * scale / 2.0f - textH / 2.0f);
+
+    ClipBox clip = CurrentClip();
+    int penX = originX;
+    for (wchar_t ch : text) {
+        const uint8_t *glyph = BitmapFont::Glyph(ch);
+        for (int col = 0; col < BitmapFont::GLYPH_W; col++) {
+            uint8_t bits = glyph[col];
+            for (int row = 0; bits && row < BitmapFont::GLYPH_H; row++, bits >>= 1) {
+                if (!(bits & 1)) continue;
+                int x0 = (std::max)(penX + col * g, clip.left);
+                int y0 = (std::max)(originY + row * g, clip.top);
+                int x1 = (std::min)(penX + (col + 1) * g, clip.right);
+                int y1 = (std::min)(originY + (row + 1) * g, clip.bottom);
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) BlendPixel(x, y, color, 1.0f);
+                }
+            }
+        }
+        penX += BitmapFont::CELL_W * g;
+    }
+
+    if (flags & DRAW_TEXT_CLIP) PopClip();
+}
+
+uint64_t SoftwareBackend::Checksum() const
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (uint32_t p : pixels) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= (p >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+size_t SoftwareBackend::CountDifferences(const SoftwareBackend &a, const SoftwareBackend &b)
+{
+    if (a.width != b.width || a.height != b.height) return SIZE_MAX;
+
+    size_t diff = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        if (a.pixels[i] != b.pixels[i]) diff++;
+    }
+    return diff;
+}
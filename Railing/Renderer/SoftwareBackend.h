@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "DrawingBackend.h"
+
+/// <summary>
+/// CPU rasterizer implementing DrawingBackend. Renders into a premultiplied
+/// BGRA buffer (same layout as the swap chain) with analytic anti-aliasing,
+/// and draws text with the bundled bitmap font. No platform dependencies, so
+/// full frames can be rendered headless and the buffers diffed.
+/// </summary>
+class SoftwareBackend : public DrawingBackend
+{
+public:
+    SoftwareBackend(int width = 0, int height = 0, float scale = 1.0f);
+
+    void Resize(int width, int height);
+    void SetScale(float scale) { this->scale = scale; }
+    void SetFontSize(DrawFont font, float size) { fontSizes[(int)font] = size; }
+
+    void Clear(const DrawColor &color) override;
+    void PushClip(const DrawRect &rect) override;
+    void PopClip() override;
+
+    void FillRect(const DrawRect &rect, const DrawColor &color) override;
+    void StrokeRect(const DrawRect &rect, const DrawColor &color, float strokeWidth) override;
+    void FillRoundedRect(const DrawRect &rect, float radius, const DrawColor &color) override;
+    void StrokeRoundedRect(const DrawRect &rect, float radius, const DrawColor &color, float strokeWidth) override;
+    void FillEllipse(float cx, float cy, float rx, float ry, const DrawColor &color) override;
+    void DrawImage(const ImageRef &image, const DrawRect &dest, float opacity = 1.0f) override;
+    void DrawString(const std::wstring &text, const DrawRect &rect, DrawFont font, const DrawColor &color, unsigned flags = DRAW_TEXT_NONE) override;
+    void DrawMask(const ImageRef &mask, const DrawRect &src, const DrawRect &dest, const DrawColor &color) override;
+
+    TextMetrics MeasureString(const std::wstring &text, DrawFont font) override;
+    float GetFontSize(DrawFont font) const override { return fontSizes[(int)font]; }
+
+    // Masks are heap pixel buffers owned by the caller until ReleaseImage
+    ImageRef CreateTextMask(const std::vector<MaskCell> &cells, DrawFont font, int pixelWidth, int pixelHeight, float scale) override;
+    void ReleaseImage(ImageRef &image) override;
+
+    // Frame output (0xAARRGGBB, premultiplied, row-major, stride == width)
+    const std::vector<uint32_t> &GetPixels() const { return pixels; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    uint32_t GetPixel(int x, int y) const { return pixels[(size_t)y * width + x]; }
+
+    /// <summary>
+    /// FNV-1a hash of the buffer, for cheap frame-to-frame comparisons.
+    /// </summary>
+    uint64_t Checksum() const;
+
+    /// <summary>
+    /// Number of differing pixels between two equally sized frames
+    /// (SIZE_MAX if the sizes differ).
+    /// </summary>
+    static size_t CountDifferences(const SoftwareBackend &a, const SoftwareBackend &b);
+
+    size_t primitiveCount = 0; // Draw calls since construction
+
+private:
+    struct ClipBox { int left, top, right, bottom; };
+
+    std::vector<uint32_t> pixels;
+    int width = 0;
+    int height = 0;
+    float scale = 1.0f;
+    std::vector<ClipBox> clips;
+    float fontSizes[(int)DrawFont::Count] = { 12.0f, 12.0f, 14.0f, 16.0f };
+
+    ClipBox CurrentClip() const;
+    ClipBox ToPixelBox(float left, float top, float right, float bottom) const;
+    void BlendPixel(int x, int y, const DrawColor &color, float coverage);
+    int GlyphScale(DrawFont font) const;
+
+    template <typename Coverage>
+    void Rasterize(float left, float top, float right, float bottom, const DrawColor &color, Coverage coverageAt);
+};
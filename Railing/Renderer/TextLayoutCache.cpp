@@ -0,0 +1,114 @@
+#include "TextLayoutCache.h"
+#include <cstring>
+#include <functional>
+
+size_t TextLayoutCache::KeyHash::operator()(const TextLayoutKeyView &k) const
+{
+    size_t h = std::hash<std::wstring_view>{}(k.text);
+    auto mix = [&h](size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+
+    uint32_t w, ht;
+    std::memcpy(&w, &k.maxWidth, sizeof(w));
+    std::memcpy(&ht, &k.maxHeight, sizeof(ht));
+    mix(k.format);
+    mix(w);
+    mix(ht);
+    return h;
+}
+
+size_t TextLayoutCache::DescHash::operator()(const TextFormatDesc &d) const
+{
+    size_t h = std::hash<std::wstring>{}(d.family);
+    auto mix = [&h](size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+
+    uint32_t size;
+    std::memcpy(&size, &d.size, sizeof(size));
+    mix(std::hash<std::wstring>{}(d.locale));
+    mix(size);
+    mix((size_t)(d.weight << 8 | d.style << 4 | d.stretch));
+    mix((size_t)(d.textAlignment << 8 | d.paragraphAlignment << 4 | d.wordWrapping));
+    return h;
+}
+
+uint32_t TextLayoutCache::FormatId(const TextFormatDesc &desc)
+{
+    auto found = formatIds.find(desc);
+    if (found != formatIds.end()) return found->second;
+    uint32_t id = (uint32_t)formatIds.size() + 1;
+    formatIds.emplace(desc, id);
+    return id;
+}
+
+size_t TextLayoutCache::CostOf(const Entry &e)
+{
+    // The key string lives in both the map and the list node
+    return sizeof(Entry) + 2 * e.key.text.size() * sizeof(wchar_t) + e.shaped.bytes;
+}
+
+const ShapedText *TextLayoutCache::Get(TextShaper &shaper, std::wstring_view text, uint32_t formatId, const void *format, float maxWidth, float maxHeight)
+{
+    auto found = entries.find(TextLayoutKeyView(text, formatId, maxWidth, maxHeight));
+    if (found != entries.end()) {
+        hits++;
+        lru.splice(lru.begin(), lru, found->second);
+        return &found->second->shaped;
+    }
+
+    misses++;
+    ShapedText shaped;
+    if (!shaper.Shape(text, format, maxWidth, maxHeight, shaped)) return nullptr;
+
+    Entry e;
+    e.key = { std::wstring(text), formatId, maxWidth, maxHeight };
+    e.shaped = shaped;
+    e.shaper = &shaper;
+    e.cost = CostOf(e);
+
+    lru.push_front(std::move(e));
+    entries.emplace(lru.front().key, lru.begin());
+    used += lru.front().cost;
+
+    // Evict from the back, but never the entry the caller is about to use
+    while (used > budget && lru.size() > 1) {
+        Erase(std::prev(lru.end()));
+        evictions++;
+    }
+    return &lru.front().shaped;
+}
+
+void TextLayoutCache::SetBudget(size_t bytes)
+{
+    budget = bytes;
+    Trim();
+}
+
+void TextLayoutCache::EvictShaper(const TextShaper *shaper)
+{
+    for (auto it = lru.begin(); it != lru.end();) {
+        auto next = std::next(it);
+        if (it->shaper == shaper) Erase(it);
+        it = next;
+    }
+}
+
+void TextLayoutCache::Clear()
+{
+    while (!lru.empty()) Erase(lru.begin());
+}
+
+void TextLayoutCache::Erase(std::list<Entry>::iterator it)
+{
+    if (it->shaped.layout) it->shaper->Release(it->shaped.layout);
+    used -= it->cost;
+    auto found = entries.find(TextLayoutKeyView(it->key));
+    if (found != entries.end()) entries.erase(found);
+    lru.erase(it);
+}
+
+void TextLayoutCache::Trim()
+{
+    while (used > budget && !lru.empty()) {
+        Erase(std::prev(lru.end()));
+        evictions++;
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstddef>
+#include "DrawingBackend.h"
+
+// Process-wide cache of shaped text. Modules redraw the same handful of
+// strings ("42%", "12:30", icon glyphs) every frame, so layouts are kept
+// by (text, format, box) and evicted least-recently-used under a byte budget.
+// Formats are keyed by what they describe, not by object, so every bar's
+// formats built from the same theme settings share layouts.
+// The cache only sees opaque layouts through TextShaper, which keeps it free
+// of DirectWrite and lets a fake shaper drive it off Windows.
+
+struct ShapedText {
+    void *layout = nullptr;  // Shaper-owned handle (IDWriteTextLayout* on Windows)
+    TextMetrics metrics;
+    size_t bytes = 0;        // Shaper's estimate of the layout's footprint
+};
+
+class TextShaper
+{
+public:
+    virtual ~TextShaper() = default;
+
+    // Shape `text` in `format` inside a maxWidth x maxHeight box
+    virtual bool Shape(std::wstring_view text, const void *format, float maxWidth, float maxHeight, ShapedText &out) = 0;
+    virtual void Release(void *layout) = 0;
+};
+
+// Everything about a text format that changes the shaped result. Enums are
+// stored as the platform's values (DWRITE_FONT_WEIGHT and friends).
+struct TextFormatDesc {
+    std::wstring family;
+    std::wstring locale;
+    float size = 0.0f;
+    int weight = 0;
+    int style = 0;
+    int stretch = 0;
+    int textAlignment = 0;
+    int paragraphAlignment = 0;
+    int wordWrapping = 0;
+
+    bool operator==(const TextFormatDesc &o) const = default;
+};
+
+struct TextLayoutKey {
+    std::wstring text;
+    uint32_t format = 0; // TextLayoutCache::FormatId
+    float maxWidth = 0.0f;
+    float maxHeight = 0.0f;
+};
+
+// Borrowed form of the key so lookups on the hit path don't copy the string
+struct TextLayoutKeyView {
+    std::wstring_view text;
+    uint32_t format = 0;
+    float maxWidth = 0.0f;
+    float maxHeight = 0.0f;
+
+    TextLayoutKeyView(std::wstring_view text, uint32_t format, float maxWidth, float maxHeight)
+        : text(text), format(format), maxWidth(maxWidth), maxHeight(maxHeight) {}
+    TextLayoutKeyView(const TextLayoutKey &k) : text(k.text), format(k.format), maxWidth(k.maxWidth), maxHeight(k.maxHeight) {}
+};
+
+class TextLayoutCache
+{
+public:
+    static constexpr size_t DEFAULT_BUDGET = 1024 * 1024;
+
+    static TextLayoutCache &Shared() {
+        static TextLayoutCache instance;
+        return instance;
+    }
+
+    explicit TextLayoutCache(size_t budgetBytes = DEFAULT_BUDGET) : budget(budgetBytes) {}
+    ~TextLayoutCache() { Clear(); }
+    TextLayoutCache(const TextLayoutCache &) = delete;
+    TextLayoutCache &operator=(const TextLayoutCache &) = delete;
+
+    // Stable id for a format description; equal descriptions get the same id (never 0)
+    uint32_t FormatId(const TextFormatDesc &desc);
+
+    /// <summary>
+    /// Returns the shaped layout for the key, shaping it through `shaper` on a miss.
+    /// `formatId` keys the entry; `format` is the shaper's handle for it and must
+    /// shape as FormatId's description says. The pointer stays valid until the
+    /// next call that can evict (Get, SetBudget, EvictShaper, Clear). Returns
+    /// nullptr if shaping failed.
+    /// </summary>
+    const ShapedText *Get(TextShaper &shaper, std::wstring_view text, uint32_t formatId, const void *format, float maxWidth, float maxHeight);
+
+    void SetBudget(size_t bytes);
+    size_t GetBudget() const { return budget; }
+
+    void EvictShaper(const TextShaper *shaper);
+    void Clear();
+
+    size_t Count() const { return entries.size(); }
+    size_t BytesUsed() const { return used; }
+
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    void ResetCounters() { hits = misses = evictions = 0; }
+
+private:
+    struct Entry {
+        TextLayoutKey key;
+        ShapedText shaped;
+        TextShaper *shaper = nullptr;
+        size_t cost = 0;
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(const TextLayoutKeyView &k) const;
+    };
+    struct KeyEqual {
+        using is_transparent = void;
+        bool operator()(const TextLayoutKeyView &a, const TextLayoutKeyView &b) const {
+            return a.format == b.format && a.maxWidth == b.maxWidth && a.maxHeight == b.maxHeight && a.text == b.text;
+        }
+    };
+
+    struct DescHash {
+        size_t operator()(const TextFormatDesc &d) const;
+    };
+
+    // Front is most recently used
+    std::list<Entry> lru;
+    std::unordered_map<TextFormatDesc, uint32_t, DescHash> formatIds;
+    std::unordered_map<TextLayoutKey, std::list<Entry>::iterator, KeyHash, KeyEqual> entries;
+    size_t budget;
+    size_t used = 0;
+
+    static size_t CostOf(const Entry &e);
+    void Erase(std::list<Entry>::iterator it);
+    void Trim();
+};
@@ -3,15 +3,23 @@
 #include <mmdeviceapi.h>
 #include <audioclient.h>
 #include <vector>
+#include <iterator>
 #include <thread>
 #include <atomic>
-#include <mutex>
+#include "AudioRing.h"
+#include "FrameProfiler.h"
 
 #pragma comment(lib, "Ole32.lib")
 
+// Loopback capture of the default output device on its own thread. Each
+// packet is downmixed to mono and appended to `ring`; the visualizer reads
+// the newest FFT_SIZE samples from it in place.
 class AudioCapture {
 public:
-    AudioCapture() { Start(); }
+    static constexpr size_t FFT_SIZE = 512;
+    static constexpr size_t RING_SIZE = 8192; // ~170 ms at 48 kHz
+
+    explicit AudioCapture(size_t ringSize = RING_SIZE) : ring(ringSize) { Start(); }
     ~AudioCapture() { Stop(); }
 
     void Start() {
@@ -25,17 +33,14 @@ public:
         if (captureThread.joinable()) captureThread.join();
     }
 
-    void GetAudioData(std::vector<float> &outBuffer) {
-        std::lock_guard<std::mutex> lock(dataMutex);
-        outBuffer = currentBuffer;
-    }
+    // Written by the capture thread only; readers use Latest and Intact
+    const AudioRing &Samples() const { return ring; }
 
 private:
     std::atomic<bool> running = false;
     std::thread captureThread;
-    std::mutex dataMutex;
-    std::vector<float> currentBuffer;
-    static constexpr size_t FFT_SIZE = 512;
+    AudioRing ring;
+    float scratch[1024] = {}; // One chunk of a packet, downmixed
 
     void Loop() {
         HRESULT hr;
@@ -46,6 +51,7 @@ private:
         WAVEFORMATEX *pwfx = NULL;
 
         CoInitialize(NULL);
+        FrameProfiler::SetThreadName("Audio capture");
 
         hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, IID_PPV_ARGS(&pEnumerator));
         if (FAILED(hr)) goto Exit;
@@ -81,19 +87,20 @@ private:
                 if (FAILED(hr)) break;
 
                 if (numFramesAvailable > 0) {
-                    std::vector<float> tempBuf;
-                    tempBuf.resize(FFT_SIZE, 0.0f);
+                    PROFILE_SCOPE("Capture", nullptr, "frames", numFramesAvailable);
 
                     // --- FORMAT DETECTION & NORMALIZATION ---
                     int channels = pwfx->nChannels;
                     int bitsPerSample = pwfx->wBitsPerSample;
                     int bytesPerFrame = pwfx->nBlockAlign;
+                    bool silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0; // pData is not meaningful then
 
-                    for (size_t i = 0; i < numFramesAvailable && i < FFT_SIZE; i++) {
+                    for (size_t i = 0; i < numFramesAvailable; i++) {
                         float sample = 0.0f;
                         BYTE *framePtr = pData + (i * bytesPerFrame);
 
-                        if (bitsPerSample == 32) {
+                        if (silent) sample = 0.0f;
+                        else if (bitsPerSample == 32) {
                             float *pFloat = (float *)framePtr;
                             // Downmix stereo to mono
                             if (channels >= 2) sample = (pFloat[0] + pFloat[1]) * 0.5f;
@@ -111,12 +118,9 @@ private:
                             sample = (float)(val >> 8) / 8388608.0f; // Normalize!
                         }
 
-                        tempBuf[i] = sample;
-                    }
-
-                    {
-                        std::lock_guard<std::mutex> lock(dataMutex);
-                        currentBuffer = tempBuf;
+                        size_t chunk = i % std::size(scratch);
+                        scratch[chunk] = sample;
+                        if (chunk == std::size(scratch) - 1 || i == numFramesAvailable - 1) ring.Write(scratch, chunk + 1);
                     }
                 }
 
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <memory>
+
+// Mono samples handed from the capture thread to the UI thread without a
+// lock or a per-packet allocation. One thread writes; any number of readers
+// look at the most recent samples in place. Every sample is stored twice,
+// at its slot and one capacity further on, so any window of up to half the
+// capacity is contiguous no matter where the write position has wrapped to.
+// The ring never blocks the writer: old samples are simply overwritten, and
+// a reader that held a window for too long finds out through Intact.
+
+struct AudioWindow {
+    const float *samples = nullptr;
+    size_t count = 0;
+    uint64_t end = 0; // Write position just past the last sample
+    explicit operator bool() const { return samples != nullptr; }
+};
+
+class AudioRing
+{
+public:
+    // `capacity` is rounded up to a power of two (at least 2)
+    explicit AudioRing(size_t capacity)
+    {
+        size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        buffer = std::make_unique<float[]>(size * 2); // Zeroed: reads before the first wrap see silence
+    }
+    AudioRing(const AudioRing &) = delete;
+    AudioRing &operator=(const AudioRing &) = delete;
+
+    size_t Capacity() const { return size; }
+    size_t MaxWindow() const { return size / 2; }
+    uint64_t Written() const { return head.load(std::memory_order_acquire); }
+
+    /// <summary>
+    /// Writer thread only. Appends `count` samples, in blocks of at most half
+    /// the capacity so the newest window is never one still being written.
+    /// </summary>
+    void Write(const float *samples, size_t count)
+    {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        while (count > 0) {
+            size_t block = count < size / 2 ? count : size / 2;
+            // Announce the slots about to change before touching them
+            reserved.store(pos + block, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            size_t slot = (size_t)(pos & mask);
+            size_t first = block < size - slot ? block : size - slot;
+            std::memcpy(buffer.get() + slot, samples, first * sizeof(float));
+            std::memcpy(buffer.get() + slot + size, samples, first * sizeof(float));
+            if (first < block) {
+                // Wrapped: the rest starts over at slot 0
+                std::memcpy(buffer.get(), samples + first, (block - first) * sizeof(float));
+                std::memcpy(buffer.get() + size, samples + first, (block - first) * sizeof(float));
+            }
+
+            pos += block;
+            samples += block;
+            count -= block;
+            head.store(pos, std::memory_order_release);
+        }
+    }
+
+    /// <summary>
+    /// The newest `count` samples (clamped to MaxWindow), oldest first, read
+    /// in place. Empty until anything has been written; before `count`
+    /// samples exist the window starts with zeros.
+    /// </summary>
+    AudioWindow Latest(size_t count) const
+    {
+        if (count > size / 2) count = size / 2;
+        uint64_t end = head.load(std::memory_order_acquire);
+        if (end == 0 || count == 0) return {};
+        size_t start = (size_t)((end - count) & mask);
+        return { buffer.get() + start, count, end };
+    }
+
+    /// <summary>
+    /// True if the writer has not started on any slot of `window` since
+    /// Latest returned it. Check after using the samples; if it fails they
+    /// may be torn and should be dropped or read again.
+    /// </summary>
+    bool Intact(const AudioWindow &window) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t touched = reserved.load(std::memory_order_relaxed);
+        return touched + window.count <= window.end + size;
+    }
+
+private:
+    std::unique_ptr<float[]> buffer; // 2 * size floats; slot i mirrored at i + size
+    size_t size = 0;
+    uint64_t mask = 0;
+    // Own cache lines: the writer bumps these on every block while readers poll them
+    alignas(64) std::atomic<uint64_t> head = 0;     // Samples published
+    alignas(64) std::atomic<uint64_t> reserved = 0; // Samples published or being written
+};
@@ -0,0 +1,235 @@
+#include "IconAtlas.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t totalBytes;
+};
+
+struct FileEntry {
+    uint64_t pathHash;
+    int32_t index;
+    int32_t size;
+    uint64_t stamp;
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset; // From the start of the file
+};
+
+static_assert(sizeof(FileHeader) == 24, "atlas header layout");
+static_assert(sizeof(FileEntry) == 40, "atlas entry layout");
+
+const char MAGIC[4] = { 'R', 'I', 'C', 'A' };
+
+bool KeyLess(const IconAtlasKey &a, const IconAtlasKey &b)
+{
+    if (a.pathHash != b.pathHash) return a.pathHash < b.pathHash;
+    if (a.index != b.index) return a.index < b.index;
+    return a.size < b.size;
+}
+
+bool SameSlot(const IconAtlasKey &a, const IconAtlasKey &b)
+{
+    return a.pathHash == b.pathHash && a.index == b.index && a.size == b.size;
+}
+
+size_t Align16(size_t n) { return (n + 15) & ~(size_t)15; }
+
+}
+
+bool IconAtlasReader::Open(const uint8_t *bytes, size_t length)
+{
+    Close();
+    if (!bytes || length < sizeof(FileHeader)) return false;
+
+    FileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, 4) != 0 || header.version != VERSION) return false;
+    if (header.totalBytes != length) return false; // Truncated or appended to
+    if (header.count > (length - sizeof(FileHeader)) / sizeof(FileEntry)) return false;
+
+    // Check every entry once so lookups can trust the index
+    const FileEntry *entries = (const FileEntry *)(bytes + sizeof(FileHeader));
+    for (size_t i = 0; i < header.count; i++) {
+        const FileEntry &e = entries[i];
+        if (e.width == 0 || e.height == 0 || e.width > MAX_EDGE || e.height > MAX_EDGE) return false;
+        uint64_t bytesNeeded = (uint64_t)e.width * e.height * sizeof(uint32_t);
+        if (e.offset % 16 != 0 || e.offset > length || bytesNeeded > length - e.offset) return false;
+        if (i > 0) {
+            IconAtlasKey prev{ entries[i - 1].pathHash, entries[i - 1].index, entries[i - 1].size };
+            IconAtlasKey cur{ e.pathHash, e.index, e.size };
+            if (!KeyLess(prev, cur)) return false;
+        }
+    }
+
+    data = bytes;
+    size = length;
+    count = header.count;
+    return true;
+}
+
+int IconAtlasReader::Find(const IconAtlasKey &key) const
+{
+    const FileEntry *entries = (const FileEntry *)(data + sizeof(FileHeader));
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        IconAtlasKey k{ entries[mid].pathHash, entries[mid].index, entries[mid].size };
+        if (KeyLess(k, key)) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == count) return -1;
+    const FileEntry &e = entries[lo];
+    return SameSlot({ e.pathHash, e.index, e.size }, key) ? (int)lo : -1;
+}
+
+IconAtlasKey IconAtlasReader::KeyAt(size_t i) const
+{
+    const FileEntry &e = ((const FileEntry *)(data + sizeof(FileHeader)))[i];
+    return { e.pathHash, e.index, e.size, e.stamp };
+}
+
+IconAtlasImage IconAtlasReader::ImageAt(size_t i) const
+{
+    const FileEntry &e = ((const FileEntry *)(data + sizeof(FileHeader)))[i];
+    return { (const uint32_t *)(data + e.offset), (int)e.width, (int)e.height };
+}
+
+void IconAtlasWriter::Add(const IconAtlasKey &key, const uint32_t *pixels, int width, int height)
+{
+    if (!pixels || width <= 0 || height <= 0 || width > IconAtlasReader::MAX_EDGE || height > IconAtlasReader::MAX_EDGE) return;
+
+    int existing = Find(key);
+    Pending &p = existing >= 0 ? entries[existing] : entries.emplace_back();
+    p.key = key;
+    p.width = width;
+    p.height = height;
+    p.pixels.assign(pixels, pixels + (size_t)width * height);
+}
+
+int IconAtlasWriter::Find(const IconAtlasKey &key) const
+{
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (SameSlot(entries[i].key, key)) return (int)i;
+    }
+    return -1;
+}
+
+void IconAtlasWriter::Serialize(std::vector<uint8_t> &out) const
+{
+    std::vector<const Pending *> sorted;
+    sorted.reserve(entries.size());
+    for (const Pending &p : entries) sorted.push_back(&p);
+    std::sort(sorted.begin(), sorted.end(), [](const Pending *a, const Pending *b) { return KeyLess(a->key, b->key); });
+
+    size_t offset = Align16(sizeof(FileHeader) + sorted.size() * sizeof(FileEntry));
+    std::vector<FileEntry> index(sorted.size());
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const Pending &p = *sorted[i];
+        index[i] = { p.key.pathHash, p.key.index, p.key.size, p.key.stamp, (uint32_t)p.width, (uint32_t)p.height, offset };
+        offset = Align16(offset + p.pixels.size() * sizeof(uint32_t));
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, 4);
+    header.version = IconAtlasReader::VERSION;
+    header.count = (uint32_t)sorted.size();
+    header.totalBytes = offset;
+
+    out.assign(offset, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (!index.empty()) std::memcpy(out.data() + sizeof(header), index.data(), index.size() * sizeof(FileEntry));
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const std::vector<uint32_t> &pixels = sorted[i]->pixels;
+        std::memcpy(out.data() + index[i].offset, pixels.data(), pixels.size() * sizeof(uint32_t));
+    }
+}
+
+void IconAtlas::Load()
+{
+    reader.Close();
+    storage.Unmap();
+    state.clear();
+
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+    if (!storage.Map(bytes, length)) return;
+    if (!reader.Open(bytes, length)) {
+        storage.Unmap();
+        dirty = true; // Damaged: replace it on the next save
+        return;
+    }
+    state.assign(reader.Count(), 0);
+}
+
+IconAtlasImage IconAtlas::Find(const IconAtlasKey &key)
+{
+    int pending = added.Find(key);
+    if (pending >= 0 && added.KeyAt(pending).stamp == key.stamp) {
+        hits++;
+        return added.ImageAt(pending);
+    }
+
+    int i = reader.Find(key);
+    if (i < 0) {
+        misses++;
+        return {};
+    }
+    if (key.stamp == 0 || reader.KeyAt(i).stamp != key.stamp) {
+        if (state[i] != 2) {
+            state[i] = 2;
+            stale++;
+            dirty = true;
+        }
+        misses++;
+        return {};
+    }
+    state[i] = 1;
+    hits++;
+    return reader.ImageAt(i);
+}
+
+void IconAtlas::Add(const IconAtlasKey &key, const uint32_t *pixels, int width, int height)
+{
+    if (key.stamp == 0) return; // Nothing to validate it against later
+    added.Add(key, pixels, width, height);
+    dirty = true;
+}
+
+bool IconAtlas::Save()
+{
+    if (!dirty) return true;
+
+    // Copy out of the mapping first: the file is replaced underneath it
+    IconAtlasWriter out;
+    for (size_t i = added.Count(); i-- > 0 && out.Count() < MAX_ENTRIES;) {
+        IconAtlasImage image = added.ImageAt(i);
+        out.Add(added.KeyAt(i), image.pixels, image.width, image.height);
+    }
+    for (int pass = 1; pass >= 0; pass--) {
+        for (size_t i = 0; i < reader.Count() && out.Count() < MAX_ENTRIES; i++) {
+            if (state[i] != pass) continue;
+            IconAtlasKey key = reader.KeyAt(i);
+            if (out.Find(key) >= 0) continue;
+            IconAtlasImage image = reader.ImageAt(i);
+            out.Add(key, image.pixels, image.width, image.height);
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    out.Serialize(bytes);
+
+    reader.Close();
+    storage.Unmap();
+    bool written = storage.Write(bytes);
+    if (written) added.Clear();
+    Load();
+    if (written) dirty = false; // Load flags a damaged file; this one was just written
+    return written;
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Decoded icons persisted next to pinned.dat so a launch can show the dock
+// without extracting and decoding every pinned app again. The file is read
+// in place from a memory mapping: a sorted index of (path hash, icon index,
+// size) followed by premultiplied BGRA pixels. Each entry records its source
+// file's modification stamp; an icon whose file changed is treated as a miss
+// and dropped the next time the atlas is written. Saving rewrites the whole
+// file from the entries still worth keeping, which also compacts it.
+// File access goes through IconAtlasStorage so the format runs off Windows.
+//
+// Layout (little-endian):
+//   Header       magic "RICA", version, count, reserved, total bytes
+//   Entry[count] sorted by (pathHash, index, size)
+//   Pixels       one 16-byte-aligned block per entry, width * height * 4 bytes
+
+struct IconAtlasKey {
+    uint64_t pathHash = 0; // WindowRegistry::PathHash of the icon's file
+    int32_t index = 0;
+    int32_t size = 0;      // Requested edge in pixels
+    uint64_t stamp = 0;    // Source file's last-write time; 0 never matches a stored entry
+};
+
+struct IconAtlasImage {
+    const uint32_t *pixels = nullptr; // Tightly packed, width * height
+    int width = 0;
+    int height = 0;
+    explicit operator bool() const { return pixels != nullptr; }
+};
+
+class IconAtlasReader
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int MAX_EDGE = 512;
+
+    /// <summary>
+    /// Validates and indexes `data` without copying. The bytes must stay
+    /// valid (mapped) until Close or the next Open. False on any damage.
+    /// </summary>
+    bool Open(const uint8_t *data, size_t size);
+    void Close() { data = nullptr; size = 0; count = 0; }
+
+    size_t Count() const { return count; }
+
+    // Entry by (pathHash, index, size); -1 if absent. Stamps are not compared
+    int Find(const IconAtlasKey &key) const;
+    IconAtlasKey KeyAt(size_t i) const;
+    IconAtlasImage ImageAt(size_t i) const;
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    size_t count = 0;
+};
+
+class IconAtlasWriter
+{
+public:
+    // Copies the pixels. A later Add with the same (pathHash, index, size) replaces the earlier one
+    void Add(const IconAtlasKey &key, const uint32_t *pixels, int width, int height);
+    size_t Count() const { return entries.size(); }
+    void Clear() { entries.clear(); }
+
+    int Find(const IconAtlasKey &key) const;
+    const IconAtlasKey &KeyAt(size_t i) const { return entries[i].key; }
+    IconAtlasImage ImageAt(size_t i) const { return { entries[i].pixels.data(), entries[i].width, entries[i].height }; }
+
+    void Serialize(std::vector<uint8_t> &out) const;
+
+private:
+    struct Pending {
+        IconAtlasKey key;
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> pixels;
+    };
+    std::vector<Pending> entries;
+};
+
+class IconAtlasStorage
+{
+public:
+    virtual ~IconAtlasStorage() = default;
+    // Map the current file read-only; false if there is none
+    virtual bool Map(const uint8_t *&data, size_t &size) = 0;
+    virtual void Unmap() = 0;
+    // Replace the file with `bytes` (called while unmapped)
+    virtual bool Write(const std::vector<uint8_t> &bytes) = 0;
+};
+
+class IconAtlas
+{
+public:
+    static constexpr size_t MAX_ENTRIES = 256;
+
+    explicit IconAtlas(IconAtlasStorage &storage) : storage(storage) {}
+    ~IconAtlas() { storage.Unmap(); }
+    IconAtlas(const IconAtlas &) = delete;
+    IconAtlas &operator=(const IconAtlas &) = delete;
+
+    // Map the file; a missing or damaged one just starts empty
+    void Load();
+
+    /// <summary>
+    /// The stored icon for `key` if its stamp still matches. Pixels point into
+    /// the mapping (or a pending add) and stay valid until Save.
+    /// </summary>
+    IconAtlasImage Find(const IconAtlasKey &key);
+
+    void Add(const IconAtlasKey &key, const uint32_t *pixels, int width, int height);
+
+    bool IsDirty() const { return dirty; }
+
+    /// <summary>
+    /// Rewrite the file if anything was added or went stale: newest icons
+    /// first, then stored ones that matched this session, then the rest, up
+    /// to MAX_ENTRIES. Stale entries are dropped. Remaps the new file.
+    /// </summary>
+    bool Save();
+
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t stale = 0;
+
+private:
+    IconAtlasStorage &storage;
+    IconAtlasReader reader;
+    IconAtlasWriter added;
+    std::vector<uint8_t> state; // Per stored entry: 0 untouched, 1 matched, 2 stale
+    bool dirty = false;
+};
@@ -0,0 +1,93 @@
+#include "IconLoader.h"
+
+bool IconLoader::Request(const IconRequest &request)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stopping) return false;
+        if (!pending.insert(request.key).second) {
+            deduped++;
+            return false;
+        }
+        requests++;
+        jobs.push_back(request);
+    }
+
+    if (workers.empty()) {
+        for (int i = 0; i < workerCount; i++) workers.emplace_back(&IconLoader::Work, this);
+    }
+    wake.notify_one();
+    return true;
+}
+
+size_t IconLoader::Drain(std::vector<LoadedIcon> &out)
+{
+    out.clear();
+    std::lock_guard<std::mutex> guard(lock);
+    out.swap(finished);
+    for (const LoadedIcon &icon : out) {
+        pending.erase(icon.key);
+        if (icon.ok) loaded++;
+        else failures++;
+    }
+    return out.size();
+}
+
+bool IconLoader::Busy() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return !pending.empty();
+}
+
+bool IconLoader::IsPending(uint64_t key) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return pending.count(key) != 0;
+}
+
+void IconLoader::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stopping) return;
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+}
+
+void IconLoader::Work()
+{
+    source.BeginThread();
+    while (true) {
+        IconRequest request;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !jobs.empty(); });
+            if (stopping) break;
+            request = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        LoadedIcon icon;
+        icon.ok = source.Load(request, icon);
+        icon.key = request.key;
+        if (icon.ok) {
+            if (request.mipEdges.empty()) request.mipEdges.push_back(request.size);
+            icon.mips.Build(icon.pixels.data(), icon.width, icon.height, icon.width, request.mipEdges);
+        }
+
+        bool first;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            first = finished.empty();
+            finished.push_back(std::move(icon));
+        }
+        if (first && onFinished) onFinished();
+    }
+    source.EndThread();
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_set>
+#include "IconMips.h"
+
+// Loads icons on worker threads so extraction, WM_GETICON round trips to
+// slow windows and the decode stay off the UI thread. Requests are keyed by
+// where the icon comes from (path, index and size, or the window for apps
+// without a file icon); a key that is already queued or loading joins the
+// existing job. Finished icons, with their mip chains already built, wait
+// in a completion list that the UI thread drains on the frame the loader's
+// completion callback woke it for, instead of polling. The OS side
+// sits behind IconSource so the queue runs against a fake source off Windows.
+
+struct IconRequest {
+    uint64_t key = 0;      // Caller's dedupe key, also the IconCache source
+    std::wstring path;     // File to extract from; empty to use the window's icon
+    int index = 0;
+    int size = 0;          // Requested edge in pixels
+    std::vector<int> mipEdges; // Levels to build from the result; empty for just `size`
+    uintptr_t hwnd = 0;    // Fallback when the file has no icon
+};
+
+struct LoadedIcon {
+    uint64_t key = 0;
+    std::vector<uint32_t> pixels; // Premultiplied BGRA, tightly packed
+    int width = 0;
+    int height = 0;
+    bool ok = false;
+    bool fromFile = false; // From request.path rather than the window's fallback icon
+    IconMipChain mips;     // Built from pixels on the worker
+};
+
+class IconSource
+{
+public:
+    virtual ~IconSource() = default;
+
+    // Called on each worker as it starts and stops (COM, per-thread factories)
+    virtual void BeginThread() {}
+    virtual void EndThread() {}
+
+    // Runs on a worker. Fills `out` and returns true, or false if nothing could be loaded
+    virtual bool Load(const IconRequest &request, LoadedIcon &out) = 0;
+};
+
+class IconLoader
+{
+public:
+    static constexpr int DEFAULT_WORKERS = 2;
+
+    explicit IconLoader(IconSource &source, int workerCount = DEFAULT_WORKERS) : source(source), workerCount(workerCount) {}
+    ~IconLoader() { Stop(); }
+    IconLoader(const IconLoader &) = delete;
+    IconLoader &operator=(const IconLoader &) = delete;
+
+    /// <summary>
+    /// Queues a load; workers start on the first request. Returns false if
+    /// the key is already queued, loading or waiting to be drained.
+    /// </summary>
+    bool Request(const IconRequest &request);
+
+    // Moves finished icons (failures too, with ok = false) into `out`. UI thread
+    size_t Drain(std::vector<LoadedIcon> &out);
+
+    /// <summary>
+    /// Runs on a worker when a result lands in an empty completion list, so
+    /// one wake covers everything until the next Drain. Set before the first Request.
+    /// </summary>
+    void SetOnFinished(std::function<void()> callback) { onFinished = std::move(callback); }
+
+    // Anything queued, loading or not yet drained
+    bool Busy() const;
+    bool IsPending(uint64_t key) const;
+
+    // Drops queued jobs and joins the workers; later requests are ignored
+    void Stop();
+
+    size_t requests = 0;
+    size_t deduped = 0;
+    size_t loaded = 0;
+    size_t failures = 0;
+
+private:
+    IconSource &source;
+    int workerCount;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::deque<IconRequest> jobs;
+    std::unordered_set<uint64_t> pending; // Queued, loading or finished but not drained
+    std::vector<LoadedIcon> finished;
+    bool stopping = false;
+    std::function<void()> onFinished;
+
+    void Work();
+};
@@ -0,0 +1,108 @@
+#include "NotifyIconParser.h"
+#include <algorithm>
+
+namespace {
+
+// Field offsets within NOTIFYICONDATAW for each sender layout
+struct Layout {
+    size_t handleSize;
+    size_t hWnd, uID, uFlags, uCallbackMessage, hIcon;
+    size_t tip, state, stateMask, info, version, infoTitle, infoFlags, guid, balloonIcon;
+    uint32_t sizes[4]; // V1 (64-char tip), V2, V3 (guidItem), V4 (hBalloonIcon)
+};
+
+const Layout LAYOUT32 = { 4, 4, 8, 12, 16, 20, 24, 280, 284, 288, 800, 804, 932, 936, 952, { 152, 936, 952, 956 } };
+const Layout LAYOUT64 = { 8, 8, 16, 20, 24, 32, 40, 296, 300, 304, 816, 820, 948, 952, 968, { 168, 952, 968, 976 } };
+
+const size_t HEADER = 8; // dwSignature, dwMessage
+const size_t TIP_BYTES = 128 * sizeof(char16_t);
+const size_t INFO_BYTES = 256 * sizeof(char16_t);
+const size_t INFO_TITLE_BYTES = 64 * sizeof(char16_t);
+
+uint32_t Read32(const uint8_t *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t ReadHandle(const uint8_t *p, size_t handleSize)
+{
+    if (handleSize == 4) return Read32(p);
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+bool IsVersionSize(const Layout &layout, uint32_t cbSize)
+{
+    return std::find(std::begin(layout.sizes), std::end(layout.sizes), cbSize) != std::end(layout.sizes);
+}
+
+// Text field of up to `bytes`, cut short where the struct ends
+NotifyIconText ReadText(const uint8_t *nid, size_t available, size_t offset, size_t bytes)
+{
+    NotifyIconText text;
+    if (offset >= available) return text;
+    const uint8_t *p = nid + offset;
+    const uint8_t *end = p + (std::min(bytes, available - offset) & ~(size_t)1);
+    const uint8_t *at = p;
+    while (at < end && (at[0] | at[1])) at += 2;
+    text.data = p;
+    text.length = (size_t)(at - p) / sizeof(char16_t);
+    return text;
+}
+
+}
+
+bool ParseNotifyIcon(const uint8_t *data, size_t size, NotifyIconView &out)
+{
+    out = NotifyIconView();
+    if (!data || size < HEADER + sizeof(uint32_t)) return false;
+
+    const uint8_t *nid = data + HEADER;
+    out.message = Read32(data + 4);
+    out.cbSize = Read32(nid);
+    if (out.cbSize > size - HEADER) return false; // Runs past what was sent
+
+    bool in32 = IsVersionSize(LAYOUT32, out.cbSize);
+    bool in64 = IsVersionSize(LAYOUT64, out.cbSize);
+    if (in32 != in64) {
+        out.is64 = in64;
+    }
+    else {
+        // Ambiguous or unknown size. A 32-bit sender has hWnd at offset 4, a
+        // 64-bit one padding; every message that matters names a window
+        out.is64 = out.cbSize >= LAYOUT64.sizes[0] && Read32(nid + 4) == 0;
+    }
+
+    const Layout &l = out.is64 ? LAYOUT64 : LAYOUT32;
+    size_t available = out.cbSize;
+    if (available < l.sizes[0]) return false;
+
+    out.hWnd = ReadHandle(nid + l.hWnd, l.handleSize);
+    out.uID = Read32(nid + l.uID);
+    out.uFlags = Read32(nid + l.uFlags);
+    out.uCallbackMessage = Read32(nid + l.uCallbackMessage);
+    out.hIcon = ReadHandle(nid + l.hIcon, l.handleSize);
+    out.tip = ReadText(nid, available, l.tip, TIP_BYTES);
+
+    if (available >= l.infoFlags + sizeof(uint32_t)) {
+        out.hasInfo = true;
+        out.state = Read32(nid + l.state);
+        out.stateMask = Read32(nid + l.stateMask);
+        out.info = ReadText(nid, available, l.info, INFO_BYTES);
+        out.versionOrTimeout = Read32(nid + l.version);
+        out.infoTitle = ReadText(nid, available, l.infoTitle, INFO_TITLE_BYTES);
+        out.infoFlags = Read32(nid + l.infoFlags);
+    }
+    if (available >= l.guid + sizeof(TrayIconGuid)) {
+        out.hasGuid = true;
+        std::memcpy(out.guid.bytes, nid + l.guid, sizeof(out.guid.bytes));
+    }
+    if (available >= l.balloonIcon + l.handleSize) {
+        out.hasBalloonIcon = true;
+        out.hBalloonIcon = ReadHandle(nid + l.balloonIcon, l.handleSize);
+    }
+    return true;
+}
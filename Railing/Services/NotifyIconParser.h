@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Reads the tray's WM_COPYDATA payload (signature, message, NOTIFYICONDATAW)
+// in place, for every struct version and both 32-bit and 64-bit senders.
+// Each app sends its own layout, and sizes alone don't tell them apart (952
+// bytes is a 32-bit V3 and a 64-bit V2), so the layout comes from the size
+// where that's unambiguous and otherwise from where the window handle sits.
+// A field is only read if the struct's cbSize and the buffer both cover it;
+// strings are views into the buffer. No windows.h, so it runs off Windows.
+
+struct TrayIconGuid {
+    uint8_t bytes[16] = {};
+    bool operator==(const TrayIconGuid &o) const { return std::memcmp(bytes, o.bytes, sizeof(bytes)) == 0; }
+    bool operator!=(const TrayIconGuid &o) const { return !(*this == o); }
+};
+
+// UTF-16 text inside the buffer, up to its first NUL. May be unaligned
+struct NotifyIconText {
+    const uint8_t *data = nullptr;
+    size_t length = 0; // In UTF-16 units
+
+    bool Empty() const { return length == 0; }
+
+    template <typename Char>
+    void CopyTo(std::basic_string<Char> &out) const {
+        static_assert(sizeof(Char) == sizeof(char16_t), "UTF-16 code units");
+        out.resize(length);
+        if (length) std::memcpy(&out[0], data, length * sizeof(char16_t));
+    }
+};
+
+struct NotifyIconView {
+    uint32_t message = 0;  // NIM_*
+    uint32_t cbSize = 0;
+    bool is64 = false;     // Sender's layout
+
+    uint64_t hWnd = 0;
+    uint32_t uID = 0;
+    uint32_t uFlags = 0;
+    uint32_t uCallbackMessage = 0;
+    uint64_t hIcon = 0;
+    NotifyIconText tip;
+
+    // Later versions; false when the struct is too old to carry them
+    bool hasInfo = false;
+    uint32_t state = 0;
+    uint32_t stateMask = 0;
+    NotifyIconText info;
+    uint32_t versionOrTimeout = 0; // uVersion for NIM_SETVERSION, uTimeout otherwise
+    NotifyIconText infoTitle;
+    uint32_t infoFlags = 0;
+
+    bool hasGuid = false;
+    TrayIconGuid guid;
+
+    bool hasBalloonIcon = false;
+    uint64_t hBalloonIcon = 0;
+};
+
+/// <summary>
+/// Parses a tray COPYDATA payload. False if it is too short, its cbSize
+/// runs past the buffer, or it is smaller than the oldest struct version.
+/// The view points into `data`, which must outlive it.
+/// </summary>
+bool ParseNotifyIcon(const uint8_t *data, size_t size, NotifyIconView &out);
@@ -21,6 +21,12 @@ public:
         return path.substr(0, path.find_last_of(L"\\/")) + L"\\pinned.dat";
     }
 
+    // Decoded icons cached alongside the pins (IconAtlas)
+    static std::wstring GetIconAtlasPath() {
+        std::wstring path = GetConfigPath();
+        return path.substr(0, path.find_last_of(L"\\/")) + L"\\icons.dat";
+    }
+
     static bool Save(const std::vector<PinnedAppEntry> &apps) {
         std::ofstream out(GetConfigPath(), std::ios::binary);
         if (!out.is_open()) return false;
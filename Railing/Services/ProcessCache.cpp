@@ -0,0 +1,84 @@
+#include "ProcessCache.h"
+#include "WindowRegistry.h"
+#include <iterator>
+
+const ProcessInfo *ProcessCache::Lookup(uint32_t pid)
+{
+    if (pid == 0) return nullptr;
+
+    bool wasCached = false;
+    uint64_t cachedStart = 0;
+    auto it = entries.find(pid);
+    if (it != entries.end()) {
+        if (source.IsAlive(it->second.process, it->second.info.startTime)) {
+            hits++;
+            it->second.lastUse = ++useCounter;
+            return &it->second.info;
+        }
+        wasCached = true;
+        cachedStart = it->second.info.startTime;
+        Evict(it);
+    }
+
+    misses++;
+    uintptr_t process = source.Open(pid);
+    if (!process) {
+        failures++;
+        return nullptr;
+    }
+
+    Entry entry;
+    entry.process = process;
+    entry.info.pid = pid;
+    entry.info.startTime = source.StartTime(process);
+    // Same PID, different start: the number was handed to a new process
+    if (wasCached && entry.info.startTime != cachedStart) recycled++;
+    entry.info.imagePath = source.ImagePath(process);
+    if (entry.info.imagePath.empty()) {
+        failures++;
+        source.Close(process);
+        return nullptr;
+    }
+    entry.info.pathHash = WindowRegistry::PathHash(entry.info.imagePath);
+    entry.info.displayName = source.DisplayName(entry.info.imagePath);
+    entry.lastUse = ++useCounter;
+
+    if (entries.size() >= MAX_ENTRIES) EvictLeastRecent();
+    return &entries.emplace(pid, std::move(entry)).first->second.info;
+}
+
+size_t ProcessCache::Sweep()
+{
+    size_t dropped = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto next = std::next(it);
+        if (!source.IsAlive(it->second.process, it->second.info.startTime)) {
+            Evict(it);
+            dropped++;
+        }
+        it = next;
+    }
+    return dropped;
+}
+
+void ProcessCache::Clear()
+{
+    for (auto &[pid, entry] : entries) source.Close(entry.process);
+    entries.clear();
+}
+
+void ProcessCache::Evict(std::unordered_map<uint32_t, Entry>::iterator it)
+{
+    source.Close(it->second.process);
+    entries.erase(it);
+    evictions++;
+}
+
+void ProcessCache::EvictLeastRecent()
+{
+    auto oldest = entries.begin();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+    }
+    if (oldest != entries.end()) Evict(oldest);
+}
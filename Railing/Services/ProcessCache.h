@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Image path and display name per process, so windows of the same process
+// (browsers, editors, Explorer) don't each open it and query its image.
+// Entries are keyed by PID and remember the process's start time: a PID
+// that now belongs to a different process is noticed and re-queried.
+// Exited processes are dropped on lookup and by Sweep.
+// The OS side is a ProcessSource, so the policy runs against a fake process
+// table off Windows.
+
+class ProcessSource
+{
+public:
+    virtual ~ProcessSource() = default;
+
+    // Open a process for queries; 0 if it is gone or inaccessible
+    virtual uintptr_t Open(uint32_t pid) = 0;
+    virtual void Close(uintptr_t process) = 0;
+    virtual uint64_t StartTime(uintptr_t process) const = 0;
+    // The process opened as `process` still runs and is the one started at `startTime`
+    virtual bool IsAlive(uintptr_t process, uint64_t startTime) const = 0;
+    virtual std::wstring ImagePath(uintptr_t process) const = 0;
+    // e.g. the executable's file description, else its file name
+    virtual std::wstring DisplayName(const std::wstring &imagePath) const = 0;
+};
+
+struct ProcessInfo {
+    uint32_t pid = 0;
+    uint64_t startTime = 0;
+    std::wstring imagePath;
+    size_t pathHash = 0; // WindowRegistry::PathHash(imagePath)
+    std::wstring displayName;
+};
+
+class ProcessCache
+{
+public:
+    static constexpr size_t MAX_ENTRIES = 512; // Processes with windows; the least recently used goes first
+
+    explicit ProcessCache(ProcessSource &source) : source(source) {}
+    ~ProcessCache() { Clear(); }
+    ProcessCache(const ProcessCache &) = delete;
+    ProcessCache &operator=(const ProcessCache &) = delete;
+
+    /// <summary>
+    /// Cached details of a running process, queried on first use. Null if the
+    /// process can't be opened. The pointer is valid until the next call.
+    /// </summary>
+    const ProcessInfo *Lookup(uint32_t pid);
+
+    // Drop processes that have exited
+    size_t Sweep();
+    void Clear();
+
+    size_t Count() const { return entries.size(); }
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0; // Exited, recycled or pushed out
+    uint64_t recycled = 0;  // A cached PID found running a different process
+    uint64_t failures = 0;  // Processes that couldn't be opened or queried
+
+private:
+    struct Entry {
+        ProcessInfo info;
+        uintptr_t process = 0;
+        uint64_t lastUse = 0;
+    };
+
+    ProcessSource &source;
+    std::unordered_map<uint32_t, Entry> entries;
+    uint64_t useCounter = 0;
+
+    void Evict(std::unordered_map<uint32_t, Entry>::iterator it);
+    void EvictLeastRecent();
+};
@@ -72,7 +72,11 @@ public:
 	/// <param name="output">Will fill with values 0.0-1.0</param>
 	void Compute(const std::vector<float> &samples, std::vector<float> &output)
 	{
-		size_t n = samples.size();
+		Compute(samples.data(), samples.size(), output);
+	}
+
+	void Compute(const float *samples, size_t n, std::vector<float> &output)
+	{
 		CArray data(n);
 
 		for (size_t i = 0; i < n; i++) {
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <iostream>
 #include <psapi.h> 
+#include "NotifyIconParser.h"
+#include "TrayIconStore.h"
 
 #pragma comment(lib, "psapi.lib")
 
@@ -35,66 +37,7 @@ struct TrayIconData {
     GUID guidItem;
     RECT rect = { 0 };
 	UINT uVersion = 0; // 0=legacy, 3=Win2k, 4=Vista+
-};
-
-#pragma pack(push, 1)
-
-struct NOTIFYICONDATA32 {
-    DWORD cbSize;
-    DWORD hWnd;
-    DWORD uID;
-    DWORD uFlags;
-    DWORD uCallbackMessage;
-    DWORD hIcon;
-    WCHAR szTip[128];
-    DWORD dwState;
-    DWORD dwStateMask;
-    WCHAR szInfo[256];
-    DWORD uTimeout;
-    WCHAR szInfoTitle[64];
-    DWORD dwInfoFlags;
-    GUID  guidItem;
-    DWORD hBalloonIcon;
-};
-
-struct TRAY_NOTIFY_DATA_HEADER_32 {
-    DWORD dwSignature;
-    DWORD dwMessage;
-    NOTIFYICONDATA32 nid;
-};
-
-struct TRAY_NOTIFY_DATA_HEADER {
-    DWORD dwSignature;
-    DWORD dwMessage;
-    NOTIFYICONDATAW nid;
-};
-
-#pragma pack(pop)
-
-struct NOTIFYICONDATA_V3 {
-    DWORD cbSize;
-    HWND hWnd;
-    UINT uID;
-    UINT uFlags;
-    UINT uCallbackMessage;
-    HICON hIcon;
-    WCHAR szTip[128];
-    DWORD dwState;
-    DWORD dwStateMask;
-    WCHAR szInfo[256];
-    union {
-        UINT uTimeout;
-        UINT uVersion;
-    } DUMMYUNIONNAME;
-    WCHAR szInfoTitle[64];
-    DWORD dwInfoFlags;
-    GUID guidItem;
-};
-
-struct TRAY_NOTIFY_DATA_HEADER_V3 {
-    DWORD dwSignature;
-    DWORD dwMessage;
-    NOTIFYICONDATA_V3 nid;
+    UINT iconRevision = 0; // Changes whenever NIF_ICON sets hIcon
 };
 
 class TrayBackend {
@@ -111,8 +54,9 @@ class TrayBackend {
 private:
     static TrayBackend *instance;
     HWND hTrayHost = NULL;
-    std::vector<TrayIconData> icons;
+    TrayIconStore<TrayIconData> icons;
     std::recursive_mutex iconMutex;
+    UINT iconRevisions = 0;
 
     std::vector<AppBarEntry> registeredBars;
     std::recursive_mutex barMutex;
@@ -134,110 +78,58 @@ private:
 
 public:
     LRESULT HandleCopyData(HWND sender, COPYDATASTRUCT *cds) {
-        if (cds->dwData != 1 || cds->cbData < 8) return FALSE;
-
-        BYTE *pData = (BYTE *)cds->lpData;
-        DWORD dwMessage = *((DWORD *)(pData + 4));
-        DWORD cbSize = *((DWORD *)(pData + 8));
-
-        HWND hWnd = NULL;
-        UINT uID = 0;
-        UINT uFlags = 0;
-        UINT uCallbackMsg = 0;
-        HICON hRawIcon = NULL;
-        WCHAR szTipBuf[128] = { 0 };
-        GUID guidItem = { 0 };
-        UINT uVersion = 0;
-
-        // --- ARCHITECTURE DETECTION ---
-        bool is32Bit = (cbSize == 956 || cbSize == 936 || cbSize == 504 || cbSize == 488 || cbSize == 484);
-
-        if (is32Bit) {
-            NOTIFYICONDATA32 *p32 = (NOTIFYICONDATA32 *)(pData + 8);
-            hWnd = (HWND)(UINT_PTR)p32->hWnd;
-            uID = p32->uID;
-            uFlags = p32->uFlags;
-            uCallbackMsg = p32->uCallbackMessage;
-            hRawIcon = (HICON)(UINT_PTR)p32->hIcon;
-            wcsncpy_s(szTipBuf, p32->szTip, 127);
-
-            // FIX: Extract Version from the 32-bit struct
-            // The uTimeout field is a union with uVersion.
-            // We only read this if the struct is large enough (offsets > 800)
-            if (cbSize >= 504) {
-                uVersion = p32->uTimeout;
-            }
+        if (cds->dwData != 1 || !cds->lpData) return FALSE;
 
-            if (cbSize >= 936) guidItem = p32->guidItem;
-        }
-        else {
-            NOTIFYICONDATAW *pNid = (NOTIFYICONDATAW *)(pData + 8);
-            hWnd = pNid->hWnd;
-            uID = pNid->uID;
-            uFlags = pNid->uFlags;
-            uCallbackMsg = pNid->uCallbackMessage;
-            hRawIcon = pNid->hIcon;
-            wcsncpy_s(szTipBuf, pNid->szTip, 127);
-            guidItem = pNid->guidItem;
-            uVersion = pNid->uVersion;
-        }
+        // Layout (32/64-bit sender, struct version) is worked out by the parser
+        NotifyIconView nid;
+        if (!ParseNotifyIcon((const uint8_t *)cds->lpData, cds->cbData, nid)) return FALSE;
+
+        DWORD dwMessage = nid.message;
+        HWND hWnd = (HWND)(UINT_PTR)nid.hWnd;
+        UINT uFlags = nid.uFlags;
 
         // SANITY CHECK
         if (!hWnd && dwMessage != NIM_SETVERSION) return FALSE;
 
         std::lock_guard<std::recursive_mutex> lock(iconMutex);
 
-        // --- GARBAGE COLLECTION ---
-        auto deadIt = std::remove_if(icons.begin(), icons.end(), [](const TrayIconData &item) {
-            return !IsWindow(item.ownerHwnd);
-            });
-        if (deadIt != icons.end()) {
-            for (auto it = deadIt; it != icons.end(); ++it) if (it->hIcon) DestroyIcon(it->hIcon);
-            icons.erase(deadIt, icons.end());
-        }
-
         // --- MATCHING ---
-        auto it = std::find_if(icons.begin(), icons.end(), [&](const TrayIconData &item) {
-            return (item.ownerHwnd == hWnd && item.uID == uID);
-            });
+        // Dead owners are collected by CollectDeadIcons on a timer, not here
+        const TrayIconGuid *guid = (nid.hasGuid && (uFlags & NIF_GUID)) ? &nid.guid : nullptr;
 
         if (dwMessage == NIM_DELETE) {
-            if (it != icons.end()) {
-                if (it->hIcon) DestroyIcon(it->hIcon);
-                icons.erase(it);
-            }
+            icons.Erase(nid.hWnd, nid.uID, guid, [](TrayIconData &icon) { if (icon.hIcon) DestroyIcon(icon.hIcon); });
             NotifyIconsChanged();
             return TRUE;
         }
 
-        TrayIconData *target = nullptr;
-        if (it != icons.end()) target = &(*it);
-        else {
-            icons.push_back({});
-            target = &icons.back();
-            target->ownerHwnd = hWnd;
-            target->uID = uID;
-            // Important: New icons default to Version 0 until the app sends NIM_SETVERSION
-            target->uVersion = 0;
-        }
+        bool added = false;
+        TrayIconData *target = &icons.Upsert(nid.hWnd, nid.uID, guid, added,
+            [](TrayIconData &icon) { if (icon.hIcon) DestroyIcon(icon.hIcon); }).icon;
+        target->ownerHwnd = hWnd; // A GUID match may come from the app's new window
+        target->uID = nid.uID;
+        // Important: New icons default to Version 0 until the app sends NIM_SETVERSION
+        if (added) target->uVersion = 0;
 
         // --- APPLY DATA ---
-        if (uFlags & NIF_MESSAGE) target->uCallbackMessage = uCallbackMsg;
+        if (uFlags & NIF_MESSAGE) target->uCallbackMessage = nid.uCallbackMessage;
 
-        std::wstring szTip = szTipBuf;
+        std::wstring szTip;
+        nid.tip.CopyTo(szTip);
         if (!szTip.empty()) target->tooltip = szTip;
 
-        if (uFlags & NIF_GUID) target->guidItem = guidItem;
+        if (guid) std::memcpy(&target->guidItem, guid->bytes, sizeof(GUID));
 
         // FIX: Apply version if the message is setting it
-        if (dwMessage == NIM_SETVERSION) {
-            target->uVersion = uVersion;
+        if (dwMessage == NIM_SETVERSION && nid.hasInfo) {
+            target->uVersion = nid.versionOrTimeout;
         }
 
         // --- ICON LOGIC ---
         if (uFlags & NIF_ICON) {
             if (target->hIcon) DestroyIcon(target->hIcon);
-            target->hIcon = CopyIcon(hRawIcon);
+            target->hIcon = CopyIcon((HICON)(UINT_PTR)nid.hIcon);
+            target->iconRevision = ++iconRevisions;
             if (!target->hIcon && IsWindow(target->ownerHwnd)) {
                 target->hIcon = (HICON)SendMessage(target->ownerHwnd, WM_GETICON, ICON_SMALL, 0);
                 if (!target->hIcon) target->hIcon = (HICON)SendMessage(target->ownerHwnd, WM_GETICON, ICON_BIG, 0);
@@ -258,7 +150,21 @@ public:
 
     std::vector<TrayIconData> GetIcons() {
         std::lock_guard<std::recursive_mutex> lock(iconMutex);
-        return icons;
+        std::vector<TrayIconData> out;
+        out.reserve(icons.Size());
+        for (const auto &entry : icons.Entries()) out.push_back(entry.icon);
+        return out;
+    }
+
+    // Drops icons whose owner window is gone, all in one pass. Runs on the primary bar's stats timer
+    void CollectDeadIcons() {
+        size_t removed = 0;
+        {
+            std::lock_guard<std::recursive_mutex> lock(iconMutex);
+            removed = icons.Collect([](uint64_t owner) { return !IsWindow((HWND)(UINT_PTR)owner); },
+                [](TrayIconData &icon) { if (icon.hIcon) DestroyIcon(icon.hIcon); });
+        }
+        if (removed) NotifyIconsChanged();
     }
 
     void ResetWorkAreaToMonitor(HMONITOR hMon)
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "OpenHashMap.h"
+#include "NotifyIconParser.h"
+
+// The tray's icons in the order they were added, with hash indexes on
+// (owner window, uID) and on the GUID an icon was registered with, so each
+// NIM_* message finds its icon without walking the list. Icons whose owner
+// went away are collected in one pass when the caller's timer asks, not on
+// every message. Removing an icon rebuilds the indexes (icons are few and
+// removals rare; lookups are what happen per message).
+// Templated on the icon payload so it runs off Windows.
+
+template <typename Icon>
+class TrayIconStore
+{
+public:
+    struct Entry {
+        uint64_t owner = 0;
+        uint32_t uID = 0;
+        bool hasGuid = false;
+        TrayIconGuid guid;
+        Icon icon{};
+    };
+
+    size_t Size() const { return entries.size(); }
+    const std::vector<Entry> &Entries() const { return entries; }
+
+    // The icon a message addresses: its GUID if it has one registered, else (owner, uID)
+    Entry *Find(uint64_t owner, uint32_t uID, const TrayIconGuid *guid) {
+        int i = IndexOf(owner, uID, guid);
+        return i >= 0 ? &entries[i] : nullptr;
+    }
+
+    /// <summary>
+    /// Finds the icon or appends a new one. A GUID match takes the message's
+    /// owner and uID (the app restarted); an (owner, uID) match picks up a
+    /// GUID it didn't have before. If the GUID match moves onto an (owner, uID)
+    /// another icon holds, that icon is stale and goes to `onEvict`.
+    /// </summary>
+    template <typename Fn>
+    Entry &Upsert(uint64_t owner, uint32_t uID, const TrayIconGuid *guid, bool &added, Fn &&onEvict) {
+        int i = IndexOf(owner, uID, guid);
+        added = i < 0;
+        if (added) {
+            i = (int)entries.size();
+            entries.emplace_back();
+            entries[i].owner = owner;
+            entries[i].uID = uID;
+            byId.Insert(IdKey(owner, uID), (uint32_t)i);
+        }
+        if (entries[i].owner != owner || entries[i].uID != uID) {
+            const uint32_t *held = byId.Find(IdKey(owner, uID));
+            if (held && (int)*held != i) {
+                int other = (int)*held;
+                onEvict(entries[other].icon);
+                entries.erase(entries.begin() + other);
+                if (other < i) i--;
+                Reindex();
+            }
+            Entry &moved = entries[i];
+            byId.Erase(IdKey(moved.owner, moved.uID));
+            moved.owner = owner;
+            moved.uID = uID;
+            byId.Insert(IdKey(owner, uID), (uint32_t)i);
+        }
+        Entry &e = entries[i];
+        if (guid && (!e.hasGuid || e.guid != *guid)) {
+            if (e.hasGuid) byGuid.Erase(GuidKey(e.guid));
+            e.hasGuid = true;
+            e.guid = *guid;
+            byGuid.Insert(GuidKey(*guid), (uint32_t)i);
+        }
+        return e;
+    }
+
+    // Removes the addressed icon, handing it to `onRemove` first
+    template <typename Fn>
+    bool Erase(uint64_t owner, uint32_t uID, const TrayIconGuid *guid, Fn &&onRemove) {
+        int i = IndexOf(owner, uID, guid);
+        if (i < 0) return false;
+        onRemove(entries[i].icon);
+        entries.erase(entries.begin() + i);
+        Reindex();
+        return true;
+    }
+
+    // Removes every icon whose owner `isDead`, in one pass. Returns how many went
+    template <typename Dead, typename Fn>
+    size_t Collect(Dead &&isDead, Fn &&onRemove) {
+        size_t kept = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (isDead(entries[i].owner)) {
+                onRemove(entries[i].icon);
+                continue;
+            }
+            if (kept != i) entries[kept] = std::move(entries[i]);
+            kept++;
+        }
+        size_t removed = entries.size() - kept;
+        if (removed) {
+            entries.erase(entries.begin() + kept, entries.end());
+            Reindex();
+        }
+        return removed;
+    }
+
+    template <typename Fn>
+    void Clear(Fn &&onRemove) {
+        for (Entry &e : entries) onRemove(e.icon);
+        entries.clear();
+        byId.Clear();
+        byGuid.Clear();
+    }
+
+private:
+    std::vector<Entry> entries;
+    OpenHashMap<uint64_t, uint32_t> byId;
+    OpenHashMap<uint64_t, uint32_t> byGuid; // Folded GUID; the entry's full GUID is compared
+
+    // Window handles carry 32 significant bits, also from 64-bit senders
+    static uint64_t IdKey(uint64_t owner, uint32_t uID) { return (uint64_t)(uint32_t)owner << 32 | uID; }
+
+    static uint64_t GuidKey(const TrayIconGuid &guid) {
+        uint64_t lo, hi;
+        std::memcpy(&lo, guid.bytes, 8);
+        std::memcpy(&hi, guid.bytes + 8, 8);
+        return lo ^ (hi * 0x9e3779b97f4a7c15ull);
+    }
+
+    int IndexOf(uint64_t owner, uint32_t uID, const TrayIconGuid *guid) const {
+        if (guid) {
+            const uint32_t *i = byGuid.Find(GuidKey(*guid));
+            if (i && entries[*i].guid == *guid) return (int)*i;
+        }
+        const uint32_t *i = byId.Find(IdKey(owner, uID));
+        return i ? (int)*i : -1;
+    }
+
+    void Reindex() {
+        byId.Clear();
+        byGuid.Clear();
+        for (size_t i = 0; i < entries.size(); i++) {
+            byId.Insert(IdKey(entries[i].owner, entries[i].uID), (uint32_t)i);
+            if (entries[i].hasGuid) byGuid.Insert(GuidKey(entries[i].guid), (uint32_t)i);
+        }
+    }
+};
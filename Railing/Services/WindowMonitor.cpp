@@ -6,6 +6,7 @@
 #include <cctype>
 
 #pragma comment(lib, "dwmapi.lib")
+#pragma comment(lib, "version.lib")
 
 size_t CalculatePathHash(const std::wstring &path) {
     std::wstring lower = path;
@@ -30,7 +31,7 @@ void WindowMonitor::GetTopLevelWindows(std::vector<WindowInfo> &outWindows, cons
             size_t hash = CalculatePathHash(exe);
 
             RECT r; GetWindowRect(hwnd, &r);
-            ctx->list->push_back({ hwnd, title, r, exe, false });
+            ctx->list->push_back({ hwnd, title, r, exe, hash });
         }
         return TRUE;
         }, (LPARAM)&data);
@@ -45,7 +46,7 @@ void WindowMonitor::GetTopLevelWindows(std::vector<WindowInfo> &outWindows, cons
             final.push_back(*it);
             running.erase(it);
         }
-        else final.push_back({ NULL, L"", {0}, pin, true });
+        else final.push_back({ NULL, L"", {0}, pin, pinHash, true });
     }
     final.insert(final.end(), running.begin(), running.end());
     outWindows = final;
@@ -78,16 +79,112 @@ BOOL WindowMonitor::IsAppWindow(HWND hwnd, HWND barWindow)
 
 std::wstring WindowMonitor::GetWindowExePath(HWND hwnd)
 {
-    DWORD pid;
+    const ProcessInfo *info = GetWindowProcess(hwnd);
+    return info ? info->imagePath : L"";
+}
+
+const ProcessInfo *WindowMonitor::GetWindowProcess(HWND hwnd)
+{
+    DWORD pid = 0;
     GetWindowThreadProcessId(hwnd, &pid);
-    HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
-    if (hProcess) {
-        wchar_t path[MAX_PATH];
-        if (GetModuleFileNameExW(hProcess, NULL, path, MAX_PATH)) {
-            CloseHandle(hProcess);
-            return std::wstring(path);
+    return Processes().Lookup(pid);
+}
+
+ProcessCache &WindowMonitor::Processes()
+{
+    static Win32ProcessSource source;
+    static ProcessCache cache(source);
+    return cache;
+}
+
+uintptr_t Win32ProcessSource::Open(uint32_t pid)
+{
+    // Limited information is enough for the image name and works on elevated processes
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, pid);
+    return (uintptr_t)hProcess;
+}
+
+void Win32ProcessSource::Close(uintptr_t process)
+{
+    if (process) CloseHandle((HANDLE)process);
+}
+
+uint64_t Win32ProcessSource::StartTime(uintptr_t process) const
+{
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes((HANDLE)process, &created, &exited, &kernel, &user)) return 0;
+    return ((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime;
+}
+
+bool Win32ProcessSource::IsAlive(uintptr_t process, uint64_t startTime) const
+{
+    // The open handle pins the PID to this process, so only exit needs checking
+    return WaitForSingleObject((HANDLE)process, 0) == WAIT_TIMEOUT;
+}
+
+std::wstring Win32ProcessSource::ImagePath(uintptr_t process) const
+{
+    wchar_t path[MAX_PATH];
+    DWORD size = MAX_PATH;
+    if (!QueryFullProcessImageNameW((HANDLE)process, 0, path, &size)) return L"";
+    return std::wstring(path, size);
+}
+
+std::wstring Win32ProcessSource::DisplayName(const std::wstring &imagePath) const
+{
+    DWORD handle = 0;
+    DWORD size = GetFileVersionInfoSizeW(imagePath.c_str(), &handle);
+    if (size > 0) {
+        std::vector<BYTE> data(size);
+        if (GetFileVersionInfoW(imagePath.c_str(), 0, size, data.data())) {
+            struct Translation { WORD language; WORD codePage; } *translations = nullptr;
+            UINT len = 0;
+            if (VerQueryValueW(data.data(), L"\\VarFileInfo\\Translation", (LPVOID *)&translations, &len) && len >= sizeof(Translation)) {
+                wchar_t key[64];
+                swprintf_s(key, L"\\StringFileInfo\\%04x%04x\\FileDescription", translations[0].language, translations[0].codePage);
+                wchar_t *description = nullptr;
+                if (VerQueryValueW(data.data(), key, (LPVOID *)&description, &len) && len > 1 && description[0]) return description;
+            }
         }
-        CloseHandle(hProcess);
     }
-    return L"";
+
+    // No description: the file name without its extension
+    size_t slash = imagePath.find_last_of(L"\\/");
+    std::wstring name = slash == std::wstring::npos ? imagePath : imagePath.substr(slash + 1);
+    size_t dot = name.rfind(L'.');
+    return dot == std::wstring::npos ? name : name.substr(0, dot);
+}
+
+void DesktopWindowSystem::EnumerateAppWindows(std::vector<uintptr_t> &out) const
+{
+    struct EnumData { const DesktopWindowSystem *self; std::vector<uintptr_t> *list; };
+    EnumData data = { this, &out };
+
+    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
+        auto *ctx = (EnumData *)lParam;
+        if (ctx->self->IsAppWindow((uintptr_t)hwnd)) ctx->list->push_back((uintptr_t)hwnd);
+        return TRUE;
+        }, (LPARAM)&data);
+}
+
+bool DesktopWindowSystem::IsAppWindow(uintptr_t hwnd) const
+{
+    HWND h = (HWND)hwnd;
+    if (GetAncestor(h, GA_ROOT) != h) return false;
+    DWORD pid = 0;
+    GetWindowThreadProcessId(h, &pid);
+    if (pid == GetCurrentProcessId()) return false;
+    return WindowMonitor::IsAppWindow(h, NULL) != FALSE;
+}
+
+std::wstring DesktopWindowSystem::GetTitle(uintptr_t hwnd) const
+{
+    wchar_t title[256];
+    int len = GetWindowTextW((HWND)hwnd, title, 256);
+    return std::wstring(title, len > 0 ? len : 0);
+}
+
+std::wstring DesktopWindowSystem::GetExePath(uintptr_t hwnd) const
+{
+    return WindowMonitor::GetWindowExePath((HWND)hwnd);
 }
@@ -5,6 +5,37 @@
 #include <vector>
 #include <string>
 #include <Types.h>
+#include "WindowRegistry.h"
+#include "ProcessCache.h"
+
+/// <summary>
+/// WindowSystem over the real desktop. Railing's own windows are left out,
+/// matching the WinEvent hooks (WINEVENT_SKIPOWNPROCESS).
+/// </summary>
+class DesktopWindowSystem : public WindowSystem
+{
+public:
+	void EnumerateAppWindows(std::vector<uintptr_t> &out) const override;
+	bool IsAppWindow(uintptr_t hwnd) const override;
+	std::wstring GetTitle(uintptr_t hwnd) const override;
+	std::wstring GetExePath(uintptr_t hwnd) const override;
+};
+
+/// <summary>
+/// ProcessSource over real processes. The cache keeps each handle open, which
+/// also stops Windows from handing the PID to another process meanwhile.
+/// </summary>
+class Win32ProcessSource : public ProcessSource
+{
+public:
+	uintptr_t Open(uint32_t pid) override;
+	void Close(uintptr_t process) override;
+	uint64_t StartTime(uintptr_t process) const override;
+	bool IsAlive(uintptr_t process, uint64_t startTime) const override;
+	std::wstring ImagePath(uintptr_t process) const override;
+	std::wstring DisplayName(const std::wstring &imagePath) const override;
+};
+
 class WindowMonitor
 {
 public:
@@ -31,6 +62,10 @@ public:
 	/// <returns>Executable path if exists, else ""</returns>
 	static std::wstring GetWindowExePath(HWND hwnd);
 
+	// Cached details of the process owning `hwnd` (UI thread only); null if it can't be queried
+	static const ProcessInfo *GetWindowProcess(HWND hwnd);
+	static ProcessCache &Processes();
+
 	static inline std::wstring ResolveShortcut(const std::wstring &path) {
 		if (path.length() < 4 || path.substr(path.length() - 4) != L".lnk")
 			return path;
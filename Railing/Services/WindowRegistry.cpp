@@ -0,0 +1,212 @@
+#include "WindowRegistry.h"
+#include <algorithm>
+#include <cwctype>
+#include <unordered_set>
+
+size_t WindowRegistry::PathHash(const std::wstring &path)
+{
+    std::wstring lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), std::towlower);
+    return std::hash<std::wstring>{}(lower);
+}
+
+const WindowRecord *WindowRegistry::Find(uintptr_t hwnd) const
+{
+    const uint32_t *slot = slots.Find(hwnd);
+    return slot ? &records[*slot] : nullptr;
+}
+
+bool WindowRegistry::Sync()
+{
+    syncs++;
+    enumerated.clear();
+    system.EnumerateAppWindows(enumerated);
+
+    bool changed = false;
+    if (!seeded) {
+        seeded = true;
+        for (uintptr_t hwnd : enumerated) {
+            if (!slots.Contains(hwnd)) Add(hwnd, false);
+        }
+        changed = !order.empty();
+    }
+    else {
+        std::unordered_set<uintptr_t> present(enumerated.begin(), enumerated.end());
+        std::vector<uintptr_t> gone;
+        for (uint32_t slot : order) {
+            if (!present.count(records[slot].hwnd)) gone.push_back(records[slot].hwnd);
+        }
+        for (uintptr_t hwnd : gone) Remove(hwnd);
+        changed = !gone.empty();
+
+        // Missed shows join on top, in the enumeration's order
+        for (auto it = enumerated.rbegin(); it != enumerated.rend(); ++it) {
+            if (slots.Contains(*it)) continue;
+            Add(*it, true);
+            changed = true;
+        }
+        // Titles are cheap to read; exe paths never change for a window
+        for (uint32_t slot : order) {
+            WindowRecord &r = records[slot];
+            std::wstring title = system.GetTitle(r.hwnd);
+            if (title == r.title) continue;
+            r.title = std::move(title);
+            renames++;
+            Record(WindowDelta::Renamed, r.hwnd);
+            changed = true;
+        }
+    }
+
+    if (changed) version++;
+    return changed;
+}
+
+bool WindowRegistry::OnShown(uintptr_t hwnd)
+{
+    bool present = slots.Contains(hwnd);
+    bool qualifies = system.IsAppWindow(hwnd);
+    if (present == qualifies) return present ? OnRenamed(hwnd) : false;
+
+    if (qualifies) Add(hwnd, true);
+    else Remove(hwnd);
+    version++;
+    return true;
+}
+
+bool WindowRegistry::OnRenamed(uintptr_t hwnd)
+{
+    const uint32_t *slot = slots.Find(hwnd);
+    if (!slot) return OnShown(hwnd); // Windows can qualify once they get a title
+    WindowRecord &r = records[*slot];
+    std::wstring title = system.GetTitle(hwnd);
+    if (title == r.title) return false;
+    r.title = std::move(title);
+    renames++;
+    Record(WindowDelta::Renamed, hwnd);
+    version++;
+    return true;
+}
+
+bool WindowRegistry::OnRemoved(uintptr_t hwnd)
+{
+    if (!slots.Contains(hwnd)) return false;
+    Remove(hwnd);
+    version++;
+    return true;
+}
+
+bool WindowRegistry::Apply(const WinEventBatch &batch)
+{
+    bool changed = false;
+    for (const WindowEventEntry &e : batch.windows) {
+        if (e.changes == WINDOW_MOVED) continue; // Geometry isn't part of the record
+        if (e.changes & (WINDOW_DESTROYED | WINDOW_HIDDEN)) changed |= OnRemoved(e.hwnd);
+        else if (e.changes & WINDOW_SHOWN) changed |= OnShown(e.hwnd);
+        else if (e.changes & WINDOW_RENAMED) changed |= OnRenamed(e.hwnd);
+        else if (!slots.Contains(e.hwnd)) changed |= OnShown(e.hwnd); // Focused, not listed yet
+    }
+    return changed;
+}
+
+bool WindowRegistry::DeltasSince(uint64_t sinceVersion, std::vector<WindowDelta> &out) const
+{
+    out.clear();
+    if (sinceVersion < logFloor || sinceVersion > version) return false;
+    auto first = std::upper_bound(log.begin(), log.end(), sinceVersion,
+        [](uint64_t v, const WindowDelta &d) { return v < d.version; });
+    out.assign(first, log.end());
+    return true;
+}
+
+void WindowRegistry::Snapshot(std::vector<const WindowRecord *> &out) const
+{
+    out.clear();
+    out.reserve(order.size());
+    for (uint32_t slot : order) out.push_back(&records[slot]);
+}
+
+void WindowRegistry::MergePinned(const std::vector<size_t> &pinnedHashes, std::vector<WindowListEntry> &out) const
+{
+    out.clear();
+    out.reserve(pinnedHashes.size() + order.size());
+
+    // Chain windows of the same app so each pinned entry claims the next one in order
+    firstOfHash.clear();
+    nextOfHash.assign(order.size(), UINT32_MAX);
+    taken.assign(order.size(), false);
+    for (size_t i = order.size(); i-- > 0;) {
+        size_t h = records[order[i]].pathHash;
+        auto it = firstOfHash.find(h);
+        if (it != firstOfHash.end()) nextOfHash[i] = it->second;
+        firstOfHash[h] = (uint32_t)i;
+    }
+
+    for (size_t p = 0; p < pinnedHashes.size(); p++) {
+        WindowListEntry entry;
+        entry.pinnedIndex = (int)p;
+        auto it = firstOfHash.find(pinnedHashes[p]);
+        if (it != firstOfHash.end() && it->second != UINT32_MAX) {
+            uint32_t i = it->second;
+            entry.window = &records[order[i]];
+            taken[i] = true;
+            it->second = nextOfHash[i];
+        }
+        out.push_back(entry);
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        if (!taken[i]) out.push_back({ &records[order[i]], -1 });
+    }
+}
+
+uint32_t WindowRegistry::Add(uintptr_t hwnd, bool onTop)
+{
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = (uint32_t)records.size();
+        records.emplace_back();
+    }
+
+    WindowRecord &r = records[slot];
+    r.hwnd = hwnd;
+    r.title = system.GetTitle(hwnd);
+    r.exePath = system.GetExePath(hwnd);
+    r.pathHash = PathHash(r.exePath);
+
+    slots.Insert(hwnd, slot);
+    if (onTop) order.insert(order.begin(), slot);
+    else order.push_back(slot);
+    adds++;
+    Record(WindowDelta::Added, hwnd);
+    return slot;
+}
+
+void WindowRegistry::Remove(uintptr_t hwnd)
+{
+    const uint32_t *found = slots.Find(hwnd);
+    if (!found) return;
+    uint32_t slot = *found;
+    slots.Erase(hwnd);
+    order.erase(std::find(order.begin(), order.end(), slot));
+
+    WindowRecord &r = records[slot];
+    r.hwnd = 0;
+    r.title.clear();
+    r.exePath.clear();
+    freeSlots.push_back(slot);
+    removes++;
+    Record(WindowDelta::Removed, hwnd);
+}
+
+void WindowRegistry::Record(WindowDelta::Kind kind, uintptr_t hwnd)
+{
+    // Every change lands in the version the current call is about to publish
+    log.push_back({ version + 1, hwnd, kind });
+    if (log.size() > MAX_LOG) {
+        logFloor = log.front().version;
+        log.pop_front();
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include "WinEventQueue.h"
+#include "OpenHashMap.h"
+
+// The desktop's app windows, kept up to date from window events instead of
+// enumerating every window (and opening its process) on every paint. One full
+// enumeration seeds it; after that shows, hides, renames and destroys edit the
+// records in place, and a periodic Sync diffs against a fresh enumeration to
+// catch anything the hooks don't report. Consumers compare Version() with the
+// one they last built from and only then rebuild their lists.
+// Window queries go through WindowSystem so the registry runs against a fake
+// desktop off Windows.
+
+class WindowSystem
+{
+public:
+    virtual ~WindowSystem() = default;
+    // Windows the dock would list, top of the z-order first
+    virtual void EnumerateAppWindows(std::vector<uintptr_t> &out) const = 0;
+    virtual bool IsAppWindow(uintptr_t hwnd) const = 0;
+    virtual std::wstring GetTitle(uintptr_t hwnd) const = 0;
+    virtual std::wstring GetExePath(uintptr_t hwnd) const = 0;
+};
+
+struct WindowRecord {
+    uintptr_t hwnd = 0;
+    std::wstring title;
+    std::wstring exePath;
+    size_t pathHash = 0; // WindowRegistry::PathHash(exePath)
+};
+
+// One change to the list, stamped with the Version() it is part of
+struct WindowDelta {
+    enum Kind : uint8_t { Added, Removed, Renamed };
+    uint64_t version = 0;
+    uintptr_t hwnd = 0;
+    Kind kind = Added;
+};
+
+// One row of a dock list: a running window, a pinned app, or a pinned app's running window
+struct WindowListEntry {
+    const WindowRecord *window = nullptr; // Null for a pinned app that isn't running
+    int pinnedIndex = -1;                 // Into the pinned list passed to MergePinned
+};
+
+class WindowRegistry
+{
+public:
+    explicit WindowRegistry(const WindowSystem &system) : system(system) {}
+
+    /// <summary>
+    /// Enumerate the desktop and reconcile: add new windows, drop vanished
+    /// ones, pick up title changes. The first call seeds the registry in
+    /// z-order. Returns true if anything changed.
+    /// </summary>
+    bool Sync();
+
+    // Incremental updates; each returns true if the list changed
+    bool OnShown(uintptr_t hwnd);   // Adds the window if it now qualifies, drops it if it no longer does
+    bool OnRenamed(uintptr_t hwnd);
+    bool OnRemoved(uintptr_t hwnd); // Hidden, cloaked or destroyed
+    bool Apply(const WinEventBatch &batch);
+
+    uint64_t Version() const { return version; }
+
+    /// <summary>
+    /// Changes after `sinceVersion`, oldest first, for consumers that keep
+    /// their own model. False when the log no longer reaches back that far;
+    /// rebuild from Snapshot then.
+    /// </summary>
+    bool DeltasSince(uint64_t sinceVersion, std::vector<WindowDelta> &out) const;
+    size_t Count() const { return order.size(); }
+    const WindowRecord *Find(uintptr_t hwnd) const;
+
+    /// <summary>
+    /// Live windows, z-order at seed time with windows shown since placed on
+    /// top. Pointers stay valid until the registry next changes.
+    /// </summary>
+    void Snapshot(std::vector<const WindowRecord *> &out) const;
+
+    /// <summary>
+    /// Pinned apps first, each with its first running window if there is one,
+    /// then the remaining windows. `pinnedHashes` are PathHash values.
+    /// </summary>
+    void MergePinned(const std::vector<size_t> &pinnedHashes, std::vector<WindowListEntry> &out) const;
+
+    // Same hash as the dock's: case-insensitive on the full path
+    static size_t PathHash(const std::wstring &path);
+
+    uint64_t adds = 0;
+    uint64_t removes = 0;
+    uint64_t renames = 0;
+    uint64_t syncs = 0;
+
+private:
+    const WindowSystem &system;
+
+    std::deque<WindowRecord> records;            // Stable addresses; freed slots are reused
+    std::vector<uint32_t> freeSlots;
+    OpenHashMap<uintptr_t, uint32_t> slots;      // hwnd -> record
+    std::vector<uint32_t> order;                 // Live records, front = top
+    uint64_t version = 0;
+    bool seeded = false;
+
+    static constexpr size_t MAX_LOG = 4096;
+    std::deque<WindowDelta> log;
+    uint64_t logFloor = 0; // Versions below this may have lost deltas
+
+    // Scratch for Sync and MergePinned
+    std::vector<uintptr_t> enumerated;
+    mutable std::unordered_map<size_t, uint32_t> firstOfHash;
+    mutable std::vector<uint32_t> nextOfHash;
+    mutable std::vector<bool> taken;
+
+    uint32_t Add(uintptr_t hwnd, bool onTop);
+    void Remove(uintptr_t hwnd);
+    void Record(WindowDelta::Kind kind, uintptr_t hwnd);
+};
@@ -4,7 +4,9 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cmath>
 #include <Windows.h>
+#include "IconDecode.h"
 
 #pragma comment(lib, "d2d1.lib")
 #pragma comment(lib, "dwrite.lib")
@@ -97,17 +99,7 @@ private:
     void CreateIconBitmap() {
         if (!m_pRenderTarget || !m_hIcon || !m_pWicFactory) return;
         if (m_pIconBitmap) return;
-        IWICBitmap *wicBitmap = nullptr;
-        if (SUCCEEDED(m_pWicFactory->CreateBitmapFromHICON(m_hIcon, &wicBitmap))) {
-            IWICFormatConverter *converter = nullptr;
-            m_pWicFactory->CreateFormatConverter(&converter);
-            if (converter) {
-                converter->Initialize(wicBitmap, GUID_WICPixelFormat32bppPBGRA, WICBitmapDitherTypeNone, nullptr, 0.f, WICBitmapPaletteTypeMedianCut);
-                m_pRenderTarget->CreateBitmapFromWicBitmap(converter, nullptr, &m_pIconBitmap);
-                converter->Release();
-            }
-            wicBitmap->Release();
-        }
+        m_pIconBitmap = ::CreateIconBitmap(m_pRenderTarget, m_pWicFactory, m_hIcon, (int)std::lround(GetMetrics().iconSize));
     }
 
     void DiscardDeviceResources() {
@@ -1,6 +1,7 @@
 #include "MainMenu.h"
 #include "BarInstance.h"
 #include "Railing.h"
+#include "FrameProfiler.h"
 #include <shobjidl.h>
 #include <thread>
 #include <shtypes.h>
@@ -62,6 +63,10 @@ HMENU MainMenu::CreateTaskbarContextMenu(BarInstance *bar)
     AppendMenu(system, MF_STRING, CMD_SYSTEM_RESTART_SHELL, L"Restart Shell");
     AppendMenu(system, MF_SEPARATOR, 0, nullptr);
     AppendMenu(system, MF_STRING, CMD_SYSTEM_EXIT_TO_EXPLORER, L"Exit to Explorer");
+#if RAILING_PROFILER
+    AppendMenu(system, MF_SEPARATOR, 0, nullptr);
+    AppendMenu(system, MF_STRING | (FrameProfiler::IsEnabled() ? MF_CHECKED : 0), CMD_SYSTEM_FRAME_TRACE, L"Record Frame Trace");
+#endif
     
     AppendMenu(root, MF_POPUP, (UINT_PTR)system, L"System");
 
@@ -222,6 +227,7 @@ void MainMenu::HandleMenuCmd(HWND hwnd, UINT cmd) {
             const char *cfgName = bar->configFileName.c_str();
 
             bar->config = ThemeLoader::Load(cfgName);
+            bar->ApplyAnimationConfig();
             if (bar->renderer) {
                 bar->renderer->Reload(cfgName);
                 if (cmd == CMD_CONFIG_RELOAD) bar->renderer->Resize();
@@ -235,7 +241,9 @@ void MainMenu::HandleMenuCmd(HWND hwnd, UINT cmd) {
             else Railing::instance->UpdateGlobalStats();
 
             SetTimer(hwnd, 1, 1000, NULL);
-            SetTimer(hwnd, ANIMATION_TIMER_ID, 16, NULL);
+            bar->frames.Cancel(FRAME_CLIENT_REPAINT | FRAME_CLIENT_AUTOHIDE);
+            if (bar->config.global.autoHide) bar->frames.RequestFrame(FRAME_CLIENT_AUTOHIDE);
+            bar->ScheduleFrames();
 
             InvalidateRect(hwnd, NULL, FALSE);
             OutputDebugString(L"[Railing] Config Reloaded Safely.\n");
@@ -309,6 +317,27 @@ void MainMenu::HandleMenuCmd(HWND hwnd, UINT cmd) {
             PostQuitMessage(0);
             break;
         }
+        case CMD_SYSTEM_FRAME_TRACE: {
+            // First click starts recording, the second writes what the rings hold
+            if (!FrameProfiler::IsEnabled()) {
+                FrameProfiler::Clear();
+                FrameProfiler::SetEnabled(true);
+                break;
+            }
+            FrameProfiler::SetEnabled(false);
+
+            wchar_t exePath[MAX_PATH];
+            GetModuleFileName(NULL, exePath, MAX_PATH);
+            std::wstring tracePath(exePath);
+            tracePath = tracePath.substr(0, tracePath.find_last_of(L"\\/")) + L"\\railing-trace.json";
+
+            if (FrameProfiler::WriteChromeTrace(tracePath)) {
+                std::wstring msg = L"Frame trace saved to:\n" + tracePath + L"\n\nOpen it in ui.perfetto.dev or chrome://tracing.";
+                MessageBox(hwnd, msg.c_str(), L"Railing", MB_OK | MB_ICONINFORMATION | MB_TOPMOST);
+            }
+            else MessageBox(hwnd, L"Could not write the frame trace.", L"Railing", MB_OK | MB_ICONWARNING | MB_TOPMOST);
+            break;
+        }
         case CMD_SYSTEM_RESTART_BAR: {
             wchar_t exePath[MAX_PATH];
             GetModuleFileName(NULL, exePath, MAX_PATH);
@@ -31,6 +31,7 @@ public:
 		CMD_SYSTEM_RESTART_BAR = 1400,
 		CMD_SYSTEM_RESTART_SHELL,
 		CMD_SYSTEM_EXIT_TO_EXPLORER,
+		CMD_SYSTEM_FRAME_TRACE,
 
 		CMD_ABOUT = 1500,
 		CMD_AUTOHIDE
@@ -2,6 +2,7 @@
 #include <windowsx.h>
 #include "RailingRenderer.h"
 #include <wincodec.h>
+#include "IconDecode.h"
 #include <cmath>
 #include "dwmapi.h"
 
@@ -32,38 +33,6 @@ static LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
     return CallNextHookEx(g_mouseHook, nCode, wParam, lParam);
 }
 
-ID2D1Bitmap *CreateBitmapFromIcon(ID2D1RenderTarget *rt, IWICImagingFactory *pWIC, HICON hIcon) {
-    if (!hIcon || !rt || !pWIC) return nullptr;
-
-    ID2D1Bitmap *d2dBitmap = nullptr;
-    IWICBitmap *wicBitmap = nullptr;
-
-    // Use WIC to wrap the HICON
-    HRESULT hr = pWIC->CreateBitmapFromHICON(hIcon, &wicBitmap);
-    if (FAILED(hr)) return nullptr;
-
-    IWICFormatConverter *pConverter = nullptr;
-    hr = pWIC->CreateFormatConverter(&pConverter);
-    if (SUCCEEDED(hr)) {
-        // Specifically use GUID_WICPixelFormat32bppPBGRA for Direct2D compatibility
-        hr = pConverter->Initialize(
-            wicBitmap,
-            GUID_WICPixelFormat32bppPBGRA,
-            WICBitmapDitherTypeNone,
-            NULL,
-            0.f,
-            WICBitmapPaletteTypeCustom
-        );
-
-        if (SUCCEEDED(hr)) {
-            rt->CreateBitmapFromWicBitmap(pConverter, NULL, &d2dBitmap);
-        }
-        pConverter->Release();
-    }
-    wicBitmap->Release();
-    return d2dBitmap;
-}
-
 TrayFlyout::TrayFlyout(BarInstance *owner, HINSTANCE hInst, ID2D1Factory *sharedFactory, IWICImagingFactory *sharedWIC, TooltipHandler *tooltips, const ThemeConfig &config)
     : ownerBar(owner), pFactory(sharedFactory), pWICFactory(sharedWIC), tooltips(tooltips) {
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
@@ -104,8 +73,8 @@ TrayFlyout::~TrayFlyout() {
     if (pHoverBrush) pHoverBrush->Release();
     if (pBorderBrush) pBorderBrush->Release();
 
-    for (auto *bmp : cachedBitmaps) if (bmp) bmp->Release();
     cachedBitmaps.clear();
+    iconCache.Clear();
     CoUninitialize();
 }
 
@@ -120,9 +89,7 @@ void TrayFlyout::Toggle(RECT iconRect) {
         FlyoutManager::Get().CloseOthers(this);
         currentIcons = TrayBackend::Get().GetIcons();
         UpdateLayout();
-
-        for (auto *bmp : cachedBitmaps) if (bmp) bmp->Release();
-        cachedBitmaps.clear();
+        cachedBitmaps.clear(); // Matched up with the cache on the next draw
 
         if (currentIcons.size() <= 5) layoutCols = max(1, (int)currentIcons.size());
         else if (currentIcons.size() <= 9) layoutCols = 3;
@@ -210,9 +177,6 @@ void TrayFlyout::Hide()
     animState = AnimationState::Hidden;
     ShowWindow(hwnd, SW_HIDE);
     fadeAlpha = 0.0f;
-
-    for (auto *bmp : cachedBitmaps) if (bmp) bmp->Release();
-    cachedBitmaps.clear();
 }
 
 void TrayFlyout::UpdateLayout() {
@@ -302,10 +266,6 @@ LRESULT CALLBACK TrayFlyout::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPA
     case WM_TRAY_REFRESH:
         if (self && self->animState == AnimationState::Visible) {
             self->currentIcons = TrayBackend::Get().GetIcons();
-
-            for (auto *bmp : self->cachedBitmaps) if (bmp) bmp->Release();
-            self->cachedBitmaps.clear();
-
             self->UpdateLayout();
             self->UpdateBitmapCache();
             InvalidateRect(hwnd, NULL, FALSE);
@@ -380,17 +340,24 @@ void TrayFlyout::OnMouseLeave() {
     InvalidateRect(hwnd, NULL, FALSE);
 }
 
+// Only icons whose pixels changed since they were last converted get new bitmaps
 void TrayFlyout::UpdateBitmapCache() {
-    if (cachedBitmaps.size() != currentIcons.size()) {
-        for (auto *bmp : cachedBitmaps) if (bmp) bmp->Release();
-        cachedBitmaps.assign(currentIcons.size(), nullptr);
+    if (!pRenderTarget) return; // Draw creates the target and comes back here
+
+    int edge = (int)layoutIconSize; // 96 DPI target: DIPs are pixels
+    if (iconConverter.rt != pRenderTarget || iconConverter.edge != edge) {
+        iconCache.Clear();
+        iconConverter.rt = pRenderTarget;
+        iconConverter.edge = edge;
     }
+    iconConverter.wic = pWICFactory;
 
-    for (size_t i = 0; i < currentIcons.size(); i++) {
-        if (cachedBitmaps[i] == nullptr && currentIcons[i].hIcon) {
-            cachedBitmaps[i] = CreateBitmapFromIcon(pRenderTarget, pWICFactory, currentIcons[i].hIcon);
-        }
+    std::vector<TrayIconRef> refs;
+    refs.reserve(currentIcons.size());
+    for (const TrayIconData &icon : currentIcons) {
+        refs.push_back({ (uintptr_t)icon.ownerHwnd, icon.uID, icon.iconRevision, (uintptr_t)icon.hIcon });
     }
+    iconCache.Update(refs, cachedBitmaps);
 }
 
 void TrayFlyout::Draw() {
@@ -467,7 +434,7 @@ void TrayFlyout::Draw() {
 
             // Icon
             if (i < cachedBitmaps.size() && cachedBitmaps[i]) {
-                pRenderTarget->DrawBitmap(cachedBitmaps[i], iconDest, fadeAlpha);
+                pRenderTarget->DrawBitmap((ID2D1Bitmap *)cachedBitmaps[i], iconDest, fadeAlpha);
             }
             else {
                 pBgBrush->SetColor(D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.3f * fadeAlpha));
@@ -7,11 +7,30 @@
 #include "ThemeTypes.h"
 #include "TooltipHandler.h"
 #include "TrayBackend.h"
+#include "TrayIconCache.h"
+#include "IconDecode.h"
 #include "IFlyout.h"
 #pragma comment(lib, "winmm.lib")
 
 class BarInstance;
 
+// Reads tray icons through WIC and uploads them at the flyout's icon size
+class D2DTrayIconConverter : public TrayIconConverter {
+public:
+    ID2D1RenderTarget *rt = nullptr;
+    IWICImagingFactory *wic = nullptr;
+    int edge = 32;
+
+    bool Read(uintptr_t icon, std::vector<uint32_t> &pixels, int &width, int &height) override {
+        return ReadIconPixels(wic, (HICON)icon, pixels, width, height);
+    }
+    void *Convert(std::vector<uint32_t> &pixels, int width, int height) override {
+        PrepareIconPixels(pixels, width, height, edge);
+        return CreateIconBitmap(rt, pixels.data(), width, height);
+    }
+    void Release(void *image) override { ((ID2D1Bitmap *)image)->Release(); }
+};
+
 class TrayFlyout : IFlyout {
 public:
     TrayFlyout(BarInstance *owner, HINSTANCE hInst, ID2D1Factory *sharedFactory, IWICImagingFactory *sharedWIC, TooltipHandler *tooltips, const ThemeConfig &config);
@@ -65,5 +84,7 @@ private:
     ID2D1SolidColorBrush *pBorderBrush = nullptr;
 
     std::vector<TrayIconData> currentIcons;
-    std::vector<ID2D1Bitmap *> cachedBitmaps;
+    D2DTrayIconConverter iconConverter;
+    TrayIconCache iconCache{ iconConverter }; // Owns the bitmaps; kept while the flyout is closed
+    std::vector<void *> cachedBitmaps;        // Per currentIcons entry, borrowed from iconCache
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "TrayIconCache.h"
+
+uint64_t TrayIconCache::PixelHash(const uint32_t *pixels, int width, int height)
+{
+    // FNV-1a over the size and pixels, then a final mix
+    uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&h](uint64_t v) { h = (h ^ v) * 0x100000001b3ull; };
+    mix((uint64_t)(uint32_t)width << 32 | (uint32_t)height);
+    for (size_t i = 0; i < (size_t)width * height; i++) mix(pixels[i]);
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull; h ^= h >> 33;
+    return h;
+}
+
+void TrayIconCache::Update(const std::vector<TrayIconRef> &icons, std::vector<void *> &images)
+{
+    generation++;
+    images.assign(icons.size(), nullptr);
+
+    for (size_t i = 0; i < icons.size(); i++) {
+        const TrayIconRef &ref = icons[i];
+        Slot &slot = slots[{ ref.owner, ref.uID }];
+        slot.seen = generation;
+
+        if (slot.read && slot.revision == ref.revision) {
+            hits++;
+            images[i] = slot.image;
+            continue;
+        }
+        slot.read = true;
+        slot.revision = ref.revision;
+
+        int w = 0, h = 0;
+        if (!ref.icon || !converter.Read(ref.icon, scratch, w, h) || w <= 0 || h <= 0) {
+            if (slot.image) converter.Release(slot.image);
+            slot.image = nullptr;
+            failures++;
+            continue;
+        }
+
+        uint64_t hash = PixelHash(scratch.data(), w, h);
+        if (slot.image && hash == slot.hash) {
+            pixelHits++;
+            images[i] = slot.image;
+            continue;
+        }
+
+        void *image = converter.Convert(scratch, w, h);
+        if (slot.image) converter.Release(slot.image);
+        slot.image = image;
+        slot.hash = hash;
+        if (image) converts++;
+        else failures++;
+        images[i] = image;
+    }
+
+    for (auto it = slots.begin(); it != slots.end();) {
+        if (it->second.seen == generation) { ++it; continue; }
+        if (it->second.image) converter.Release(it->second.image);
+        it = slots.erase(it);
+        dropped++;
+    }
+}
+
+void TrayIconCache::Clear()
+{
+    for (auto &[id, slot] : slots) {
+        if (slot.image) converter.Release(slot.image);
+    }
+    slots.clear();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+// The tray flyout's bitmaps, one per notification icon (owner window, uID).
+// Apps re-send their icon all the time (progress, unread counts, or just the
+// same image again), so an icon is only read back when its revision changes
+// and only reconverted when the pixels it reads back actually differ. Slots
+// outlive the flyout closing; an icon that disappears from the tray releases
+// its bitmap on the next update. The Win32 side sits behind
+// TrayIconConverter so the diffing runs against synthetic icons off Windows.
+
+struct TrayIconRef {
+    uintptr_t owner = 0;   // Owner window
+    uint32_t uID = 0;
+    uint32_t revision = 0; // Bumped each time the icon is set; 0 for none
+    uintptr_t icon = 0;    // Handle the converter reads from
+};
+
+class TrayIconConverter
+{
+public:
+    virtual ~TrayIconConverter() = default;
+
+    // Raw BGRA as the icon holds it, before any conversion. False if unreadable
+    virtual bool Read(uintptr_t icon, std::vector<uint32_t> &pixels, int &width, int &height) = 0;
+    // Converts what Read returned into the backend's image. May modify `pixels`
+    virtual void *Convert(std::vector<uint32_t> &pixels, int width, int height) = 0;
+    virtual void Release(void *image) = 0;
+};
+
+class TrayIconCache
+{
+public:
+    explicit TrayIconCache(TrayIconConverter &converter) : converter(converter) {}
+    ~TrayIconCache() { Clear(); }
+    TrayIconCache(const TrayIconCache &) = delete;
+    TrayIconCache &operator=(const TrayIconCache &) = delete;
+
+    /// <summary>
+    /// Brings the cache in line with the tray's icons and fills `images` in
+    /// the same order (null where an icon couldn't be read or converted).
+    /// Slots for icons no longer in the list are released.
+    /// </summary>
+    void Update(const std::vector<TrayIconRef> &icons, std::vector<void *> &images);
+
+    // Releases every image (new render target, new icon size)
+    void Clear();
+
+    size_t Count() const { return slots.size(); }
+
+    static uint64_t PixelHash(const uint32_t *pixels, int width, int height);
+
+    size_t hits = 0;        // Revision unchanged, nothing read
+    size_t pixelHits = 0;   // New revision, same pixels: bitmap kept
+    size_t converts = 0;
+    size_t failures = 0;    // Unreadable or unconvertible
+    size_t dropped = 0;     // Slots released because their icon left the tray
+    void ResetCounters() { hits = pixelHits = converts = failures = dropped = 0; }
+
+private:
+    struct Id {
+        uintptr_t owner;
+        uint32_t uID;
+        bool operator==(const Id &o) const { return owner == o.owner && uID == o.uID; }
+    };
+    struct IdHash {
+        size_t operator()(const Id &id) const { return (size_t)(((uint64_t)id.owner * 0x9e3779b97f4a7c15ull) ^ id.uID); }
+    };
+    struct Slot {
+        bool read = false; // `revision` has been looked at
+        uint32_t revision = 0;
+        uint64_t hash = 0;
+        void *image = nullptr;
+        uint32_t seen = 0; // Update generation that last listed it
+    };
+
+    TrayIconConverter &converter;
+    std::unordered_map<Id, Slot, IdHash> slots;
+    std::vector<uint32_t> scratch;
+    uint32_t generation = 0;
+};
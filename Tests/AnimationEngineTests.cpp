@@ -0,0 +1,234 @@
+#include "Check.h"
+#include "AnimationEngine.h"
+#include <cmath>
+
+namespace {
+    class FakeClock : public FrameClock
+    {
+    public:
+        uint64_t now = 1000;
+        uint64_t NowMs() const override { return now; }
+    };
+
+    bool Near(float a, float b, float eps = 1e-4f) { return std::fabs(a - b) <= eps; }
+
+    AnimationCurve Tween(Easing easing, uint32_t ms)
+    {
+        AnimationCurve c;
+        c.easing = easing;
+        c.durationMs = ms;
+        return c;
+    }
+
+    AnimationCurve Spring()
+    {
+        AnimationCurve c;
+        c.easing = Easing::Spring;
+        return c;
+    }
+}
+
+TEST(EasingCurves)
+{
+    const Easing all[] = { Easing::Linear, Easing::EaseIn, Easing::EaseOut, Easing::EaseInOut, Easing::EaseOutBack, Easing::Spring };
+    for (Easing e : all) {
+        CHECK(EasingFromName(EasingName(e)) == e);
+        CHECK(ApplyEasing(e, 0.0f) == 0.0f);
+        CHECK(ApplyEasing(e, 1.0f) == 1.0f);
+        CHECK(ApplyEasing(e, -1.0f) == 0.0f);
+        CHECK(ApplyEasing(e, 2.0f) == 1.0f);
+    }
+    CHECK(EasingFromName("bogus") == Easing::EaseOut);
+    CHECK(Near(ApplyEasing(Easing::Linear, 0.25f), 0.25f));
+    CHECK(ApplyEasing(Easing::EaseIn, 0.5f) < 0.5f);
+    CHECK(ApplyEasing(Easing::EaseOut, 0.5f) > 0.5f);
+    CHECK(Near(ApplyEasing(Easing::EaseInOut, 0.5f), 0.5f));
+
+    // Back overshoots before settling
+    float peak = 0.0f;
+    for (int i = 1; i < 100; i++) peak = std::fmax(peak, ApplyEasing(Easing::EaseOutBack, i / 100.0f));
+    CHECK(peak > 1.0f);
+}
+
+TEST(TweensFollowTheClockNotTheFrameCount)
+{
+    FakeClock clock;
+    AnimationEngine slow(clock), fast(clock);
+    AnimHandle a = slow.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    AnimHandle b = fast.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    slow.AnimateTo(a, 100.0f, Tween(Easing::EaseInOut, 300));
+    fast.AnimateTo(b, 100.0f, Tween(Easing::EaseInOut, 300));
+
+    // One engine gets a frame every 8 ms, the other every 50 ms (dropped frames)
+    uint64_t start = clock.now;
+    for (uint64_t t = 8; t <= 320; t += 8) {
+        clock.now = start + t;
+        fast.Step();
+        if (t % 50 == 0 || t > 300) {
+            slow.Step();
+            CHECK(slow.Get(a) == fast.Get(b));
+        }
+    }
+    CHECK(slow.Get(a) == 100.0f);
+    CHECK(slow.IsIdle() && fast.IsIdle());
+    CHECK(fast.steps > slow.steps);
+}
+
+TEST(TweenMidpointsAndRetargets)
+{
+    FakeClock clock;
+    AnimationEngine engine(clock);
+    AnimHandle h = engine.Create(FRAME_CLIENT_REPAINT, 10.0f);
+    engine.AnimateTo(h, 20.0f, Tween(Easing::Linear, 100));
+    CHECK(engine.IsActive(h));
+    CHECK(engine.GetTarget(h) == 20.0f);
+
+    clock.now += 50;
+    engine.Step();
+    CHECK(Near(engine.Get(h), 15.0f));
+
+    // Same target again: no restart
+    engine.AnimateTo(h, 20.0f, Tween(Easing::Linear, 100));
+    clock.now += 25;
+    engine.Step();
+    CHECK(Near(engine.Get(h), 17.5f));
+
+    // New target: starts over from where it is
+    engine.AnimateTo(h, 7.5f, Tween(Easing::Linear, 100));
+    clock.now += 50;
+    engine.Step();
+    CHECK(Near(engine.Get(h), 12.5f));
+    clock.now += 50;
+    engine.Step();
+    CHECK(engine.Get(h) == 7.5f);
+    CHECK(!engine.IsActive(h));
+
+    // Zero duration jumps without ever going active
+    engine.AnimateTo(h, 3.0f, Tween(Easing::EaseOut, 0));
+    CHECK(engine.Get(h) == 3.0f);
+    CHECK(engine.IsIdle());
+}
+
+TEST(SpringsSettleIndependentlyOfFrameRate)
+{
+    FakeClock clock;
+    AnimationEngine a(clock), b(clock);
+    AnimHandle ha = a.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    AnimHandle hb = b.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    a.AnimateTo(ha, 1.0f, Spring());
+    b.AnimateTo(hb, 1.0f, Spring());
+
+    uint64_t start = clock.now;
+    for (uint64_t t = 1; t <= 3000 && !(a.IsIdle() && b.IsIdle()); t++) {
+        clock.now = start + t;
+        a.Step();
+        if (t % 33 == 0) {
+            b.Step();
+            // Fixed integration steps: both have run the same steps at a shared time
+            CHECK(a.Get(ha) == b.Get(hb));
+        }
+    }
+    CHECK(a.IsIdle());
+    CHECK(a.Get(ha) == 1.0f);
+    CHECK(clock.now - start < 2000);
+}
+
+TEST(RetargetedSpringKeepsItsVelocity)
+{
+    FakeClock clock;
+    AnimationEngine engine(clock);
+    AnimHandle h = engine.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    engine.AnimateTo(h, 100.0f, Spring());
+    clock.now += 60;
+    engine.Step();
+    float before = engine.Get(h);
+    CHECK(before > 0.0f);
+
+    // Reversing the target doesn't reverse the motion instantly
+    engine.AnimateTo(h, 0.0f, Spring());
+    clock.now += 8;
+    engine.Step();
+    CHECK(engine.Get(h) > before);
+}
+
+TEST(LongGapsSnapToTheTarget)
+{
+    FakeClock clock;
+    AnimationEngine engine(clock);
+    AnimHandle h = engine.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    engine.AnimateTo(h, 50.0f, Spring());
+    clock.now += AnimationEngine::MAX_CATCH_UP_MS + 500; // Laptop lid closed
+    engine.Step();
+    CHECK(engine.Get(h) == 50.0f);
+    CHECK(engine.IsIdle());
+}
+
+TEST(ClientsAreReportedWhileMoving)
+{
+    FakeClock clock;
+    AnimationEngine engine(clock);
+    AnimHandle dock = engine.Create(FRAME_CLIENT_REPAINT, 0.0f);
+    AnimHandle slide = engine.Create(FRAME_CLIENT_AUTOHIDE, 0.0f);
+    CHECK(engine.ActiveClients() == 0);
+
+    engine.AnimateTo(dock, 1.0f, Tween(Easing::EaseOut, 100));
+    engine.AnimateTo(slide, 1.0f, Tween(Easing::EaseOut, 200));
+    CHECK(engine.ActiveClients() == (FRAME_CLIENT_REPAINT | FRAME_CLIENT_AUTOHIDE));
+
+    clock.now += 150;
+    engine.Step();
+    CHECK(engine.ActiveClients() == FRAME_CLIENT_AUTOHIDE);
+    clock.now += 50;
+    engine.Step();
+    CHECK(engine.ActiveClients() == 0);
+}
+
+TEST(MultiLaneChannelsAndHandleReuse)
+{
+    FakeClock clock;
+    AnimationEngine engine(clock);
+    const float start[4] = { 0, 0, 0, 1 };
+    const float target[4] = { 1, 0.5f, 0, 1 };
+    AnimHandle color = engine.Create(FRAME_CLIENT_REPAINT, start, 4);
+    REQUIRE(color != INVALID_ANIM);
+    CHECK(engine.Create(FRAME_CLIENT_REPAINT, start, 5) == INVALID_ANIM);
+
+    engine.AnimateTo(color, target, Tween(Easing::Linear, 100));
+    CHECK(engine.ActiveLanes() == 2); // Lanes already at their target stay at rest
+    clock.now += 100;
+    engine.Step();
+    for (int i = 0; i < 4; i++) CHECK(engine.Get(color, i) == target[i]);
+
+    // Set stops motion; Release frees the slot for the next channel of that width
+    engine.AnimateTo(color, start, Tween(Easing::Linear, 100));
+    engine.Set(color, target);
+    CHECK(engine.IsIdle());
+    engine.Release(color);
+    AnimHandle other = engine.Create(FRAME_CLIENT_AUTOHIDE, start, 4);
+    CHECK(other == color);
+    CHECK(engine.Get(other, 0) == 0.0f);
+    AnimHandle single = engine.Create(FRAME_CLIENT_REPAINT, 5.0f);
+    CHECK(single != color);
+}
+
+TEST(ManyChannelsStepInOneBatch)
+{
+    FakeClock clock;
+    AnimationEngine engine(clock);
+    std::vector<AnimHandle> handles;
+    for (int i = 0; i < 1000; i++) handles.push_back(engine.Create(FRAME_CLIENT_REPAINT, 0.0f));
+    for (int i = 0; i < 1000; i++) engine.AnimateTo(handles[i], 1.0f, i % 2 ? Spring() : Tween(Easing::EaseOut, 50 + i % 200));
+    CHECK(engine.ActiveLanes() == 1000);
+
+    // Channels finish at different times; the batch shrinks as they do
+    size_t frames = 0;
+    while (!engine.IsIdle() && frames < 1000) {
+        clock.now += 16;
+        engine.Step();
+        frames++;
+    }
+    CHECK(engine.IsIdle());
+    CHECK(engine.steps == frames);
+    CHECK(engine.lanesStepped < 1000 * frames);
+    for (AnimHandle h : handles) CHECK(engine.Get(h) == 1.0f);
+}
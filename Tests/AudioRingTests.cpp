@@ -0,0 +1,167 @@
+#include "Check.h"
+#include "AudioRing.h"
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Sample value for write position `pos`: exact in a float and different for every slot of a small ring
+    float At(uint64_t pos) { return (float)(pos & 0xFFFFFF); }
+
+    void WriteRun(AudioRing &ring, uint64_t from, size_t count)
+    {
+        std::vector<float> samples(count);
+        for (size_t i = 0; i < count; i++) samples[i] = At(from + i);
+        ring.Write(samples.data(), count);
+    }
+
+    bool Matches(const float *samples, size_t count, uint64_t end)
+    {
+        for (size_t i = 0; i < count; i++) {
+            if (samples[i] != At(end - count + i)) return false;
+        }
+        return true;
+    }
+
+    struct StressResult {
+        uint64_t reads = 0;
+        uint64_t torn = 0;  // Intact said no
+        uint64_t wrong = 0; // Intact said yes but the samples were not the window's
+    };
+
+    // One writer in random block sizes, `readers` readers copying windows and validating them
+    StressResult Stress(size_t capacity, size_t window, int readers, uint64_t total)
+    {
+        AudioRing ring(capacity);
+        std::atomic<bool> done{ false };
+        std::vector<StressResult> results(readers);
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; r++) {
+            threads.emplace_back([&, r] {
+                std::vector<float> copy(window);
+                StressResult &out = results[r];
+                while (ring.Written() < ring.Capacity() && !done.load()) std::this_thread::yield();
+                while (!done.load(std::memory_order_relaxed)) {
+                    AudioWindow w = ring.Latest(window);
+                    if (!w) continue;
+                    std::memcpy(copy.data(), w.samples, w.count * sizeof(float));
+                    out.reads++;
+                    if (!ring.Intact(w)) {
+                        out.torn++;
+                        continue;
+                    }
+                    if (!Matches(copy.data(), w.count, w.end)) out.wrong++;
+                }
+            });
+        }
+
+        std::mt19937 rng((uint32_t)capacity);
+        std::vector<float> block(capacity * 2);
+        uint64_t pos = 0;
+        while (pos < total) {
+            size_t n = 1 + rng() % (capacity + capacity / 2); // Sometimes more than fits in one block
+            for (size_t i = 0; i < n; i++) block[i] = At(pos + i);
+            ring.Write(block.data(), n);
+            pos += n;
+        }
+        done = true;
+        for (std::thread &t : threads) t.join();
+
+        StressResult sum;
+        for (const StressResult &r : results) {
+            sum.reads += r.reads;
+            sum.torn += r.torn;
+            sum.wrong += r.wrong;
+        }
+        return sum;
+    }
+}
+
+TEST(CapacityAndEmptyReads)
+{
+    AudioRing ring(100);
+    CHECK(ring.Capacity() == 128);
+    CHECK(ring.MaxWindow() == 64);
+    CHECK(AudioRing(0).Capacity() == 2);
+    CHECK(!ring.Latest(16));
+    CHECK(ring.Written() == 0);
+
+    // Before enough samples exist the window is padded with silence at the front
+    WriteRun(ring, 1, 5);
+    AudioWindow w = ring.Latest(8);
+    REQUIRE(w);
+    CHECK(w.count == 8 && w.end == 5);
+    const float want[8] = { 0, 0, 0, 1, 2, 3, 4, 5 };
+    CHECK(std::memcmp(w.samples, want, sizeof(want)) == 0);
+    CHECK(ring.Intact(w));
+    CHECK(!ring.Latest(0));
+    CHECK(ring.Latest(1000).count == 64); // Clamped to MaxWindow
+}
+
+TEST(WindowsAreContiguousAcrossTheWrap)
+{
+    AudioRing ring(16);
+    uint64_t pos = 0;
+    std::mt19937 rng(25);
+    for (int step = 0; step < 2000; step++) {
+        size_t n = 1 + rng() % 40; // Up to several wraps in one call
+        WriteRun(ring, pos, n);
+        pos += n;
+        for (size_t count = 1; count <= ring.MaxWindow(); count++) {
+            AudioWindow w = ring.Latest(count);
+            REQUIRE(w);
+            CHECK(w.end == pos);
+            if (pos >= count) CHECK(Matches(w.samples, w.count, w.end));
+        }
+    }
+    CHECK(ring.Written() == pos);
+}
+
+TEST(IntactFailsOnceTheWriterReachesTheWindow)
+{
+    // A 64-slot ring and a 16-sample window at positions [84, 100)
+    AudioRing ring(64);
+    WriteRun(ring, 0, 100);
+    AudioWindow w = ring.Latest(16);
+    REQUIRE(w.end == 100);
+
+    // The window's oldest slot is rewritten by position 84 + 64 = 148: writing up to it is safe
+    WriteRun(ring, 100, 48);
+    CHECK(ring.Written() == 148);
+    CHECK(ring.Intact(w));
+    CHECK(Matches(w.samples, w.count, w.end));
+
+    WriteRun(ring, 148, 1);
+    CHECK(!ring.Intact(w));
+    CHECK(!Matches(w.samples, w.count, w.end)); // And it really was overwritten
+
+    // A fresh window is fine again
+    CHECK(ring.Intact(ring.Latest(16)));
+}
+
+TEST(LargeWritesLandInHalfCapacityBlocks)
+{
+    AudioRing ring(32);
+    WriteRun(ring, 0, 1000);
+    AudioWindow w = ring.Latest(16);
+    CHECK(w.end == 1000);
+    CHECK(Matches(w.samples, w.count, w.end));
+    CHECK(ring.Intact(w));
+}
+
+TEST(ConcurrentReadersNeverAcceptTornWindows)
+{
+    // A small ring the writer laps constantly: most reads race it
+    StressResult small = Stress(64, 32, 2, 20000000);
+    std::printf("  64-slot ring: %llu reads, %llu torn\n", (unsigned long long)small.reads, (unsigned long long)small.torn);
+    CHECK(small.wrong == 0);
+    CHECK(small.reads > 0);
+
+    // The visualizer's shape: a large ring, half-capacity windows
+    StressResult large = Stress(4096, 2048, 2, 20000000);
+    std::printf("  4096-slot ring: %llu reads, %llu torn\n", (unsigned long long)large.reads, (unsigned long long)large.torn);
+    CHECK(large.wrong == 0);
+    CHECK(large.reads > 0);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+// Minimal harness for the core tests. TEST registers a case; CHECK records a
+// failure and carries on, REQUIRE records it and leaves the case.
+
+struct TestCase {
+    const char *name;
+    void (*run)();
+};
+
+inline std::vector<TestCase> &TestCases() { static std::vector<TestCase> cases; return cases; }
+inline int &TestFailures() { static int failures = 0; return failures; }
+
+struct TestRegistrar {
+    TestRegistrar(const char *name, void (*run)()) { TestCases().push_back({ name, run }); }
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##_registrar(#name, name); \
+    static void name()
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); TestFailures()++; } \
+} while (0)
+
+#define REQUIRE(cond) do { \
+    if (!(cond)) { std::printf("  %s:%d: REQUIRE(%s) failed\n", __FILE__, __LINE__, #cond); TestFailures()++; return; } \
+} while (0)
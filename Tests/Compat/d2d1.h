@@ -0,0 +1,24 @@
+#pragma once
+
+// Stand-in for the Windows SDK header on other toolchains: Config/ThemeTypes.h
+// only needs the color type and its constructors.
+
+struct D2D1_COLOR_F {
+    float r, g, b, a;
+};
+
+namespace D2D1 {
+    class ColorF : public D2D1_COLOR_F
+    {
+    public:
+        enum Enum : unsigned {
+            Black = 0x000000,
+            White = 0xFFFFFF,
+            Crimson = 0xDC143C,
+        };
+
+        ColorF(float r, float g, float b, float a = 1.0f) : D2D1_COLOR_F{ r, g, b, a } {}
+        ColorF(Enum rgb, float a = 1.0f)
+            : D2D1_COLOR_F{ ((rgb >> 16) & 0xFF) / 255.0f, ((rgb >> 8) & 0xFF) / 255.0f, (rgb & 0xFF) / 255.0f, a } {}
+    };
+}
@@ -0,0 +1,2 @@
+#pragma once
+#include "d2d1.h"
@@ -0,0 +1,219 @@
+#include "Check.h"
+#include "DamageTracker.h"
+#include <deque>
+#include <random>
+
+namespace {
+    bool Covers(const std::vector<LayoutRect> &rects, const LayoutRect &r)
+    {
+        for (const LayoutRect &d : rects) {
+            if (d.left <= r.left && d.top <= r.top && d.right >= r.right && d.bottom >= r.bottom) return true;
+        }
+        return false;
+    }
+
+    // What RailingRenderer::CollectDamage does with one arranged section
+    void Collect(DamageTracker &damage, const std::vector<LayoutNode *> &nodes, bool arranged, const std::vector<LayoutNode *> &repainted)
+    {
+        for (LayoutNode *n : nodes) {
+            bool painted = false;
+            for (LayoutNode *p : repainted) painted |= (p == n);
+            if (arranged && n->previousRect != n->rect) {
+                damage.Add(n->previousRect);
+                damage.Add(n->rect);
+            }
+            else if (painted) damage.Add(n->rect);
+        }
+    }
+}
+
+TEST(StartsAsAFullFrame)
+{
+    DamageTracker damage;
+    CHECK(damage.IsFullFrame());
+    CHECK(!damage.IsEmpty());
+    damage.Add({ 0, 0, 10, 10 });
+    CHECK(damage.GetRects().empty());
+
+    damage.Reset();
+    CHECK(damage.IsEmpty());
+    damage.Add({ 5, 5, 5, 10 }); // Zero width
+    damage.Add({ 5, 5, 10, 4 }); // Inverted
+    CHECK(damage.IsEmpty());
+}
+
+TEST(MergesTouchingRectsOnly)
+{
+    DamageTracker damage;
+    damage.Reset();
+    damage.Add({ 0, 0, 10, 30 });
+    damage.Add({ 10, 0, 20, 30 });  // Shares an edge
+    damage.Add({ 100, 0, 110, 30 }); // Apart
+    REQUIRE(damage.GetRects().size() == 2);
+    CHECK(Covers(damage.GetRects(), { 0, 0, 20, 30 }));
+    CHECK(Covers(damage.GetRects(), { 100, 0, 110, 30 }));
+
+    // A rect bridging both pulls them into one
+    damage.Add({ 15, 0, 105, 30 });
+    REQUIRE(damage.GetRects().size() == 1);
+    CHECK(damage.GetRects()[0] == (LayoutRect{ 0, 0, 110, 30 }));
+}
+
+TEST(CollapsesPastTheRectLimit)
+{
+    DamageTracker damage;
+    damage.Reset();
+    for (size_t i = 0; i < DamageTracker::MAX_RECTS; i++) damage.Add({ i * 20.0f, 0, i * 20.0f + 10, 30 });
+    CHECK(damage.GetRects().size() == DamageTracker::MAX_RECTS);
+
+    damage.Add({ 500, 2, 510, 20 });
+    REQUIRE(damage.GetRects().size() == 1);
+    CHECK(damage.GetRects()[0] == (LayoutRect{ 0, 0, 510, 30 }));
+}
+
+TEST(ResolveClampsAndPromotes)
+{
+    DamageTracker damage;
+    damage.Reset();
+    damage.Add({ -5, -2, 40, 40 });
+    damage.Resolve(1000, 32);
+    REQUIRE(!damage.IsFullFrame());
+    CHECK(damage.GetRects()[0] == (LayoutRect{ 0, 0, 40, 32 }));
+
+    damage.Reset();
+    damage.Add({ 0, 0, 760, 32 });
+    damage.Resolve(1000, 32);
+    CHECK(damage.IsFullFrame());
+}
+
+TEST(PixelRectsRoundOutwardsWithPadding)
+{
+    DamageTracker damage;
+    damage.Reset();
+    damage.Add({ 10.2f, 0, 20.5f, 32 });
+    damage.Add({ 990, 0, 1000, 32 });
+    damage.Resolve(1000, 32);
+
+    auto pixels = damage.ToPixels(1.5f, 1500, 48);
+    REQUIRE(pixels.size() == 2);
+    CHECK(pixels[0].left == 14 && pixels[0].top == 0 && pixels[0].right == 32 && pixels[0].bottom == 48);
+    CHECK(pixels[1].left == 1484 && pixels[1].right == 1500);
+
+    damage.InvalidateAll();
+    pixels = damage.ToPixels(1.5f, 1500, 48);
+    REQUIRE(pixels.size() == 1);
+    CHECK(pixels[0].left == 0 && pixels[0].right == 1500 && pixels[0].bottom == 48);
+}
+
+TEST(RecordedFrameSequence)
+{
+    // Left: workspaces, dock. Right: cpu, ram, clock
+    std::deque<LayoutNode> store(5);
+    LayoutNode *workspaces = &store[0], *dock = &store[1], *cpu = &store[2], *ram = &store[3], *clock = &store[4];
+    float sizes[] = { 120, 300, 60, 60, 80 };
+    for (int i = 0; i < 5; i++) store[i].SetMeasuredSize(sizes[i]);
+    std::vector<LayoutNode *> left = { workspaces, dock }, right = { cpu, ram, clock };
+
+    LayoutEngine layout;
+    layout.SetSection(LayoutSection::Left, left);
+    layout.SetSection(LayoutSection::Right, right);
+    layout.SetBounds(1000, 32, false);
+    DamageTracker damage;
+
+    auto frame = [&](const std::vector<LayoutNode *> &repainted) {
+        unsigned arranged = layout.Arrange();
+        Collect(damage, left, (arranged & 1u) != 0, repainted);
+        Collect(damage, right, (arranged & 4u) != 0, repainted);
+        damage.Resolve(1000, 32);
+    };
+
+    // First frame paints everything
+    frame({});
+    CHECK(damage.IsFullFrame());
+    damage.Reset();
+
+    // Idle frame: nothing
+    frame({});
+    CHECK(damage.IsEmpty());
+
+    // The clock ticks over; same width
+    frame({ clock });
+    REQUIRE(damage.GetRects().size() == 1);
+    CHECK(damage.GetRects()[0] == (LayoutRect{ 920, 0, 1000, 32 }));
+    damage.Reset();
+
+    // Cpu and clock change in one frame, ram between them doesn't
+    frame({ cpu, clock });
+    REQUIRE(damage.GetRects().size() == 2);
+    CHECK(Covers(damage.GetRects(), cpu->rect));
+    CHECK(Covers(damage.GetRects(), clock->rect));
+    CHECK(!Covers(damage.GetRects(), ram->rect));
+    damage.Reset();
+
+    // Cpu grows: everything left of it in the right section shifts
+    cpu->SetMeasuredSize(70);
+    frame({ cpu });
+    REQUIRE(damage.GetRects().size() == 1);
+    CHECK(damage.GetRects()[0] == (LayoutRect{ 790, 0, 860, 32 }));
+    damage.Reset();
+
+    // Ram grows: cpu moves with it, the clock stays put
+    ram->SetMeasuredSize(64);
+    frame({ ram });
+    REQUIRE(damage.GetRects().size() == 1);
+    CHECK(damage.GetRects()[0] == (LayoutRect{ 786, 0, 920, 32 }));
+    damage.Reset();
+
+    // The dock gains an item; the left section and the right section are independent
+    dock->SetMeasuredSize(340);
+    frame({ clock });
+    REQUIRE(damage.GetRects().size() == 2);
+    CHECK(Covers(damage.GetRects(), { 120, 0, 460, 32 }));
+    CHECK(Covers(damage.GetRects(), clock->rect));
+    CHECK(!Covers(damage.GetRects(), workspaces->rect));
+    damage.Reset();
+}
+
+TEST(RandomFramesCoverEveryChange)
+{
+    std::mt19937 rng(7);
+    std::deque<LayoutNode> store(24);
+    std::vector<LayoutNode *> sections[3];
+    for (int i = 0; i < 24; i++) {
+        store[i].SetMeasuredSize(20.0f + (float)(rng() % 40));
+        sections[i % 3].push_back(&store[i]);
+    }
+    LayoutEngine layout;
+    for (int s = 0; s < 3; s++) layout.SetSection((LayoutSection)s, sections[s]);
+    layout.SetBounds(2000, 30, false);
+    DamageTracker damage;
+    layout.Arrange();
+    damage.Reset();
+
+    for (int f = 0; f < 2000; f++) {
+        std::vector<LayoutNode *> repainted, expected;
+        for (int k = (int)(rng() % 4); k > 0; k--) repainted.push_back(&store[rng() % store.size()]);
+        if (rng() % 3 == 0) store[rng() % store.size()].SetMeasuredSize(20.0f + (float)(rng() % 40));
+
+        unsigned arranged = layout.Arrange();
+        for (int s = 0; s < 3; s++) Collect(damage, sections[s], (arranged & (1u << s)) != 0, repainted);
+        damage.Resolve(2000, 30);
+
+        CHECK(damage.GetRects().size() <= DamageTracker::MAX_RECTS);
+        if (!damage.IsFullFrame()) {
+            for (LayoutNode *n : repainted) CHECK(Covers(damage.GetRects(), n->rect));
+            for (auto &n : store) {
+                if (n.previousRect != n.rect && n.previousRect.Width() > 0) {
+                    CHECK(Covers(damage.GetRects(), n.rect));
+                }
+            }
+            // Merged rects never overlap each other
+            const auto &rects = damage.GetRects();
+            for (size_t i = 0; i < rects.size(); i++) {
+                for (size_t j = i + 1; j < rects.size(); j++) CHECK(!DamageTracker::Intersects(rects[i], rects[j]));
+            }
+        }
+        damage.Reset();
+        for (auto &n : store) n.previousRect = n.rect;
+    }
+}
@@ -0,0 +1,193 @@
+#include "Check.h"
+#include "DisplayList.h"
+#include "SoftwareBackend.h"
+#include <functional>
+#include <random>
+
+namespace {
+    const DrawColor RED(1, 0, 0, 1);
+    const DrawColor BLUE(0, 0, 1, 1);
+    const DrawColor GREEN(0, 1, 0, 0.5f);
+
+    size_t CountOps(const DisplayList &list, DrawOp op)
+    {
+        size_t n = 0;
+        for (const DrawCommand &c : list.GetCommands()) n += c.op == op;
+        return n;
+    }
+}
+
+TEST(RecordsEveryCall)
+{
+    uint32_t pixel = 0xFF00FF00;
+    ImageRef image;
+    image.pixels = &pixel;
+    image.width = image.height = image.stride = 1;
+
+    DisplayList list;
+    list.Begin(nullptr);
+    list.Clear(DrawColor(0, 0, 0, 0));
+    list.PushClip(DrawRect(0, 0, 100, 30));
+    list.FillRoundedRect(DrawRect(0, 0, 40, 30), 4, RED);
+    list.StrokeRect(DrawRect(50, 0, 60, 30), BLUE, 2);
+    list.FillEllipse(80, 15, 5, 5, GREEN);
+    list.DrawImage(image, DrawRect(62, 2, 78, 18), 0.5f);
+    list.DrawString(L"12", DrawRect(0, 0, 40, 30), DrawFont::Bold, BLUE, DRAW_TEXT_CLIP);
+    list.PopClip();
+    list.End();
+
+    REQUIRE(list.IsRecorded());
+    REQUIRE(list.Size() == 8);
+    const auto &c = list.GetCommands();
+    CHECK(c[0].op == DrawOp::Clear);
+    CHECK(c[1].op == DrawOp::PushClip);
+    CHECK(c[7].op == DrawOp::PopClip);
+    CHECK(CountOps(list, DrawOp::FillEllipse) == 1);
+    CHECK(CountOps(list, DrawOp::DrawImage) == 1);
+    CHECK(CountOps(list, DrawOp::DrawString) == 1);
+
+    list.Reset();
+    CHECK(!list.IsRecorded());
+    CHECK(list.Size() == 0);
+}
+
+TEST(DropsCommandsThatDrawNothing)
+{
+    DisplayList list;
+    list.Begin(nullptr);
+    list.FillRect(DrawRect(0, 0, 10, 10), DrawColor(1, 0, 0, 0)); // Transparent
+    list.FillRect(DrawRect(10, 0, 5, 10), RED);                   // Inverted
+    list.DrawImage(ImageRef(), DrawRect(0, 0, 10, 10));             // No image
+    list.PushClip(DrawRect(5, 5, 5, 0));                          // Empty clip...
+    list.FillRect(DrawRect(0, 0, 10, 10), RED);
+    list.PushClip(DrawRect(0, 0, 4, 4));
+    list.PopClip();
+    list.PopClip();                                               // ...and everything inside it
+    list.FillRect(DrawRect(20, 0, 30, 10), BLUE);
+    list.End();
+
+    REQUIRE(list.Size() == 1);
+    CHECK(list.GetCommands()[0].color == BLUE);
+    CHECK(list.droppedCount == 8);
+}
+
+TEST(MergesEdgeSharingFills)
+{
+    DisplayList list;
+    list.Begin(nullptr);
+    for (int i = 0; i < 5; i++) list.FillRect(DrawRect(i * 4.0f, 0, i * 4.0f + 4, 20), RED); // A bar of segments
+    list.FillRect(DrawRect(0, 20, 20, 30), RED); // Same columns, below
+    list.FillRect(DrawRect(30, 0, 40, 20), RED); // Gap: stays separate
+    list.End();
+
+    REQUIRE(list.Size() == 2);
+    CHECK(list.mergedCount == 5);
+    CHECK(list.GetCommands()[0].rect.left == 0 && list.GetCommands()[0].rect.right == 20);
+    CHECK(list.GetCommands()[0].rect.bottom == 30);
+}
+
+TEST(ReordersOnlyAroundNonOverlappingCommands)
+{
+    // Red, blue, red with nothing overlapping: the second red joins the first
+    DisplayList list;
+    list.Begin(nullptr);
+    list.FillRect(DrawRect(0, 0, 10, 10), RED);
+    list.FillRect(DrawRect(40, 0, 50, 10), BLUE);
+    list.FillRect(DrawRect(10, 0, 20, 10), RED);
+    list.End();
+    REQUIRE(list.Size() == 2);
+    CHECK(list.reorderedCount == 1);
+    CHECK(list.mergedCount == 1);
+    CHECK(list.GetCommands()[1].color == BLUE);
+
+    // Blue covers the second red's spot: painter's order must hold
+    list.Begin(nullptr);
+    list.FillRect(DrawRect(0, 0, 10, 10), RED);
+    list.FillRect(DrawRect(10, 0, 20, 10), BLUE);
+    list.FillRect(DrawRect(12, 0, 18, 10), RED);
+    list.End();
+    REQUIRE(list.Size() == 3);
+    CHECK(list.reorderedCount == 0);
+    CHECK(list.GetCommands()[2].color == RED);
+
+    // Unclipped text is a barrier
+    list.Begin(nullptr);
+    list.FillRect(DrawRect(0, 0, 10, 10), RED);
+    list.DrawString(L"x", DrawRect(40, 0, 50, 10), DrawFont::Text, BLUE);
+    list.FillRect(DrawRect(10, 0, 20, 10), RED);
+    list.End();
+    CHECK(list.reorderedCount == 0);
+    CHECK(list.Size() == 3);
+}
+
+TEST(ForwardsMeasurementWhileRecording)
+{
+    SoftwareBackend live(100, 30);
+    DisplayList list;
+    list.Begin(&live);
+    TextMetrics m = list.MeasureString(L"123", DrawFont::Text);
+    CHECK(m.width > 0);
+    CHECK(m.width == live.MeasureString(L"123", DrawFont::Text).width);
+    CHECK(list.GetFontSize(DrawFont::Icon) == live.GetFontSize(DrawFont::Icon));
+    list.End();
+    CHECK(list.MeasureString(L"123", DrawFont::Text).width == 0);
+}
+
+TEST(OptimizedReplayMatchesDirectRendering)
+{
+    std::mt19937 rng(11);
+    const DrawColor palette[] = { RED, BLUE, GREEN, DrawColor(1, 1, 1, 0.25f), DrawColor(0, 0, 0, 0) };
+    uint32_t texels[4] = { 0xFFFF0000, 0x80008000, 0x00000000, 0xFF0000FF };
+    ImageRef image;
+    image.pixels = texels;
+    image.width = image.height = image.stride = 2;
+
+    size_t optimized = 0;
+    for (int scene = 0; scene < 300; scene++) {
+        // Whole-pixel geometry, so a merged fill covers exactly what its parts did
+        std::vector<std::function<void(DrawingBackend &)>> calls;
+        int count = 10 + (int)(rng() % 40);
+        for (int i = 0; i < count; i++) {
+            float x = (float)(rng() % 120), y = (float)(rng() % 24);
+            float w = (float)(rng() % 24), h = (float)(1 + rng() % 12);
+            DrawRect r(x, y, x + w, y + h);
+            DrawColor color = palette[rng() % 5];
+            switch (rng() % 10) {
+            case 0: calls.push_back([=](DrawingBackend &b) { b.StrokeRect(r, color, 1); }); break;
+            case 1: calls.push_back([=](DrawingBackend &b) { b.FillRoundedRect(r, 3, color); }); break;
+            case 2: calls.push_back([=](DrawingBackend &b) { b.FillEllipse(x, y, w / 2, h / 2, color); }); break;
+            case 3: calls.push_back([=](DrawingBackend &b) { b.DrawImage(image, r, 0.75f); }); break;
+            case 4: calls.push_back([=](DrawingBackend &b) { b.DrawString(L"42", r, DrawFont::Text, color, DRAW_TEXT_CLIP); }); break;
+            case 5:
+                calls.push_back([=](DrawingBackend &b) { b.PushClip(r); });
+                calls.push_back([=](DrawingBackend &b) { b.FillRect(DrawRect(0, 0, 150, 32), color); });
+                calls.push_back([=](DrawingBackend &b) { b.PopClip(); });
+                break;
+            default:
+                // Runs of abutting segments, like a visualizer's bars
+                for (int k = 0; k < 3; k++) {
+                    DrawRect seg(x + k * w, y, x + (k + 1) * w, y + h);
+                    calls.push_back([=](DrawingBackend &b) { b.FillRect(seg, color); });
+                }
+                break;
+            }
+        }
+
+        SoftwareBackend direct(150, 32), replayed(150, 32);
+        direct.Clear(DrawColor(0.1f, 0.1f, 0.1f, 1));
+        replayed.Clear(DrawColor(0.1f, 0.1f, 0.1f, 1));
+        DisplayList list;
+        list.Begin(&direct);
+        for (auto &call : calls) {
+            call(direct);
+            call(list);
+        }
+        list.End();
+        list.Replay(replayed);
+
+        CHECK(SoftwareBackend::CountDifferences(direct, replayed) == 0);
+        if (list.Size() < calls.size()) optimized++;
+    }
+    // The scenes exercise the optimizer, not just plain replay
+    CHECK(optimized > 200);
+}
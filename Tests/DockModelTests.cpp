@@ -0,0 +1,189 @@
+#include "Check.h"
+#include "DockModel.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace {
+    using Model = DockModel<uintptr_t>;
+
+    // Per app: pinned flag, title and windows; item order is compared separately
+    struct ItemView {
+        bool pinned = false;
+        std::wstring title;
+        std::vector<uintptr_t> windows;
+        bool operator==(const ItemView &) const = default;
+    };
+
+    std::map<size_t, ItemView> View(const Model &model)
+    {
+        std::map<size_t, ItemView> out;
+        for (const Model::Item &item : model.Items()) out[item.pathHash] = { item.isPinned, item.title, item.windows };
+        return out;
+    }
+
+    std::vector<size_t> ItemOrder(const Model &model)
+    {
+        std::vector<size_t> out;
+        for (const Model::Item &item : model.Items()) out.push_back(item.pathHash);
+        return out;
+    }
+
+    // `after` keeps the relative order of everything it shares with `before`
+    bool OrderKept(const std::vector<size_t> &before, const std::vector<size_t> &after)
+    {
+        std::vector<size_t> common;
+        for (size_t h : before) {
+            if (std::find(after.begin(), after.end(), h) != after.end()) common.push_back(h);
+        }
+        size_t at = 0;
+        for (size_t h : after) {
+            if (at < common.size() && common[at] == h) at++;
+        }
+        return at == common.size();
+    }
+
+    struct FakeWindow {
+        uintptr_t hwnd;
+        size_t app;
+        std::wstring exe;
+        std::wstring title;
+    };
+
+    std::wstring Exe(size_t app) { return L"C:\\app" + std::to_wstring(app) + L".exe"; }
+}
+
+TEST(WindowsGroupByApp)
+{
+    Model model;
+    CHECK(model.AddWindow(1, 100, L"a.exe", L"a one"));
+    CHECK(model.AddWindow(2, 200, L"b.exe", L"b one"));
+    CHECK(model.AddWindow(3, 100, L"a.exe", L"a two"));
+    CHECK(!model.AddWindow(3, 100, L"a.exe", L"a two")); // Already there
+
+    REQUIRE(model.Items().size() == 2);
+    CHECK(model.Items()[0].windows == (std::vector<uintptr_t>{ 1, 3 }));
+    CHECK(model.Items()[0].title == L"a one");
+    CHECK(model.WindowCount() == 3);
+
+    // The first window's title leads; renaming another doesn't change it
+    CHECK(model.RenameWindow(3, L"a three"));
+    CHECK(model.Items()[0].title == L"a one");
+    CHECK(model.RenameWindow(1, L"a first"));
+    CHECK(model.Items()[0].title == L"a first");
+    CHECK(!model.RenameWindow(1, L"a first"));
+    CHECK(!model.RenameWindow(9, L"nobody"));
+
+    // Closing the first hands the title to the next
+    CHECK(model.RemoveWindow(1));
+    CHECK(model.Items()[0].title == L"a three");
+    CHECK(model.RemoveWindow(3));
+    CHECK(!model.RemoveWindow(3));
+    REQUIRE(model.Items().size() == 1);
+    CHECK(model.Items()[0].pathHash == 200);
+}
+
+TEST(PinnedAppsStayWithoutWindows)
+{
+    Model model;
+    model.AddWindow(1, 100, L"a.exe", L"a");
+    CHECK(model.SetPinned({ { L"c.exe", L"C app", 300 }, { L"a.exe", L"A app", 100 } }));
+    REQUIRE(model.Items().size() == 2);
+    CHECK(model.Items()[0].isPinned && model.Items()[0].pathHash == 100);
+    CHECK(model.Items()[1].title == L"C app" && model.Items()[1].windows.empty());
+    CHECK(model.IsPinned(300) && !model.IsPinned(200));
+
+    // A pinned app's last window closing leaves the item with its last title
+    model.RemoveWindow(1);
+    REQUIRE(model.Items().size() == 2);
+    CHECK(model.Items()[0].title == L"a");
+
+    // Unpinning an empty app removes it; a window of an unpinned app keeps its item
+    model.AddWindow(5, 300, L"c.exe", L"c");
+    CHECK(model.SetPinned({}));
+    REQUIRE(model.Items().size() == 1);
+    CHECK(model.Items()[0].pathHash == 300 && !model.Items()[0].isPinned);
+    CHECK(!model.SetPinned({}));
+}
+
+TEST(ReusedHandlesMoveApps)
+{
+    Model model;
+    model.AddWindow(1, 100, L"a.exe", L"a");
+    model.AddWindow(1, 200, L"b.exe", L"b"); // The handle now belongs to another app
+    REQUIRE(model.Items().size() == 1);
+    CHECK(model.Items()[0].pathHash == 200);
+    CHECK(model.WindowCount() == 1);
+}
+
+TEST(ReconcileMatchesFullList)
+{
+    std::wstring a = L"a.exe", b = L"b.exe", ta = L"ta", tb = L"tb";
+    Model model;
+    model.AddWindow(1, 100, a, ta);
+    model.AddWindow(2, 200, b, tb);
+    std::vector<Model::Window> live = { { 2, 200, &b, &tb }, { 4, 100, &a, &ta } };
+    CHECK(model.Reconcile(live));
+    CHECK(!model.HasWindow(1) && model.HasWindow(4));
+    CHECK(ItemOrder(model) == (std::vector<size_t>{ 200, 100 })); // a emptied and came back at the end
+    CHECK(!model.Reconcile(live));
+}
+
+TEST(IncrementalMatchesRebuildUnderChurn)
+{
+    // 500 windows across 80 apps, then add/remove/rename/pin churn
+    std::mt19937 rng(170);
+    Model model;
+    std::vector<FakeWindow> live; // Arrival order
+    std::vector<Model::Pin> pins;
+    uintptr_t next = 0x1000;
+    auto open = [&](size_t app) {
+        live.push_back({ next, app, Exe(app), L"w" + std::to_wstring(next) });
+        model.AddWindow(next, app, live.back().exe, live.back().title);
+        next += 4;
+    };
+    for (int i = 0; i < 500; i++) open(rng() % 80);
+    CHECK(model.WindowCount() == 500);
+
+    for (int step = 0; step < 3000; step++) {
+        std::vector<size_t> before = ItemOrder(model);
+        int what = (int)(rng() % 10);
+        if (what < 3) open(rng() % 80);
+        else if (what < 6 && !live.empty()) {
+            size_t i = rng() % live.size();
+            CHECK(model.RemoveWindow(live[i].hwnd));
+            live.erase(live.begin() + i);
+        }
+        else if (what < 9 && !live.empty()) {
+            FakeWindow &w = live[rng() % live.size()];
+            w.title += L"*";
+            CHECK(model.RenameWindow(w.hwnd, w.title));
+        }
+        else {
+            pins.clear();
+            for (int p = 0, n = (int)(rng() % 6); p < n; p++) {
+                size_t app = rng() % 90; // Some pinned apps never run
+                if (std::none_of(pins.begin(), pins.end(), [&](const Model::Pin &q) { return q.pathHash == app; }))
+                    pins.push_back({ Exe(app), L"pin" + std::to_wstring(app), app });
+            }
+            model.SetPinned(pins);
+        }
+        CHECK(OrderKept(before, ItemOrder(model)));
+
+        if (step % 100 == 0) {
+            // Rebuilding from scratch gives the same apps, windows and titles
+            Model fresh;
+            fresh.SetPinned(pins);
+            std::vector<Model::Window> list;
+            for (const FakeWindow &w : live) list.push_back({ w.hwnd, w.app, &w.exe, &w.title });
+            fresh.Reconcile(list);
+            std::map<size_t, ItemView> got = View(model), want = View(fresh);
+            // A pinned app's title after its windows close is history the rebuild can't know
+            for (auto &[hash, item] : got) {
+                if (item.windows.empty() && want.count(hash)) item.title = want[hash].title;
+            }
+            CHECK(got == want);
+            CHECK(model.WindowCount() == live.size());
+        }
+    }
+}
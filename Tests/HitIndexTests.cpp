@@ -0,0 +1,175 @@
+#include "Check.h"
+#include "HitIndex.h"
+#include <random>
+
+namespace {
+    // Stand-ins for modules; the index only compares owner pointers
+    int modules[256];
+
+    bool Inside(const HitEntry &e, int x, int y, int slack, bool vertical)
+    {
+        if (vertical) return y >= e.top && y < e.bottom && x >= e.left - slack && x < e.right + slack;
+        return x >= e.left && x < e.right && y >= e.top - slack && y < e.bottom + slack;
+    }
+
+    // The linear walk the window procedures used to do
+    HitResult BruteForce(const HitIndex &index, int x, int y, int slack)
+    {
+        HitResult result;
+        const auto &entries = index.GetEntries();
+        int parent = -1;
+        while (true) {
+            int hit = -1;
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (entries[i].parent == parent && Inside(entries[i], x, y, slack, index.IsVertical())) hit = (int)i;
+            }
+            if (hit < 0) break;
+            if (entries[hit].part >= 0) {
+                if (result.module && entries[hit].owner == result.module->owner) result.part = entries[hit].part;
+                break;
+            }
+            result.module = &entries[hit];
+            parent = hit;
+        }
+        return result;
+    }
+}
+
+TEST(FindsModulesAndGaps)
+{
+    HitIndex index;
+    index.Begin(false, 1.0f);
+    index.Add({ 0, 0, 40, 30 }, &modules[0], -1, -1);
+    index.Add({ 40, 0, 100, 30 }, &modules[1], -1, -1);
+    index.Add({ 900, 0, 1000, 30 }, &modules[2], -1, -1);
+    index.Finish();
+
+    CHECK(index.Find(0, 0).module->owner == &modules[0]);
+    CHECK(index.Find(39, 29).module->owner == &modules[0]);
+    CHECK(index.Find(40, 10).module->owner == &modules[1]);
+    CHECK(index.Find(999, 10).module->owner == &modules[2]);
+    CHECK(index.Find(500, 10).module == nullptr);   // Between sections
+    CHECK(index.Find(1000, 10).module == nullptr);  // Right edge is exclusive
+    CHECK(index.Find(20, 30).module == nullptr);    // Below the bar
+    CHECK(index.Find(20, 30, 5).module->owner == &modules[0]); // Forgiving edge
+    CHECK(index.Find(20, -3, 5).module->owner == &modules[0]);
+}
+
+TEST(GroupsAndSubItemsNest)
+{
+    HitIndex index;
+    index.Begin(false, 1.0f);
+    int group = index.Add({ 100, 0, 300, 30 }, &modules[0], -1, -1);
+    index.Add({ 105, 2, 150, 28 }, &modules[1], -1, group);
+    int dock = index.Add({ 150, 2, 295, 28 }, &modules[2], -1, group);
+    for (int i = 0; i < 4; i++) index.Add({ 150.0f + i * 32, 2, 182.0f + i * 32, 28 }, &modules[2], i, dock);
+    index.Finish();
+
+    HitResult r = index.Find(120, 10);
+    CHECK(r.module && r.module->owner == &modules[1] && r.part == -1);
+    CHECK(r.module->depth == 1);
+
+    r = index.Find(220, 10);
+    CHECK(r.module && r.module->owner == &modules[2] && r.part == 2);
+
+    // In the dock but past its last icon
+    r = index.Find(290, 10);
+    CHECK(r.module && r.module->owner == &modules[2] && r.part == -1);
+
+    // Group padding: the group itself
+    r = index.Find(102, 10);
+    CHECK(r.module && r.module->owner == &modules[0]);
+    r = index.Find(298, 1);
+    CHECK(r.module && r.module->owner == &modules[0]);
+}
+
+TEST(VerticalBarsAndScaling)
+{
+    HitIndex index;
+    index.Begin(true, 1.5f);
+    index.Add({ 0, 0, 40, 30 }, &modules[0], -1, -1);
+    index.Add({ 0, 30, 40, 90.5f }, &modules[1], -1, -1);
+    CHECK(index.Add({ 0, 100, 40, 100 }, &modules[2], -1, -1) == -1); // Collapsed
+    index.Finish();
+
+    REQUIRE(index.Count() == 2);
+    CHECK(index.GetEntries()[1].top == 45 && index.GetEntries()[1].bottom == 135);
+    CHECK(index.Find(10, 44).module->owner == &modules[0]);
+    CHECK(index.Find(10, 45).module->owner == &modules[1]);
+    CHECK(index.Find(59, 100).module->owner == &modules[1]);
+    CHECK(index.Find(60, 100).module == nullptr);
+    CHECK(index.Find(10, 200).module == nullptr);
+}
+
+TEST(MatchesLinearWalkOnLargeBars)
+{
+    std::mt19937 rng(3);
+    for (int round = 0; round < 20; round++) {
+        bool vertical = round % 4 == 3;
+        float scale = round % 2 ? 1.25f : 1.0f;
+        HitIndex index;
+        index.Begin(vertical, scale);
+
+        // 200 modules packed along the bar, some groups, some docks with icons
+        float cursor = 0.0f;
+        int owner = 0;
+        while (owner < 200) {
+            float size = 10.0f + (float)(rng() % 30);
+            LayoutRect r = vertical ? LayoutRect{ 0, cursor, 40, cursor + size } : LayoutRect{ cursor, 0, cursor + size, 40 };
+            int self = index.Add(r, &modules[owner % 256], -1, -1);
+            int kind = (int)(rng() % 6);
+            if (kind == 0) {
+                // Group with two children inside a 2px inset
+                float half = size / 2.0f;
+                for (int c = 0; c < 2; c++) {
+                    float s = cursor + c * half + (c == 0 ? 2.0f : 0.0f), e = cursor + (c + 1) * half - (c == 1 ? 2.0f : 0.0f);
+                    LayoutRect cr = vertical ? LayoutRect{ 2, s, 38, e } : LayoutRect{ s, 2, e, 38 };
+                    index.Add(cr, &modules[(owner + 100 + c) % 256], -1, self);
+                }
+            }
+            else if (kind == 1) {
+                // Dock icons
+                int icons = 1 + (int)(rng() % 4);
+                float step = size / icons;
+                for (int i = 0; i < icons; i++) {
+                    float s = cursor + i * step, e = s + step - 1.0f;
+                    LayoutRect ir = vertical ? LayoutRect{ 4, s, 36, e } : LayoutRect{ s, 4, e, 36 };
+                    index.Add(ir, &modules[owner % 256], i, self);
+                }
+            }
+            cursor += size + (float)(rng() % 3); // Occasional gaps
+            owner++;
+        }
+        index.Finish();
+
+        // A mouse trace sweeping the bar with jitter across it
+        int extent = (int)(cursor * scale) + 10;
+        int slack = round % 3 == 0 ? 4 : 0;
+        index.probes = 0;
+        int finds = 0;
+        for (int main = -5; main < extent; main += 1 + (int)(rng() % 3)) {
+            int cross = (int)(rng() % 60) - 10;
+            int x = vertical ? cross : main, y = vertical ? main : cross;
+            HitResult fast = index.Find(x, y, slack);
+            HitResult slow = BruteForce(index, x, y, slack);
+            CHECK(fast.module == slow.module);
+            CHECK(fast.part == slow.part);
+            finds++;
+        }
+        // Side-by-side siblings: about one probe per level
+        CHECK(index.probes <= (size_t)finds * 3);
+    }
+}
+
+TEST(BeginStartsOver)
+{
+    HitIndex index;
+    index.Begin(false, 1.0f);
+    index.Add({ 0, 0, 40, 30 }, &modules[0], -1, -1);
+    index.Finish();
+    index.Begin(false, 2.0f);
+    index.Finish();
+    CHECK(index.Count() == 0);
+    CHECK(index.Find(10, 10).module == nullptr);
+    CHECK(index.GetScale() == 2.0f);
+}
@@ -0,0 +1,293 @@
+#include "Check.h"
+#include "IconAtlas.h"
+#include <cstring>
+#include <random>
+
+namespace {
+    // The atlas file held in memory; Map hands out a copy so a stale mapping can't see a rewrite
+    class MemoryStorage : public IconAtlasStorage
+    {
+    public:
+        std::vector<uint8_t> file;
+        bool exists = false;
+        bool failWrites = false;
+        int writes = 0;
+
+        bool Map(const uint8_t *&data, size_t &size) override
+        {
+            if (!exists) return false;
+            view = file;
+            data = view.data();
+            size = view.size();
+            return true;
+        }
+        void Unmap() override
+        {
+            view.assign(view.size(), 0xCD); // Poison what a dangling pointer would read
+        }
+        bool Write(const std::vector<uint8_t> &bytes) override
+        {
+            if (failWrites) return false;
+            file = bytes;
+            exists = true;
+            writes++;
+            return true;
+        }
+
+    private:
+        std::vector<uint8_t> view;
+    };
+
+    std::vector<uint32_t> Pixels(uint32_t seed, int w, int h)
+    {
+        std::vector<uint32_t> p((size_t)w * h);
+        for (size_t i = 0; i < p.size(); i++) p[i] = seed * 0x9E3779B1u + (uint32_t)i;
+        return p;
+    }
+
+    bool Same(IconAtlasImage image, const std::vector<uint32_t> &pixels, int w, int h)
+    {
+        return image && image.width == w && image.height == h && std::memcmp(image.pixels, pixels.data(), pixels.size() * 4) == 0;
+    }
+
+    IconAtlasKey Key(uint64_t path, int32_t index, int32_t size, uint64_t stamp)
+    {
+        return { path, index, size, stamp };
+    }
+
+    std::vector<uint8_t> SampleFile()
+    {
+        IconAtlasWriter writer;
+        for (uint32_t i = 0; i < 6; i++) {
+            std::vector<uint32_t> p = Pixels(i, 16 + (int)i, 16);
+            writer.Add(Key(100 + i % 3, (int32_t)i, 32, 7), p.data(), 16 + (int)i, 16);
+        }
+        std::vector<uint8_t> bytes;
+        writer.Serialize(bytes);
+        return bytes;
+    }
+}
+
+TEST(WriterAndReaderRoundTrip)
+{
+    IconAtlasWriter writer;
+    std::vector<std::vector<uint32_t>> images;
+    std::vector<IconAtlasKey> keys;
+    std::mt19937 rng(20);
+    for (int i = 0; i < 40; i++) {
+        int w = 1 + (int)(rng() % 64), h = 1 + (int)(rng() % 64);
+        keys.push_back(Key(rng() % 8, (int32_t)(rng() % 5) - 2, 16 << (rng() % 3), 1 + rng()));
+        images.push_back(Pixels((uint32_t)i, w, h));
+        writer.Add(keys.back(), images.back().data(), w, h);
+    }
+    std::vector<uint8_t> bytes;
+    writer.Serialize(bytes);
+
+    IconAtlasReader reader;
+    REQUIRE(reader.Open(bytes.data(), bytes.size()));
+    CHECK(reader.Count() == writer.Count());
+    for (size_t i = 0; i < writer.Count(); i++) {
+        // The last Add for a slot wins in both
+        int at = reader.Find(writer.KeyAt(i));
+        REQUIRE(at >= 0);
+        IconAtlasImage want = writer.ImageAt(i);
+        CHECK(reader.KeyAt(at).stamp == writer.KeyAt(i).stamp);
+        CHECK(reader.ImageAt(at).width == want.width && reader.ImageAt(at).height == want.height);
+        CHECK(std::memcmp(reader.ImageAt(at).pixels, want.pixels, (size_t)want.width * want.height * 4) == 0);
+        CHECK((reinterpret_cast<const uint8_t *>(reader.ImageAt(at).pixels) - bytes.data()) % 16 == 0);
+    }
+    for (size_t i = 1; i < reader.Count(); i++) {
+        IconAtlasKey a = reader.KeyAt(i - 1), b = reader.KeyAt(i);
+        CHECK(a.pathHash < b.pathHash || (a.pathHash == b.pathHash && (a.index < b.index || (a.index == b.index && a.size < b.size))));
+    }
+    CHECK(reader.Find(Key(99, 0, 32, 0)) == -1);
+
+    // An empty atlas is a valid file
+    IconAtlasWriter none;
+    none.Serialize(bytes);
+    CHECK(reader.Open(bytes.data(), bytes.size()));
+    CHECK(reader.Count() == 0);
+    CHECK(reader.Find(Key(1, 0, 32, 1)) == -1);
+}
+
+TEST(WriterRejectsBadImages)
+{
+    IconAtlasWriter writer;
+    std::vector<uint32_t> p = Pixels(1, 4, 4);
+    writer.Add(Key(1, 0, 32, 1), nullptr, 4, 4);
+    writer.Add(Key(1, 0, 32, 1), p.data(), 0, 4);
+    writer.Add(Key(1, 0, 32, 1), p.data(), IconAtlasReader::MAX_EDGE + 1, 1);
+    CHECK(writer.Count() == 0);
+}
+
+TEST(ReaderRejectsDamage)
+{
+    IconAtlasReader reader;
+    std::vector<uint8_t> good = SampleFile();
+    REQUIRE(reader.Open(good.data(), good.size()));
+
+    auto rejects = [&reader](std::vector<uint8_t> bytes) { return !reader.Open(bytes.data(), bytes.size()) && reader.Count() == 0; };
+    std::vector<uint8_t> bad = good;
+    bad[0] = 'X';
+    CHECK(rejects(bad));                                  // Magic
+    bad = good;
+    bad[4] = 2;
+    CHECK(rejects(bad));                                  // Version
+    bad = good;
+    bad.pop_back();
+    CHECK(rejects(bad));                                  // Truncated
+    bad = good;
+    bad.push_back(0);
+    CHECK(rejects(bad));                                  // Appended to
+    bad = good;
+    bad[8] = 0xFF;
+    CHECK(rejects(bad));                                  // Count past the end
+    bad = good;
+    bad[24 + 40 + 24] = 0;                                // Second entry's width
+    CHECK(rejects(bad));
+    bad = good;
+    bad[24 + 32] += 4;                                    // First entry's offset off alignment
+    CHECK(rejects(bad));
+    bad = good;
+    std::swap_ranges(bad.begin() + 24, bad.begin() + 64, bad.begin() + 64); // Out of order
+    CHECK(rejects(bad));
+    CHECK(!reader.Open(nullptr, 0));
+    CHECK(!reader.Open(good.data(), 10));
+}
+
+TEST(RandomCorruptionNeverReadsOutOfBounds)
+{
+    std::vector<uint8_t> good = SampleFile();
+    std::mt19937 rng(200);
+    IconAtlasReader reader;
+    for (int round = 0; round < 3000; round++) {
+        std::vector<uint8_t> bytes = good;
+        for (int flips = 1 + (int)(rng() % 4); flips > 0; flips--) bytes[rng() % bytes.size()] ^= (uint8_t)(1 + rng() % 255);
+        if (rng() % 4 == 0) bytes.resize(rng() % bytes.size());
+        if (!reader.Open(bytes.data(), bytes.size())) continue;
+        // Whatever survives validation must stay inside the buffer
+        for (size_t i = 0; i < reader.Count(); i++) {
+            IconAtlasImage image = reader.ImageAt(i);
+            const uint8_t *start = reinterpret_cast<const uint8_t *>(image.pixels);
+            CHECK(start >= bytes.data());
+            CHECK(start + (size_t)image.width * image.height * 4 <= bytes.data() + bytes.size());
+            CHECK(reader.Find(reader.KeyAt(i)) == (int)i);
+        }
+    }
+}
+
+TEST(AtlasSurvivesARestart)
+{
+    MemoryStorage storage;
+    std::vector<uint32_t> a = Pixels(1, 32, 32), b = Pixels(2, 24, 24);
+    {
+        IconAtlas atlas(storage);
+        atlas.Load();
+        CHECK(!atlas.IsDirty());
+        CHECK(!atlas.Find(Key(1, 0, 32, 10)));
+        atlas.Add(Key(1, 0, 32, 10), a.data(), 32, 32);
+        atlas.Add(Key(2, 0, 24, 11), b.data(), 24, 24);
+        atlas.Add(Key(3, 0, 24, 0), b.data(), 24, 24); // No stamp: never stored
+        CHECK(Same(atlas.Find(Key(1, 0, 32, 10)), a, 32, 32)); // Pending adds are found too
+        CHECK(atlas.Save());
+        CHECK(storage.writes == 1);
+        CHECK(atlas.Save());
+        CHECK(storage.writes == 1); // Nothing new
+    }
+
+    IconAtlas atlas(storage);
+    atlas.Load();
+    CHECK(Same(atlas.Find(Key(1, 0, 32, 10)), a, 32, 32));
+    CHECK(Same(atlas.Find(Key(2, 0, 24, 11)), b, 24, 24));
+    CHECK(!atlas.Find(Key(3, 0, 24, 0)));
+    CHECK(!atlas.Find(Key(2, 1, 24, 11)));
+    CHECK(atlas.hits == 2 && atlas.misses == 2);
+    CHECK(!atlas.IsDirty());
+}
+
+TEST(ChangedFilesAreDroppedOnSave)
+{
+    MemoryStorage storage;
+    std::vector<uint32_t> old = Pixels(1, 16, 16), fresh = Pixels(9, 16, 16);
+    {
+        IconAtlas atlas(storage);
+        atlas.Load();
+        atlas.Add(Key(1, 0, 16, 10), old.data(), 16, 16);
+        atlas.Add(Key(2, 0, 16, 10), old.data(), 16, 16);
+        atlas.Save();
+    }
+
+    IconAtlas atlas(storage);
+    atlas.Load();
+    CHECK(!atlas.Find(Key(1, 0, 16, 20))); // The exe was updated
+    CHECK(atlas.stale == 1);
+    CHECK(atlas.IsDirty());
+    CHECK(!atlas.Find(Key(1, 0, 16, 0)));  // Unknown stamp never matches
+    CHECK(atlas.stale == 1);
+    REQUIRE(atlas.Save());
+
+    // The stale entry is gone; the untouched one is kept
+    IconAtlasReader reader;
+    REQUIRE(reader.Open(storage.file.data(), storage.file.size()));
+    CHECK(reader.Count() == 1);
+    CHECK(reader.Find(Key(2, 0, 16, 0)) == 0);
+
+    // Re-decoded and added with the new stamp
+    atlas.Add(Key(1, 0, 16, 20), fresh.data(), 16, 16);
+    REQUIRE(atlas.Save());
+    CHECK(Same(atlas.Find(Key(1, 0, 16, 20)), fresh, 16, 16));
+}
+
+TEST(SaveKeepsTheMostUsefulEntries)
+{
+    MemoryStorage storage;
+    std::vector<uint32_t> p = Pixels(5, 16, 16);
+    {
+        IconAtlas atlas(storage);
+        atlas.Load();
+        for (uint64_t i = 0; i < IconAtlas::MAX_ENTRIES; i++) atlas.Add(Key(1000 + i, 0, 16, 1), p.data(), 16, 16);
+        atlas.Save();
+    }
+
+    IconAtlas atlas(storage);
+    atlas.Load();
+    // This session used ten stored icons and added five new ones
+    for (uint64_t i = 200; i < 210; i++) CHECK(atlas.Find(Key(1000 + i, 0, 16, 1)));
+    for (uint64_t i = 0; i < 5; i++) atlas.Add(Key(5000 + i, 0, 16, 1), p.data(), 16, 16);
+    REQUIRE(atlas.Save());
+
+    IconAtlasReader reader;
+    REQUIRE(reader.Open(storage.file.data(), storage.file.size()));
+    CHECK(reader.Count() == IconAtlas::MAX_ENTRIES);
+    for (uint64_t i = 0; i < 5; i++) CHECK(reader.Find(Key(5000 + i, 0, 16, 0)) >= 0);
+    for (uint64_t i = 200; i < 210; i++) CHECK(reader.Find(Key(1000 + i, 0, 16, 0)) >= 0);
+    // Untouched ones fill the rest in file order, so the last few fall off
+    CHECK(reader.Find(Key(1000, 0, 16, 0)) >= 0);
+    CHECK(reader.Find(Key(1000 + IconAtlas::MAX_ENTRIES - 1, 0, 16, 0)) == -1);
+}
+
+TEST(DamagedOrUnwritableFiles)
+{
+    MemoryStorage storage;
+    storage.exists = true;
+    storage.file = SampleFile();
+    storage.file[2] = '?';
+
+    IconAtlas atlas(storage);
+    atlas.Load();
+    CHECK(atlas.IsDirty()); // Replaced on the next save even with nothing added
+    CHECK(!atlas.Find(Key(100, 0, 32, 7)));
+
+    std::vector<uint32_t> p = Pixels(1, 8, 8);
+    atlas.Add(Key(1, 0, 8, 3), p.data(), 8, 8);
+    storage.failWrites = true;
+    CHECK(!atlas.Save());
+    CHECK(atlas.IsDirty());
+    CHECK(Same(atlas.Find(Key(1, 0, 8, 3)), p, 8, 8)); // The add survives for the next attempt
+
+    storage.failWrites = false;
+    CHECK(atlas.Save());
+    CHECK(!atlas.IsDirty());
+    IconAtlasReader reader;
+    CHECK(reader.Open(storage.file.data(), storage.file.size()) && reader.Count() == 1);
+}
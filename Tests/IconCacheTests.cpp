@@ -0,0 +1,210 @@
+#include "Check.h"
+#include "IconCache.h"
+#include <random>
+#include <set>
+
+namespace {
+    // Hands out distinct fake images and tracks which are still alive
+    class FakeUploader : public IconUploader
+    {
+    public:
+        std::set<uintptr_t> live;
+        uintptr_t next = 0x1000;
+        size_t uploads = 0;
+        int failAfter = -1; // Fail the upload after this many more succeed
+
+        void *Upload(const uint32_t *, int width, int height, int stride) override
+        {
+            CHECK(width > 0 && height > 0 && stride >= width);
+            if (failAfter == 0) return nullptr;
+            if (failAfter > 0) failAfter--;
+            uploads++;
+            live.insert(next);
+            return reinterpret_cast<void *>(next++);
+        }
+        void Release(void *image) override { CHECK(live.erase(reinterpret_cast<uintptr_t>(image)) == 1); }
+    };
+
+    // A 32px icon filled from `seed`, with a 16px mip: 5120 bytes in the cache
+    constexpr size_t ICON_BYTES = (32 * 32 + 16 * 16) * 4;
+
+    IconMipChain Icon(uint32_t seed, int edge = 32)
+    {
+        std::vector<uint32_t> pixels((size_t)edge * edge);
+        for (size_t i = 0; i < pixels.size(); i++) pixels[i] = 0xFF000000u | ((seed * 2654435761u + (uint32_t)i * 40503u) & 0xFFFFFF);
+        IconMipChain mips;
+        mips.Build(pixels.data(), edge, edge, edge, { edge });
+        return mips;
+    }
+}
+
+TEST(IdenticalPixelsShareOneUpload)
+{
+    FakeUploader uploader;
+    {
+        IconCache cache(uploader);
+        IconMipChain icon = Icon(1);
+        REQUIRE(icon.Count() == 2);
+
+        // Twenty windows of one app decode the same icon
+        IconKey first = cache.Acquire(icon);
+        REQUIRE(first != NO_ICON);
+        for (int i = 0; i < 19; i++) CHECK(cache.Acquire(Icon(1)) == first);
+        CHECK(cache.uploads == 1 && cache.hits == 19);
+        CHECK(uploader.uploads == 2); // One per level
+        CHECK(cache.Count() == 1 && cache.LevelCount() == 2);
+        CHECK(cache.BytesUsed() == ICON_BYTES);
+        CHECK(cache.MipBytes() == 16 * 16 * 4);
+
+        IconKey other = cache.Acquire(Icon(2));
+        CHECK(other != first && other != NO_ICON);
+        CHECK(IconCache::ContentKey(Icon(1)) == first);
+        CHECK(IconCache::ContentKey(Icon(1, 48)) != first); // Same seed, different size
+    }
+    CHECK(uploader.live.empty());
+}
+
+TEST(LevelsArePickedByDrawSize)
+{
+    FakeUploader uploader;
+    IconCache cache(uploader);
+    IconKey key = cache.Acquire(Icon(3));
+    void *large = cache.Image(key);
+    void *small = cache.Image(key, 16.0f);
+    CHECK(large != nullptr && small != nullptr && large != small);
+    CHECK(cache.Image(key, 32.0f) == large);
+    CHECK(cache.Image(key, 20.0f) == large);   // 16 would need enlarging
+    CHECK(cache.Image(key, 16.4f) == small);   // Within half a pixel
+    CHECK(cache.Image(key, 8.0f) == small);
+    CHECK(cache.Image(key, 64.0f) == large);
+    CHECK(cache.Image(NO_ICON) == nullptr);
+    CHECK(cache.Image(12345, 16.0f) == nullptr);
+}
+
+TEST(ReferencedIconsAreNeverEvicted)
+{
+    FakeUploader uploader;
+    IconCache cache(uploader, ICON_BYTES * 2);
+    std::vector<IconKey> held;
+    for (uint32_t i = 0; i < 5; i++) held.push_back(cache.Acquire(Icon(10 + i)));
+    CHECK(cache.Count() == 5); // Over budget, but all in use
+    CHECK(cache.evictions == 0);
+
+    // Released icons linger up to the budget, oldest release first out
+    for (IconKey k : held) cache.Release(k);
+    CHECK(cache.Count() == 2);
+    CHECK(cache.IdleCount() == 2);
+    CHECK(cache.BytesUsed() <= cache.GetBudget());
+    CHECK(cache.evictions == 3);
+    CHECK(cache.Image(held[4]) && cache.Image(held[3]));
+    CHECK(!cache.Image(held[0]));
+    CHECK(uploader.live.size() == 4);
+
+    // Re-acquiring an idle icon revives it without an upload
+    size_t uploads = uploader.uploads;
+    CHECK(cache.Acquire(Icon(13)) == held[3]);
+    CHECK(uploader.uploads == uploads);
+    CHECK(cache.IdleCount() == 1);
+
+    cache.SetBudget(0);
+    CHECK(cache.Count() == 1);
+    CHECK(cache.IdleCount() == 0);
+}
+
+TEST(AddRefAndReleaseBalance)
+{
+    FakeUploader uploader;
+    IconCache cache(uploader, 0);
+    IconKey key = cache.Acquire(Icon(20));
+    cache.AddRef(key);
+    cache.Release(key);
+    CHECK(cache.Count() == 1);
+    cache.Release(key);
+    CHECK(cache.Count() == 0); // Budget 0: gone as soon as it's unused
+    cache.Release(key);        // Stale keys are ignored
+    cache.AddRef(key);
+    CHECK(cache.Count() == 0);
+}
+
+TEST(SourcesSkipTheDecode)
+{
+    FakeUploader uploader;
+    IconCache cache(uploader);
+    CHECK(cache.AcquireSource(77) == NO_ICON);
+    IconKey key = cache.Acquire(Icon(30), 77);
+    cache.Acquire(Icon(30), 78); // Another file with the same pixels
+    CHECK(cache.AcquireSource(77) == key);
+    CHECK(cache.AcquireSource(78) == key);
+    CHECK(cache.sourceHits == 2);
+
+    // The file at 77 changed: the source moves to the new pixels
+    IconKey changed = cache.Acquire(Icon(31), 77);
+    CHECK(changed != key);
+    CHECK(cache.AcquireSource(77) == changed);
+    CHECK(cache.AcquireSource(78) == key);
+
+    // Eviction forgets the sources along with the pixels
+    for (int i = 0; i < 5; i++) cache.Release(key); // Two acquires, three source hits
+    cache.Release(changed);
+    cache.Release(changed);
+    cache.SetBudget(0);
+    CHECK(cache.AcquireSource(77) == NO_ICON);
+    CHECK(cache.AcquireSource(78) == NO_ICON);
+}
+
+TEST(FailedUploadsLeaveNothingBehind)
+{
+    FakeUploader uploader;
+    IconCache cache(uploader);
+    uploader.failAfter = 1; // The first level uploads, the mip doesn't
+    CHECK(cache.Acquire(Icon(40), 5) == NO_ICON);
+    CHECK(cache.failures == 1);
+    CHECK(cache.Count() == 0 && cache.BytesUsed() == 0);
+    CHECK(uploader.live.empty());
+    CHECK(cache.AcquireSource(5) == NO_ICON);
+    CHECK(cache.Acquire(IconMipChain()) == NO_ICON);
+
+    uploader.failAfter = -1;
+    CHECK(cache.Acquire(Icon(40)) != NO_ICON);
+}
+
+TEST(SyntheticChurnStaysBoundedAndConsistent)
+{
+    // Windows of 60 apps opening and closing; each holds a reference while open
+    FakeUploader uploader;
+    const size_t budget = ICON_BYTES * 10;
+    IconCache cache(uploader, budget);
+    std::mt19937 rng(18);
+    std::vector<IconMipChain> icons;
+    for (uint32_t app = 0; app < 60; app++) icons.push_back(Icon(app));
+    std::vector<std::pair<uint32_t, IconKey>> open;
+    size_t inUse = 0;
+    for (int step = 0; step < 20000; step++) {
+        if (open.size() < 200 && (open.empty() || rng() % 2)) {
+            uint32_t app = rng() % 60;
+            IconKey key = cache.AcquireSource(app);
+            if (key == NO_ICON) key = cache.Acquire(icons[app], app);
+            REQUIRE(key == IconCache::ContentKey(icons[app]));
+            open.push_back({ app, key });
+        }
+        else {
+            size_t i = rng() % open.size();
+            cache.Release(open[i].second);
+            open.erase(open.begin() + i);
+        }
+        std::set<IconKey> distinct;
+        for (auto &[app, key] : open) {
+            distinct.insert(key);
+        }
+        inUse = distinct.size();
+        CHECK(cache.Count() - cache.IdleCount() == inUse);
+        CHECK(cache.IdleCount() == 0 || cache.BytesUsed() <= std::max(budget, inUse * ICON_BYTES));
+        CHECK(cache.BytesUsed() == cache.Count() * ICON_BYTES);
+        CHECK(uploader.live.size() == cache.LevelCount());
+        if (step % 1000 == 0) {
+            for (auto &[app, key] : open) CHECK(cache.Image(key) != nullptr);
+        }
+    }
+    // Reuse mostly comes from the cache rather than new uploads
+    CHECK(cache.uploads < cache.hits + cache.sourceHits);
+}
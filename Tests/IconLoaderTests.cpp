@@ -0,0 +1,219 @@
+#include "Check.h"
+#include "IconLoader.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+    // Produces a flat icon of the requested size after `latency`; loads can be held at a gate
+    class FakeSource : public IconSource
+    {
+    public:
+        std::chrono::milliseconds latency{ 0 };
+        std::atomic<int> threads{ 0 };
+        std::atomic<int> loads{ 0 };
+        std::atomic<int> active{ 0 };
+        std::atomic<int> maxActive{ 0 };
+        std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> ranOnCaller{ false };
+
+        void BeginThread() override { threads++; }
+        void EndThread() override { threads--; }
+
+        bool Load(const IconRequest &request, LoadedIcon &out) override
+        {
+            if (std::this_thread::get_id() == caller) ranOnCaller = true;
+            int now = ++active;
+            for (int seen = maxActive; now > seen && !maxActive.compare_exchange_weak(seen, now);) {}
+            {
+                std::unique_lock<std::mutex> guard(gateLock);
+                gateOpen.wait(guard, [this] { return open; });
+            }
+            std::this_thread::sleep_for(latency);
+            loads++;
+            active--;
+            if (request.path == L"missing") return false;
+            out.width = out.height = request.size;
+            out.pixels.assign((size_t)request.size * request.size, 0xFF336699u);
+            out.fromFile = !request.path.empty();
+            return true;
+        }
+
+        void Hold() { std::lock_guard<std::mutex> guard(gateLock); open = false; }
+        void Release()
+        {
+            { std::lock_guard<std::mutex> guard(gateLock); open = true; }
+            gateOpen.notify_all();
+        }
+
+    private:
+        std::mutex gateLock;
+        std::condition_variable gateOpen;
+        bool open = true;
+    };
+
+    // Counts completion callbacks and lets the test wait for one
+    struct Wakes {
+        std::mutex lock;
+        std::condition_variable changed;
+        int count = 0;
+
+        std::function<void()> Callback()
+        {
+            return [this] {
+                { std::lock_guard<std::mutex> guard(lock); count++; }
+                changed.notify_all();
+            };
+        }
+        bool WaitFor(int n)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            return changed.wait_for(guard, 5s, [&] { return count >= n; });
+        }
+        int Count() { std::lock_guard<std::mutex> guard(lock); return count; }
+    };
+
+    IconRequest Req(uint64_t key, std::wstring path = L"C:\\app.exe", int size = 32)
+    {
+        IconRequest r;
+        r.key = key;
+        r.path = std::move(path);
+        r.size = size;
+        return r;
+    }
+
+    // Drains until `n` icons have arrived, waiting on the callback between drains
+    std::vector<LoadedIcon> Collect(IconLoader &loader, Wakes &wakes, size_t n)
+    {
+        std::vector<LoadedIcon> all, batch;
+        for (int round = 1; all.size() < n && wakes.WaitFor(round); round = wakes.Count() + 1) {
+            loader.Drain(batch);
+            for (LoadedIcon &icon : batch) all.push_back(std::move(icon));
+        }
+        return all;
+    }
+}
+
+TEST(LoadsOffTheCallingThread)
+{
+    FakeSource source;
+    Wakes wakes;
+    IconLoader loader(source);
+    loader.SetOnFinished(wakes.Callback());
+    CHECK(!loader.Busy());
+
+    IconRequest r = Req(1, L"C:\\app.exe", 48);
+    r.mipEdges = { 48, 24 };
+    CHECK(loader.Request(r));
+    CHECK(loader.Busy());
+    std::vector<LoadedIcon> icons = Collect(loader, wakes, 1);
+    REQUIRE(icons.size() == 1);
+    CHECK(icons[0].key == 1 && icons[0].ok && icons[0].fromFile);
+    CHECK(icons[0].width == 48);
+    CHECK(icons[0].mips.Count() == 2); // 24 halves below MIN_EDGE
+    CHECK(icons[0].mips.Edge(1) == 24);
+    CHECK(!source.ranOnCaller);
+    CHECK(!loader.Busy());
+    CHECK(loader.loaded == 1);
+}
+
+TEST(DuplicateKeysJoinTheExistingJob)
+{
+    FakeSource source;
+    Wakes wakes;
+    IconLoader loader(source);
+    loader.SetOnFinished(wakes.Callback());
+    source.Hold();
+
+    // Thirty windows of one app ask for its icon while the first load is stuck
+    CHECK(loader.Request(Req(7)));
+    for (int i = 0; i < 29; i++) CHECK(!loader.Request(Req(7)));
+    CHECK(loader.IsPending(7));
+    CHECK(loader.requests == 1 && loader.deduped == 29);
+
+    source.Release();
+    std::vector<LoadedIcon> icons = Collect(loader, wakes, 1);
+    CHECK(icons.size() == 1);
+    CHECK(source.loads == 1);
+
+    // Once drained the key can be loaded again (e.g. the file changed)
+    CHECK(!loader.IsPending(7));
+    CHECK(loader.Request(Req(7)));
+}
+
+TEST(OneWakePerUndrainedBatch)
+{
+    FakeSource source;
+    Wakes wakes;
+    IconLoader loader(source);
+    loader.SetOnFinished(wakes.Callback());
+    source.Hold();
+    for (uint64_t k = 1; k <= 10; k++) loader.Request(Req(k));
+    source.Release();
+
+    // Everything lands before the UI thread drains: one wake per batch it takes
+    while (source.loads < 10) std::this_thread::sleep_for(1ms);
+    std::vector<LoadedIcon> all, batch;
+    int batches = 0;
+    for (int spins = 0; all.size() < 10 && spins < 5000; spins++) {
+        if (loader.Drain(batch)) batches++;
+        all.insert(all.end(), batch.begin(), batch.end());
+        if (all.size() < 10) std::this_thread::sleep_for(1ms);
+    }
+    CHECK(all.size() == 10);
+    CHECK(wakes.WaitFor(batches));
+    CHECK(wakes.Count() == batches);
+    CHECK(batches <= 3); // Only results still in flight when the first drain ran come separately
+    CHECK(!loader.Busy());
+}
+
+TEST(WorkersLoadInParallel)
+{
+    FakeSource source;
+    source.latency = 20ms;
+    Wakes wakes;
+    IconLoader loader(source, 4);
+    loader.SetOnFinished(wakes.Callback());
+    for (uint64_t k = 1; k <= 16; k++) loader.Request(Req(k));
+    std::vector<LoadedIcon> icons = Collect(loader, wakes, 16);
+    CHECK(icons.size() == 16);
+    CHECK(source.maxActive > 1);
+    CHECK(source.maxActive <= 4);
+}
+
+TEST(FailuresAreReported)
+{
+    FakeSource source;
+    Wakes wakes;
+    IconLoader loader(source);
+    loader.SetOnFinished(wakes.Callback());
+    loader.Request(Req(3, L"missing"));
+    std::vector<LoadedIcon> icons = Collect(loader, wakes, 1);
+    REQUIRE(icons.size() == 1);
+    CHECK(!icons[0].ok);
+    CHECK(icons[0].mips.Count() == 0);
+    CHECK(loader.failures == 1 && loader.loaded == 0);
+}
+
+TEST(StopDropsQueuedJobsAndJoins)
+{
+    FakeSource source;
+    IconLoader loader(source, 1);
+    source.Hold();
+    for (uint64_t k = 1; k <= 5; k++) loader.Request(Req(k));
+    while (source.active == 0) std::this_thread::sleep_for(1ms);
+    CHECK(source.threads == 1);
+
+    // The stuck load finishes; the four behind it never start
+    std::thread release([&source] { std::this_thread::sleep_for(20ms); source.Release(); });
+    loader.Stop();
+    release.join();
+    CHECK(source.loads == 1);
+    CHECK(source.threads == 0);
+    CHECK(!loader.Request(Req(9)));
+    loader.Stop(); // Twice is fine
+}
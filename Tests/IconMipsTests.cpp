@@ -0,0 +1,114 @@
+#include "Check.h"
+#include "IconMips.h"
+#include "PixelOps.h"
+#include <cstring>
+#include <random>
+
+namespace {
+    std::vector<uint32_t> Source(int w, int h, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<uint32_t> px((size_t)w * h);
+        for (uint32_t &p : px) {
+            uint32_t a = rng() % 256;
+            p = a << 24 | (rng() % (a + 1)) << 16 | (rng() % (a + 1)) << 8 | rng() % (a + 1);
+        }
+        return px;
+    }
+
+    std::vector<int> Edges(const IconMipChain &mips)
+    {
+        std::vector<int> out;
+        for (size_t i = 0; i < mips.Count(); i++) out.push_back(mips.Edge(i));
+        return out;
+    }
+}
+
+TEST(LevelSetsFromRequestedEdges)
+{
+    std::vector<uint32_t> px = Source(256, 256, 1);
+    IconMipChain mips;
+
+    mips.Build(px.data(), 256, 256, 256, { 32 });
+    CHECK(Edges(mips) == (std::vector<int>{ 32, 16 }));
+
+    // Unordered, repeated and invalid edges
+    mips.Build(px.data(), 256, 256, 256, { 40, 96, 40, 0, -5, 48 });
+    CHECK(Edges(mips) == (std::vector<int>{ 96, 48, 40, 20 }));
+
+    // Above the source clamps to it; nothing requested means the source size
+    mips.Build(px.data(), 256, 256, 256, { 1024 });
+    CHECK(Edges(mips) == (std::vector<int>{ 256, 128, 64, 32, 16 }));
+    mips.Build(px.data(), 48, 48, 256, {});
+    CHECK(Edges(mips) == (std::vector<int>{ 48, 24 }));
+
+    // Below MIN_EDGE is kept when asked for, with no halvings under it
+    mips.Build(px.data(), 256, 256, 256, { 12 });
+    CHECK(Edges(mips) == (std::vector<int>{ 12 }));
+
+    mips.Build(nullptr, 32, 32, 32, { 32 });
+    CHECK(mips.Count() == 0 && mips.Bytes() == 0);
+    CHECK(!mips.Level(0));
+}
+
+TEST(LevelsKeepAspectAndAccountMemory)
+{
+    std::vector<uint32_t> px = Source(64, 32, 2);
+    IconMipChain mips;
+    mips.Build(px.data(), 64, 32, 64, { 48 });
+    REQUIRE(mips.Count() == 2);
+    CHECK(mips.Level(0).width == 48 && mips.Level(0).height == 24);
+    CHECK(mips.Level(1).width == 24 && mips.Level(1).height == 12);
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < mips.Count(); i++) bytes += (size_t)mips.Level(i).width * mips.Level(i).height * 4;
+    CHECK(mips.Bytes() == bytes);
+
+    // A tall sliver never collapses to zero width
+    std::vector<uint32_t> sliver = Source(2, 200, 3);
+    mips.Build(sliver.data(), 2, 200, 2, { 32 });
+    CHECK(mips.Level(0).width == 1 && mips.Level(0).height == 32);
+
+    // One DPI adds a quarter for its 16px level
+    std::vector<uint32_t> square = Source(256, 256, 4);
+    mips.Build(square.data(), 256, 256, 256, { 32 });
+    CHECK(mips.Bytes() == (32 * 32 + 16 * 16) * 4);
+}
+
+TEST(EachLevelIsFilteredFromTheSource)
+{
+    // Not a blur of a blur: every level equals a direct resample of the source
+    std::vector<uint32_t> px = Source(120, 100, 5);
+    IconMipChain mips;
+    mips.Build(px.data() + 3, 100, 100, 120, { 64, 40 }); // 64, 40, 20
+    REQUIRE(mips.Count() == 3);
+    for (size_t i = 0; i < mips.Count(); i++) {
+        IconMipLevel level = mips.Level(i);
+        std::vector<uint32_t> direct((size_t)level.width * level.height);
+        ResampleBGRA(px.data() + 3, 100, 100, 120, direct.data(), level.width, level.height, level.width);
+        CHECK(std::memcmp(direct.data(), level.pixels, direct.size() * 4) == 0);
+    }
+
+    // Rebuilding replaces the old levels
+    mips.Build(px.data(), 32, 32, 120, { 32 });
+    CHECK(mips.Count() == 2);
+}
+
+TEST(PickChoosesTheSmallestThatNeedsNoEnlarging)
+{
+    std::vector<uint32_t> px = Source(96, 96, 6);
+    IconMipChain mips;
+    mips.Build(px.data(), 96, 96, 96, { 96, 48, 40 }); // 96, 48, 40, 20
+    CHECK(mips.Pick(96.0f) == 0);
+    CHECK(mips.Pick(120.0f) == 0); // Larger than any level: the largest
+    CHECK(mips.Pick(48.0f) == 1);
+    CHECK(mips.Pick(48.4f) == 1);  // Rounding slack
+    CHECK(mips.Pick(49.0f) == 0);
+    CHECK(mips.Pick(40.0f) == 2);
+    CHECK(mips.Pick(30.0f) == 2);
+    CHECK(mips.Pick(20.0f) == 3);
+    CHECK(mips.Pick(4.0f) == 3);
+
+    IconMipChain empty;
+    CHECK(empty.Pick(32.0f) == 0);
+}
@@ -0,0 +1,150 @@
+#include "Check.h"
+#include "LayoutEngine.h"
+#include <deque>
+
+namespace {
+    constexpr unsigned LEFT = 1u << (int)LayoutSection::Left;
+    constexpr unsigned CENTER = 1u << (int)LayoutSection::Center;
+    constexpr unsigned RIGHT = 1u << (int)LayoutSection::Right;
+
+    bool Near(float a, float b) { return a - b < 0.001f && b - a < 0.001f; }
+
+    // Nodes live in a deque so the section pointers stay valid as it grows
+    std::vector<LayoutNode *> MakeNodes(std::deque<LayoutNode> &store, std::initializer_list<float> sizes)
+    {
+        std::vector<LayoutNode *> out;
+        for (float size : sizes) {
+            store.emplace_back();
+            store.back().SetMeasuredSize(size);
+            out.push_back(&store.back());
+        }
+        return out;
+    }
+}
+
+TEST(PlacesSectionsAlongTheBar)
+{
+    std::deque<LayoutNode> store;
+    LayoutEngine layout;
+    auto left = MakeNodes(store, { 40, 60 });
+    auto center = MakeNodes(store, { 100 });
+    auto right = MakeNodes(store, { 30, 20 });
+    layout.SetSection(LayoutSection::Left, left);
+    layout.SetSection(LayoutSection::Center, center);
+    layout.SetSection(LayoutSection::Right, right);
+    layout.SetBounds(1000, 32, false);
+
+    CHECK(layout.Arrange() == (LEFT | CENTER | RIGHT));
+    CHECK(left[0]->rect == (LayoutRect{ 0, 0, 40, 32 }));
+    CHECK(left[1]->rect == (LayoutRect{ 40, 0, 100, 32 }));
+    CHECK(center[0]->rect == (LayoutRect{ 450, 0, 550, 32 }));
+    CHECK(right[0]->rect == (LayoutRect{ 950, 0, 980, 32 }));
+    CHECK(right[1]->rect == (LayoutRect{ 980, 0, 1000, 32 }));
+    CHECK(layout.CrossExtent() == 32);
+}
+
+TEST(VerticalBarsStackDownTheMainAxis)
+{
+    std::deque<LayoutNode> store;
+    LayoutEngine layout;
+    auto left = MakeNodes(store, { 40, 60 });
+    auto right = MakeNodes(store, { 25 });
+    layout.SetSection(LayoutSection::Left, left);
+    layout.SetSection(LayoutSection::Right, right);
+    layout.SetBounds(48, 800, true);
+    layout.Arrange();
+
+    CHECK(left[0]->rect == (LayoutRect{ 0, 0, 48, 40 }));
+    CHECK(left[1]->rect == (LayoutRect{ 0, 40, 48, 100 }));
+    CHECK(right[0]->rect == (LayoutRect{ 0, 775, 48, 800 }));
+    CHECK(layout.CrossExtent() == 48);
+}
+
+TEST(GroupChildrenSitInsideTheInsets)
+{
+    std::deque<LayoutNode> store;
+    LayoutEngine layout;
+    auto group = MakeNodes(store, { 90 });
+    auto children = MakeNodes(store, { 30, 50 });
+    group[0]->children = children;
+    group[0]->SetChildInsets({ 5, 4, 5, 4 });
+    layout.SetSection(LayoutSection::Left, group);
+    layout.SetBounds(500, 30, false);
+    layout.Arrange();
+
+    CHECK(group[0]->rect == (LayoutRect{ 0, 0, 90, 30 }));
+    CHECK(children[0]->rect == (LayoutRect{ 5, 4, 35, 26 }));
+    CHECK(children[1]->rect == (LayoutRect{ 35, 4, 85, 26 }));
+}
+
+TEST(OnlySectionsWithResizedNodesAreArranged)
+{
+    std::deque<LayoutNode> store;
+    LayoutEngine layout;
+    auto left = MakeNodes(store, { 40 });
+    auto center = MakeNodes(store, { 100 });
+    auto right = MakeNodes(store, { 30 });
+    layout.SetSection(LayoutSection::Left, left);
+    layout.SetSection(LayoutSection::Center, center);
+    layout.SetSection(LayoutSection::Right, right);
+    layout.SetBounds(1000, 32, false);
+    layout.Arrange();
+
+    // Steady state: nothing to do
+    CHECK(layout.Arrange() == 0);
+    CHECK(!center[0]->SetMeasuredSize(100));
+    CHECK(layout.Arrange() == 0);
+
+    CHECK(center[0]->SetMeasuredSize(120));
+    CHECK(layout.Arrange() == CENTER);
+    CHECK(center[0]->previousRect == (LayoutRect{ 450, 0, 550, 32 }));
+    CHECK(center[0]->rect == (LayoutRect{ 440, 0, 560, 32 }));
+    CHECK(left[0]->rect == (LayoutRect{ 0, 0, 40, 32 }));
+
+    // A resized child dirties its group's section
+    auto children = MakeNodes(store, { 10 });
+    right[0]->children = children;
+    layout.Arrange();
+    children[0]->SetMeasuredSize(12);
+    CHECK(layout.Arrange() == RIGHT);
+
+    // New bounds or orientation move everything
+    layout.SetBounds(1200, 32, false);
+    CHECK(layout.Arrange() == (LEFT | CENTER | RIGHT));
+    layout.SetBounds(1200, 32, true);
+    CHECK(layout.Arrange() == (LEFT | CENTER | RIGHT));
+}
+
+TEST(HundredsOfModulesStayContiguous)
+{
+    std::deque<LayoutNode> store;
+    LayoutEngine layout;
+    std::vector<LayoutNode *> sections[LayoutEngine::SECTION_COUNT];
+    for (int i = 0; i < 300; i++) {
+        store.emplace_back();
+        store.back().SetMeasuredSize((float)(8 + i % 13));
+        sections[i % 3].push_back(&store.back());
+    }
+    for (int s = 0; s < LayoutEngine::SECTION_COUNT; s++) layout.SetSection((LayoutSection)s, sections[s]);
+    layout.SetBounds(4000, 40, false);
+    layout.Arrange();
+
+    size_t before = layout.arrangeCount;
+    for (int frame = 0; frame < 100; frame++) {
+        LayoutNode *n = sections[1][frame % sections[1].size()];
+        n->SetMeasuredSize(n->measuredSize + 1);
+        CHECK(layout.Arrange() == CENTER);
+    }
+    CHECK(layout.arrangeCount - before == 100);
+
+    for (const auto &list : sections) {
+        for (size_t i = 1; i < list.size(); i++) CHECK(list[i]->rect.left == list[i - 1]->rect.right);
+        float total = 0;
+        for (LayoutNode *n : list) total += n->measuredSize;
+        CHECK(Near(list.back()->rect.right - list.front()->rect.left, total));
+    }
+    CHECK(sections[0].front()->rect.left == 0);
+    CHECK(sections[2].back()->rect.right == 4000);
+    float centerMid = (sections[1].front()->rect.left + sections[1].back()->rect.right) / 2.0f;
+    CHECK(Near(centerMid, 2000));
+}
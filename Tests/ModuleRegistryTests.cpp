@@ -0,0 +1,91 @@
+#include "Check.h"
+#include "ModuleRegistry.h"
+#include <string>
+
+namespace {
+    // The registry only stores module pointers
+    Module *Fake(int i) { static char storage[1024]; return reinterpret_cast<Module *>(&storage[i]); }
+}
+
+TEST(TypeNamesMapToEnums)
+{
+    CHECK(ModuleTypeFromName("dock") == ModuleType::Dock);
+    CHECK(ModuleTypeFromName("app_icon") == ModuleType::AppIcon);
+    CHECK(ModuleTypeFromName("notification") == ModuleType::Notification);
+    CHECK(ModuleTypeFromName("Dock") == ModuleType::Unknown);
+    CHECK(ModuleTypeFromName("") == ModuleType::Unknown);
+}
+
+TEST(HandlesAreDenseAndFindable)
+{
+    ModuleRegistry registry;
+    ModuleHandle clock = registry.Register(Fake(0), "clock", ModuleType::Clock);
+    ModuleHandle cpu = registry.Register(Fake(1), "cpu#main", ModuleType::Cpu);
+    ModuleHandle cpu2 = registry.Register(Fake(2), "cpu#second", ModuleType::Cpu);
+
+    CHECK(clock == 0 && cpu == 1 && cpu2 == 2);
+    CHECK(registry.Count() == 3);
+    CHECK(registry.Get(cpu) == Fake(1));
+    CHECK(registry.Get(3) == nullptr);
+    CHECK(registry.Get(INVALID_MODULE) == nullptr);
+
+    CHECK(registry.Find("cpu#second") == cpu2);
+    CHECK(registry.Find(std::string_view("clockwork").substr(0, 5)) == clock); // Borrowed lookup
+    CHECK(registry.Find("ram") == INVALID_MODULE);
+
+    // First of each type, in registration (layout) order
+    CHECK(registry.FindType(ModuleType::Cpu) == cpu);
+    CHECK(registry.FindType(ModuleType::Dock) == INVALID_MODULE);
+}
+
+TEST(RepeatedIdsKeepTheFirstRegistration)
+{
+    ModuleRegistry registry;
+    ModuleHandle first = registry.Register(Fake(0), "clock", ModuleType::Clock);
+    ModuleHandle second = registry.Register(Fake(1), "clock", ModuleType::Clock);
+    CHECK(second != first);
+    CHECK(registry.Find("clock") == first);
+    CHECK(registry.Get(second) == Fake(1));
+}
+
+TEST(RectsArePublishedPerHandle)
+{
+    ModuleRegistry registry;
+    ModuleHandle a = registry.Register(Fake(0), "a", ModuleType::Custom);
+    ModuleHandle b = registry.Register(Fake(1), "b", ModuleType::Custom);
+    CHECK(registry.GetRect(a) == LayoutRect());
+
+    registry.SetRect(b, { 10, 0, 50, 30 });
+    CHECK(registry.GetRect(b) == (LayoutRect{ 10, 0, 50, 30 }));
+    CHECK(registry.GetRect(a) == LayoutRect());
+    CHECK(registry.GetRect(INVALID_MODULE) == LayoutRect());
+
+    // Per-frame publication for a large bar
+    ModuleRegistry big;
+    for (int i = 0; i < 500; i++) big.Register(Fake(i), "m" + std::to_string(i), ModuleType::Custom);
+    for (int frame = 0; frame < 10; frame++) {
+        for (ModuleHandle h = 0; h < big.Count(); h++) big.SetRect(h, { (float)h * 10 + frame, 0, (float)h * 10 + 10 + frame, 30 });
+    }
+    CHECK(big.GetRect(big.Find("m321")).left == 3219.0f);
+}
+
+TEST(ClearResetsEverything)
+{
+    ModuleRegistry registry;
+    registry.Register(Fake(0), "dock", ModuleType::Dock);
+    registry.Clear();
+    CHECK(registry.Count() == 0);
+    CHECK(registry.Find("dock") == INVALID_MODULE);
+    CHECK(registry.FindType(ModuleType::Dock) == INVALID_MODULE);
+    CHECK(registry.Register(Fake(1), "dock", ModuleType::Dock) == 0);
+}
+
+TEST(HandleSpaceIsBounded)
+{
+    ModuleRegistry registry;
+    for (int i = 0; i < INVALID_MODULE; i++) registry.Register(Fake(i % 1024), std::string(), ModuleType::Custom);
+    CHECK(registry.Count() == INVALID_MODULE);
+    CHECK(registry.Register(Fake(0), "late", ModuleType::Clock) == INVALID_MODULE);
+    CHECK(registry.Find("late") == INVALID_MODULE);
+    CHECK(registry.FindType(ModuleType::Clock) == INVALID_MODULE);
+}
@@ -0,0 +1,354 @@
+#include "Check.h"
+#include "NotifyIconParser.h"
+#include "TrayIconStore.h"
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // NOTIFYICONDATAW as 32-bit and 64-bit senders lay it out (handles widened, natural alignment)
+    template <typename Handle>
+    struct Nid {
+        uint32_t cbSize;
+        Handle hWnd;
+        uint32_t uID;
+        uint32_t uFlags;
+        uint32_t uCallbackMessage;
+        Handle hIcon;
+        char16_t szTip[128];
+        uint32_t dwState;
+        uint32_t dwStateMask;
+        char16_t szInfo[256];
+        uint32_t uVersion;
+        char16_t szInfoTitle[64];
+        uint32_t dwInfoFlags;
+        uint8_t guidItem[16];
+        Handle hBalloonIcon;
+    };
+    using Nid32 = Nid<uint32_t>;
+    using Nid64 = Nid<uint64_t>;
+
+    // The SDK's offsets, so the structs above really are the wire layouts
+    static_assert(offsetof(Nid32, szTip) == 24 && offsetof(Nid32, szInfo) == 288 && offsetof(Nid32, guidItem) == 936);
+    static_assert(offsetof(Nid64, hWnd) == 8 && offsetof(Nid64, hIcon) == 32 && offsetof(Nid64, szTip) == 40);
+    static_assert(offsetof(Nid64, szInfo) == 304 && offsetof(Nid64, guidItem) == 952 && sizeof(Nid64) == 976);
+
+    // cbSize of each NOTIFYICONDATAW version: V1 (64-char tip), V2, V3 (guidItem), V4 (hBalloonIcon)
+    const uint32_t SIZES32[4] = { 152, 936, 952, 956 };
+    const uint32_t SIZES64[4] = { 168, 952, 968, 976 };
+
+    const uint32_t NIM_ADD = 0, NIM_MODIFY = 1, NIM_SETVERSION = 4;
+
+    void Put(char16_t *field, size_t capacity, const std::u16string &text)
+    {
+        for (size_t i = 0; i < capacity; i++) field[i] = i < text.size() ? text[i] : u'\0';
+    }
+
+    template <typename Handle>
+    Nid<Handle> Sample()
+    {
+        Nid<Handle> n = {};
+        n.hWnd = (Handle)0x000A0B0Cu;
+        n.uID = 42;
+        n.uFlags = 0x1F;
+        n.uCallbackMessage = 0x8001;
+        n.hIcon = (Handle)0x00C0FFEEu;
+        Put(n.szTip, 128, u"Volume: 40%");
+        n.dwState = 1;
+        n.dwStateMask = 3;
+        Put(n.szInfo, 256, u"Update ready");
+        n.uVersion = 4;
+        Put(n.szInfoTitle, 64, u"Installer");
+        n.dwInfoFlags = 0x24;
+        for (int i = 0; i < 16; i++) n.guidItem[i] = (uint8_t)(0xA0 + i);
+        n.hBalloonIcon = (Handle)0x00BA110Cu;
+        return n;
+    }
+
+    // The COPYDATA payload: signature, message, then the first cbSize bytes of the struct
+    template <typename Handle>
+    std::vector<uint8_t> Blob(Nid<Handle> n, uint32_t cbSize, uint32_t message = NIM_MODIFY, size_t trailing = 0)
+    {
+        n.cbSize = cbSize;
+        std::vector<uint8_t> out(8 + cbSize + trailing, 0);
+        uint32_t header[2] = { 0x34753423, message };
+        std::memcpy(out.data(), header, 8);
+        std::memcpy(out.data() + 8, &n, std::min<size_t>(cbSize, sizeof(n)));
+        return out;
+    }
+
+    std::u16string Text(const NotifyIconText &t)
+    {
+        std::u16string s;
+        t.CopyTo(s);
+        return s;
+    }
+
+    template <typename Handle>
+    void CheckVersions(const uint32_t (&sizes)[4], bool is64)
+    {
+        Nid<Handle> n = Sample<Handle>();
+        for (int v = 0; v < 4; v++) {
+            std::vector<uint8_t> blob = Blob(n, sizes[v], NIM_ADD);
+            NotifyIconView view;
+            REQUIRE(ParseNotifyIcon(blob.data(), blob.size(), view));
+            CHECK(view.is64 == is64);
+            CHECK(view.message == NIM_ADD && view.cbSize == sizes[v]);
+            CHECK(view.hWnd == 0x000A0B0C && view.uID == 42 && view.uFlags == 0x1F);
+            CHECK(view.uCallbackMessage == 0x8001 && view.hIcon == 0x00C0FFEE);
+            CHECK(Text(view.tip) == u"Volume: 40%");
+            CHECK(view.hasInfo == (v >= 1));
+            CHECK(view.hasGuid == (v >= 2));
+            CHECK(view.hasBalloonIcon == (v >= 3));
+            if (view.hasInfo) {
+                CHECK(view.state == 1 && view.stateMask == 3);
+                CHECK(Text(view.info) == u"Update ready");
+                CHECK(Text(view.infoTitle) == u"Installer");
+                CHECK(view.versionOrTimeout == 4 && view.infoFlags == 0x24);
+            }
+            if (view.hasGuid) CHECK(view.guid.bytes[0] == 0xA0 && view.guid.bytes[15] == 0xAF);
+            if (view.hasBalloonIcon) CHECK(view.hBalloonIcon == 0x00BA110C);
+        }
+    }
+
+    TrayIconGuid Guid(uint8_t seed)
+    {
+        TrayIconGuid g;
+        for (int i = 0; i < 16; i++) g.bytes[i] = (uint8_t)(seed * 31 + i);
+        return g;
+    }
+}
+
+TEST(EveryVersionFrom32BitSenders)
+{
+    CheckVersions<uint32_t>(SIZES32, false);
+}
+
+TEST(EveryVersionFrom64BitSenders)
+{
+    CheckVersions<uint64_t>(SIZES64, true);
+}
+
+TEST(AmbiguousSizesUseTheHandleOffset)
+{
+    // 952 bytes: a 32-bit V3 or a 64-bit V2
+    NotifyIconView view;
+    std::vector<uint8_t> v3 = Blob(Sample<uint32_t>(), 952);
+    REQUIRE(ParseNotifyIcon(v3.data(), v3.size(), view));
+    CHECK(!view.is64);
+    CHECK(view.hasGuid && view.guid.bytes[0] == 0xA0);
+
+    std::vector<uint8_t> v2 = Blob(Sample<uint64_t>(), 952);
+    REQUIRE(ParseNotifyIcon(v2.data(), v2.size(), view));
+    CHECK(view.is64);
+    CHECK(view.hWnd == 0x000A0B0C && view.uID == 42);
+    CHECK(view.hasInfo && !view.hasGuid);
+
+    // Sizes no SDK produced (apps padding the struct) fall back to the same test
+    std::vector<uint8_t> odd32 = Blob(Sample<uint32_t>(), 940);
+    REQUIRE(ParseNotifyIcon(odd32.data(), odd32.size(), view));
+    CHECK(!view.is64 && view.uID == 42 && view.hasInfo && !view.hasGuid);
+    std::vector<uint8_t> odd64 = Blob(Sample<uint64_t>(), 972);
+    REQUIRE(ParseNotifyIcon(odd64.data(), odd64.size(), view));
+    CHECK(view.is64 && view.uID == 42 && view.hasGuid && !view.hasBalloonIcon);
+
+    // 64-bit handles keep their upper half
+    Nid64 wide = Sample<uint64_t>();
+    wide.hIcon = 0x1234567800C0FFEEull;
+    std::vector<uint8_t> blob = Blob(wide, 976);
+    REQUIRE(ParseNotifyIcon(blob.data(), blob.size(), view));
+    CHECK(view.hIcon == 0x1234567800C0FFEEull);
+}
+
+TEST(FieldsStopAtCbSize)
+{
+    NotifyIconView view;
+    // V1's tip holds 64 characters; a longer one is cut where the struct ends
+    Nid32 n = Sample<uint32_t>();
+    Put(n.szTip, 128, std::u16string(100, u'x'));
+    std::vector<uint8_t> v1 = Blob(n, 152);
+    REQUIRE(ParseNotifyIcon(v1.data(), v1.size(), view));
+    CHECK(view.tip.length == 64);
+    CHECK(!view.hasInfo);
+
+    // Unterminated tip in a full struct: all 128 characters, nothing past the field
+    Put(n.szTip, 128, std::u16string(128, u'y'));
+    std::vector<uint8_t> full = Blob(n, 956);
+    REQUIRE(ParseNotifyIcon(full.data(), full.size(), view));
+    CHECK(view.tip.length == 128);
+    CHECK(Text(view.info) == u"Update ready");
+
+    // A size that ends inside szInfo: the info block is not read at all
+    std::vector<uint8_t> partial = Blob(Sample<uint32_t>(), 400);
+    REQUIRE(ParseNotifyIcon(partial.data(), partial.size(), view));
+    CHECK(!view.hasInfo && view.info.Empty());
+
+    // Odd sizes never split a UTF-16 unit
+    Put(n.szTip, 128, std::u16string(128, u'z'));
+    std::vector<uint8_t> odd = Blob(n, 153);
+    REQUIRE(ParseNotifyIcon(odd.data(), odd.size(), view));
+    CHECK(view.tip.length == 64);
+
+    // Bytes after cbSize are ignored
+    std::vector<uint8_t> padded = Blob(Sample<uint32_t>(), 936, NIM_SETVERSION, 64);
+    REQUIRE(ParseNotifyIcon(padded.data(), padded.size(), view));
+    CHECK(view.message == NIM_SETVERSION && view.hasInfo && !view.hasGuid);
+}
+
+TEST(RejectsShortAndOverrunningPayloads)
+{
+    NotifyIconView view;
+    std::vector<uint8_t> good = Blob(Sample<uint64_t>(), 976);
+    CHECK(!ParseNotifyIcon(nullptr, 0, view));
+    CHECK(!ParseNotifyIcon(good.data(), 11, view));           // No room for cbSize
+    CHECK(!ParseNotifyIcon(good.data(), good.size() - 1, view)); // cbSize runs past the buffer
+
+    std::vector<uint8_t> tiny = Blob(Sample<uint32_t>(), 100); // Older than any version
+    CHECK(!ParseNotifyIcon(tiny.data(), tiny.size(), view));
+    CHECK(view.uID == 0); // Nothing half-filled
+
+    // A huge cbSize doesn't wrap the bounds check
+    std::vector<uint8_t> huge = good;
+    uint32_t big = 0xFFFFFFF0u;
+    std::memcpy(huge.data() + 8, &big, 4);
+    CHECK(!ParseNotifyIcon(huge.data(), huge.size(), view));
+}
+
+TEST(UnalignedBuffersAndFuzz)
+{
+    // COPYDATA hands over whatever alignment it likes
+    std::vector<uint8_t> blob = Blob(Sample<uint64_t>(), 976);
+    std::vector<uint8_t> shifted(blob.size() + 3);
+    std::memcpy(shifted.data() + 3, blob.data(), blob.size());
+    NotifyIconView view;
+    REQUIRE(ParseNotifyIcon(shifted.data() + 3, blob.size(), view));
+    CHECK(view.hIcon == 0x00C0FFEE && Text(view.tip) == u"Volume: 40%");
+
+    // Random sizes and bytes: every view stays inside the buffer
+    std::mt19937 rng(24);
+    for (int round = 0; round < 5000; round++) {
+        std::vector<uint8_t> bytes(rng() % 1100);
+        for (uint8_t &b : bytes) b = (uint8_t)(rng() % 4 ? 0 : rng());
+        if (bytes.size() >= 12) {
+            uint32_t cb = rng() % 2 ? (uint32_t)(bytes.size() - 8 - rng() % 16) : (uint32_t)rng();
+            std::memcpy(bytes.data() + 8, &cb, 4);
+        }
+        if (!ParseNotifyIcon(bytes.data(), bytes.size(), view)) continue;
+        CHECK(view.cbSize + 8 <= bytes.size());
+        for (const NotifyIconText *t : { &view.tip, &view.info, &view.infoTitle }) {
+            if (t->Empty()) continue;
+            CHECK(t->data >= bytes.data() + 8);
+            CHECK(t->data + t->length * 2 <= bytes.data() + 8 + view.cbSize);
+        }
+    }
+}
+
+TEST(StoreFindsIconsByIdAndGuid)
+{
+    TrayIconStore<int> store;
+    std::vector<int> removed;
+    auto onRemove = [&removed](int icon) { removed.push_back(icon); };
+    bool added = false;
+    TrayIconGuid g1 = Guid(1);
+
+    store.Upsert(0x10, 1, nullptr, added, onRemove).icon = 100;
+    CHECK(added);
+    store.Upsert(0x10, 2, &g1, added, onRemove).icon = 200;
+    store.Upsert(0x20, 1, nullptr, added, onRemove).icon = 300;
+    CHECK(store.Size() == 3);
+    CHECK(store.Find(0x10, 1, nullptr)->icon == 100);
+    CHECK(store.Find(0x99, 9, &g1)->icon == 200); // GUID wins over the id
+    CHECK(store.Find(0x10, 3, nullptr) == nullptr);
+
+    // Modify in place
+    store.Upsert(0x10, 1, nullptr, added, onRemove).icon = 101;
+    CHECK(!added && store.Size() == 3);
+
+    // The app restarted: same GUID, new window
+    store.Upsert(0x30, 7, &g1, added, onRemove);
+    CHECK(!added);
+    CHECK(store.Find(0x30, 7, nullptr)->icon == 200);
+    CHECK(store.Find(0x10, 2, nullptr) == nullptr);
+
+    // An id picks up a GUID later
+    TrayIconGuid g2 = Guid(2);
+    store.Upsert(0x20, 1, &g2, added, onRemove);
+    CHECK(store.Find(0, 0, &g2)->icon == 300);
+
+    CHECK(store.Erase(0x10, 1, nullptr, onRemove));
+    CHECK(!store.Erase(0x10, 1, nullptr, onRemove));
+    CHECK(removed == (std::vector<int>{ 101 }));
+    CHECK(store.Find(0, 0, &g2)->icon == 300); // Indexes survive the shift
+    CHECK(store.Find(0x30, 7, &g1)->icon == 200);
+}
+
+TEST(StoreEvictsIconsAGuidMoveDisplaces)
+{
+    TrayIconStore<int> store;
+    std::vector<int> removed;
+    auto onRemove = [&removed](int icon) { removed.push_back(icon); };
+    bool added;
+    TrayIconGuid g = Guid(3);
+    store.Upsert(0x10, 1, nullptr, added, onRemove).icon = 1; // Left over from before a restart
+    store.Upsert(0x20, 5, &g, added, onRemove).icon = 2;
+
+    // The GUID's icon now claims (0x10, 1): the old holder is stale
+    store.Upsert(0x10, 1, &g, added, onRemove);
+    CHECK(removed == (std::vector<int>{ 1 }));
+    CHECK(store.Size() == 1);
+    CHECK(store.Find(0x10, 1, nullptr)->icon == 2);
+    CHECK(store.Find(0x20, 5, nullptr) == nullptr);
+}
+
+TEST(StoreCollectsDeadOwners)
+{
+    TrayIconStore<int> store;
+    std::vector<int> removed;
+    auto onRemove = [&removed](int icon) { removed.push_back(icon); };
+    bool added;
+    for (int i = 0; i < 10; i++) {
+        TrayIconGuid g = Guid((uint8_t)i);
+        store.Upsert(0x100 + (uint64_t)(i % 3), (uint32_t)i, i % 2 ? &g : nullptr, added, onRemove).icon = i;
+    }
+    CHECK(store.Collect([](uint64_t owner) { return owner == 0x101; }, onRemove) == 3);
+    CHECK(removed == (std::vector<int>{ 1, 4, 7 }));
+    CHECK(store.Size() == 7);
+    for (const auto &e : store.Entries()) CHECK(store.Find(e.owner, e.uID, e.hasGuid ? &e.guid : nullptr)->icon == e.icon);
+    CHECK(store.Collect([](uint64_t) { return false; }, onRemove) == 0);
+
+    store.Clear(onRemove);
+    CHECK(store.Size() == 0 && removed.size() == 10);
+}
+
+TEST(ReplayedMessagesDriveTheStore)
+{
+    // A session's COPYDATA traffic from a mix of 32- and 64-bit apps
+    TrayIconStore<std::u16string> store;
+    auto ignore = [](const std::u16string &) {};
+    std::vector<std::vector<uint8_t>> session;
+    Nid32 a = Sample<uint32_t>();
+    a.hWnd = 0x111;
+    a.uID = 1;
+    Nid64 b = Sample<uint64_t>();
+    b.hWnd = 0x222;
+    b.uID = 1;
+    session.push_back(Blob(a, 936, NIM_ADD));
+    session.push_back(Blob(b, 976, NIM_ADD));
+    Put(a.szTip, 128, u"Battery 80%");
+    session.push_back(Blob(a, 936, NIM_MODIFY));
+    b.hWnd = 0x333; // Restarted; found again by its GUID
+    Put(b.szTip, 128, u"Back again");
+    session.push_back(Blob(b, 976, NIM_ADD));
+
+    for (const std::vector<uint8_t> &blob : session) {
+        NotifyIconView view;
+        REQUIRE(ParseNotifyIcon(blob.data(), blob.size(), view));
+        bool added;
+        auto &e = store.Upsert(view.hWnd, view.uID, view.hasGuid ? &view.guid : nullptr, added, ignore);
+        view.tip.CopyTo(e.icon);
+    }
+    REQUIRE(store.Size() == 2);
+    CHECK(store.Entries()[0].icon == u"Battery 80%");
+    CHECK(store.Entries()[1].owner == 0x333 && store.Entries()[1].icon == u"Back again");
+}
@@ -0,0 +1,114 @@
+#include "Check.h"
+#include "OpenHashMap.h"
+#include <random>
+#include <unordered_map>
+
+namespace {
+    template <typename Key, typename Value>
+    bool SameContents(const OpenHashMap<Key, Value> &map, const std::unordered_map<Key, Value> &reference)
+    {
+        if (map.Size() != reference.size()) return false;
+        size_t visited = 0;
+        bool same = true;
+        map.ForEach([&](Key k, const Value &v) {
+            auto it = reference.find(k);
+            same &= it != reference.end() && it->second == v;
+            visited++;
+        });
+        return same && visited == reference.size();
+    }
+}
+
+TEST(InsertFindEraseBasics)
+{
+    OpenHashMap<uint64_t, int> map;
+    CHECK(map.Empty());
+    CHECK(map.Find(7) == nullptr);
+    CHECK(!map.Erase(7));
+
+    map.Insert(7, 70);
+    map.Insert(0, 1); // Zero is an ordinary key
+    CHECK(map.Size() == 2);
+    CHECK(*map.Find(7) == 70);
+    CHECK(*map.Find(0) == 1);
+
+    map.Insert(7, 71); // Overwrite
+    CHECK(map.Size() == 2);
+    CHECK(*map.Find(7) == 71);
+    *map.Find(0) = 5;
+    CHECK(*map.Find(0) == 5);
+
+    CHECK(map.Erase(7));
+    CHECK(!map.Contains(7));
+    CHECK(map.Size() == 1);
+    map.Clear();
+    CHECK(map.Empty() && !map.Contains(0));
+}
+
+TEST(AlignedHandlesSpreadOut)
+{
+    // Window handles and pointers share low bits; probe runs must stay short anyway
+    OpenHashMap<uintptr_t, uint32_t> map;
+    for (uint32_t i = 0; i < 5000; i++) map.Insert(0x10000 + (uintptr_t)i * 16, i);
+    CHECK(map.Size() == 5000);
+    for (uint32_t i = 0; i < 5000; i++) {
+        const uint32_t *v = map.Find(0x10000 + (uintptr_t)i * 16);
+        REQUIRE(v);
+        CHECK(*v == i);
+    }
+    CHECK(!map.Contains(0x10008));
+}
+
+TEST(ErasingKeepsProbeRunsIntact)
+{
+    // A small table packed to the load limit so runs wrap around the end
+    OpenHashMap<uint64_t, uint64_t> map;
+    for (uint64_t k = 1; k <= 12; k++) map.Insert(k, k * 10);
+    for (uint64_t k = 1; k <= 12; k += 2) CHECK(map.Erase(k));
+    for (uint64_t k = 1; k <= 12; k++) CHECK(map.Contains(k) == (k % 2 == 0));
+    for (uint64_t k = 2; k <= 12; k += 2) CHECK(*map.Find(k) == k * 10);
+}
+
+TEST(MatchesUnorderedMapUnderRandomOperations)
+{
+    std::mt19937_64 rng(17);
+    OpenHashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> reference;
+    for (int step = 0; step < 300000; step++) {
+        // A small key space forces repeated inserts, erases and long collisions
+        uint64_t key = (rng() % 2048) << (step % 3 == 0 ? 12 : 4);
+        switch (rng() % 4) {
+        case 0:
+        case 1: {
+            uint64_t value = rng();
+            map.Insert(key, value);
+            reference[key] = value;
+            break;
+        }
+        case 2:
+            CHECK(map.Erase(key) == (reference.erase(key) == 1));
+            break;
+        default: {
+            const uint64_t *v = map.Find(key);
+            auto it = reference.find(key);
+            CHECK((v != nullptr) == (it != reference.end()));
+            if (v && it != reference.end()) CHECK(*v == it->second);
+        }
+        }
+        if (step % 50000 == 0) CHECK(SameContents(map, reference));
+        if (step == 150000) {
+            map.Clear();
+            reference.clear();
+        }
+    }
+    CHECK(SameContents(map, reference));
+}
+
+TEST(ReserveAvoidsRegrowth)
+{
+    OpenHashMap<uint32_t, uint32_t> map(1000);
+    for (uint32_t i = 0; i < 1000; i++) map.Insert(i, i);
+    map.Reserve(10); // Never shrinks
+    CHECK(map.Size() == 1000);
+    for (uint32_t i = 0; i < 1000; i++) CHECK(*map.Find(i) == i);
+}
@@ -0,0 +1,201 @@
+#include "Check.h"
+#include "PixelOps.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    // Every instruction set this machine can run, scalar first
+    std::vector<PixelIsa> Isas()
+    {
+        std::vector<PixelIsa> out = { PixelIsa::Scalar };
+        if (BestPixelIsa() >= PixelIsa::SSE2) out.push_back(PixelIsa::SSE2);
+        if (BestPixelIsa() >= PixelIsa::AVX2) out.push_back(PixelIsa::AVX2);
+        return out;
+    }
+
+    const char *Name(PixelIsa isa) { return isa == PixelIsa::AVX2 ? "AVX2" : isa == PixelIsa::SSE2 ? "SSE2" : "scalar"; }
+
+    // Restores the process-wide choice when a case ends
+    struct IsaScope {
+        PixelIsa saved = GetPixelIsa();
+        ~IsaScope() { SetPixelIsa(saved); }
+    };
+
+    uint32_t Pack(uint32_t a, uint32_t r, uint32_t g, uint32_t b) { return a << 24 | r << 16 | g << 8 | b; }
+
+    // Every (alpha, channel) pair, with the other channels varied
+    std::vector<uint32_t> AllStraightPixels()
+    {
+        std::vector<uint32_t> out;
+        for (uint32_t a = 0; a < 256; a++) {
+            for (uint32_t c = 0; c < 256; c++) out.push_back(Pack(a, c, 255 - c, (c * 7) & 0xff));
+        }
+        return out;
+    }
+
+    std::vector<uint32_t> RandomPremultiplied(std::mt19937 &rng, size_t count)
+    {
+        std::vector<uint32_t> out(count);
+        for (uint32_t &p : out) {
+            uint32_t a = rng() % 4 == 0 ? (rng() % 2) * 255 : rng() % 256; // Plenty of opaque and clear pixels
+            p = Pack(a, rng() % (a + 1), rng() % (a + 1), rng() % (a + 1));
+        }
+        return out;
+    }
+}
+
+TEST(PremultiplyRoundsToNearest)
+{
+    IsaScope scope;
+    std::vector<uint32_t> source = AllStraightPixels();
+    for (PixelIsa isa : Isas()) {
+        SetPixelIsa(isa);
+        std::vector<uint32_t> px = source;
+        PremultiplyBGRA(px.data(), px.size());
+        size_t wrong = 0;
+        for (size_t i = 0; i < px.size(); i++) {
+            uint32_t a = source[i] >> 24;
+            for (int ch = 0; ch < 3; ch++) {
+                uint32_t c = (source[i] >> (ch * 8)) & 0xff;
+                uint32_t want = (c * a * 2 + 255) / 510; // round(c * a / 255)
+                if (((px[i] >> (ch * 8)) & 0xff) != want) wrong++;
+            }
+            if (px[i] >> 24 != a) wrong++;
+        }
+        if (wrong) std::printf("  %s: %zu wrong channels\n", Name(isa), wrong);
+        CHECK(wrong == 0);
+    }
+}
+
+TEST(VectorKernelsMatchScalarBitForBit)
+{
+    IsaScope scope;
+    std::mt19937 rng(21);
+    std::vector<uint32_t> straight = AllStraightPixels();
+    std::vector<uint32_t> premultiplied = RandomPremultiplied(rng, 70000);
+
+    SetPixelIsa(PixelIsa::Scalar);
+    std::vector<uint32_t> refPre = straight, refUn = premultiplied;
+    PremultiplyBGRA(refPre.data(), refPre.size());
+    UnpremultiplyBGRA(refUn.data(), refUn.size());
+
+    for (PixelIsa isa : Isas()) {
+        SetPixelIsa(isa);
+        CHECK(GetPixelIsa() == isa);
+        std::vector<uint32_t> pre = straight, un = premultiplied;
+        PremultiplyBGRA(pre.data(), pre.size());
+        UnpremultiplyBGRA(un.data(), un.size());
+        CHECK(pre == refPre);
+        CHECK(un == refUn);
+
+        // Lengths and alignments that leave vector tails
+        for (size_t offset = 0; offset < 8; offset++) {
+            for (size_t count = 0; count < 40; count++) {
+                std::vector<uint32_t> a(straight.begin() + 3000, straight.begin() + 3000 + 48), b = a;
+                std::vector<uint32_t> c(premultiplied.begin(), premultiplied.begin() + 48), d = c;
+                PremultiplyBGRA(a.data() + offset, count);
+                UnpremultiplyBGRA(c.data() + offset, count);
+                SetPixelIsa(PixelIsa::Scalar);
+                PremultiplyBGRA(b.data() + offset, count);
+                UnpremultiplyBGRA(d.data() + offset, count);
+                SetPixelIsa(isa);
+                CHECK(a == b); // Including the pixels around the range, untouched
+                CHECK(c == d);
+            }
+        }
+    }
+}
+
+TEST(UnpremultiplyInvertsPremultiply)
+{
+    IsaScope scope;
+    std::vector<uint32_t> source = AllStraightPixels();
+    for (PixelIsa isa : Isas()) {
+        SetPixelIsa(isa);
+        std::vector<uint32_t> pre = source;
+        PremultiplyBGRA(pre.data(), pre.size());
+        std::vector<uint32_t> round = pre;
+        UnpremultiplyBGRA(round.data(), round.size());
+        for (size_t i = 0; i < source.size(); i++) {
+            uint32_t a = source[i] >> 24;
+            if (a == 0) CHECK(round[i] == 0);
+            if (a == 255) CHECK(round[i] == source[i]);
+        }
+        // Premultiplying again lands on the same premultiplied pixel
+        PremultiplyBGRA(round.data(), round.size());
+        CHECK(round == pre);
+    }
+}
+
+TEST(ResampleMatchesScalarBitForBit)
+{
+    IsaScope scope;
+    std::mt19937 rng(210);
+    const ResampleFilter filters[] = { ResampleFilter::Box, ResampleFilter::Lanczos3 };
+    for (int round = 0; round < 150; round++) {
+        int sw = 1 + (int)(rng() % 96), sh = 1 + (int)(rng() % 96);
+        int dw = 1 + (int)(rng() % 64), dh = 1 + (int)(rng() % 64);
+        int srcStride = sw + (int)(rng() % 5), dstStride = dw + (int)(rng() % 5);
+        ResampleFilter filter = filters[round % 2];
+        std::vector<uint32_t> src = RandomPremultiplied(rng, (size_t)srcStride * sh);
+
+        SetPixelIsa(PixelIsa::Scalar);
+        std::vector<uint32_t> want((size_t)dstStride * dh, 0xDEADBEEF);
+        ResampleBGRA(src.data(), sw, sh, srcStride, want.data(), dw, dh, dstStride, filter);
+
+        for (PixelIsa isa : Isas()) {
+            SetPixelIsa(isa);
+            std::vector<uint32_t> got((size_t)dstStride * dh, 0xDEADBEEF);
+            ResampleBGRA(src.data(), sw, sh, srcStride, got.data(), dw, dh, dstStride, filter);
+            if (got != want) std::printf("  %s: %dx%d -> %dx%d differs\n", Name(isa), sw, sh, dw, dh);
+            CHECK(got == want);
+        }
+
+        // Output stays premultiplied, and the row padding is left alone
+        for (int y = 0; y < dh; y++) {
+            for (int x = 0; x < dstStride; x++) {
+                uint32_t p = want[(size_t)y * dstStride + x];
+                if (x >= dw) {
+                    CHECK(p == 0xDEADBEEF);
+                    continue;
+                }
+                uint32_t a = p >> 24;
+                CHECK((p & 0xff) <= a && ((p >> 8) & 0xff) <= a && ((p >> 16) & 0xff) <= a);
+            }
+        }
+    }
+}
+
+TEST(ResampleKeepsFlatColour)
+{
+    IsaScope scope;
+    for (PixelIsa isa : Isas()) {
+        SetPixelIsa(isa);
+        for (ResampleFilter filter : { ResampleFilter::Box, ResampleFilter::Lanczos3 }) {
+            std::vector<uint32_t> src(256 * 256, Pack(255, 40, 120, 200));
+            std::vector<uint32_t> dst(24 * 24);
+            ResampleBGRA(src.data(), 256, 256, 256, dst.data(), 24, 24, 24, filter);
+            for (uint32_t p : dst) {
+                for (int ch = 0; ch < 4; ch++) {
+                    int got = (int)((p >> (ch * 8)) & 0xff), want = (int)((src[0] >> (ch * 8)) & 0xff);
+                    CHECK(got - want <= 1 && want - got <= 1);
+                }
+            }
+        }
+        // Same size is a copy
+        std::vector<uint32_t> src = { 1, 2, 3, 4, 5, 6 }, dst(4, 0);
+        ResampleBGRA(src.data(), 2, 2, 3, dst.data(), 2, 2, 2);
+        CHECK(dst == (std::vector<uint32_t>{ 1, 2, 4, 5 }));
+    }
+}
+
+TEST(IsaSelectionIsClamped)
+{
+    IsaScope scope;
+    SetPixelIsa(PixelIsa::AVX2);
+    CHECK(GetPixelIsa() == BestPixelIsa());
+    SetPixelIsa(PixelIsa::Scalar);
+    CHECK(GetPixelIsa() == PixelIsa::Scalar);
+    std::printf("  best: %s\n", Name(BestPixelIsa()));
+}
@@ -0,0 +1,185 @@
+#include "Check.h"
+#include "ProcessCache.h"
+#include "WindowRegistry.h"
+#include <map>
+#include <random>
+
+namespace {
+    // A process table; handles remember which process they were opened on
+    class FakeProcesses : public ProcessSource
+    {
+    public:
+        struct Process {
+            uint64_t start = 0;
+            std::wstring path;
+            bool accessible = true;
+        };
+        std::map<uint32_t, Process> table;
+        std::map<uintptr_t, std::pair<uint32_t, uint64_t>> handles; // Open handle -> pid, start
+        uintptr_t nextHandle = 1;
+        uint64_t clock = 100;
+        size_t opens = 0;
+
+        void Start(uint32_t pid, std::wstring path) { table[pid] = { clock++, std::move(path) }; }
+        void Exit(uint32_t pid) { table.erase(pid); }
+
+        uintptr_t Open(uint32_t pid) override
+        {
+            opens++;
+            auto it = table.find(pid);
+            if (it == table.end() || !it->second.accessible) return 0;
+            handles[nextHandle] = { pid, it->second.start };
+            return nextHandle++;
+        }
+        void Close(uintptr_t process) override { CHECK(handles.erase(process) == 1); }
+        uint64_t StartTime(uintptr_t process) const override { return handles.at(process).second; }
+        bool IsAlive(uintptr_t process, uint64_t startTime) const override
+        {
+            auto h = handles.find(process);
+            if (h == handles.end()) return false;
+            auto it = table.find(h->second.first);
+            return it != table.end() && it->second.start == h->second.second && startTime == h->second.second;
+        }
+        std::wstring ImagePath(uintptr_t process) const override
+        {
+            auto it = table.find(handles.at(process).first);
+            return it != table.end() ? it->second.path : std::wstring();
+        }
+        std::wstring DisplayName(const std::wstring &imagePath) const override
+        {
+            return imagePath.substr(imagePath.find_last_of(L'\\') + 1);
+        }
+    };
+}
+
+TEST(RepeatedLookupsHitTheCache)
+{
+    FakeProcesses os;
+    os.Start(10, L"C:\\Browser\\browser.exe");
+    {
+        ProcessCache cache(os);
+        const ProcessInfo *info = cache.Lookup(10);
+        REQUIRE(info);
+        CHECK(info->pid == 10);
+        CHECK(info->imagePath == L"C:\\Browser\\browser.exe");
+        CHECK(info->displayName == L"browser.exe");
+        CHECK(info->pathHash == WindowRegistry::PathHash(L"c:\\browser\\BROWSER.exe"));
+
+        // Forty windows of the same process: one open
+        for (int i = 0; i < 40; i++) CHECK(cache.Lookup(10) == info);
+        CHECK(os.opens == 1);
+        CHECK(cache.hits == 40 && cache.misses == 1);
+        CHECK(cache.Lookup(0) == nullptr);
+    }
+    CHECK(os.handles.empty()); // The destructor closes what it opened
+}
+
+TEST(UnopenableProcessesAreNotCached)
+{
+    FakeProcesses os;
+    os.Start(20, L"C:\\Windows\\System32\\secure.exe");
+    os.table[20].accessible = false;
+    os.Start(21, L"");
+    ProcessCache cache(os);
+
+    CHECK(cache.Lookup(20) == nullptr);
+    CHECK(cache.Lookup(21) == nullptr); // Opened, but no image path
+    CHECK(cache.Lookup(22) == nullptr); // No such process
+    CHECK(cache.failures == 3);
+    CHECK(cache.Count() == 0);
+    CHECK(os.handles.empty());
+}
+
+TEST(RecycledPidsAreRequeried)
+{
+    FakeProcesses os;
+    os.Start(30, L"C:\\editor.exe");
+    ProcessCache cache(os);
+    REQUIRE(cache.Lookup(30));
+
+    // The editor exits and the PID goes to an unrelated process
+    os.Exit(30);
+    os.Start(30, L"C:\\game.exe");
+    const ProcessInfo *info = cache.Lookup(30);
+    REQUIRE(info);
+    CHECK(info->imagePath == L"C:\\game.exe");
+    CHECK(info->startTime == os.table[30].start);
+    CHECK(cache.recycled == 1);
+    CHECK(cache.evictions == 1);
+    CHECK(cache.Count() == 1);
+    CHECK(os.handles.size() == 1);
+
+    // Exited without reuse: gone, and not counted as recycled
+    os.Exit(30);
+    CHECK(cache.Lookup(30) == nullptr);
+    CHECK(cache.recycled == 1);
+    CHECK(cache.Count() == 0);
+}
+
+TEST(SweepDropsExitedProcesses)
+{
+    FakeProcesses os;
+    ProcessCache cache(os);
+    for (uint32_t pid = 100; pid < 110; pid++) {
+        os.Start(pid, L"C:\\app" + std::to_wstring(pid) + L".exe");
+        cache.Lookup(pid);
+    }
+    for (uint32_t pid = 100; pid < 110; pid += 2) os.Exit(pid);
+    os.Exit(101);
+    os.Start(101, L"C:\\other.exe"); // Reused while not being looked at
+
+    CHECK(cache.Sweep() == 6);
+    CHECK(cache.Count() == 4);
+    CHECK(os.handles.size() == 4);
+    CHECK(cache.Sweep() == 0);
+}
+
+TEST(BoundedWithLeastRecentlyUsedEviction)
+{
+    FakeProcesses os;
+    ProcessCache cache(os);
+    const uint32_t total = (uint32_t)ProcessCache::MAX_ENTRIES + 50;
+    for (uint32_t pid = 1; pid <= total; pid++) os.Start(pid, L"C:\\p.exe");
+
+    for (uint32_t pid = 1; pid <= ProcessCache::MAX_ENTRIES; pid++) cache.Lookup(pid);
+    cache.Lookup(1); // Keep the first one warm
+    for (uint32_t pid = ProcessCache::MAX_ENTRIES + 1; pid <= total; pid++) cache.Lookup(pid);
+
+    CHECK(cache.Count() == ProcessCache::MAX_ENTRIES);
+    CHECK(os.handles.size() == ProcessCache::MAX_ENTRIES);
+    CHECK(cache.evictions == 50);
+    size_t opens = os.opens;
+    cache.Lookup(1);
+    CHECK(os.opens == opens);     // Still cached
+    cache.Lookup(2);
+    CHECK(os.opens == opens + 1); // Pushed out
+}
+
+TEST(PidChurnNeverReturnsAStaleProcess)
+{
+    // A build spawning short-lived processes while windows come and go
+    FakeProcesses os;
+    ProcessCache cache(os);
+    std::mt19937 rng(16);
+    for (int step = 0; step < 20000; step++) {
+        uint32_t pid = 4 + (rng() % 200) * 4; // Windows hands out small multiples of four
+        int what = (int)(rng() % 10);
+        if (what == 0) os.Exit(pid);
+        else if (what == 1) os.Start(pid, L"C:\\tool" + std::to_wstring(rng() % 1000) + L".exe");
+        else {
+            const ProcessInfo *info = cache.Lookup(pid);
+            auto it = os.table.find(pid);
+            if (it == os.table.end()) CHECK(info == nullptr);
+            else {
+                REQUIRE(info);
+                CHECK(info->startTime == it->second.start);
+                CHECK(info->imagePath == it->second.path);
+            }
+        }
+        if (step % 1000 == 0) cache.Sweep();
+    }
+    CHECK(cache.recycled > 0);
+    CHECK(os.handles.size() == cache.Count());
+    cache.Clear();
+    CHECK(os.handles.empty());
+}
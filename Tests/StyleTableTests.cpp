@@ -0,0 +1,135 @@
+#include "Check.h"
+#include "ThemeTypes.h"
+
+namespace {
+    Style Colored(float r, float g, float b)
+    {
+        Style s;
+        s.bg = D2D1::ColorF(r, g, b, 1.0f);
+        s.has_bg = true;
+        return s;
+    }
+
+    Style Hover()
+    {
+        Style s = Colored(0.3f, 0.3f, 0.3f);
+        s.radius = 6.0f;
+        s.has_radius = true;
+        return s;
+    }
+
+    Style Active()
+    {
+        Style s;
+        s.fg = D2D1::ColorF(D2D1::ColorF::Crimson);
+        s.has_fg = true;
+        s.font_weight = FontWeight::Bold;
+        s.has_font_weight = true;
+        return s;
+    }
+}
+
+TEST(InternDeduplicatesEqualStyles)
+{
+    StyleTable table;
+    StyleId a = table.Intern(Colored(1, 0, 0));
+    StyleId b = table.Intern(Colored(1, 0, 0));
+    StyleId c = table.Intern(Colored(0, 1, 0));
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK(table.Size() == 2);
+    CHECK(table.Get(a) == Colored(1, 0, 0));
+    CHECK(table.Get(c) == Colored(0, 1, 0));
+
+    // -0 and 0 compare equal, so they must intern to the same id
+    Style zero, negZero;
+    zero.radius = 0.0f;
+    negZero.radius = -0.0f;
+    CHECK(table.Intern(zero) == table.Intern(negZero));
+}
+
+TEST(EveryFieldSeparatesStyles)
+{
+    std::vector<Style> variants(1);
+    auto add = [&variants](auto edit) { Style s; edit(s); variants.push_back(s); };
+    add([](Style &s) { s.fg.g = 0.5f; });
+    add([](Style &s) { s.indicator.a = 1.0f; });
+    add([](Style &s) { s.borderColor.r = 1.0f; });
+    add([](Style &s) { s.radius = 3.0f; });
+    add([](Style &s) { s.padding.left = 2.0f; });
+    add([](Style &s) { s.margin.bottom = 1.0f; });
+    add([](Style &s) { s.font_weight = FontWeight::Bold; });
+    add([](Style &s) { s.borderWidth = 1.0f; });
+    add([](Style &s) { s.has_bg = true; });
+    add([](Style &s) { s.has_fg = true; });
+    add([](Style &s) { s.has_radius = true; });
+    add([](Style &s) { s.has_padding = true; });
+    add([](Style &s) { s.has_margin = true; });
+    add([](Style &s) { s.has_border = true; });
+    add([](Style &s) { s.has_font_weight = true; });
+
+    StyleTable table;
+    for (const Style &s : variants) table.Intern(s);
+    CHECK(table.Size() == variants.size());
+    for (size_t i = 0; i < variants.size(); i++) CHECK(table.Intern(variants[i]) == (StyleId)i);
+}
+
+TEST(CompiledStatesMatchMergingOnTheFly)
+{
+    StyleTable table;
+    ModuleConfig mod;
+    mod.baseStyle = Colored(0.1f, 0.1f, 0.1f);
+    mod.baseStyle.padding = { 2, 8, 2, 8 };
+    mod.baseStyle.has_padding = true;
+    mod.itemStyle = Colored(0.2f, 0.2f, 0.2f);
+    mod.states["hover"] = Hover();
+    mod.states["active"] = Active();
+    mod.thresholds.push_back({ 50, Colored(1, 1, 0) });
+    mod.thresholds.push_back({ 90, Colored(1, 0, 0) });
+    CompileModuleStyles(mod, table);
+
+    const ModuleStyles &ids = mod.styleIds;
+    CHECK(table.Get(ids.base) == mod.baseStyle);
+    CHECK(table.Get(ids.hover) == mod.baseStyle.Merge(Hover()));
+    CHECK(table.Get(ids.active) == Active());
+    CHECK(ids.defaultState == NO_STYLE);
+    CHECK(table.Get(ids.item[0]) == mod.itemStyle);
+    CHECK(table.Get(ids.item[1]) == mod.itemStyle.Merge(Active()));
+    CHECK(table.Get(ids.item[2]) == mod.itemStyle.Merge(Hover()));
+    CHECK(table.Get(ids.item[3]) == mod.itemStyle.Merge(Active()).Merge(Hover()));
+    REQUIRE(ids.thresholds.size() == 2);
+    CHECK(table.Get(ids.thresholds[1]) == mod.baseStyle.Merge(Colored(1, 0, 0)));
+    CHECK(table.Get(ids.thresholds[1]).padding == mod.baseStyle.padding);
+
+    // Without a hover state, hovering shows the base style
+    ModuleConfig plain;
+    plain.baseStyle = Colored(0.1f, 0.1f, 0.1f);
+    CompileModuleStyles(plain, table);
+    CHECK(plain.styleIds.hover == plain.styleIds.base);
+    CHECK(plain.styleIds.active == NO_STYLE);
+
+    // Recompiling doesn't stack thresholds
+    CompileModuleStyles(mod, table);
+    CHECK(mod.styleIds.thresholds.size() == 2);
+}
+
+TEST(ModulesWithTheSameThemeShareEntries)
+{
+    StyleTable table;
+    std::vector<ModuleConfig> modules(200);
+    for (size_t i = 0; i < modules.size(); i++) {
+        ModuleConfig &m = modules[i];
+        // Hover and thresholds replace the background but keep each base's padding
+        m.baseStyle = Colored(0.1f, 0.1f, 0.1f);
+        m.baseStyle.padding.left = (float)(i % 4);
+        m.baseStyle.has_padding = true;
+        m.states["hover"] = Hover();
+        m.thresholds.push_back({ 80, Colored(1, 0, 0) });
+        CompileModuleStyles(m, table);
+    }
+    // Four bases with their hovers and thresholds, plus the item style with and without hover
+    CHECK(table.Size() == 4 * 3 + 2);
+    CHECK(modules[0].styleIds.hover == modules[4].styleIds.hover);
+    CHECK(modules[0].styleIds.hover != modules[1].styleIds.hover);
+    CHECK(table.Size() < NO_STYLE);
+}
@@ -0,0 +1,15 @@
+#include "Check.h"
+
+int main()
+{
+    int failedCases = 0;
+    for (const TestCase &test : TestCases()) {
+        int before = TestFailures();
+        test.run();
+        bool ok = TestFailures() == before;
+        if (!ok) failedCases++;
+        std::printf("[%s] %s\n", ok ? " OK " : "FAIL", test.name);
+    }
+    std::printf("%zu cases, %d failed\n", TestCases().size(), failedCases);
+    return failedCases ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+#include "Check.h"
+#include "TextLayoutCache.h"
+#include <set>
+#include <string>
+
+namespace {
+    // Hands out numbered layouts and tracks which are still alive
+    class FakeShaper : public TextShaper
+    {
+    public:
+        size_t bytesPerChar = 100;
+        bool fail = false;
+        size_t shaped = 0;
+        std::set<uintptr_t> live;
+        size_t doubleReleases = 0;
+
+        bool Shape(std::wstring_view text, const void *, float maxWidth, float maxHeight, ShapedText &out) override {
+            if (fail) return false;
+            uintptr_t handle = ++shaped;
+            live.insert(handle);
+            out.layout = (void *)handle;
+            out.metrics.width = (float)text.size() * 7.0f;
+            out.metrics.height = maxHeight > 0 ? maxHeight : 16.0f;
+            out.metrics.advance = maxWidth > 0 ? maxWidth : out.metrics.width;
+            out.bytes = text.size() * bytesPerChar;
+            return true;
+        }
+        void Release(void *layout) override {
+            if (!live.erase((uintptr_t)layout)) doubleReleases++;
+        }
+    };
+
+    TextFormatDesc Desc(float size, int weight = 400)
+    {
+        TextFormatDesc d;
+        d.family = L"Segoe UI";
+        d.locale = L"en-us";
+        d.size = size;
+        d.weight = weight;
+        return d;
+    }
+}
+
+TEST(FormatIdsAreStableAndShared)
+{
+    TextLayoutCache cache;
+    uint32_t a = cache.FormatId(Desc(12));
+    uint32_t b = cache.FormatId(Desc(12));
+    uint32_t bold = cache.FormatId(Desc(12, 700));
+    uint32_t big = cache.FormatId(Desc(14));
+    CHECK(a != 0);
+    CHECK(a == b);
+    CHECK(a != bold && a != big && bold != big);
+}
+
+TEST(HitsReturnTheSameLayout)
+{
+    FakeShaper shaper;
+    TextLayoutCache cache;
+    uint32_t fmt = cache.FormatId(Desc(12));
+
+    const ShapedText *first = cache.Get(shaper, L"42%", fmt, nullptr, 100, 30);
+    REQUIRE(first);
+    void *layout = first->layout;
+    CHECK(first->metrics.width == 21.0f);
+
+    const ShapedText *again = cache.Get(shaper, std::wstring(L"42%"), fmt, nullptr, 100, 30);
+    REQUIRE(again);
+    CHECK(again->layout == layout);
+    CHECK(cache.hits == 1 && cache.misses == 1);
+
+    // Another box or format is another layout
+    CHECK(cache.Get(shaper, L"42%", fmt, nullptr, 120, 30)->layout != layout);
+    CHECK(cache.Get(shaper, L"42%", cache.FormatId(Desc(12, 700)), nullptr, 100, 30)->layout != layout);
+    CHECK(cache.Count() == 3);
+    CHECK(shaper.shaped == 3);
+}
+
+TEST(EvictsLeastRecentlyUsedUnderBudget)
+{
+    FakeShaper shaper;
+    TextLayoutCache cache(0);
+    uint32_t fmt = cache.FormatId(Desc(12));
+
+    // Measure one entry's cost, then allow exactly three of them
+    cache.SetBudget(SIZE_MAX);
+    cache.Get(shaper, L"aaaa", fmt, nullptr, 50, 20);
+    size_t cost = cache.BytesUsed();
+    cache.Clear();
+    cache.SetBudget(cost * 3);
+
+    cache.Get(shaper, L"aaaa", fmt, nullptr, 50, 20);
+    cache.Get(shaper, L"bbbb", fmt, nullptr, 50, 20);
+    cache.Get(shaper, L"cccc", fmt, nullptr, 50, 20);
+    cache.Get(shaper, L"aaaa", fmt, nullptr, 50, 20); // Touch: b is now the oldest
+    CHECK(cache.evictions == 0);
+
+    cache.Get(shaper, L"dddd", fmt, nullptr, 50, 20);
+    CHECK(cache.evictions == 1);
+    CHECK(cache.Count() == 3);
+    CHECK(cache.BytesUsed() <= cache.GetBudget());
+
+    size_t misses = cache.misses;
+    cache.Get(shaper, L"aaaa", fmt, nullptr, 50, 20);
+    cache.Get(shaper, L"cccc", fmt, nullptr, 50, 20);
+    cache.Get(shaper, L"dddd", fmt, nullptr, 50, 20);
+    CHECK(cache.misses == misses);
+    cache.Get(shaper, L"bbbb", fmt, nullptr, 50, 20);
+    CHECK(cache.misses == misses + 1);
+
+    // Shrinking the budget trims from the old end
+    cache.SetBudget(cost);
+    CHECK(cache.Count() == 1);
+    misses = cache.misses;
+    cache.Get(shaper, L"bbbb", fmt, nullptr, 50, 20);
+    CHECK(cache.misses == misses);
+}
+
+TEST(OversizedEntryStillServesItsCaller)
+{
+    FakeShaper shaper;
+    TextLayoutCache cache(64);
+    uint32_t fmt = cache.FormatId(Desc(12));
+    const ShapedText *s = cache.Get(shaper, L"a very long tooltip string", fmt, nullptr, 300, 20);
+    REQUIRE(s);
+    CHECK(s->layout != nullptr);
+    CHECK(cache.Count() == 1);
+
+    cache.Get(shaper, L"another", fmt, nullptr, 300, 20);
+    CHECK(cache.Count() == 1);
+    CHECK(shaper.live.size() == 1);
+}
+
+TEST(FailedShapesAreNotCached)
+{
+    FakeShaper shaper;
+    TextLayoutCache cache;
+    uint32_t fmt = cache.FormatId(Desc(12));
+    shaper.fail = true;
+    CHECK(cache.Get(shaper, L"x", fmt, nullptr, 10, 10) == nullptr);
+    CHECK(cache.Count() == 0);
+    shaper.fail = false;
+    CHECK(cache.Get(shaper, L"x", fmt, nullptr, 10, 10) != nullptr);
+    CHECK(cache.misses == 2);
+}
+
+TEST(EveryLayoutIsReleasedOnce)
+{
+    FakeShaper first, second;
+    {
+        TextLayoutCache cache(20000);
+        uint32_t fmt = cache.FormatId(Desc(12));
+        for (int i = 0; i < 500; i++) {
+            std::wstring text = std::to_wstring(i % 97);
+            cache.Get(i % 2 ? first : second, text + (i % 2 ? L"a" : L"b"), fmt, nullptr, 40, 20);
+        }
+        CHECK(cache.evictions > 0);
+        CHECK(first.live.size() + second.live.size() == cache.Count());
+
+        // A bar going away drops its shaper's layouts and nobody else's
+        size_t secondLive = second.live.size();
+        cache.EvictShaper(&first);
+        CHECK(first.live.empty());
+        CHECK(second.live.size() == secondLive);
+        CHECK(cache.Count() == secondLive);
+    }
+    CHECK(second.live.empty());
+    CHECK(first.doubleReleases == 0 && second.doubleReleases == 0);
+}
+
+TEST(SteadyBarWorkloadHitsTheCache)
+{
+    // Five modules redrawing every frame: cpu/ram/gpu percentages, a clock, icons
+    FakeShaper shaper;
+    shaper.bytesPerChar = 2000;
+    TextLayoutCache cache;
+    uint32_t text = cache.FormatId(Desc(12));
+    uint32_t icon = cache.FormatId(Desc(14));
+    const std::wstring icons[] = { L"\xE950", L"\xE767", L"\xE701" };
+
+    for (int frame = 0; frame < 6000; frame++) {
+        int minute = frame / 3600;
+        cache.Get(shaper, std::to_wstring(20 + frame / 60 % 15) + L"%", text, nullptr, 60, 30);
+        cache.Get(shaper, std::to_wstring(40 + frame / 90 % 10) + L"%", text, nullptr, 60, 30);
+        cache.Get(shaper, std::to_wstring(55 + frame / 120 % 8) + L"\x00B0", text, nullptr, 60, 30);
+        cache.Get(shaper, L"12:0" + std::to_wstring(minute), text, nullptr, 80, 30);
+        cache.Get(shaper, icons[frame / 500 % 3], icon, nullptr, 30, 30);
+    }
+    double hitRate = (double)cache.hits / (double)(cache.hits + cache.misses);
+    CHECK(hitRate > 0.99);
+    CHECK(cache.BytesUsed() <= cache.GetBudget());
+}
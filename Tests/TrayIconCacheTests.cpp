@@ -0,0 +1,223 @@
+#include "Check.h"
+#include "TrayIconCache.h"
+#include <map>
+#include <random>
+
+namespace {
+    // Icon handles map to pixel buffers; converted images remember what they were made from
+    class FakeConverter : public TrayIconConverter
+    {
+    public:
+        struct Icon {
+            std::vector<uint32_t> pixels;
+            int width = 16;
+            int height = 16;
+        };
+        std::map<uintptr_t, Icon> icons;
+        std::map<uintptr_t, std::vector<uint32_t>> live; // Image -> pixels converted
+        uintptr_t nextImage = 0x9000;
+        size_t reads = 0;
+        bool failConvert = false;
+
+        void Set(uintptr_t icon, uint32_t colour)
+        {
+            icons[icon].pixels.assign(16 * 16, colour);
+        }
+
+        bool Read(uintptr_t icon, std::vector<uint32_t> &pixels, int &width, int &height) override
+        {
+            reads++;
+            auto it = icons.find(icon);
+            if (it == icons.end()) return false;
+            pixels = it->second.pixels;
+            width = it->second.width;
+            height = it->second.height;
+            return true;
+        }
+        void *Convert(std::vector<uint32_t> &pixels, int width, int height) override
+        {
+            CHECK(pixels.size() == (size_t)width * height);
+            if (failConvert) return nullptr;
+            live[nextImage] = pixels;
+            for (uint32_t &p : pixels) p = 0; // Allowed to scribble on its input
+            return reinterpret_cast<void *>(nextImage++);
+        }
+        void Release(void *image) override { CHECK(live.erase(reinterpret_cast<uintptr_t>(image)) == 1); }
+
+        const std::vector<uint32_t> *PixelsOf(void *image) const
+        {
+            auto it = live.find(reinterpret_cast<uintptr_t>(image));
+            return it != live.end() ? &it->second : nullptr;
+        }
+    };
+}
+
+TEST(UnchangedRevisionsAreNotReadAgain)
+{
+    FakeConverter converter;
+    converter.Set(1, 0xFF0000FF);
+    converter.Set(2, 0xFF00FF00);
+    TrayIconCache cache(converter);
+    std::vector<void *> images;
+    std::vector<TrayIconRef> tray = { { 0x100, 1, 1, 1 }, { 0x200, 1, 1, 2 } };
+
+    cache.Update(tray, images);
+    REQUIRE(images.size() == 2);
+    CHECK(images[0] && images[1] && images[0] != images[1]);
+    CHECK(cache.converts == 2 && converter.reads == 2);
+
+    // Opening the flyout again, many times
+    std::vector<void *> again;
+    for (int i = 0; i < 50; i++) cache.Update(tray, again);
+    CHECK(again == images);
+    CHECK(converter.reads == 2);
+    CHECK(cache.hits == 100);
+}
+
+TEST(ResentPixelsKeepTheBitmap)
+{
+    FakeConverter converter;
+    converter.Set(1, 0xFF336699);
+    TrayIconCache cache(converter);
+    std::vector<void *> first, images;
+    cache.Update({ { 0x100, 7, 1, 1 } }, first);
+
+    // The app sets the same image again under a new revision (and a new handle)
+    converter.Set(2, 0xFF336699);
+    cache.Update({ { 0x100, 7, 2, 2 } }, images);
+    CHECK(images == first);
+    CHECK(cache.pixelHits == 1 && cache.converts == 1);
+
+    // A real change converts and releases the old bitmap
+    converter.Set(2, 0xFF000000);
+    cache.Update({ { 0x100, 7, 3, 2 } }, images);
+    CHECK(images[0] != first[0]);
+    CHECK(cache.converts == 2);
+    CHECK(converter.live.size() == 1);
+    CHECK((*converter.PixelsOf(images[0]))[0] == 0xFF000000);
+}
+
+TEST(KeyedByOwnerAndId)
+{
+    FakeConverter converter;
+    converter.Set(1, 1);
+    converter.Set(2, 2);
+    converter.Set(3, 3);
+    TrayIconCache cache(converter);
+    std::vector<void *> images;
+    cache.Update({ { 0x100, 1, 1, 1 }, { 0x100, 2, 1, 2 }, { 0x200, 1, 1, 3 } }, images);
+    CHECK(cache.Count() == 3);
+
+    // Reordered tray: each image follows its icon
+    std::vector<void *> reordered;
+    cache.Update({ { 0x200, 1, 1, 3 }, { 0x100, 1, 1, 1 }, { 0x100, 2, 1, 2 } }, reordered);
+    CHECK(reordered[0] == images[2] && reordered[1] == images[0] && reordered[2] == images[1]);
+    CHECK(cache.converts == 3);
+}
+
+TEST(IconsLeavingTheTrayAreReleased)
+{
+    FakeConverter converter;
+    converter.Set(1, 1);
+    converter.Set(2, 2);
+    TrayIconCache cache(converter);
+    std::vector<void *> images;
+    cache.Update({ { 0x100, 1, 1, 1 }, { 0x200, 1, 1, 2 } }, images);
+    cache.Update({ { 0x200, 1, 1, 2 } }, images);
+    CHECK(cache.Count() == 1);
+    CHECK(cache.dropped == 1);
+    CHECK(converter.live.size() == 1);
+
+    // Coming back is a fresh read
+    size_t reads = converter.reads;
+    cache.Update({ { 0x100, 1, 1, 1 }, { 0x200, 1, 1, 2 } }, images);
+    CHECK(converter.reads == reads + 1);
+
+    cache.Update({}, images);
+    CHECK(images.empty());
+    CHECK(converter.live.empty());
+}
+
+TEST(FailuresYieldNullAndReleaseOldImages)
+{
+    FakeConverter converter;
+    converter.Set(1, 1);
+    TrayIconCache cache(converter);
+    std::vector<void *> images;
+    cache.Update({ { 0x100, 1, 1, 0 }, { 0x100, 2, 1, 99 } }, images); // No handle; unreadable
+    CHECK(!images[0] && !images[1]);
+    CHECK(cache.failures == 2);
+
+    // Failure is remembered per revision, not retried every update
+    size_t reads = converter.reads;
+    cache.Update({ { 0x100, 1, 1, 0 }, { 0x100, 2, 1, 99 } }, images);
+    CHECK(converter.reads == reads);
+
+    cache.Update({ { 0x100, 1, 2, 1 } }, images);
+    REQUIRE(images[0]);
+    converter.icons.erase(1);
+    cache.Update({ { 0x100, 1, 3, 1 } }, images);
+    CHECK(!images[0]);
+    CHECK(converter.live.empty());
+
+    converter.Set(1, 5);
+    converter.failConvert = true;
+    cache.Update({ { 0x100, 1, 4, 1 } }, images);
+    CHECK(!images[0]);
+    CHECK(cache.failures == 4);
+}
+
+TEST(SyntheticSequenceConvertsOnlyRealChanges)
+{
+    // Twenty icons; apps bump revisions constantly, the pixels change now and then
+    FakeConverter converter;
+    TrayIconCache cache(converter);
+    std::mt19937 rng(23);
+    struct App { TrayIconRef ref; uint32_t colour; bool shown; };
+    std::vector<App> apps;
+    for (uint32_t i = 0; i < 20; i++) {
+        apps.push_back({ { 0x1000 + (uintptr_t)i * 16, i % 3, 1, 100 + (uintptr_t)i }, 0xFF000000u | i, true });
+        converter.Set(apps.back().ref.icon, apps.back().colour);
+    }
+
+    size_t changes = 20;
+    std::vector<void *> images;
+    for (int update = 0; update < 500; update++) {
+        for (App &app : apps) {
+            int what = (int)(rng() % 20);
+            if (what == 0) {
+                app.colour = 0xFF000000u | rng() % 0xFFFFFF;
+                converter.Set(app.ref.icon, app.colour);
+                app.ref.revision++;
+                if (app.shown) changes++;
+            }
+            else if (what < 6) app.ref.revision++; // Same picture again
+            else if (what == 6 && !app.shown) {
+                app.shown = true;
+                changes++;
+            }
+            else if (what == 7) app.shown = false;
+        }
+        std::vector<TrayIconRef> tray;
+        std::vector<uint32_t> colours;
+        for (const App &app : apps) {
+            if (!app.shown) continue;
+            tray.push_back(app.ref);
+            colours.push_back(app.colour);
+        }
+        cache.Update(tray, images);
+        REQUIRE(images.size() == tray.size());
+        for (size_t i = 0; i < images.size(); i++) {
+            const std::vector<uint32_t> *px = converter.PixelsOf(images[i]);
+            REQUIRE(px);
+            CHECK((*px)[0] == colours[i]);
+        }
+        CHECK(cache.Count() == tray.size());
+        CHECK(converter.live.size() == tray.size());
+    }
+    // A hidden app whose colour changed converts once when it returns, so changes bounds converts
+    CHECK(cache.converts <= changes);
+    CHECK(cache.converts * 3 < cache.hits + cache.pixelHits);
+    cache.Clear();
+    CHECK(converter.live.empty());
+}
@@ -0,0 +1,220 @@
+#include "Check.h"
+#include "WinEventQueue.h"
+#include <set>
+
+namespace {
+    // App windows are the ones the test says are
+    class FakeClassifier : public WindowClassifier
+    {
+    public:
+        std::set<uintptr_t> apps;
+        mutable size_t queries = 0;
+        bool IsAppWindow(uintptr_t hwnd) const override { queries++; return apps.count(hwnd) != 0; }
+    };
+
+    // One recorded hook callback
+    struct Recorded {
+        uint32_t event;
+        uintptr_t hwnd;
+        int32_t idObject = WinEvent::OBJID_WINDOW;
+        int32_t idChild = WinEvent::CHILDID_SELF;
+    };
+
+    // Push a frame's worth of events; returns how many asked for a frame
+    int Replay(WinEventQueue &queue, std::initializer_list<Recorded> events)
+    {
+        int wakes = 0;
+        for (const Recorded &e : events) wakes += queue.Push(e.event, e.hwnd, e.idObject, e.idChild);
+        return wakes;
+    }
+
+    const WindowEventEntry *EntryFor(const WinEventBatch &batch, uintptr_t hwnd)
+    {
+        for (const WindowEventEntry &e : batch.windows) {
+            if (e.hwnd == hwnd) return &e;
+        }
+        return nullptr;
+    }
+}
+
+TEST(FiltersObjectsInsideWindows)
+{
+    FakeClassifier classifier;
+    classifier.apps = { 0x10 };
+    WinEventQueue queue(classifier);
+
+    int wakes = Replay(queue, {
+        { WinEvent::OBJECT_NAMECHANGE, 0x10, -8 /* OBJID_CARET */ },
+        { WinEvent::OBJECT_SHOW, 0x10, WinEvent::OBJID_WINDOW, 3 },  // A child item
+        { WinEvent::OBJECT_SHOW, 0 },
+        { WinEvent::OBJECT_SHOW, 0x99 },                              // Tooltip: not an app window
+        { WinEvent::OBJECT_CREATE, 0x10 },                            // Creation is ignored
+    });
+    CHECK(wakes == 0);
+    CHECK(!queue.HasPending());
+    CHECK(queue.filtered == 5);
+
+    WinEventBatch batch;
+    CHECK(!queue.Drain(batch));
+    CHECK(batch.routes == WINEVENT_ROUTE_NONE);
+}
+
+TEST(CoalescesARenameStorm)
+{
+    FakeClassifier classifier;
+    classifier.apps = { 0x10 };
+    WinEventQueue queue(classifier);
+    queue.Track(0x10);
+    WinEventBatch batch;
+
+    // A browser retitling itself every few milliseconds across ten frames
+    for (int frame = 0; frame < 10; frame++) {
+        int wakes = 0;
+        for (int i = 0; i < 20; i++) wakes += queue.Push(WinEvent::OBJECT_NAMECHANGE, 0x10, 0, 0);
+        CHECK(wakes == 1);
+        REQUIRE(queue.Drain(batch));
+        REQUIRE(batch.windows.size() == 1);
+        CHECK(batch.windows[0].changes == WINDOW_RENAMED);
+        CHECK(batch.routes == WINEVENT_ROUTE_DOCK);
+    }
+    CHECK(queue.received == 200);
+    CHECK(queue.coalesced == 190);
+    CHECK(queue.batches == 10);
+    CHECK(classifier.queries == 0); // Known windows skip the classifier
+}
+
+TEST(ShortLivedWindowsNeverReachTheBars)
+{
+    FakeClassifier classifier;
+    classifier.apps = { 0x20 };
+    WinEventQueue queue(classifier);
+
+    int wakes = Replay(queue, {
+        { WinEvent::OBJECT_SHOW, 0x20 },
+        { WinEvent::OBJECT_NAMECHANGE, 0x20 },
+        { WinEvent::OBJECT_DESTROY, 0x20 },
+    });
+    CHECK(wakes == 1);
+    WinEventBatch batch;
+    CHECK(!queue.Drain(batch));
+    CHECK(batch.windows.empty());
+    CHECK(!queue.IsTracked(0x20));
+}
+
+TEST(HidesAndDestroysNeedAKnownWindow)
+{
+    FakeClassifier classifier;
+    WinEventQueue queue(classifier);
+    queue.Track(0x30);
+
+    Replay(queue, {
+        { WinEvent::OBJECT_HIDE, 0x31 },    // Never seen
+        { WinEvent::OBJECT_DESTROY, 0x32 }, // Never seen
+        { WinEvent::OBJECT_CLOAKED, 0x30 },
+    });
+    WinEventBatch batch;
+    REQUIRE(queue.Drain(batch));
+    REQUIRE(batch.windows.size() == 1);
+    CHECK(batch.windows[0].hwnd == 0x30);
+    CHECK(batch.windows[0].changes == WINDOW_HIDDEN);
+
+    // Hidden then shown again within a frame nets out to shown
+    Replay(queue, { { WinEvent::OBJECT_HIDE, 0x30 }, { WinEvent::OBJECT_UNCLOAKED, 0x30 } });
+    REQUIRE(queue.Drain(batch));
+    CHECK(batch.windows[0].changes == WINDOW_SHOWN);
+
+    Replay(queue, { { WinEvent::OBJECT_DESTROY, 0x30 } });
+    REQUIRE(queue.Drain(batch));
+    CHECK(batch.windows[0].changes == WINDOW_DESTROYED);
+    CHECK(batch.routes == (WINEVENT_ROUTE_DOCK | WINEVENT_ROUTE_WORKSPACES));
+    CHECK(!queue.IsTracked(0x30));
+}
+
+TEST(ForegroundChangesRouteToBothModules)
+{
+    FakeClassifier classifier;
+    classifier.apps = { 0x40 };
+    WinEventQueue queue(classifier);
+    WinEventBatch batch;
+
+    // Focus on the desktop: no window entry, but the active item changes
+    Replay(queue, { { WinEvent::SYSTEM_FOREGROUND, 0x77 } });
+    REQUIRE(queue.Drain(batch));
+    CHECK(batch.foregroundChanged && batch.foreground == 0x77);
+    CHECK(batch.windows.empty());
+    CHECK(batch.routes == (WINEVENT_ROUTE_DOCK | WINEVENT_ROUTE_WORKSPACES));
+
+    // Alt-tabbing through windows: the last one wins
+    Replay(queue, { { WinEvent::SYSTEM_FOREGROUND, 0x77 }, { WinEvent::SYSTEM_FOREGROUND, 0x40 } });
+    REQUIRE(queue.Drain(batch));
+    CHECK(batch.foreground == 0x40);
+    const WindowEventEntry *e = EntryFor(batch, 0x40);
+    REQUIRE(e);
+    CHECK(e->changes == WINDOW_FOCUSED);
+    CHECK(queue.IsTracked(0x40));
+}
+
+TEST(MovesAreGeometryOnly)
+{
+    FakeClassifier classifier;
+    WinEventQueue queue(classifier);
+    queue.Track(0x50);
+    WinEventBatch batch;
+
+    // A drag: one entry per frame, and nothing for untracked windows
+    int wakes = 0;
+    for (int i = 0; i < 30; i++) wakes += queue.Push(WinEvent::OBJECT_LOCATIONCHANGE, 0x50, 0, 0);
+    wakes += queue.Push(WinEvent::OBJECT_LOCATIONCHANGE, 0x51, 0, 0);
+    CHECK(wakes == 1);
+    REQUIRE(queue.Drain(batch));
+    REQUIRE(batch.windows.size() == 1);
+    CHECK(batch.windows[0].changes == WINDOW_MOVED);
+    CHECK(batch.routes == WINEVENT_ROUTE_GEOMETRY);
+
+    // Moved and renamed: the dock hears about it too
+    Replay(queue, { { WinEvent::OBJECT_LOCATIONCHANGE, 0x50 }, { WinEvent::OBJECT_NAMECHANGE, 0x50 } });
+    REQUIRE(queue.Drain(batch));
+    CHECK(batch.windows[0].changes == (WINDOW_MOVED | WINDOW_RENAMED));
+    CHECK(batch.routes == (WINEVENT_ROUTE_GEOMETRY | WINEVENT_ROUTE_DOCK));
+}
+
+TEST(RecordedSessionReplay)
+{
+    // Opening an app, typing in it, switching away, closing it
+    FakeClassifier classifier;
+    classifier.apps = { 0x100, 0x200 };
+    WinEventQueue queue(classifier);
+    queue.Track(0x200);
+    WinEventBatch batch;
+
+    Replay(queue, {
+        { WinEvent::OBJECT_CREATE, 0x100 },
+        { WinEvent::OBJECT_SHOW, 0x100 },
+        { WinEvent::SYSTEM_FOREGROUND, 0x100 },
+        { WinEvent::OBJECT_NAMECHANGE, 0x100 },
+        { WinEvent::OBJECT_SHOW, 0x100, -4 /* OBJID_CLIENT */ },
+    });
+    REQUIRE(queue.Drain(batch));
+    REQUIRE(batch.windows.size() == 1);
+    CHECK(batch.windows[0].changes == (WINDOW_SHOWN | WINDOW_FOCUSED | WINDOW_RENAMED));
+
+    // Typing moves the caret and renames the window ("*Untitled")
+    Replay(queue, {
+        { WinEvent::OBJECT_LOCATIONCHANGE, 0x100, -8 /* OBJID_CARET */ },
+        { WinEvent::OBJECT_NAMECHANGE, 0x100 },
+        { WinEvent::OBJECT_LOCATIONCHANGE, 0x100, -8 },
+    });
+    REQUIRE(queue.Drain(batch));
+    CHECK(batch.windows.size() == 1 && batch.windows[0].changes == WINDOW_RENAMED);
+
+    Replay(queue, { { WinEvent::SYSTEM_FOREGROUND, 0x200 }, { WinEvent::OBJECT_HIDE, 0x100 }, { WinEvent::OBJECT_DESTROY, 0x100 } });
+    REQUIRE(queue.Drain(batch));
+    CHECK(EntryFor(batch, 0x100)->changes == WINDOW_DESTROYED);
+    CHECK(EntryFor(batch, 0x200)->changes == WINDOW_FOCUSED);
+    CHECK(batch.routes == (WINEVENT_ROUTE_DOCK | WINEVENT_ROUTE_WORKSPACES));
+
+    // Quiet afterwards
+    CHECK(!queue.HasPending());
+    CHECK(!queue.Drain(batch));
+    CHECK(queue.TrackedCount() == 1);
+}
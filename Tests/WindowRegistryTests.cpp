@@ -0,0 +1,304 @@
+#include "Check.h"
+#include "WindowRegistry.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace {
+    // A desktop held in memory: z-order, titles and exe paths
+    class FakeDesktop : public WindowSystem
+    {
+    public:
+        struct Window {
+            std::wstring title;
+            std::wstring exe;
+            bool app = true;
+        };
+        std::map<uintptr_t, Window> windows;
+        std::vector<uintptr_t> zorder; // Top first
+        mutable size_t enumerations = 0;
+
+        void Open(uintptr_t hwnd, std::wstring title, std::wstring exe, bool app = true)
+        {
+            windows[hwnd] = { std::move(title), std::move(exe), app };
+            zorder.insert(zorder.begin(), hwnd);
+        }
+        void Close(uintptr_t hwnd)
+        {
+            windows.erase(hwnd);
+            zorder.erase(std::find(zorder.begin(), zorder.end(), hwnd));
+        }
+
+        void EnumerateAppWindows(std::vector<uintptr_t> &out) const override
+        {
+            enumerations++;
+            for (uintptr_t h : zorder) {
+                if (windows.at(h).app) out.push_back(h);
+            }
+        }
+        bool IsAppWindow(uintptr_t hwnd) const override
+        {
+            auto it = windows.find(hwnd);
+            return it != windows.end() && it->second.app;
+        }
+        std::wstring GetTitle(uintptr_t hwnd) const override
+        {
+            auto it = windows.find(hwnd);
+            return it != windows.end() ? it->second.title : std::wstring();
+        }
+        std::wstring GetExePath(uintptr_t hwnd) const override
+        {
+            auto it = windows.find(hwnd);
+            return it != windows.end() ? it->second.exe : std::wstring();
+        }
+    };
+
+    std::vector<uintptr_t> Order(const WindowRegistry &registry)
+    {
+        std::vector<const WindowRecord *> snapshot;
+        registry.Snapshot(snapshot);
+        std::vector<uintptr_t> out;
+        for (const WindowRecord *r : snapshot) out.push_back(r->hwnd);
+        return out;
+    }
+
+    // What the registry should hold after a Sync: the desktop's app windows
+    std::vector<uintptr_t> Expected(const FakeDesktop &desktop)
+    {
+        std::vector<uintptr_t> out;
+        desktop.EnumerateAppWindows(out);
+        return out;
+    }
+
+    WinEventBatch Batch(std::initializer_list<WindowEventEntry> entries)
+    {
+        WinEventBatch batch;
+        batch.windows = entries;
+        return batch;
+    }
+}
+
+TEST(FirstSyncSeedsInZOrder)
+{
+    FakeDesktop desktop;
+    desktop.Open(1, L"Notes", L"C:\\Windows\\notepad.exe");
+    desktop.Open(2, L"Tooltip", L"C:\\app.exe", false);
+    desktop.Open(3, L"Inbox", L"C:\\Mail\\mail.exe");
+
+    WindowRegistry registry(desktop);
+    CHECK(registry.Version() == 0);
+    CHECK(registry.Sync());
+    CHECK(registry.Version() == 1);
+    CHECK(Order(registry) == (std::vector<uintptr_t>{ 3, 1 }));
+    REQUIRE(registry.Find(1));
+    CHECK(registry.Find(1)->title == L"Notes");
+    CHECK(registry.Find(1)->pathHash == WindowRegistry::PathHash(L"c:\\windows\\NOTEPAD.EXE"));
+    CHECK(!registry.Find(2));
+
+    // Nothing changed: no new version
+    CHECK(!registry.Sync());
+    CHECK(registry.Version() == 1);
+}
+
+TEST(SyncDiffsAgainstTheDesktop)
+{
+    FakeDesktop desktop;
+    desktop.Open(1, L"a", L"a.exe");
+    desktop.Open(2, L"b", L"b.exe");
+    WindowRegistry registry(desktop);
+    registry.Sync();
+
+    // Missed events: one closed, two opened, one retitled
+    desktop.Close(1);
+    desktop.Open(3, L"c", L"c.exe");
+    desktop.Open(4, L"d", L"d.exe");
+    desktop.windows[2].title = L"b*";
+    CHECK(registry.Sync());
+    CHECK(registry.Version() == 2);
+    CHECK(Order(registry) == (std::vector<uintptr_t>{ 4, 3, 2 }));
+    CHECK(registry.Find(2)->title == L"b*");
+    CHECK(registry.adds == 4 && registry.removes == 1 && registry.renames == 1);
+
+    // All of it is one version's worth of deltas
+    std::vector<WindowDelta> deltas;
+    REQUIRE(registry.DeltasSince(1, deltas));
+    CHECK(deltas.size() == 4);
+    for (const WindowDelta &d : deltas) CHECK(d.version == 2);
+}
+
+TEST(IncrementalEventsEditInPlace)
+{
+    FakeDesktop desktop;
+    desktop.Open(1, L"a", L"a.exe");
+    WindowRegistry registry(desktop);
+    registry.Sync();
+
+    desktop.Open(2, L"", L"b.exe", false);
+    CHECK(!registry.OnShown(2));        // Not an app window yet
+    desktop.windows[2] = { L"Ready", L"b.exe", true };
+    CHECK(registry.OnRenamed(2));       // Gaining a title makes it qualify
+    CHECK(Order(registry) == (std::vector<uintptr_t>{ 2, 1 }));
+
+    CHECK(!registry.OnRenamed(1));      // Same title
+    desktop.windows[1].title = L"a2";
+    CHECK(registry.OnShown(1));         // Already listed: shown picks up the title
+    CHECK(registry.Find(1)->title == L"a2");
+
+    CHECK(registry.OnRemoved(2));
+    CHECK(!registry.OnRemoved(2));
+    CHECK(!registry.Find(2));
+    CHECK(registry.Count() == 1);
+
+    // A window that stops qualifying while shown is dropped
+    desktop.windows[1].app = false;
+    CHECK(registry.OnShown(1));
+    CHECK(registry.Count() == 0);
+    CHECK(desktop.enumerations == 1);
+}
+
+TEST(ApplyRoutesBatchEntries)
+{
+    FakeDesktop desktop;
+    desktop.Open(1, L"a", L"a.exe");
+    desktop.Open(2, L"b", L"b.exe");
+    WindowRegistry registry(desktop);
+    registry.Sync();
+    uint64_t seeded = registry.Version();
+
+    // Drags don't touch the record, even for a window the registry hasn't heard of
+    desktop.Open(9, L"unseen", L"u.exe");
+    CHECK(!registry.Apply(Batch({ { 1, WINDOW_MOVED }, { 2, WINDOW_MOVED }, { 9, WINDOW_MOVED } })));
+    CHECK(registry.Version() == seeded);
+    CHECK(!registry.Find(9));
+    desktop.Close(9);
+
+    desktop.Open(3, L"c", L"c.exe");
+    desktop.windows[1].title = L"a*";
+    CHECK(registry.Apply(Batch({
+        { 1, WINDOW_MOVED | WINDOW_RENAMED },
+        { 2, WINDOW_HIDDEN },
+        { 3, WINDOW_FOCUSED },            // Focused before its show arrived
+    })));
+    CHECK(Order(registry) == (std::vector<uintptr_t>{ 3, 1 }));
+    CHECK(registry.Find(1)->title == L"a*");
+
+    // A focus change on a listed window is not a list change
+    CHECK(!registry.Apply(Batch({ { 1, WINDOW_FOCUSED } })));
+}
+
+TEST(DeltaLogReplaysAndExpires)
+{
+    FakeDesktop desktop;
+    WindowRegistry registry(desktop);
+    registry.Sync();
+    uint64_t start = registry.Version();
+
+    // A consumer keeping its own set from deltas stays in step with Snapshot
+    std::vector<uintptr_t> mirror;
+    std::vector<WindowDelta> deltas;
+    uint64_t seen = start;
+    for (uintptr_t h = 1; h <= 40; h++) {
+        desktop.Open(h, L"w", L"w.exe");
+        registry.OnShown(h);
+        if (h % 3 == 0) {
+            desktop.Close(h - 1);
+            registry.OnRemoved(h - 1);
+        }
+        if (h % 10 == 0) {
+            REQUIRE(registry.DeltasSince(seen, deltas));
+            for (const WindowDelta &d : deltas) {
+                CHECK(d.version > seen && d.version <= registry.Version());
+                if (d.kind == WindowDelta::Added) mirror.push_back(d.hwnd);
+                else if (d.kind == WindowDelta::Removed) mirror.erase(std::find(mirror.begin(), mirror.end(), d.hwnd));
+            }
+            seen = registry.Version();
+            std::vector<uintptr_t> live = Order(registry);
+            std::sort(live.begin(), live.end());
+            std::sort(mirror.begin(), mirror.end());
+            CHECK(live == mirror);
+        }
+    }
+    CHECK(registry.DeltasSince(registry.Version(), deltas) && deltas.empty());
+    CHECK(!registry.DeltasSince(registry.Version() + 1, deltas));
+
+    // Enough churn pushes the start out of the log
+    for (uintptr_t h = 1000; h < 6000; h++) {
+        desktop.Open(h, L"x", L"x.exe");
+        registry.OnShown(h);
+    }
+    CHECK(!registry.DeltasSince(start, deltas));
+    CHECK(registry.DeltasSince(registry.Version() - 10, deltas));
+    CHECK(deltas.size() == 10);
+}
+
+TEST(PinnedAppsClaimWindowsInOrder)
+{
+    FakeDesktop desktop;
+    desktop.Open(1, L"term 1", L"C:\\term.exe");
+    desktop.Open(2, L"browser", L"C:\\Browser\\browser.exe");
+    desktop.Open(3, L"term 2", L"C:\\TERM.exe");
+    desktop.Open(4, L"chat", L"C:\\chat.exe");
+    WindowRegistry registry(desktop);
+    registry.Sync(); // Order: 4, 3, 2, 1
+
+    size_t term = WindowRegistry::PathHash(L"c:\\term.exe");
+    size_t editor = WindowRegistry::PathHash(L"c:\\editor.exe");
+    std::vector<WindowListEntry> list;
+    registry.MergePinned({ term, editor, term, term }, list);
+
+    REQUIRE(list.size() == 6);
+    CHECK(list[0].pinnedIndex == 0 && list[0].window && list[0].window->hwnd == 3);
+    CHECK(list[1].pinnedIndex == 1 && !list[1].window);     // Pinned, not running
+    CHECK(list[2].pinnedIndex == 2 && list[2].window->hwnd == 1);
+    CHECK(list[3].pinnedIndex == 3 && !list[3].window);     // More pins than windows
+    CHECK(list[4].pinnedIndex == -1 && list[4].window->hwnd == 4);
+    CHECK(list[5].pinnedIndex == -1 && list[5].window->hwnd == 2);
+
+    registry.MergePinned({}, list);
+    CHECK(list.size() == 4);
+}
+
+TEST(ThousandsOfWindowsStayInStep)
+{
+    FakeDesktop desktop;
+    std::mt19937 rng(15);
+    uintptr_t next = 1;
+    for (int i = 0; i < 3000; i++, next++) {
+        desktop.Open(next, L"w" + std::to_wstring(next), L"app" + std::to_wstring(rng() % 80) + L".exe", rng() % 4 != 0);
+    }
+    WindowRegistry registry(desktop);
+    registry.Sync();
+    CHECK(Order(registry) == Expected(desktop));
+
+    // Churn through events, missing some; the periodic Sync closes the gap
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 100; i++) {
+            int what = (int)(rng() % 3);
+            bool deliver = rng() % 10 != 0;
+            if (what == 0) {
+                desktop.Open(next, L"new", L"app" + std::to_wstring(rng() % 80) + L".exe", rng() % 4 != 0);
+                if (deliver) registry.OnShown(next);
+                next++;
+            }
+            else if (!desktop.zorder.empty()) {
+                uintptr_t h = desktop.zorder[rng() % desktop.zorder.size()];
+                if (what == 1) {
+                    desktop.Close(h);
+                    if (deliver) registry.OnRemoved(h);
+                }
+                else {
+                    desktop.windows[h].title += L"*";
+                    if (deliver) registry.OnRenamed(h);
+                }
+            }
+        }
+        registry.Sync();
+        std::vector<uintptr_t> live = Order(registry), expected = Expected(desktop);
+        CHECK(live.size() == expected.size());
+        std::sort(live.begin(), live.end());
+        std::sort(expected.begin(), expected.end());
+        CHECK(live == expected);
+        for (uintptr_t h : expected) CHECK(registry.Find(h)->title == desktop.windows[h].title);
+    }
+    CHECK(registry.syncs == 21);
+}